@@ -27,6 +27,9 @@ namespace UnrealBuildTool.Rules
 					"Networking",
 					"Projects",
 					"RenderCore",
+					"RHI",
+					"Slate",
+					"SlateCore",
 				});
 
 			PrivateIncludePathModuleNames.AddRange(
@@ -38,13 +41,20 @@ namespace UnrealBuildTool.Rules
 				new string[] {
 					"NdiMedia/Private",
 					"NdiMedia/Private/Assets",
+					"NdiMedia/Private/Components",
+					"NdiMedia/Private/Discovery",
 					"NdiMedia/Private/Ndi",
 					"NdiMedia/Private/Player",
+					"NdiMedia/Private/Processing",
+					"NdiMedia/Private/Sender",
 					"NdiMedia/Private/Shared",
+					"NdiMedia/Private/Thumbnails",
 				});
 
 			PublicDependencyModuleNames.AddRange(
 				new string[] {
+					"AudioMixer",
+					"Engine",
 					"MediaAssets",
 				});
 
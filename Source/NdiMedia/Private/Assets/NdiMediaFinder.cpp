@@ -2,16 +2,68 @@
 
 #include "NdiMediaFinder.h"
 
-#include "Ndi.h"
 #include "NdiMediaPrivate.h"
 
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Set.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include "Ndi.h"
+#include "NdiMediaSourceDiscovery.h"
+#include "NdiMediaSourceRegistry.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/**
+ * Get the groups that sources found by a discovery belong to.
+ *
+ * @param Discovery The discovery.
+ * @param OutGroups Will contain the group names.
+ */
+static void GetDiscoveryGroups(const FNdiMediaSourceDiscovery& Discovery, TArray<FString>& OutGroups)
+{
+	OutGroups.Reset();
+	Discovery.GetGroups().ParseIntoArray(OutGroups, TEXT(","), true);
+
+	// sources are in the default group if no groups are specified
+	if (OutGroups.Num() == 0)
+	{
+		OutGroups.Add(TEXT("public"));
+	}
+}
+
+
+/**
+ * Stop a discovery and destroy it on a background thread.
+ *
+ * The discovery thread may be blocked in the NDI find instance for a while.
+ *
+ * @param Discovery The discovery to release.
+ */
+static void ReleaseDiscovery(FNdiMediaSourceDiscovery* Discovery)
+{
+	Discovery->Stop();
+
+	FNdi::ReleaseAsync([Discovery]() {
+		delete Discovery;
+	});
+}
+
 
 /* UNdiMediaFinder structors
  *****************************************************************************/
 
 UNdiMediaFinder::UNdiMediaFinder()
 	: ShowLocalSources(true)
-	, FindInstance(nullptr)
+	, Discovery(nullptr)
+	, DiscoveryGeneration(0)
+	, NextDiscoveryGeneration(0)
+	, PendingDiscovery(nullptr)
+	, PendingDiscoveryGeneration(0)
+	, Registry(MakeShared<FNdiMediaSourceRegistry>())
+	, RestartScheduled(false)
 { }
 
 
@@ -23,7 +75,7 @@ void UNdiMediaFinder::AddExtraAddress(const FString& Address)
 	if (!ExtraAddresses.Contains(Address))
 	{
 		ExtraAddresses.Add(Address);
-		Initialize();
+		ScheduleRestart();
 	}
 }
 
@@ -33,7 +85,7 @@ void UNdiMediaFinder::AddGroupFilter(const FString& GroupName)
 	if (!GroupFilters.Contains(GroupName))
 	{
 		GroupFilters.Add(GroupName);
-		Initialize();
+		ScheduleRestart();
 	}
 }
 
@@ -43,7 +95,7 @@ void UNdiMediaFinder::ClearExtraAddresses()
 	if (ExtraAddresses.Num() > 0)
 	{
 		ExtraAddresses.Empty();
-		Initialize();
+		ScheduleRestart();
 	}
 }
 
@@ -53,61 +105,89 @@ void UNdiMediaFinder::ClearGroupFilters()
 	if (GroupFilters.Num() > 0)
 	{
 		GroupFilters.Empty();
-		Initialize();
+		ScheduleRestart();
 	}
 }
 
 
-bool UNdiMediaFinder::GetSources(TArray<FNdiMediaSourceId>& OutSources) const
+bool UNdiMediaFinder::FindSourceByEndpoint(const FString& Endpoint, FNdiMediaSourceId& OutSource) const
 {
-	if (!FNdi::IsInitialized() || (FindInstance == nullptr))
+	const FNdiMediaSourceId* Source = Registry->FindByEndpoint(Endpoint);
+
+	if (Source == nullptr)
 	{
 		return false;
 	}
 
-	uint32_t NumSources = 0;
-	const NDIlib_source_t* Sources = FNdi::Lib->NDIlib_find_get_current_sources(FindInstance, &NumSources);
+	OutSource = *Source;
+
+	return true;
+}
 
-	for (uint32_t SourceIndex = 0; SourceIndex < NumSources; ++SourceIndex)
+
+bool UNdiMediaFinder::FindSourceByName(const FString& Name, FNdiMediaSourceId& OutSource) const
+{
+	const FNdiMediaSourceId* Source = Registry->FindByName(Name);
+
+	if (Source == nullptr)
 	{
-		const NDIlib_source_t& Source = Sources[SourceIndex];
-		OutSources.Add(FNdiMediaSourceId(
-			ANSI_TO_TCHAR(Source.p_ip_address),
-			ANSI_TO_TCHAR(Source.p_ndi_name)
-		));
+		return false;
 	}
 
+	OutSource = *Source;
+
 	return true;
 }
 
 
-bool UNdiMediaFinder::Initialize()
+void UNdiMediaFinder::FindSourcesByGroup(const FString& Group, TArray<FNdiMediaSourceId>& OutSources) const
 {
-	Shutdown();
+	Registry->FindByGroup(Group, OutSources);
+}
+
+
+void UNdiMediaFinder::FindSourcesByMachine(const FString& Machine, TArray<FNdiMediaSourceId>& OutSources) const
+{
+	Registry->FindByMachine(Machine, OutSources);
+}
+
 
-	if (!FNdi::IsInitialized())
+bool UNdiMediaFinder::GetSources(TArray<FNdiMediaSourceId>& OutSources) const
+{
+	if (Discovery == nullptr)
 	{
 		return false;
 	}
 
-	FString ExtraAddressesString = FString::Join(ExtraAddresses, TEXT(","));
-	FString GroupsString = FString::Join(GroupFilters, TEXT(","));
+	OutSources.Append(Sources);
 
-	NDIlib_find_create_t FindCreate;
+	return true;
+}
+
+
+bool UNdiMediaFinder::Initialize()
+{
+	if (Discovery != nullptr)
 	{
-		FindCreate.show_local_sources = ShowLocalSources;
-		FindCreate.p_extra_ips = TCHAR_TO_ANSI(*ExtraAddressesString);
-		FindCreate.p_groups = TCHAR_TO_ANSI(*GroupsString);
+		Restart();
+		return true;
 	}
 
-	FindInstance = FNdi::Lib->NDIlib_find_create_v2(&FindCreate);
+	if (!FNdi::WaitForInitialization())
+	{
+		return false;
+	}
 
-	if (FindInstance == nullptr)
+	Discovery = CreateDiscovery();
+
+	if (Discovery == nullptr)
 	{
-		UE_LOG(LogNdiMedia, Warning, TEXT("Failed to create NDI Find instance"));
 		return false;
 	}
 
+	DiscoveryGeneration = NextDiscoveryGeneration;
+	GetDiscoveryGroups(*Discovery, DiscoveryGroups);
+
 	return true;
 }
 
@@ -116,7 +196,7 @@ void UNdiMediaFinder::RemoveExtraAddress(const FString& Address)
 {
 	if (ExtraAddresses.Remove(Address) > 0)
 	{
-		Initialize();
+		ScheduleRestart();
 	}
 }
 
@@ -125,34 +205,303 @@ void UNdiMediaFinder::RemoveGroupFilter(const FString& GroupName)
 {
 	if (GroupFilters.Remove(GroupName) > 0)
 	{
-		Initialize();
+		ScheduleRestart();
+	}
+}
+
+
+void UNdiMediaFinder::SearchSources(const FString& Text, bool PrefixOnly, TArray<FNdiMediaSourceId>& OutSources) const
+{
+	if (PrefixOnly)
+	{
+		Registry->FindByPrefix(Text, OutSources);
+	}
+	else
+	{
+		Registry->FindBySubstring(Text, OutSources);
 	}
 }
 
 
+void UNdiMediaFinder::SetCachedSources(const TArray<FNdiMediaSourceId>& InCachedSources)
+{
+	if (Discovery == nullptr)
+	{
+		return;
+	}
+
+	CachedSources = InCachedSources;
+
+	TArray<FNdiMediaSourceId> NewSources = Sources;
+	TSet<FString> Names;
+
+	for (const FNdiMediaSourceId& Source : NewSources)
+	{
+		Names.Add(Source.Name);
+	}
+
+	for (const FNdiMediaSourceId& Source : CachedSources)
+	{
+		if (!Names.Contains(Source.Name))
+		{
+			Names.Add(Source.Name);
+			NewSources.Add(Source);
+		}
+	}
+
+	UpdateSources(MoveTemp(NewSources), false);
+}
+
+
 void UNdiMediaFinder::SetShowLocalSources(bool NewShowLocal)
 {
 	if (NewShowLocal != ShowLocalSources)
 	{
 		ShowLocalSources = NewShowLocal;
-		Initialize();
+		ScheduleRestart();
 	}
 }
 
 
 void UNdiMediaFinder::Shutdown()
 {
-	if (FindInstance == nullptr)
+	// invalidate pending reports and restarts
+	DiscoveryGeneration = ++NextDiscoveryGeneration;
+	RestartScheduled = false;
+
+	if (PendingDiscovery != nullptr)
+	{
+		ReleaseDiscovery(PendingDiscovery);
+		PendingDiscovery = nullptr;
+	}
+
+	if (Discovery != nullptr)
+	{
+		ReleaseDiscovery(Discovery);
+		Discovery = nullptr;
+	}
+
+	CachedSources.Empty();
+	Registry->Empty();
+	Sources.Empty();
+}
+
+
+/* UNdiMediaFinder implementation
+ *****************************************************************************/
+
+FNdiMediaSourceDiscovery* UNdiMediaFinder::CreateDiscovery()
+{
+	const FString ExtraAddressesString = FString::Join(ExtraAddresses, TEXT(","));
+	const FString GroupsString = FString::Join(GroupFilters, TEXT(","));
+
+	TWeakObjectPtr<UNdiMediaFinder> FinderPtr(this);
+	const uint32 Generation = ++NextDiscoveryGeneration;
+
+	auto NewDiscovery = new FNdiMediaSourceDiscovery(ShowLocalSources, ExtraAddressesString, GroupsString, [FinderPtr, Generation](TArray<FNdiMediaSourceId> NewSources, bool WarmedUp)
+	{
+		UNdiMediaFinder* Finder = FinderPtr.Get();
+
+		if (Finder != nullptr)
+		{
+			Finder->HandleDiscoveredSources(Generation, MoveTemp(NewSources), WarmedUp);
+		}
+	});
+
+	if (!NewDiscovery->Start())
+	{
+		delete NewDiscovery;
+		return nullptr;
+	}
+
+	return NewDiscovery;
+}
+
+
+void UNdiMediaFinder::HandleDiscoveredSources(uint32 Generation, TArray<FNdiMediaSourceId> NewSources, bool WarmedUp)
+{
+	bool GroupsChanged = false;
+
+	if ((PendingDiscovery != nullptr) && (Generation == PendingDiscoveryGeneration))
+	{
+		// keep the previous sources until the replacement found all of them, or until it warmed up
+		if (!WarmedUp && !TSet<FNdiMediaSourceId>(NewSources).Includes(TSet<FNdiMediaSourceId>(Sources)))
+		{
+			return;
+		}
+
+		ReleaseDiscovery(Discovery);
+
+		Discovery = PendingDiscovery;
+		DiscoveryGeneration = PendingDiscoveryGeneration;
+		PendingDiscovery = nullptr;
+
+		TArray<FString> NewGroups;
+		GetDiscoveryGroups(*Discovery, NewGroups);
+
+		if (NewGroups != DiscoveryGroups)
+		{
+			DiscoveryGroups = MoveTemp(NewGroups);
+			GroupsChanged = true;
+		}
+	}
+	else if ((Discovery == nullptr) || (Generation != DiscoveryGeneration))
+	{
+		return; // stale report
+	}
+
+	// keep cached sources that were not discovered yet until the discovery warmed up
+	if (CachedSources.Num() > 0)
+	{
+		if (WarmedUp)
+		{
+			CachedSources.Empty();
+		}
+		else
+		{
+			TSet<FString> Names;
+
+			for (const FNdiMediaSourceId& Source : NewSources)
+			{
+				Names.Add(Source.Name);
+			}
+
+			CachedSources.RemoveAll([&](const FNdiMediaSourceId& Source) {
+				return Names.Contains(Source.Name);
+			});
+
+			NewSources.Append(CachedSources);
+		}
+	}
+
+	UpdateSources(MoveTemp(NewSources), GroupsChanged);
+}
+
+
+void UNdiMediaFinder::Restart()
+{
+	RestartScheduled = false;
+
+	if (Discovery == nullptr)
+	{
+		Initialize();
+		return;
+	}
+
+	const FString ExtraAddressesString = FString::Join(ExtraAddresses, TEXT(","));
+	const FString GroupsString = FString::Join(GroupFilters, TEXT(","));
+
+	// discard a replacement that was created for older settings
+	if (PendingDiscovery != nullptr)
+	{
+		if (PendingDiscovery->HasSettings(ShowLocalSources, ExtraAddressesString, GroupsString))
+		{
+			return;
+		}
+
+		ReleaseDiscovery(PendingDiscovery);
+		PendingDiscovery = nullptr;
+	}
+
+	if (Discovery->HasSettings(ShowLocalSources, ExtraAddressesString, GroupsString))
+	{
+		return;
+	}
+
+	PendingDiscovery = CreateDiscovery();
+	PendingDiscoveryGeneration = NextDiscoveryGeneration;
+}
+
+
+void UNdiMediaFinder::ScheduleRestart()
+{
+	if (RestartScheduled)
+	{
+		return;
+	}
+
+	RestartScheduled = true;
+
+	TWeakObjectPtr<UNdiMediaFinder> FinderPtr(this);
+
+	FFunctionGraphTask::CreateAndDispatchWhenReady([FinderPtr]()
+	{
+		UNdiMediaFinder* Finder = FinderPtr.Get();
+
+		if ((Finder != nullptr) && Finder->RestartScheduled)
+		{
+			Finder->Restart();
+		}
+	}, TStatId(), nullptr, ENamedThreads::GameThread);
+}
+
+
+void UNdiMediaFinder::UpdateSources(TArray<FNdiMediaSourceId> NewSources, bool GroupsChanged)
+{
+	const TSet<FNdiMediaSourceId> OldSourceSet(Sources);
+	const TSet<FNdiMediaSourceId> NewSourceSet(NewSources);
+
+	TArray<FNdiMediaSourceId> RemovedSources;
+
+	for (const FNdiMediaSourceId& Source : Sources)
+	{
+		if (!NewSourceSet.Contains(Source))
+		{
+			RemovedSources.Add(Source);
+		}
+	}
+
+	TArray<FNdiMediaSourceId> AddedSources;
+
+	for (const FNdiMediaSourceId& Source : NewSources)
+	{
+		if (!OldSourceSet.Contains(Source))
+		{
+			AddedSources.Add(Source);
+		}
+	}
+
+	// update the snapshot and the registry first, so that handlers see the new list
+	if (GroupsChanged)
+	{
+		Registry->Empty();
+
+		for (const FNdiMediaSourceId& Source : NewSources)
+		{
+			Registry->Add(Source, DiscoveryGroups);
+		}
+	}
+	else
+	{
+		for (const FNdiMediaSourceId& Source : RemovedSources)
+		{
+			Registry->Remove(Source);
+		}
+
+		for (const FNdiMediaSourceId& Source : AddedSources)
+		{
+			Registry->Add(Source, DiscoveryGroups);
+		}
+	}
+
+	Sources = MoveTemp(NewSources);
+
+	if ((RemovedSources.Num() == 0) && (AddedSources.Num() == 0))
 	{
 		return;
 	}
 
-	if (FNdi::IsInitialized())
+	for (const FNdiMediaSourceId& Source : RemovedSources)
+	{
+		OnSourceRemoved.Broadcast(Source);
+	}
+
+	for (const FNdiMediaSourceId& Source : AddedSources)
 	{
-		FNdi::Lib->NDIlib_find_destroy(FindInstance);
+		OnSourceAdded.Broadcast(Source);
 	}
 
-	FindInstance = nullptr;
+	OnSourcesChanged.Broadcast();
 }
 
 
@@ -171,7 +520,7 @@ void UNdiMediaFinder::BeginDestroy()
 void UNdiMediaFinder::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
-	Initialize();
+	ScheduleRestart();
 }
 
 #endif //WITH_EDITOR
@@ -0,0 +1,207 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSender.h"
+#include "NdiMediaPrivate.h"
+
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+#include "Ndi.h"
+#include "NdiMediaVideoSender.h"
+
+
+/* UNdiMediaSender structors
+ *****************************************************************************/
+
+UNdiMediaSender::UNdiMediaSender()
+	: ColorFormat(ENdiMediaSenderColorFormat::BGRA)
+	, Downscale(ENdiMediaDownscale::None)
+	, DownscaleFilter(ENdiMediaDownscaleFilter::Box)
+	, FrameRateDenominator(1)
+	, FrameRateNumerator(60)
+	, RenderTarget(nullptr)
+	, SourceName(TEXT("Unreal Engine"))
+	, FrameInterval(0.0)
+	, NextFrameTime(0.0)
+{ }
+
+
+/* UNdiMediaSender interface
+ *****************************************************************************/
+
+FString UNdiMediaSender::GetStats() const
+{
+	return VideoSender.IsValid() ? VideoSender->GetStats() : FString();
+}
+
+
+bool UNdiMediaSender::IsSending() const
+{
+	return VideoSender.IsValid();
+}
+
+
+bool UNdiMediaSender::StartSending()
+{
+	if (VideoSender.IsValid())
+	{
+		return true;
+	}
+
+	if (!FNdi::WaitForInitialization())
+	{
+		UE_LOG(LogNdiMedia, Warning, TEXT("Cannot send NDI source %s: NDI is not initialized"), *SourceName);
+		return false;
+	}
+
+	VideoSender = MakeShared<FNdiMediaVideoSender, ESPMode::ThreadSafe>(SourceName, Groups, ColorFormat, Downscale, DownscaleFilter, FrameRateNumerator, FrameRateDenominator);
+
+	if (!VideoSender->Start())
+	{
+		VideoSender.Reset();
+		return false;
+	}
+
+	// without a render target, the back buffer of the game viewport is captured
+	if (RenderTarget == nullptr)
+	{
+		const TSharedPtr<SWindow> ViewportWindow = ((GEngine != nullptr) && (GEngine->GameViewport != nullptr)) ? GEngine->GameViewport->GetWindow() : nullptr;
+
+		if (!ViewportWindow.IsValid() || !FSlateApplication::IsInitialized() || (FSlateApplication::Get().GetRenderer() == nullptr))
+		{
+			UE_LOG(LogNdiMedia, Warning, TEXT("Cannot send NDI source %s: No render target set, and no game viewport available"), *SourceName);
+			VideoSender.Reset();
+
+			return false;
+		}
+
+		VideoSender->SetCaptureWindow(ViewportWindow);
+		BackBufferHandle = FSlateApplication::Get().GetRenderer()->OnBackBufferReadyToPresent().AddThreadSafeSP(VideoSender.ToSharedRef(), &FNdiMediaVideoSender::HandleBackBufferReadyToPresent);
+	}
+
+	FrameInterval = (double)FMath::Max(1, FrameRateDenominator) / (double)FMath::Max(1, FrameRateNumerator);
+	NextFrameTime = FPlatformTime::Seconds();
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UNdiMediaSender::HandleTicker), 0.0f);
+
+	return true;
+}
+
+
+void UNdiMediaSender::StopSending()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+
+	if (BackBufferHandle.IsValid())
+	{
+		if (FSlateApplication::IsInitialized() && (FSlateApplication::Get().GetRenderer() != nullptr))
+		{
+			FSlateApplication::Get().GetRenderer()->OnBackBufferReadyToPresent().Remove(BackBufferHandle);
+		}
+
+		BackBufferHandle.Reset();
+	}
+
+	if (VideoSender.IsValid())
+	{
+		VideoSender->Stop();
+
+		// pending captures may still use the sender on the render thread
+		FEvent* CapturesCompleted = FPlatformProcess::GetSynchEventFromPool(true);
+
+		ENQUEUE_RENDER_COMMAND(NdiMediaSenderCompleteCaptures)(
+			[CapturesCompleted](FRHICommandListImmediate& RHICmdList)
+			{
+				CapturesCompleted->Trigger();
+			});
+
+		// the send thread may still wait for NDI to accept a frame, so the last reference is released on a background thread
+		FNdi::ReleaseAsync([Sender = MoveTemp(VideoSender), CapturesCompleted]() mutable {
+			CapturesCompleted->Wait();
+			FPlatformProcess::ReturnSynchEventToPool(CapturesCompleted);
+			Sender.Reset();
+		});
+	}
+}
+
+
+/* UObject interface
+ *****************************************************************************/
+
+void UNdiMediaSender::BeginDestroy()
+{
+	StopSending();
+
+	Super::BeginDestroy();
+}
+
+
+/* UNdiMediaSender callbacks
+ *****************************************************************************/
+
+bool UNdiMediaSender::HandleTicker(float DeltaTime)
+{
+	TSharedPtr<FNdiMediaVideoSender, ESPMode::ThreadSafe> Sender = VideoSender;
+
+	// send the last captured frames even if no further captures follow
+	ENQUEUE_RENDER_COMMAND(NdiMediaSenderPollReadbacks)(
+		[Sender](FRHICommandListImmediate& RHICmdList)
+		{
+			Sender->PollReadbacks_RenderThread(RHICmdList);
+		});
+
+	const double Now = FPlatformTime::Seconds();
+
+	if (Now < NextFrameTime)
+	{
+		return true;
+	}
+
+	// skip frames that were missed instead of catching up
+	NextFrameTime = FMath::Max(NextFrameTime + FrameInterval, Now);
+
+	// avoid reading back frames that nobody receives
+	if (!VideoSender->HasConnections())
+	{
+		return true;
+	}
+
+	if (RenderTarget == nullptr)
+	{
+		if (!VideoSender->RequestWindowCapture())
+		{
+			UE_LOG(LogNdiMedia, Warning, TEXT("Stopped sending NDI source %s: The game viewport window was closed"), *SourceName);
+			StopSending();
+
+			return false;
+		}
+
+		return true;
+	}
+
+	FTextureRenderTargetResource* Resource = RenderTarget->GameThread_GetRenderTargetResource();
+
+	if (Resource == nullptr)
+	{
+		return true;
+	}
+
+	ENQUEUE_RENDER_COMMAND(NdiMediaSenderCaptureRenderTarget)(
+		[Sender, Resource](FRHICommandListImmediate& RHICmdList)
+		{
+			Sender->Capture_RenderThread(RHICmdList, Resource->GetRenderTargetTexture());
+		});
+
+	return true;
+}
@@ -11,11 +11,28 @@
 
 UNdiMediaSource::UNdiMediaSource()
 	: AudioReferenceLevel(5)
+	, NumAudioChannelsPerTrack(0)
+	, MaxAudioQueueDuration(0)
+	, NumAudioFramesPerSample(0)
+	, AudioOverrunPolicy(ENdiMediaAudioOverrunPolicy::Drop)
+	, UseDirectAudio(false)
 	, PreferredAudioSampleRate(48000)
 	, PreferredNumAudioChannels(2)
 	, Bandwidth(ENdiMediaBandwidth::Highest)
 	, UseTimecode(false)
 	, ColorFormat(ENdiMediaColorFormat::UYVY)
+	, ColorRange(ENdiMediaColorRange::Limited)
+	, ColorSpace(ENdiMediaColorSpace::Engine)
+	, CopyVideoFrames(false)
+	, CropOffset(FIntPoint::ZeroValue)
+	, CropSize(FIntPoint::ZeroValue)
+	, DeinterlaceMode(ENdiMediaDeinterlaceMode::None)
+	, DeinterlaceToFieldRate(false)
+	, DetectDirtyRows(false)
+	, Downscale(ENdiMediaDownscale::None)
+	, DownscaleFilter(ENdiMediaDownscaleFilter::Box)
+	, DuplicateFrameDetection(ENdiMediaDuplicateFrameDetection::None)
+	, MaxVideoThreads(0)
 	, PreferredFrameFormat(ENdiMediaFrameFormatPreference::NoPreference)
 	, PreferredFrameRateNumerator(0)
 	, PreferredFrameRateDenominator(0)
@@ -29,6 +46,26 @@ UNdiMediaSource::UNdiMediaSource()
 
 bool UNdiMediaSource::GetMediaOption(const FName& Key, bool DefaultValue) const
 {
+	if (Key == NdiMedia::CopyVideoFramesOption)
+	{
+		return CopyVideoFrames;
+	}
+
+	if (Key == NdiMedia::DeinterlaceFieldRateOption)
+	{
+		return DeinterlaceToFieldRate;
+	}
+
+	if (Key == NdiMedia::DetectDirtyRowsOption)
+	{
+		return DetectDirtyRows;
+	}
+
+	if (Key == NdiMedia::DirectAudioOption)
+	{
+		return UseDirectAudio;
+	}
+
 	if (Key == NdiMedia::UseTimecodeOption)
 	{
 		return UseTimecode;
@@ -68,6 +105,26 @@ int64 UNdiMediaSource::GetMediaOption(const FName& Key, int64 DefaultValue) cons
 		return PreferredNumAudioChannels;
 	}
 
+	if (Key == NdiMedia::AudioChannelsPerTrackOption)
+	{
+		return NumAudioChannelsPerTrack;
+	}
+
+	if (Key == NdiMedia::AudioFramesPerSampleOption)
+	{
+		return NumAudioFramesPerSample;
+	}
+
+	if (Key == NdiMedia::AudioOverrunPolicyOption)
+	{
+		return (int64)AudioOverrunPolicy;
+	}
+
+	if (Key == NdiMedia::MaxAudioQueueDurationOption)
+	{
+		return MaxAudioQueueDuration;
+	}
+
 	if (Key == NdiMedia::AudioReferenceLevelOption)
 	{
 		return AudioReferenceLevel;
@@ -95,7 +152,75 @@ int64 UNdiMediaSource::GetMediaOption(const FName& Key, int64 DefaultValue) cons
 
 	if (Key == NdiMedia::ColorFormatOption)
 	{
-		return (int64)ColorFormat;
+		switch (ColorFormat)
+		{
+		case ENdiMediaColorFormat::BGRA:
+			return NDIlib_recv_color_format_e::NDIlib_recv_color_format_e_BGRX_BGRA;
+
+		case ENdiMediaColorFormat::P216:
+			return NdiMedia::ColorFormatBest;
+
+		case ENdiMediaColorFormat::UYVA:
+			return NDIlib_recv_color_format_e::NDIlib_recv_color_format_e_fastest;
+
+		default:
+			return NDIlib_recv_color_format_e::NDIlib_recv_color_format_e_UYVY_BGRA;
+		}
+	}
+
+	if (Key == NdiMedia::ColorRangeOption)
+	{
+		return (int64)ColorRange;
+	}
+
+	if (Key == NdiMedia::ColorSpaceOption)
+	{
+		return (int64)ColorSpace;
+	}
+
+	if (Key == NdiMedia::CropHeightOption)
+	{
+		return CropSize.Y;
+	}
+
+	if (Key == NdiMedia::CropWidthOption)
+	{
+		return CropSize.X;
+	}
+
+	if (Key == NdiMedia::CropXOption)
+	{
+		return CropOffset.X;
+	}
+
+	if (Key == NdiMedia::CropYOption)
+	{
+		return CropOffset.Y;
+	}
+
+	if (Key == NdiMedia::DeinterlaceModeOption)
+	{
+		return (int64)DeinterlaceMode;
+	}
+
+	if (Key == NdiMedia::DownscaleOption)
+	{
+		return (int64)Downscale;
+	}
+
+	if (Key == NdiMedia::DownscaleFilterOption)
+	{
+		return (int64)DownscaleFilter;
+	}
+
+	if (Key == NdiMedia::DuplicateFrameDetectionOption)
+	{
+		return (int64)DuplicateFrameDetection;
+	}
+
+	if (Key == NdiMedia::MaxVideoThreadsOption)
+	{
+		return MaxVideoThreads;
 	}
 
 	if (Key == NdiMedia::VideoHeightOption)
@@ -125,11 +250,30 @@ int64 UNdiMediaSource::GetMediaOption(const FName& Key, int64 DefaultValue) cons
 bool UNdiMediaSource::HasMediaOption(const FName& Key) const
 {
 	if ((Key == NdiMedia::AudioChannelsOption) ||
+		(Key == NdiMedia::AudioChannelsPerTrackOption) ||
+		(Key == NdiMedia::AudioFramesPerSampleOption) ||
+		(Key == NdiMedia::AudioOverrunPolicyOption) ||
 		(Key == NdiMedia::AudioSampleRateOption) ||
 		(Key == NdiMedia::BandwidthOption) ||
 		(Key == NdiMedia::ColorFormatOption) ||
+		(Key == NdiMedia::ColorRangeOption) ||
+		(Key == NdiMedia::ColorSpaceOption) ||
+		(Key == NdiMedia::CopyVideoFramesOption) ||
+		(Key == NdiMedia::CropHeightOption) ||
+		(Key == NdiMedia::CropWidthOption) ||
+		(Key == NdiMedia::CropXOption) ||
+		(Key == NdiMedia::CropYOption) ||
+		(Key == NdiMedia::DeinterlaceFieldRateOption) ||
+		(Key == NdiMedia::DeinterlaceModeOption) ||
+		(Key == NdiMedia::DetectDirtyRowsOption) ||
+		(Key == NdiMedia::DirectAudioOption) ||
+		(Key == NdiMedia::DownscaleOption) ||
+		(Key == NdiMedia::DownscaleFilterOption) ||
+		(Key == NdiMedia::DuplicateFrameDetectionOption) ||
 		(Key == NdiMedia::FrameRateDOption) ||
 		(Key == NdiMedia::FrameRateNOption) ||
+		(Key == NdiMedia::MaxAudioQueueDurationOption) ||
+		(Key == NdiMedia::MaxVideoThreadsOption) ||
 		(Key == NdiMedia::ProgressiveOption) ||
 		(Key == NdiMedia::UseTimecodeOption) ||
 		(Key == NdiMedia::VideoHeightOption) ||
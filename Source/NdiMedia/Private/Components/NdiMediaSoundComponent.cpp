@@ -0,0 +1,101 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSoundComponent.h"
+#include "NdiMediaPrivate.h"
+
+#include "Misc/ScopeLock.h"
+
+#include "NdiMediaAudioRing.h"
+#include "NdiMediaSource.h"
+
+
+/* UNdiMediaSoundComponent structors
+ *****************************************************************************/
+
+UNdiMediaSoundComponent::UNdiMediaSoundComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, MediaSource(nullptr)
+	, MaxLatency(20)
+	, SampleRate(48000)
+{
+	NumChannels = FNdiMediaAudioRing::NumChannels;
+}
+
+
+/* UActorComponent interface
+ *****************************************************************************/
+
+void UNdiMediaSoundComponent::OnUnregister()
+{
+	Super::OnUnregister();
+
+	DetachRing();
+}
+
+
+/* USynthComponent interface
+ *****************************************************************************/
+
+bool UNdiMediaSoundComponent::Init(int32& OutSampleRate)
+{
+	NumChannels = FNdiMediaAudioRing::NumChannels;
+	OutSampleRate = SampleRate;
+
+	DetachRing();
+
+	if (MediaSource != nullptr)
+	{
+		auto NewRing = FNdiMediaAudioRing::FindOrCreate(MediaSource->GetUrl());
+
+		if (NewRing->AttachConsumer())
+		{
+			// the audio render thread discards stale audio on its next read
+			NewRing->RequestReset();
+
+			FScopeLock Lock(&RingCriticalSection);
+			Ring = NewRing;
+		}
+		else
+		{
+			UE_LOG(LogNdiMedia, Warning, TEXT("The direct audio of %s is already played by another NdiMediaSoundComponent."), *MediaSource->GetUrl());
+		}
+	}
+
+	return true;
+}
+
+
+void UNdiMediaSoundComponent::OnGenerateAudio(float* OutAudio, int32 NumSamples)
+{
+	const int32 NumFrames = NumSamples / FNdiMediaAudioRing::NumChannels;
+
+	FScopeLock Lock(&RingCriticalSection);
+
+	if (Ring.IsValid())
+	{
+		const int32 RingSampleRate = Ring->GetSampleRate();
+		const int32 MaxLatencyFrames = (int32)(((int64)MaxLatency * ((RingSampleRate > 0) ? RingSampleRate : SampleRate)) / 1000);
+
+		Ring->Read(OutAudio, NumFrames, MaxLatencyFrames);
+	}
+	else
+	{
+		FMemory::Memzero(OutAudio, NumSamples * sizeof(float));
+	}
+}
+
+
+/* UNdiMediaSoundComponent implementation
+ *****************************************************************************/
+
+void UNdiMediaSoundComponent::DetachRing()
+{
+	// the consumer must be gone before another sound component can attach
+	FScopeLock Lock(&RingCriticalSection);
+
+	if (Ring.IsValid())
+	{
+		Ring->DetachConsumer();
+		Ring.Reset();
+	}
+}
@@ -0,0 +1,124 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSourceCache.h"
+#include "NdiMediaPrivate.h"
+
+#include "Containers/Set.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+
+/* FNdiMediaSourceCache interface
+ *****************************************************************************/
+
+void FNdiMediaSourceCache::GetSources(TArray<FNdiMediaSourceId>& OutSources) const
+{
+	for (const FEntry& Entry : Entries)
+	{
+		OutSources.Add(Entry.Source);
+	}
+}
+
+
+bool FNdiMediaSourceCache::Load()
+{
+	TArray<FString> Lines;
+
+	if (!FFileHelper::LoadFileToStringArray(Lines, *GetFilePath()))
+	{
+		return false;
+	}
+
+	Entries.Reset();
+
+	for (const FString& Line : Lines)
+	{
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		// each line contains: last seen time, endpoint, name (tab separated)
+		TArray<FString> Fields;
+
+		if (Line.ParseIntoArray(Fields, TEXT("\t"), false) != 3)
+		{
+			UE_LOG(LogNdiMedia, Verbose, TEXT("Ignoring invalid line in NDI source cache: %s"), *Line);
+			continue;
+		}
+
+		FEntry Entry;
+
+		if (!FDateTime::ParseIso8601(*Fields[0], Entry.LastSeen) || Fields[1].IsEmpty() || Fields[2].IsEmpty())
+		{
+			UE_LOG(LogNdiMedia, Verbose, TEXT("Ignoring invalid line in NDI source cache: %s"), *Line);
+			continue;
+		}
+
+		Entry.Source = FNdiMediaSourceId(Fields[1], Fields[2]);
+		Entries.Add(Entry);
+	}
+
+	return true;
+}
+
+
+void FNdiMediaSourceCache::Prune(FTimespan MaxAge)
+{
+	const FDateTime MinLastSeen = FDateTime::UtcNow() - MaxAge;
+
+	Entries.RemoveAll([&](const FEntry& Entry) {
+		return (Entry.LastSeen < MinLastSeen);
+	});
+}
+
+
+bool FNdiMediaSourceCache::Save() const
+{
+	FString Contents = TEXT("# NDI sources seen in previous sessions: last seen time (UTC), endpoint, name\n");
+
+	for (const FEntry& Entry : Entries)
+	{
+		Contents += FString::Printf(TEXT("%s\t%s\t%s\n"), *Entry.LastSeen.ToIso8601(), *Entry.Source.Endpoint, *Entry.Source.Name);
+	}
+
+	return FFileHelper::SaveStringToFile(Contents, *GetFilePath());
+}
+
+
+void FNdiMediaSourceCache::Update(const TArray<FNdiMediaSourceId>& Sources, const FDateTime& Time)
+{
+	TSet<FString> Endpoints;
+	TSet<FString> Names;
+
+	for (const FNdiMediaSourceId& Source : Sources)
+	{
+		Endpoints.Add(Source.Endpoint);
+		Names.Add(Source.Name);
+	}
+
+	// remove outdated entries
+	Entries.RemoveAll([&](const FEntry& Entry) {
+		return Endpoints.Contains(Entry.Source.Endpoint) || Names.Contains(Entry.Source.Name);
+	});
+
+	for (const FNdiMediaSourceId& Source : Sources)
+	{
+		FEntry Entry;
+		{
+			Entry.LastSeen = Time;
+			Entry.Source = Source;
+		}
+
+		Entries.Add(Entry);
+	}
+}
+
+
+/* FNdiMediaSourceCache static functions
+ *****************************************************************************/
+
+FString FNdiMediaSourceCache::GetFilePath()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("NdiMedia"), TEXT("SourceCache.txt"));
+}
@@ -0,0 +1,91 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/DateTime.h"
+#include "Misc/Timespan.h"
+
+#include "NdiMediaFinder.h"
+
+
+/**
+ * Persists the last known NDI sources between sessions.
+ *
+ * Discovering sources on the network takes a few seconds after startup. The cache
+ * provides the sources and their endpoints that were seen in previous sessions, so
+ * that they are available immediately, until the live discovery has caught up.
+ *
+ * The cache is stored as a text file with one source per line.
+ */
+class FNdiMediaSourceCache
+{
+public:
+
+	/**
+	 * Get the sources in the cache.
+	 *
+	 * @param OutSources Will contain the sources.
+	 * @see Update
+	 */
+	void GetSources(TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Load the cache from disk.
+	 *
+	 * @return true on success, false if the file doesn't exist or couldn't be read.
+	 * @see Save
+	 */
+	bool Load();
+
+	/**
+	 * Remove sources that were not seen for a while.
+	 *
+	 * @param MaxAge Maximum time since a source was last seen.
+	 * @see Update
+	 */
+	void Prune(FTimespan MaxAge);
+
+	/**
+	 * Save the cache to disk.
+	 *
+	 * @return true on success, false otherwise.
+	 * @see Load
+	 */
+	bool Save() const;
+
+	/**
+	 * Mark the specified sources as seen.
+	 *
+	 * Cached sources with the same name or endpoint as a seen source are replaced.
+	 *
+	 * @param Sources The sources that were seen.
+	 * @param Time The time at which the sources were seen (in UTC).
+	 * @see GetSources, Prune
+	 */
+	void Update(const TArray<FNdiMediaSourceId>& Sources, const FDateTime& Time);
+
+public:
+
+	/**
+	 * Get the path of the cache file.
+	 *
+	 * @return The file path.
+	 */
+	static FString GetFilePath();
+
+private:
+
+	/** A cached source. */
+	struct FEntry
+	{
+		/** The time at which the source was last seen (in UTC). */
+		FDateTime LastSeen;
+
+		/** The source. */
+		FNdiMediaSourceId Source;
+	};
+
+	/** The cached sources. */
+	TArray<FEntry> Entries;
+};
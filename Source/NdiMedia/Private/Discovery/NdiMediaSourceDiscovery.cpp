@@ -0,0 +1,164 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSourceDiscovery.h"
+#include "NdiMediaPrivate.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Set.h"
+#include "Containers/StringConv.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+
+#include "Ndi.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Maximum time that the discovery thread blocks before checking whether it should stop. */
+static const uint32 WaitTimeoutMs = 250;
+
+/** Time after which most sources on the network have usually announced themselves (in seconds). */
+static const double WarmupTime = 2.0;
+
+
+/* FNdiMediaSourceDiscovery structors
+ *****************************************************************************/
+
+FNdiMediaSourceDiscovery::FNdiMediaSourceDiscovery(bool InShowLocalSources, const FString& InExtraAddresses, const FString& InGroups, FSourcesCallback InCallback)
+	: Callback(MoveTemp(InCallback))
+	, ExtraAddresses(InExtraAddresses)
+	, FindInstance(nullptr)
+	, Groups(InGroups)
+	, ShowLocalSources(InShowLocalSources)
+	, Thread(nullptr)
+{ }
+
+
+FNdiMediaSourceDiscovery::~FNdiMediaSourceDiscovery()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if ((FindInstance != nullptr) && FNdi::IsInitialized())
+	{
+		FNdi::Lib->NDIlib_find_destroy(FindInstance);
+	}
+
+	FindInstance = nullptr;
+}
+
+
+/* FNdiMediaSourceDiscovery interface
+ *****************************************************************************/
+
+bool FNdiMediaSourceDiscovery::Start()
+{
+	if (!FNdi::IsInitialized() || (FindInstance != nullptr))
+	{
+		return false;
+	}
+
+	// the converted strings must outlive the call to NDIlib_find_create_v2
+	auto ExtraAddressesAnsi = StringCast<ANSICHAR>(*ExtraAddresses);
+	auto GroupsAnsi = StringCast<ANSICHAR>(*Groups);
+
+	NDIlib_find_create_t FindCreate;
+	{
+		FindCreate.show_local_sources = ShowLocalSources;
+		FindCreate.p_extra_ips = ExtraAddresses.IsEmpty() ? nullptr : ExtraAddressesAnsi.Get();
+		FindCreate.p_groups = Groups.IsEmpty() ? nullptr : GroupsAnsi.Get();
+	}
+
+	FindInstance = FNdi::Lib->NDIlib_find_create_v2(&FindCreate);
+
+	if (FindInstance == nullptr)
+	{
+		UE_LOG(LogNdiMedia, Warning, TEXT("Failed to create NDI Find instance"));
+		return false;
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("NdiMediaSourceDiscovery"), 0, TPri_BelowNormal);
+
+	if (Thread == nullptr)
+	{
+		UE_LOG(LogNdiMedia, Warning, TEXT("Failed to create NDI source discovery thread"));
+		return false;
+	}
+
+	return true;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FNdiMediaSourceDiscovery::Run()
+{
+	TSet<FNdiMediaSourceId> LastSources;
+
+	const double WarmupEndTime = FPlatformTime::Seconds() + WarmupTime;
+	bool WarmedUp = false;
+
+	while (!Stopping)
+	{
+		const bool SourcesChanged = FNdi::Lib->NDIlib_find_wait_for_sources(FindInstance, WaitTimeoutMs);
+		const bool WarmupEnded = !WarmedUp && (FPlatformTime::Seconds() >= WarmupEndTime);
+
+		if (!SourcesChanged && !WarmupEnded)
+		{
+			continue;
+		}
+
+		WarmedUp = WarmedUp || WarmupEnded;
+
+		uint32_t NumSources = 0;
+		const NDIlib_source_t* NdiSources = FNdi::Lib->NDIlib_find_get_current_sources(FindInstance, &NumSources);
+
+		TArray<FNdiMediaSourceId> Sources;
+		Sources.Reserve(NumSources);
+
+		for (uint32_t SourceIndex = 0; SourceIndex < NumSources; ++SourceIndex)
+		{
+			const NDIlib_source_t& Source = NdiSources[SourceIndex];
+			Sources.Add(FNdiMediaSourceId(
+				ANSI_TO_TCHAR(Source.p_ip_address),
+				ANSI_TO_TCHAR(Source.p_ndi_name)
+			));
+		}
+
+		// the find instance also signals if only the order of sources changed
+		TSet<FNdiMediaSourceId> NewSources(Sources);
+
+		if (!WarmupEnded && (NewSources.Num() == LastSources.Num()) && LastSources.Includes(NewSources))
+		{
+			continue;
+		}
+
+		LastSources = MoveTemp(NewSources);
+
+		FSourcesCallback CallbackCopy = Callback;
+
+		FFunctionGraphTask::CreateAndDispatchWhenReady([CallbackCopy, Sources, WarmedUp]() mutable
+		{
+			CallbackCopy(MoveTemp(Sources), WarmedUp);
+		}, TStatId(), nullptr, ENamedThreads::GameThread);
+	}
+
+	return 0;
+}
+
+
+void FNdiMediaSourceDiscovery::Stop()
+{
+	Stopping = true;
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
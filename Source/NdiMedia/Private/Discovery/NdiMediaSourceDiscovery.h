@@ -0,0 +1,111 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Templates/Function.h"
+
+#include "NdiMediaFinder.h"
+
+class FRunnableThread;
+
+
+/**
+ * Discovers NDI sources on a background thread.
+ *
+ * The thread blocks until the NDI find instance reports a change, converts the new
+ * source list once, and passes it to a callback on the game thread if it differs
+ * from the previously reported list. Sources announce themselves over a period of
+ * time, so the list is also reported once when the warm-up time has elapsed.
+ */
+class FNdiMediaSourceDiscovery
+	: public FRunnable
+{
+public:
+
+	/** Type of the callback that receives the discovered sources, and whether the warm-up time elapsed, on the game thread. */
+	typedef TFunction<void(TArray<FNdiMediaSourceId> Sources, bool WarmedUp)> FSourcesCallback;
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InShowLocalSources Whether to discover sources running on the local machine.
+	 * @param InExtraAddresses Comma separated list of additional IP addresses to search.
+	 * @param InGroups Comma separated list of NDI groups to search (empty = all groups).
+	 * @param InCallback The function to call when the list of sources changed.
+	 */
+	FNdiMediaSourceDiscovery(bool InShowLocalSources, const FString& InExtraAddresses, const FString& InGroups, FSourcesCallback InCallback);
+
+	/**
+	 * Virtual destructor.
+	 *
+	 * Waits for the discovery thread to exit, which may block for up to one wait
+	 * timeout. Use FNdi::ReleaseAsync to destroy discoveries on the game thread.
+	 */
+	virtual ~FNdiMediaSourceDiscovery();
+
+public:
+
+	/**
+	 * Get the NDI groups that are searched.
+	 *
+	 * @return Comma separated list of groups (empty = all groups).
+	 * @see HasSettings
+	 */
+	const FString& GetGroups() const
+	{
+		return Groups;
+	}
+
+	/**
+	 * Check whether this discovery uses the specified settings.
+	 *
+	 * @param InShowLocalSources Whether to discover sources running on the local machine.
+	 * @param InExtraAddresses Comma separated list of additional IP addresses to search.
+	 * @param InGroups Comma separated list of NDI groups to search.
+	 * @return true if the settings match, false otherwise.
+	 */
+	bool HasSettings(bool InShowLocalSources, const FString& InExtraAddresses, const FString& InGroups) const
+	{
+		return (ShowLocalSources == InShowLocalSources) && (ExtraAddresses == InExtraAddresses) && (Groups == InGroups);
+	}
+
+	/**
+	 * Create the NDI find instance and start the discovery thread.
+	 *
+	 * @return true on success, false otherwise.
+	 */
+	bool Start();
+
+public:
+
+	//~ FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+
+	/** The function to call when the list of sources changed. */
+	FSourcesCallback Callback;
+
+	/** Comma separated list of additional IP addresses to search. */
+	FString ExtraAddresses;
+
+	/** The NDI source finder instance. */
+	void* FindInstance;
+
+	/** Comma separated list of NDI groups to search. */
+	FString Groups;
+
+	/** Whether to discover sources running on the local machine. */
+	bool ShowLocalSources;
+
+	/** Whether the discovery thread should stop. */
+	FThreadSafeBool Stopping;
+
+	/** The discovery thread. */
+	FRunnableThread* Thread;
+};
@@ -0,0 +1,313 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSourceRegistry.h"
+#include "NdiMediaPrivate.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Number of bits per character in a trigram. */
+static const int32 TrigramCharBits = 21;
+
+/** Mask for the character bits of a trigram. */
+static const uint64 TrigramCharMask = (1ull << TrigramCharBits) - 1;
+
+
+/* FNdiMediaSourceRegistry interface
+ *****************************************************************************/
+
+void FNdiMediaSourceRegistry::Add(const FNdiMediaSourceId& Source, const TArray<FString>& Groups)
+{
+	const int32* NameEntryIndex = NameIndex.Find(Source.Name);
+
+	if (NameEntryIndex != nullptr)
+	{
+		const int32 EntryIndex = *NameEntryIndex;
+		FEntry& Entry = Entries[EntryIndex];
+
+		if (Entry.Source == Source)
+		{
+			// only the groups changed
+			for (const FString& Group : Entry.Groups)
+			{
+				GroupIndex.RemoveSingle(Group, EntryIndex);
+			}
+
+			Entry.Groups = Groups;
+
+			for (const FString& Group : Entry.Groups)
+			{
+				GroupIndex.Add(Group, EntryIndex);
+			}
+
+			return;
+		}
+
+		RemoveEntry(EntryIndex);
+	}
+
+	const int32* EndpointEntryIndex = EndpointIndex.Find(Source.Endpoint);
+
+	if (EndpointEntryIndex != nullptr)
+	{
+		RemoveEntry(*EndpointEntryIndex);
+	}
+
+	// add entry
+	FEntry NewEntry;
+	{
+		NewEntry.Groups = Groups;
+		NewEntry.Machine = Source.GetMachineName();
+		NewEntry.SearchName = Source.Name.ToLower();
+		NewEntry.Source = Source;
+	}
+
+	const int32 EntryIndex = Entries.Add(MoveTemp(NewEntry));
+	const FEntry& Entry = Entries[EntryIndex];
+
+	// add to indices
+	EndpointIndex.Add(Entry.Source.Endpoint, EntryIndex);
+	NameIndex.Add(Entry.Source.Name, EntryIndex);
+
+	for (const FString& Group : Entry.Groups)
+	{
+		GroupIndex.Add(Group, EntryIndex);
+	}
+
+	if (!Entry.Machine.IsEmpty())
+	{
+		MachineIndex.Add(Entry.Machine, EntryIndex);
+	}
+
+	SortedNames.Insert(EntryIndex, LowerBound(Entry.SearchName));
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(Entry.SearchName, Trigrams);
+
+	for (uint64 Trigram : Trigrams)
+	{
+		TrigramIndex.FindOrAdd(Trigram).Add(EntryIndex);
+	}
+}
+
+
+void FNdiMediaSourceRegistry::Empty()
+{
+	EndpointIndex.Empty();
+	Entries.Empty();
+	GroupIndex.Empty();
+	MachineIndex.Empty();
+	NameIndex.Empty();
+	SortedNames.Empty();
+	TrigramIndex.Empty();
+}
+
+
+const FNdiMediaSourceId* FNdiMediaSourceRegistry::FindByEndpoint(const FString& Endpoint) const
+{
+	const int32* EntryIndex = EndpointIndex.Find(Endpoint);
+	return (EntryIndex != nullptr) ? &Entries[*EntryIndex].Source : nullptr;
+}
+
+
+void FNdiMediaSourceRegistry::FindByGroup(const FString& Group, TArray<FNdiMediaSourceId>& OutSources) const
+{
+	for (auto It = GroupIndex.CreateConstKeyIterator(Group); It; ++It)
+	{
+		OutSources.Add(Entries[It.Value()].Source);
+	}
+}
+
+
+void FNdiMediaSourceRegistry::FindByMachine(const FString& Machine, TArray<FNdiMediaSourceId>& OutSources) const
+{
+	for (auto It = MachineIndex.CreateConstKeyIterator(Machine); It; ++It)
+	{
+		OutSources.Add(Entries[It.Value()].Source);
+	}
+}
+
+
+const FNdiMediaSourceId* FNdiMediaSourceRegistry::FindByName(const FString& Name) const
+{
+	const int32* EntryIndex = NameIndex.Find(Name);
+	return (EntryIndex != nullptr) ? &Entries[*EntryIndex].Source : nullptr;
+}
+
+
+void FNdiMediaSourceRegistry::FindByPrefix(const FString& Prefix, TArray<FNdiMediaSourceId>& OutSources) const
+{
+	const FString SearchPrefix = Prefix.ToLower();
+
+	for (int32 SortedIndex = LowerBound(SearchPrefix); SortedIndex < SortedNames.Num(); ++SortedIndex)
+	{
+		const FEntry& Entry = Entries[SortedNames[SortedIndex]];
+
+		if (!Entry.SearchName.StartsWith(SearchPrefix, ESearchCase::CaseSensitive))
+		{
+			break;
+		}
+
+		OutSources.Add(Entry.Source);
+	}
+}
+
+
+void FNdiMediaSourceRegistry::FindBySubstring(const FString& Text, TArray<FNdiMediaSourceId>& OutSources) const
+{
+	const FString SearchText = Text.ToLower();
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(SearchText, Trigrams);
+
+	// short search strings have no trigrams
+	if (Trigrams.Num() == 0)
+	{
+		for (const FEntry& Entry : Entries)
+		{
+			if (Entry.SearchName.Contains(SearchText, ESearchCase::CaseSensitive))
+			{
+				OutSources.Add(Entry.Source);
+			}
+		}
+
+		return;
+	}
+
+	// only check the entries of the least common trigram
+	const TArray<int32>* Candidates = nullptr;
+
+	for (uint64 Trigram : Trigrams)
+	{
+		const TArray<int32>* TrigramEntries = TrigramIndex.Find(Trigram);
+
+		if (TrigramEntries == nullptr)
+		{
+			return;
+		}
+
+		if ((Candidates == nullptr) || (TrigramEntries->Num() < Candidates->Num()))
+		{
+			Candidates = TrigramEntries;
+		}
+	}
+
+	for (int32 EntryIndex : *Candidates)
+	{
+		const FEntry& Entry = Entries[EntryIndex];
+
+		if (Entry.SearchName.Contains(SearchText, ESearchCase::CaseSensitive))
+		{
+			OutSources.Add(Entry.Source);
+		}
+	}
+}
+
+
+bool FNdiMediaSourceRegistry::Remove(const FNdiMediaSourceId& Source)
+{
+	const int32* EntryIndex = NameIndex.Find(Source.Name);
+
+	if ((EntryIndex == nullptr) || !(Entries[*EntryIndex].Source == Source))
+	{
+		return false;
+	}
+
+	RemoveEntry(*EntryIndex);
+
+	return true;
+}
+
+
+/* FNdiMediaSourceRegistry implementation
+ *****************************************************************************/
+
+void FNdiMediaSourceRegistry::GetTrigrams(const FString& SearchName, TArray<uint64>& OutTrigrams)
+{
+	const int32 Len = SearchName.Len();
+
+	for (int32 CharIndex = 0; CharIndex + 3 <= Len; ++CharIndex)
+	{
+		const uint64 Trigram =
+			(((uint64)SearchName[CharIndex] & TrigramCharMask) << (TrigramCharBits * 2)) |
+			(((uint64)SearchName[CharIndex + 1] & TrigramCharMask) << TrigramCharBits) |
+			((uint64)SearchName[CharIndex + 2] & TrigramCharMask);
+
+		OutTrigrams.AddUnique(Trigram);
+	}
+}
+
+
+int32 FNdiMediaSourceRegistry::LowerBound(const FString& SearchName) const
+{
+	int32 First = 0;
+	int32 Count = SortedNames.Num();
+
+	while (Count > 0)
+	{
+		const int32 Step = Count / 2;
+		const int32 Middle = First + Step;
+
+		if (Entries[SortedNames[Middle]].SearchName.Compare(SearchName, ESearchCase::CaseSensitive) < 0)
+		{
+			First = Middle + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+
+	return First;
+}
+
+
+void FNdiMediaSourceRegistry::RemoveEntry(int32 EntryIndex)
+{
+	const FEntry& Entry = Entries[EntryIndex];
+
+	EndpointIndex.Remove(Entry.Source.Endpoint);
+	NameIndex.Remove(Entry.Source.Name);
+
+	for (const FString& Group : Entry.Groups)
+	{
+		GroupIndex.RemoveSingle(Group, EntryIndex);
+	}
+
+	if (!Entry.Machine.IsEmpty())
+	{
+		MachineIndex.RemoveSingle(Entry.Machine, EntryIndex);
+	}
+
+	// find the entry among the entries with the same name
+	for (int32 SortedIndex = LowerBound(Entry.SearchName); SortedIndex < SortedNames.Num(); ++SortedIndex)
+	{
+		if (SortedNames[SortedIndex] == EntryIndex)
+		{
+			SortedNames.RemoveAt(SortedIndex, 1, false);
+			break;
+		}
+	}
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(Entry.SearchName, Trigrams);
+
+	for (uint64 Trigram : Trigrams)
+	{
+		TArray<int32>* TrigramEntries = TrigramIndex.Find(Trigram);
+
+		if (TrigramEntries != nullptr)
+		{
+			TrigramEntries->RemoveSingleSwap(EntryIndex, false);
+
+			if (TrigramEntries->Num() == 0)
+			{
+				TrigramIndex.Remove(Trigram);
+			}
+		}
+	}
+
+	Entries.RemoveAt(EntryIndex);
+}
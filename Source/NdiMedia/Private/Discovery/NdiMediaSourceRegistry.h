@@ -0,0 +1,181 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/SparseArray.h"
+
+#include "NdiMediaFinder.h"
+
+
+/**
+ * Indexes discovered NDI sources for fast lookups on large networks.
+ *
+ * Sources are indexed by name, endpoint, machine and group, and their names can be
+ * searched by prefix or substring. The indices are updated incrementally as sources
+ * are added and removed, so that the cost of an update does not depend on the total
+ * number of sources (except for a memory move in the sorted name list).
+ *
+ * All lookups ignore case. This class is not thread-safe.
+ */
+class FNdiMediaSourceRegistry
+{
+public:
+
+	/**
+	 * Add a source to the registry.
+	 *
+	 * If a source with the same name and endpoint is already registered, its groups
+	 * are replaced. Registered sources that have either the same name or the same
+	 * endpoint are removed, because they moved or disappeared.
+	 *
+	 * @param Source The source to add.
+	 * @param Groups The NDI groups that the source belongs to.
+	 * @see Empty, Remove
+	 */
+	void Add(const FNdiMediaSourceId& Source, const TArray<FString>& Groups);
+
+	/**
+	 * Remove all sources.
+	 *
+	 * @see Add, Remove
+	 */
+	void Empty();
+
+	/**
+	 * Find the source with the specified endpoint.
+	 *
+	 * @param Endpoint The endpoint to find, i.e. "1.2.3.4:12345".
+	 * @return The source, or nullptr if not found.
+	 * @see FindByName
+	 */
+	const FNdiMediaSourceId* FindByEndpoint(const FString& Endpoint) const;
+
+	/**
+	 * Find all sources in the specified NDI group.
+	 *
+	 * @param Group The name of the group.
+	 * @param OutSources Will contain the sources.
+	 * @see FindByMachine
+	 */
+	void FindByGroup(const FString& Group, TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Find all sources running on the specified machine.
+	 *
+	 * @param Machine The name of the machine.
+	 * @param OutSources Will contain the sources.
+	 * @see FindByGroup, FNdiMediaSourceId::GetMachineName
+	 */
+	void FindByMachine(const FString& Machine, TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Find the source with the specified name.
+	 *
+	 * @param Name The name to find, i.e. "MACHINE (Source)".
+	 * @return The source, or nullptr if not found.
+	 * @see FindByEndpoint
+	 */
+	const FNdiMediaSourceId* FindByName(const FString& Name) const;
+
+	/**
+	 * Find all sources whose name starts with the specified text.
+	 *
+	 * @param Prefix The text to find.
+	 * @param OutSources Will contain the sources, in order of their names.
+	 * @see FindBySubstring
+	 */
+	void FindByPrefix(const FString& Prefix, TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Find all sources whose name contains the specified text.
+	 *
+	 * @param Text The text to find.
+	 * @param OutSources Will contain the sources, in no particular order.
+	 * @see FindByPrefix
+	 */
+	void FindBySubstring(const FString& Text, TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Get the number of registered sources.
+	 *
+	 * @return Number of sources.
+	 */
+	int32 Num() const
+	{
+		return Entries.Num();
+	}
+
+	/**
+	 * Remove a source from the registry.
+	 *
+	 * @param Source The source to remove.
+	 * @return true if the source was removed, false if it wasn't registered.
+	 * @see Add, Empty
+	 */
+	bool Remove(const FNdiMediaSourceId& Source);
+
+protected:
+
+	/** A registered source. */
+	struct FEntry
+	{
+		/** The NDI groups that the source belongs to. */
+		TArray<FString> Groups;
+
+		/** The name of the machine that the source is running on. */
+		FString Machine;
+
+		/** The source's name in lower case, used for searching. */
+		FString SearchName;
+
+		/** The source. */
+		FNdiMediaSourceId Source;
+	};
+
+	/**
+	 * Get the index of the first entry in the sorted name list whose name is not less than the specified name.
+	 *
+	 * @param SearchName The lower case name to find.
+	 * @return Index into the sorted name list.
+	 */
+	int32 LowerBound(const FString& SearchName) const;
+
+	/**
+	 * Remove an entry from the registry and all indices.
+	 *
+	 * @param EntryIndex The index of the entry to remove.
+	 */
+	void RemoveEntry(int32 EntryIndex);
+
+	/**
+	 * Collect the distinct trigrams of a lower case string.
+	 *
+	 * @param SearchName The string.
+	 * @param OutTrigrams Will contain the trigrams.
+	 */
+	static void GetTrigrams(const FString& SearchName, TArray<uint64>& OutTrigrams);
+
+private:
+
+	/** Maps endpoints to entry indices. */
+	TMap<FString, int32> EndpointIndex;
+
+	/** The registered sources. */
+	TSparseArray<FEntry> Entries;
+
+	/** Maps group names to entry indices. */
+	TMultiMap<FString, int32> GroupIndex;
+
+	/** Maps machine names to entry indices. */
+	TMultiMap<FString, int32> MachineIndex;
+
+	/** Maps source names to entry indices. */
+	TMap<FString, int32> NameIndex;
+
+	/** Entry indices, sorted by name. */
+	TArray<int32> SortedNames;
+
+	/** Maps each trigram of the source names to the indices of the entries containing it. */
+	TMap<uint64, TArray<int32>> TrigramIndex;
+};
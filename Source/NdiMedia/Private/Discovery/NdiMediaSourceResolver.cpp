@@ -0,0 +1,93 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSourceResolver.h"
+#include "NdiMediaPrivate.h"
+
+#include "Misc/ScopeLock.h"
+#include "UObject/UObjectBase.h"
+
+#include "NdiMediaFinder.h"
+
+
+/* Static initialization
+ *****************************************************************************/
+
+FCriticalSection FNdiMediaSourceResolver::CriticalSection;
+double FNdiMediaSourceResolver::EndpointConnectMilliseconds = 0.0;
+TMap<FString, FString> FNdiMediaSourceResolver::Endpoints;
+double FNdiMediaSourceResolver::NameConnectMilliseconds = 0.0;
+int32 FNdiMediaSourceResolver::NumEndpointConnects = 0;
+int32 FNdiMediaSourceResolver::NumNameConnects = 0;
+
+
+/* FNdiMediaSourceResolver static functions
+ *****************************************************************************/
+
+void FNdiMediaSourceResolver::AddEndpoint(const FString& SourceName, const FString& Endpoint)
+{
+	if (SourceName.IsEmpty() || Endpoint.IsEmpty())
+	{
+		return;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+	Endpoints.Add(SourceName, Endpoint);
+}
+
+
+double FNdiMediaSourceResolver::GetAverageConnectTime(bool UsedEndpoint)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (UsedEndpoint)
+	{
+		return (NumEndpointConnects > 0) ? EndpointConnectMilliseconds / NumEndpointConnects : -1.0;
+	}
+
+	return (NumNameConnects > 0) ? NameConnectMilliseconds / NumNameConnects : -1.0;
+}
+
+
+void FNdiMediaSourceResolver::RemoveEndpoint(const FString& SourceName)
+{
+	FScopeLock Lock(&CriticalSection);
+	Endpoints.Remove(SourceName);
+}
+
+
+void FNdiMediaSourceResolver::ReportConnectTime(bool UsedEndpoint, double Milliseconds)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (UsedEndpoint)
+	{
+		EndpointConnectMilliseconds += Milliseconds;
+		++NumEndpointConnects;
+	}
+	else
+	{
+		NameConnectMilliseconds += Milliseconds;
+		++NumNameConnects;
+	}
+}
+
+
+FString FNdiMediaSourceResolver::Resolve(const FString& SourceName)
+{
+	// prefer sources that are currently discovered (the finder is not thread-safe)
+	if (IsInGameThread() && UObjectInitialized())
+	{
+		FNdiMediaSourceId Source;
+
+		if (GetDefault<UNdiMediaFinder>()->FindSourceByName(SourceName, Source))
+		{
+			AddEndpoint(SourceName, Source.Endpoint);
+
+			return Source.Endpoint;
+		}
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	return Endpoints.FindRef(SourceName);
+}
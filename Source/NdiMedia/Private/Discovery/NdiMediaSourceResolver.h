@@ -0,0 +1,88 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+
+/**
+ * Resolves NDI source names to IP endpoints.
+ *
+ * Connecting to a source by endpoint is faster than by name, because the receiver
+ * doesn't need to wait for the source to be discovered. Endpoints are looked up in
+ * the sources found by the default UNdiMediaFinder, and cached, so that they are
+ * also known to players that are opened on other threads or before the finder has
+ * discovered the source again. The time it takes to connect with and without an
+ * endpoint is tracked to estimate the time saved.
+ *
+ * This class is thread-safe.
+ */
+class FNdiMediaSourceResolver
+{
+public:
+
+	/**
+	 * Remember the endpoint of an NDI source.
+	 *
+	 * @param SourceName The name of the source.
+	 * @param Endpoint The source's IP endpoint, i.e. "1.2.3.4:12345".
+	 * @see RemoveEndpoint, Resolve
+	 */
+	static void AddEndpoint(const FString& SourceName, const FString& Endpoint);
+
+	/**
+	 * Get the average time that it took to connect to sources.
+	 *
+	 * @param UsedEndpoint Whether to get the time for connections by endpoint or by name.
+	 * @return Average time (in milliseconds), or a negative value if no connections were made.
+	 * @see ReportConnectTime
+	 */
+	static double GetAverageConnectTime(bool UsedEndpoint);
+
+	/**
+	 * Forget the endpoint of an NDI source, i.e. because a connection to it failed.
+	 *
+	 * @param SourceName The name of the source.
+	 * @see AddEndpoint
+	 */
+	static void RemoveEndpoint(const FString& SourceName);
+
+	/**
+	 * Record the time that it took to connect to a source.
+	 *
+	 * @param UsedEndpoint Whether the connection was made by endpoint or by name.
+	 * @param Milliseconds The time to connect.
+	 * @see GetAverageConnectTime
+	 */
+	static void ReportConnectTime(bool UsedEndpoint, double Milliseconds);
+
+	/**
+	 * Get the endpoint of an NDI source.
+	 *
+	 * @param SourceName The name of the source.
+	 * @return The endpoint, or an empty string if unknown.
+	 * @see AddEndpoint
+	 */
+	static FString Resolve(const FString& SourceName);
+
+private:
+
+	/** Critical section for synchronizing access to the cache and statistics. */
+	static FCriticalSection CriticalSection;
+
+	/** Total time of connections by endpoint (in milliseconds). */
+	static double EndpointConnectMilliseconds;
+
+	/** Maps source names to endpoints. */
+	static TMap<FString, FString> Endpoints;
+
+	/** Total time of connections by name (in milliseconds). */
+	static double NameConnectMilliseconds;
+
+	/** Number of connections by endpoint. */
+	static int32 NumEndpointConnects;
+
+	/** Number of connections by name. */
+	static int32 NumNameConnects;
+};
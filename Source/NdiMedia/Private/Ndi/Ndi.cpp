@@ -3,11 +3,16 @@
 #include "Ndi.h"
 #include "NdiMediaPrivate.h"
 
+#include "Async/Async.h"
+#include "Async/Future.h"
 #include "Containers/StringConv.h"
 #include "HAL/PlatformMisc.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
 #include "Interfaces/IPluginManager.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
 
 
 /* Static initialization
@@ -16,11 +21,164 @@
 const NDIlib_v3* FNdi::Lib = nullptr;
 void* FNdi::LibHandle = nullptr;
 
+/** States of the NDI runtime library. */
+namespace ENdiState
+{
+	enum Type
+	{
+		Uninitialized,
+		Initializing,
+		Initialized,
+		Failed
+	};
+}
+
+/** Result of loading the runtime library on a background thread (game thread only, only valid if loaded asynchronously). */
+static TFuture<bool> InitializeFuture;
+
+/** The current ENdiState of the runtime library, which may be checked from any thread. */
+static FThreadSafeCounter State(ENdiState::Uninitialized);
+
+/** Releases of objects that use NDI which are still running on a background thread. */
+static TArray<TFuture<void>> PendingReleases;
+
+/** Synchronizes access to the pending releases. */
+static FCriticalSection PendingReleasesCriticalSection;
+
 
 /* FVlc static functions
  *****************************************************************************/
 
 bool FNdi::Initialize()
+{
+	State.Set(ENdiState::Initializing);
+
+	if (!LoadLib())
+	{
+		FreeLib();
+		State.Set(ENdiState::Failed);
+
+		return false;
+	}
+
+	State.Set(ENdiState::Initialized);
+
+	return true;
+}
+
+
+void FNdi::InitializeAsync()
+{
+	if (State.GetValue() != ENdiState::Uninitialized)
+	{
+		return;
+	}
+
+	State.Set(ENdiState::Initializing);
+
+	// loading the runtime library and initializing NDI may take a while
+	InitializeFuture = Async<bool>(EAsyncExecution::Thread, []()
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		if (!Initialize())
+		{
+			return false;
+		}
+
+		UE_LOG(LogNdiMedia, Log, TEXT("Initialized NDI on a background thread in %.1f ms"), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+
+		return true;
+	});
+}
+
+
+bool FNdi::IsInitialized()
+{
+	return (State.GetValue() == ENdiState::Initialized);
+}
+
+
+bool FNdi::IsInitializing()
+{
+	return (State.GetValue() == ENdiState::Initializing);
+}
+
+
+void FNdi::ReleaseAsync(TFunction<void()> Release)
+{
+	FScopeLock Lock(&PendingReleasesCriticalSection);
+
+	PendingReleases.RemoveAll([](const TFuture<void>& Future) {
+		return Future.IsReady();
+	});
+
+	// threads that block in NDI calls may take a while to stop
+	PendingReleases.Add(Async<void>(EAsyncExecution::ThreadPool, MoveTemp(Release)));
+}
+
+
+void FNdi::Shutdown()
+{
+	if (InitializeFuture.IsValid())
+	{
+		InitializeFuture.Wait();
+		InitializeFuture = TFuture<bool>();
+	}
+
+	// objects that use NDI must be released before the library is unloaded
+	TArray<TFuture<void>> Releases;
+	{
+		FScopeLock Lock(&PendingReleasesCriticalSection);
+		Releases = MoveTemp(PendingReleases);
+	}
+
+	for (const TFuture<void>& Release : Releases)
+	{
+		Release.Wait();
+	}
+
+	if (State.GetValue() == ENdiState::Initialized)
+	{
+		Lib->NDIlib_destroy();
+	}
+
+	FreeLib();
+	State.Set(ENdiState::Uninitialized);
+}
+
+
+bool FNdi::WaitForInitialization()
+{
+	if (InitializeFuture.IsValid() && !InitializeFuture.IsReady())
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		InitializeFuture.Wait();
+
+		UE_LOG(LogNdiMedia, Verbose, TEXT("Waited %.1f ms for NDI to initialize"), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+
+	return IsInitialized();
+}
+
+
+/* FNdi implementation
+ *****************************************************************************/
+
+void FNdi::FreeLib()
+{
+	Lib = nullptr;
+
+	if (LibHandle != nullptr)
+	{
+		FPlatformProcess::FreeDllHandle(LibHandle);
+		LibHandle = nullptr;
+	}
+}
+
+
+bool FNdi::LoadLib()
 {
 #if NDIMEDIA_DLL_PLATFORM
 	// determine runtime library path
@@ -55,6 +213,12 @@ bool FNdi::Initialize()
 
 	Lib = NDIlib_v3_load();
 
+	if (Lib == nullptr)
+	{
+		UE_LOG(LogNdiMedia, Error, TEXT("Failed to initialize NDI: The runtime library could not be loaded"));
+		return false;
+	}
+
 	if (!Lib->NDIlib_is_supported_CPU())
 	{
 		UE_LOG(LogNdiMedia, Error, TEXT("Failed to initialize NDI: Your CPU is not supported"));
@@ -70,21 +234,3 @@ bool FNdi::Initialize()
 	return true;
 }
 
-
-bool FNdi::IsInitialized()
-{
-	return (LibHandle != nullptr);
-}
-
-
-void FNdi::Shutdown()
-{
-	if (LibHandle != nullptr)
-	{
-		Lib->NDIlib_destroy();
-		FPlatformProcess::FreeDllHandle(LibHandle);
-
-		LibHandle = nullptr;
-		Lib = nullptr;
-	}
-}
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "Templates/Function.h"
+
 struct NDIlib_v3;
 
 
@@ -12,10 +14,17 @@ public:
 	static const NDIlib_v3* Lib;
 
 	static bool Initialize();
+	static void InitializeAsync();
 	static bool IsInitialized();
+	static bool IsInitializing();
+	static void ReleaseAsync(TFunction<void()> Release);
 	static void Shutdown();
+	static bool WaitForInitialization();
 
 private:
 
+	static void FreeLib();
+	static bool LoadLib();
+
 	static void* LibHandle;
 };
@@ -2,12 +2,19 @@
 
 #include "NdiMediaPrivate.h"
 
+#include "Containers/Ticker.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/UObjectBase.h"
+#include "UObject/UObjectIterator.h"
 
 #include "INdiMediaModule.h"
 #include "Ndi.h"
 #include "NdiMediaFinder.h"
 #include "NdiMediaPlayer.h"
+#include "NdiMediaSender.h"
+#include "NdiMediaSourceCache.h"
+#include "NdiMediaSourceResolver.h"
+#include "NdiMediaThumbnailPool.h"
 
 
 DEFINE_LOG_CATEGORY(LogNdiMedia);
@@ -15,6 +22,19 @@ DEFINE_LOG_CATEGORY(LogNdiMedia);
 #define LOCTEXT_NAMESPACE "FNdiMediaModule"
 
 
+/** Number of days after which sources that were not seen are removed from the source cache. */
+static const double SourceCacheMaxAgeDays = 7.0;
+
+/** Maximum number of receivers that capture source thumbnails at the same time. */
+static const int32 ThumbnailMaxReceivers = 4;
+
+/** Maximum width of source thumbnails (in pixels). */
+static const int32 ThumbnailMaxWidth = 160;
+
+/** Time after which source thumbnails are captured again (in seconds). */
+static const double ThumbnailRefreshInterval = 5.0;
+
+
 /**
  * Implements the NdiMedia module.
  */
@@ -26,6 +46,8 @@ public:
 	/** Default constructor. */
 	FNdiMediaModule()
 		: Initialized(false)
+		, InitializationFailed(false)
+		, ThumbnailPool(nullptr)
 	{ }
 
 public:
@@ -34,7 +56,8 @@ public:
 
 	virtual TSharedPtr<IMediaPlayer, ESPMode::ThreadSafe> CreatePlayer(IMediaEventSink& EventSink) override
 	{
-		if (!Initialized)
+		// waits for NDI if it is still initializing
+		if (!FinishInitialization())
 		{
 			return nullptr;
 		}
@@ -42,32 +65,184 @@ public:
 		return MakeShared<FNdiMediaPlayer, ESPMode::ThreadSafe>(EventSink);
 	}
 
+	virtual TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> GetSourceThumbnail(const FNdiMediaSourceId& Source) override
+	{
+		// don't block the caller while NDI is still loading
+		if (FNdi::IsInitializing() || !FinishInitialization())
+		{
+			return nullptr;
+		}
+
+		if (ThumbnailPool == nullptr)
+		{
+			ThumbnailPool = new FNdiMediaThumbnailPool(ThumbnailMaxReceivers, ThumbnailMaxWidth, ThumbnailRefreshInterval);
+
+			if (!ThumbnailPool->Start())
+			{
+				UE_LOG(LogNdiMedia, Warning, TEXT("Failed to start NDI thumbnail capture"));
+			}
+		}
+
+		return ThumbnailPool->GetThumbnail(Source);
+	}
+
 public:
 
 	//~ IModuleInterface interface
 
 	virtual void StartupModule() override
 	{
-		if (!FNdi::Initialize())
+		// load the NDI runtime off the startup path
+		FNdi::InitializeAsync();
+
+		// make endpoints from previous sessions available to players right away
+		if (SourceCache.Load())
 		{
-			UE_LOG(LogNdiMedia, Error, TEXT("Failed to initialize NDI"));
-			return;
+			SourceCache.Prune(FTimespan::FromDays(SourceCacheMaxAgeDays));
+
+			TArray<FNdiMediaSourceId> CachedSources;
+			SourceCache.GetSources(CachedSources);
+
+			for (const FNdiMediaSourceId& Source : CachedSources)
+			{
+				FNdiMediaSourceResolver::AddEndpoint(Source.Name, Source.Endpoint);
+			}
 		}
 
-		GetMutableDefault<UNdiMediaFinder>()->Initialize();
-		Initialized = true;
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FNdiMediaModule::HandleTicker), 0.0f);
 	}
 
 	virtual void ShutdownModule() override
 	{
+		if (TickerHandle.IsValid())
+		{
+			FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+			TickerHandle.Reset();
+		}
+
+		// the capture, discovery and send threads stop in parallel, and FNdi::Shutdown waits for them
+		if (ThumbnailPool != nullptr)
+		{
+			FNdiMediaThumbnailPool* Pool = ThumbnailPool;
+			Pool->Stop();
+
+			FNdi::ReleaseAsync([Pool]() {
+				delete Pool;
+			});
+
+			ThumbnailPool = nullptr;
+		}
+
+		if (UObjectInitialized())
+		{
+			for (TObjectIterator<UNdiMediaSender> It; It; ++It)
+			{
+				It->StopSending();
+			}
+		}
+
+		if (Initialized && UObjectInitialized())
+		{
+			UNdiMediaFinder* Finder = GetMutableDefault<UNdiMediaFinder>();
+
+			// remember the sources that were discovered in this session
+			TArray<FNdiMediaSourceId> Sources;
+
+			if (Finder->GetSources(Sources))
+			{
+				const TArray<FNdiMediaSourceId>& CachedSources = Finder->GetCachedSources();
+
+				Sources.RemoveAll([&](const FNdiMediaSourceId& Source) {
+					return CachedSources.Contains(Source);
+				});
+
+				SourceCache.Update(Sources, FDateTime::UtcNow());
+				SourceCache.Prune(FTimespan::FromDays(SourceCacheMaxAgeDays));
+
+				if (!SourceCache.Save())
+				{
+					UE_LOG(LogNdiMedia, Warning, TEXT("Failed to save NDI source cache %s"), *FNdiMediaSourceCache::GetFilePath());
+				}
+			}
+
+			Finder->Shutdown();
+		}
+
 		FNdi::Shutdown();
 		Initialized = false;
 	}
 
+private:
+
+	/**
+	 * Complete the initialization of the module on the game thread.
+	 *
+	 * Waits for the NDI runtime to be loaded, then starts the default finder.
+	 *
+	 * @return true if the module is initialized, false if NDI failed to initialize.
+	 */
+	bool FinishInitialization()
+	{
+		if (Initialized || InitializationFailed)
+		{
+			return Initialized;
+		}
+
+		if (!FNdi::WaitForInitialization())
+		{
+			UE_LOG(LogNdiMedia, Error, TEXT("Failed to initialize NDI"));
+			InitializationFailed = true;
+
+			return false;
+		}
+
+		UNdiMediaFinder* Finder = GetMutableDefault<UNdiMediaFinder>();
+		Finder->Initialize();
+
+		// make sources from previous sessions available until they are discovered
+		TArray<FNdiMediaSourceId> CachedSources;
+		SourceCache.GetSources(CachedSources);
+
+		if (CachedSources.Num() > 0)
+		{
+			Finder->SetCachedSources(CachedSources);
+		}
+
+		Initialized = true;
+
+		return true;
+	}
+
+	/** Callback for the core ticker, used to finish the initialization once NDI is loaded. */
+	bool HandleTicker(float DeltaTime)
+	{
+		if (FNdi::IsInitializing())
+		{
+			return true;
+		}
+
+		FinishInitialization();
+		TickerHandle.Reset();
+
+		return false;
+	}
+
 private:
 
 	/** Whether the module has been initialized. */
 	bool Initialized;
+
+	/** Whether the NDI runtime failed to initialize. */
+	bool InitializationFailed;
+
+	/** The NDI sources that were seen in previous sessions. */
+	FNdiMediaSourceCache SourceCache;
+
+	/** Captures source thumbnails (created on demand). */
+	FNdiMediaThumbnailPool* ThumbnailPool;
+
+	/** Handle to the registered ticker. */
+	FDelegateHandle TickerHandle;
 };
 
 
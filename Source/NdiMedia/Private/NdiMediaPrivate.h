@@ -4,6 +4,12 @@
 
 #define NDIMEDIA_DLL_PLATFORM (PLATFORM_LINUX || PLATFORM_MAC || PLATFORM_WINDOWS)
 
+#if PLATFORM_ENABLE_VECTORINTRINSICS && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+	#define NDIMEDIA_SSE2 1
+#else
+	#define NDIMEDIA_SSE2 0
+#endif
+
 
 #include "NdiMediaAllowPlatformTypes.h"
 	#include "Processing.NDI.Lib.h"
@@ -14,14 +20,45 @@
 #include "../../NdiMediaFactory/Public/NdiMediaSettings.h"
 
 
+#ifndef NDI_LIB_FOURCC
+	#define NDI_LIB_FOURCC(ch0, ch1, ch2, ch3) \
+		((uint32)(uint8)(ch0) | ((uint32)(uint8)(ch1) << 8) | ((uint32)(uint8)(ch2) << 16) | ((uint32)(uint8)(ch3) << 24))
+#endif
+
+
 DECLARE_LOG_CATEGORY_EXTERN(LogNdiMedia, Log, All);
 
 
 namespace NdiMedia
 {
+	/**
+	 * Receive color format for the best available quality, i.e. P216 or PA16 for
+	 * high-bit-depth sources (not declared by the version of the NDI SDK in use).
+	 *
+	 * This is the value of NDIlib_recv_color_format_best in the NDI 4 SDK headers, where
+	 * it directly follows NDIlib_recv_color_format_fastest (100). Receivers fall back to
+	 * the fastest color format if the installed runtime does not accept it.
+	 */
+	static const int64 ColorFormatBest = 101;
+
+	/** Semi-planar 4:2:2 YUV with 16 bits per component (not declared by the NDI SDK in use). */
+	static const uint32 FourCC_P216 = NDI_LIB_FOURCC('P', '2', '1', '6');
+
+	/** P216 followed by a 16-bit alpha plane (not declared by the NDI SDK in use). */
+	static const uint32 FourCC_PA16 = NDI_LIB_FOURCC('P', 'A', '1', '6');
+
 	/** Name of the AudioChannels media option. */
 	static const FName AudioChannelsOption("AudioChannels");
 
+	/** Name of the AudioChannelsPerTrack media option. */
+	static const FName AudioChannelsPerTrackOption("AudioChannelsPerTrack");
+
+	/** Name of the AudioFramesPerSample media option. */
+	static const FName AudioFramesPerSampleOption("AudioFramesPerSample");
+
+	/** Name of the AudioOverrunPolicy media option. */
+	static const FName AudioOverrunPolicyOption("AudioOverrunPolicy");
+
 	/** Name of the AudioReferenceLevel media option. */
 	static const FName AudioReferenceLevelOption("AudioReferenceLevel");
 
@@ -34,12 +71,60 @@ namespace NdiMedia
 	/** Name of the ColorFormat media option. */
 	static const FName ColorFormatOption("ColorFormat");
 
+	/** Name of the ColorRange media option. */
+	static const FName ColorRangeOption("ColorRange");
+
+	/** Name of the ColorSpace media option. */
+	static const FName ColorSpaceOption("ColorSpace");
+
+	/** Name of the CopyVideoFrames media option. */
+	static const FName CopyVideoFramesOption("CopyVideoFrames");
+
+	/** Name of the CropHeight media option. */
+	static const FName CropHeightOption("CropHeight");
+
+	/** Name of the CropWidth media option. */
+	static const FName CropWidthOption("CropWidth");
+
+	/** Name of the CropX media option. */
+	static const FName CropXOption("CropX");
+
+	/** Name of the CropY media option. */
+	static const FName CropYOption("CropY");
+
+	/** Name of the DeinterlaceFieldRate media option. */
+	static const FName DeinterlaceFieldRateOption("DeinterlaceFieldRate");
+
+	/** Name of the DeinterlaceMode media option. */
+	static const FName DeinterlaceModeOption("DeinterlaceMode");
+
+	/** Name of the DetectDirtyRows media option. */
+	static const FName DetectDirtyRowsOption("DetectDirtyRows");
+
+	/** Name of the DirectAudio media option. */
+	static const FName DirectAudioOption("DirectAudio");
+
+	/** Name of the Downscale media option. */
+	static const FName DownscaleOption("Downscale");
+
+	/** Name of the DownscaleFilter media option. */
+	static const FName DownscaleFilterOption("DownscaleFilter");
+
+	/** Name of the DuplicateFrameDetection media option. */
+	static const FName DuplicateFrameDetectionOption("DuplicateFrameDetection");
+
 	/** Name of the FrameRateDenominator media option. */
 	static const FName FrameRateDOption("FrameRateD");
 
 	/** Name of the FrameRateNumerator media option. */
 	static const FName FrameRateNOption("FrameRateN");
 
+	/** Name of the MaxAudioQueueDuration media option. */
+	static const FName MaxAudioQueueDurationOption("MaxAudioQueueDuration");
+
+	/** Name of the MaxVideoThreads media option. */
+	static const FName MaxVideoThreadsOption("MaxVideoThreads");
+
 	/** Name of the Progressive media option. */
 	static const FName ProgressiveOption("Progressive");
 
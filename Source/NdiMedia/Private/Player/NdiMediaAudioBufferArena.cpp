@@ -0,0 +1,91 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaAudioBufferArena.h"
+
+#include "HAL/UnrealMemory.h"
+#include "Misc/ScopeLock.h"
+
+
+/* FNdiMediaAudioBufferArena structors
+ *****************************************************************************/
+
+FNdiMediaAudioBufferArena::FNdiMediaAudioBufferArena(int32 InBlockSize, int32 InNumBlocks)
+	: BlockSize(InBlockSize)
+	, Blocks(nullptr)
+	, NumBlocks(InNumBlocks)
+{
+	check(BlockSize > 0);
+	check(NumBlocks >= 0);
+
+	if (NumBlocks > 0)
+	{
+		Blocks = (short*)FMemory::Malloc((SIZE_T)BlockSize * NumBlocks * sizeof(short));
+		FreeBlocks.Reserve(NumBlocks);
+
+		for (int32 BlockIndex = NumBlocks - 1; BlockIndex >= 0; --BlockIndex)
+		{
+			FreeBlocks.Add(Blocks + BlockIndex * BlockSize);
+		}
+	}
+}
+
+
+FNdiMediaAudioBufferArena::~FNdiMediaAudioBufferArena()
+{
+	checkf(FreeBlocks.Num() == NumBlocks, TEXT("Audio buffer arena destroyed while blocks are still in use"));
+
+	if (Blocks != nullptr)
+	{
+		FMemory::Free(Blocks);
+	}
+}
+
+
+/* FNdiMediaAudioBufferArena interface
+ *****************************************************************************/
+
+short* FNdiMediaAudioBufferArena::Allocate(int32 NumSamples, int32& OutCapacity)
+{
+	if (NumSamples <= BlockSize)
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (FreeBlocks.Num() > 0)
+		{
+			OutCapacity = BlockSize;
+
+			return FreeBlocks.Pop(false);
+		}
+	}
+
+	NumHeapAllocations.Increment();
+	OutCapacity = NumSamples;
+
+	return (short*)FMemory::Malloc(NumSamples * sizeof(short));
+}
+
+
+void FNdiMediaAudioBufferArena::Free(short* Buffer)
+{
+	if (Buffer == nullptr)
+	{
+		return;
+	}
+
+	if ((Buffer >= Blocks) && (Buffer < Blocks + (SIZE_T)BlockSize * NumBlocks))
+	{
+		FScopeLock Lock(&CriticalSection);
+		FreeBlocks.Add(Buffer);
+	}
+	else
+	{
+		FMemory::Free(Buffer);
+	}
+}
+
+
+int32 FNdiMediaAudioBufferArena::GetNumFreeBlocks() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return FreeBlocks.Num();
+}
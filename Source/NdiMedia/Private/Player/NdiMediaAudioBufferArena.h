@@ -0,0 +1,116 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+
+
+/**
+ * Implements a fixed-block arena for interleaved audio sample buffers.
+ *
+ * All blocks are allocated up front in a single slab, so that pre-warmed audio
+ * samples can be served without any heap allocations in the steady state. Requests
+ * that exceed the block size, or that arrive when all blocks are in use, fall back
+ * to the heap and are counted, so that the arena size can be verified at run-time.
+ *
+ * Buffers may be freed on any thread.
+ */
+class FNdiMediaAudioBufferArena
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InBlockSize Size of each block (in number of samples).
+	 * @param InNumBlocks Number of blocks to allocate.
+	 */
+	FNdiMediaAudioBufferArena(int32 InBlockSize, int32 InNumBlocks);
+
+	/** Destructor. */
+	~FNdiMediaAudioBufferArena();
+
+public:
+
+	/**
+	 * Allocate a buffer.
+	 *
+	 * @param NumSamples The required buffer size (in number of samples).
+	 * @param OutCapacity Will contain the actual buffer size (in number of samples).
+	 * @return The buffer.
+	 * @see Free
+	 */
+	short* Allocate(int32 NumSamples, int32& OutCapacity);
+
+	/**
+	 * Free a buffer that was allocated from this arena.
+	 *
+	 * @param Buffer The buffer to free.
+	 * @see Allocate
+	 */
+	void Free(short* Buffer);
+
+public:
+
+	/**
+	 * Get the size of each block.
+	 *
+	 * @return Block size (in number of samples).
+	 */
+	int32 GetBlockSize() const
+	{
+		return BlockSize;
+	}
+
+	/**
+	 * Get the total number of blocks.
+	 *
+	 * @return Number of blocks.
+	 * @see GetNumFreeBlocks
+	 */
+	int32 GetNumBlocks() const
+	{
+		return NumBlocks;
+	}
+
+	/**
+	 * Get the number of blocks that are currently not in use.
+	 *
+	 * @return Number of blocks.
+	 * @see GetNumBlocks
+	 */
+	int32 GetNumFreeBlocks() const;
+
+	/**
+	 * Get the number of buffers that had to be allocated on the heap.
+	 *
+	 * @return Number of allocations.
+	 */
+	int32 GetNumHeapAllocations() const
+	{
+		return NumHeapAllocations.GetValue();
+	}
+
+private:
+
+	/** Size of each block (in number of samples). */
+	const int32 BlockSize;
+
+	/** The slab that contains all blocks. */
+	short* Blocks;
+
+	/** Critical section for synchronizing access to the free list. */
+	mutable FCriticalSection CriticalSection;
+
+	/** Blocks that are currently not in use. */
+	TArray<short*> FreeBlocks;
+
+	/** Total number of blocks. */
+	const int32 NumBlocks;
+
+	/** Number of buffers that were allocated on the heap. */
+	FThreadSafeCounter NumHeapAllocations;
+};
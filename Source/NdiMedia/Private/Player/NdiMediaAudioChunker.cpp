@@ -0,0 +1,135 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaAudioChunker.h"
+#include "NdiMediaPrivate.h"
+
+#include "Math/UnrealMathUtility.h"
+
+#include "Ndi.h"
+#include "NdiMediaAudioSample.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* FNdiMediaAudioChunker structors
+ *****************************************************************************/
+
+FNdiMediaAudioChunker::FNdiMediaAudioChunker()
+	: CapacityFrames(0)
+	, ChunkFrames(0)
+	, NumAllocations(0)
+	, NumBufferedFrames(0)
+	, NumChannels(0)
+	, ReadFrame(0)
+	, SampleRate(0)
+	, Time(FTimespan::Zero())
+{ }
+
+
+/* FNdiMediaAudioChunker interface
+ *****************************************************************************/
+
+void FNdiMediaAudioChunker::Append(const short* Data, int32 NumFrames, int32 InNumChannels, int32 InSampleRate, FTimespan InTime)
+{
+	if ((Data == nullptr) || (NumFrames <= 0) || (InNumChannels <= 0) || (InSampleRate <= 0))
+	{
+		return;
+	}
+
+	if ((InNumChannels != NumChannels) || (InSampleRate != SampleRate))
+	{
+		Reset();
+
+		NumChannels = InNumChannels;
+		SampleRate = InSampleRate;
+	}
+
+	if (NumBufferedFrames == 0)
+	{
+		Time = InTime;
+	}
+
+	// grow ring buffer (only happens until the steady state is reached)
+	const int32 RequiredFrames = NumBufferedFrames + NumFrames;
+
+	if ((RequiredFrames > CapacityFrames) || (Buffer.Num() != CapacityFrames * NumChannels))
+	{
+		const int32 NewCapacityFrames = FMath::RoundUpToPowerOfTwo(FMath::Max(RequiredFrames, ChunkFrames * 2));
+		TArray<short> NewBuffer;
+		NewBuffer.AddUninitialized(NewCapacityFrames * NumChannels);
+
+		for (int32 Frame = 0; Frame < NumBufferedFrames; ++Frame)
+		{
+			const int32 Position = ((ReadFrame + Frame) % CapacityFrames) * NumChannels;
+			FMemory::Memcpy(&NewBuffer[Frame * NumChannels], &Buffer[Position], NumChannels * sizeof(short));
+		}
+
+		Buffer = MoveTemp(NewBuffer);
+		CapacityFrames = NewCapacityFrames;
+		ReadFrame = 0;
+
+		++NumAllocations;
+	}
+
+	// copy frames in up to two contiguous blocks
+	const int32 WriteFrame = (ReadFrame + NumBufferedFrames) % CapacityFrames;
+	const int32 FirstFrames = FMath::Min(NumFrames, CapacityFrames - WriteFrame);
+
+	FMemory::Memcpy(&Buffer[WriteFrame * NumChannels], Data, FirstFrames * NumChannels * sizeof(short));
+
+	if (FirstFrames < NumFrames)
+	{
+		FMemory::Memcpy(Buffer.GetData(), Data + FirstFrames * NumChannels, (NumFrames - FirstFrames) * NumChannels * sizeof(short));
+	}
+
+	NumBufferedFrames += NumFrames;
+}
+
+
+bool FNdiMediaAudioChunker::Pop(FNdiMediaAudioSample& OutSample, const TSharedPtr<FNdiMediaAudioQueue, ESPMode::ThreadSafe>& Queue)
+{
+	if (!CanPop())
+	{
+		return false;
+	}
+
+	short* SampleData = OutSample.InitializeBuffer(NumChannels, ChunkFrames, SampleRate, Time, Queue);
+
+	if (SampleData == nullptr)
+	{
+		return false;
+	}
+
+	// copy frames in up to two contiguous blocks
+	const int32 FirstFrames = FMath::Min(ChunkFrames, CapacityFrames - ReadFrame);
+
+	FMemory::Memcpy(SampleData, &Buffer[ReadFrame * NumChannels], FirstFrames * NumChannels * sizeof(short));
+
+	if (FirstFrames < ChunkFrames)
+	{
+		FMemory::Memcpy(SampleData + FirstFrames * NumChannels, Buffer.GetData(), (ChunkFrames - FirstFrames) * NumChannels * sizeof(short));
+	}
+
+	NumBufferedFrames -= ChunkFrames;
+	ReadFrame = (ReadFrame + ChunkFrames) % CapacityFrames;
+	Time += FTimespan(ETimespan::TicksPerSecond * ChunkFrames / SampleRate);
+
+	return true;
+}
+
+
+void FNdiMediaAudioChunker::Reset()
+{
+	NumBufferedFrames = 0;
+	ReadFrame = 0;
+}
+
+
+void FNdiMediaAudioChunker::SetChunkFrames(int32 InChunkFrames)
+{
+	ChunkFrames = FMath::Max(0, InChunkFrames);
+	Reset();
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
@@ -0,0 +1,138 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Misc/Timespan.h"
+#include "Templates/SharedPointer.h"
+
+class FNdiMediaAudioQueue;
+class FNdiMediaAudioSample;
+
+
+/**
+ * Re-chunks received audio into media samples of a fixed number of frames.
+ *
+ * NDI audio frames arrive in arbitrary sizes, which forces the audio sink to split
+ * and stitch buffers. The chunker accumulates converted audio in a ring buffer and
+ * emits samples that match the size of the Engine's audio callback buffers instead.
+ *
+ * This class is not thread-safe.
+ */
+class FNdiMediaAudioChunker
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaAudioChunker();
+
+public:
+
+	/**
+	 * Append interleaved audio frames.
+	 *
+	 * Buffered frames are discarded if the audio format changes.
+	 *
+	 * @param Data The interleaved audio samples.
+	 * @param NumFrames Number of audio frames to append.
+	 * @param InNumChannels Number of interleaved channels.
+	 * @param InSampleRate The sample rate (in samples per second).
+	 * @param Time The time of the first appended frame.
+	 * @see Pop
+	 */
+	void Append(const short* Data, int32 NumFrames, int32 InNumChannels, int32 InSampleRate, FTimespan Time);
+
+	/**
+	 * Check whether a full chunk of audio frames is available.
+	 *
+	 * @return true if a chunk is available, false otherwise.
+	 * @see Pop
+	 */
+	bool CanPop() const
+	{
+		return (ChunkFrames > 0) && (NumBufferedFrames >= ChunkFrames);
+	}
+
+	/**
+	 * Initialize the given media sample with the next chunk of audio frames.
+	 *
+	 * @param OutSample The sample to initialize.
+	 * @param Queue The audio queue that tracks unreleased samples (optional).
+	 * @return true on success, false if no chunk was available.
+	 * @see Append, CanPop
+	 */
+	bool Pop(FNdiMediaAudioSample& OutSample, const TSharedPtr<FNdiMediaAudioQueue, ESPMode::ThreadSafe>& Queue);
+
+	/**
+	 * Get the number of frames per chunk.
+	 *
+	 * @return Number of frames (0 = chunking disabled).
+	 * @see SetChunkFrames
+	 */
+	int32 GetChunkFrames() const
+	{
+		return ChunkFrames;
+	}
+
+	/**
+	 * Get the number of times that the ring buffer had to be allocated.
+	 *
+	 * @return Number of allocations.
+	 */
+	int32 GetNumAllocations() const
+	{
+		return NumAllocations;
+	}
+
+	/** Discard all buffered audio frames. */
+	void Reset();
+
+	/**
+	 * Set the number of frames per chunk.
+	 *
+	 * @param InChunkFrames Number of frames (0 = disable chunking).
+	 * @see IsEnabled
+	 */
+	void SetChunkFrames(int32 InChunkFrames);
+
+	/**
+	 * Whether chunking is enabled.
+	 *
+	 * @return true if enabled, false otherwise.
+	 * @see SetChunkFrames
+	 */
+	bool IsEnabled() const
+	{
+		return (ChunkFrames > 0);
+	}
+
+private:
+
+	/** The interleaved audio samples. */
+	TArray<short> Buffer;
+
+	/** Capacity of the ring buffer (in frames). */
+	int32 CapacityFrames;
+
+	/** Number of frames per chunk. */
+	int32 ChunkFrames;
+
+	/** Number of times that the ring buffer was allocated. */
+	int32 NumAllocations;
+
+	/** Number of buffered frames. */
+	int32 NumBufferedFrames;
+
+	/** Number of interleaved channels. */
+	int32 NumChannels;
+
+	/** Index of the first buffered frame. */
+	int32 ReadFrame;
+
+	/** Sample rate of the buffered audio. */
+	int32 SampleRate;
+
+	/** Time of the first buffered frame. */
+	FTimespan Time;
+};
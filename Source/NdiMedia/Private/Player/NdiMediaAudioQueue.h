@@ -0,0 +1,113 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Math/UnrealMathUtility.h"
+#include "Misc/Timespan.h"
+
+
+/**
+ * Tracks the audio samples that a player queued, but that were not released yet.
+ *
+ * Every queued sample is assigned its end position in the stream of queued audio.
+ * After a queue overrun, the player can discard the oldest queued audio by moving
+ * the drop position forward. The samples cannot be removed from the sample queues
+ * by the player, so discarded samples are still delivered, but report no frames.
+ *
+ * Samples may be released on any thread. All other methods must be called by the player.
+ */
+class FNdiMediaAudioQueue
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaAudioQueue()
+		: EnqueuedTicks(0)
+	{ }
+
+public:
+
+	/**
+	 * Add a sample to the queue.
+	 *
+	 * @param Duration The sample's duration.
+	 * @return The sample's end position in the queued audio.
+	 * @see Release
+	 */
+	int64 Add(FTimespan Duration)
+	{
+		EnqueuedTicks += Duration.GetTicks();
+		QueuedTicks.Add(Duration.GetTicks());
+
+		return EnqueuedTicks;
+	}
+
+	/**
+	 * Discard the oldest queued audio, so that no more than the given duration remains.
+	 *
+	 * @param KeepDuration The duration of the newest queued audio to keep.
+	 * @return The duration of audio that was discarded.
+	 * @see IsDropped
+	 */
+	FTimespan DropOldest(FTimespan KeepDuration)
+	{
+		const int64 OldDropTicks = DropTicks.GetValue();
+		const int64 NewDropTicks = EnqueuedTicks - KeepDuration.GetTicks();
+
+		if (NewDropTicks <= OldDropTicks)
+		{
+			return FTimespan::Zero();
+		}
+
+		DropTicks.Set(NewDropTicks);
+
+		// audio that was already released can't be discarded anymore
+		return FTimespan(FMath::Clamp(QueuedTicks.GetValue() - KeepDuration.GetTicks(), 0LL, NewDropTicks - OldDropTicks));
+	}
+
+	/**
+	 * Get the duration of all samples that were not released yet.
+	 *
+	 * @return Queued duration.
+	 */
+	FTimespan GetQueuedDuration() const
+	{
+		return FTimespan(QueuedTicks.GetValue());
+	}
+
+	/**
+	 * Check whether the sample with the given end position was discarded.
+	 *
+	 * @param EndPosition The sample's end position, as returned by Add.
+	 * @return true if discarded, false otherwise.
+	 * @see DropOldest
+	 */
+	bool IsDropped(int64 EndPosition) const
+	{
+		return (EndPosition <= DropTicks.GetValue());
+	}
+
+	/**
+	 * Remove a released sample from the queue.
+	 *
+	 * @param Duration The sample's duration.
+	 * @see Add
+	 */
+	void Release(FTimespan Duration)
+	{
+		QueuedTicks.Subtract(Duration.GetTicks());
+	}
+
+private:
+
+	/** End position of the newest discarded audio (in ticks). */
+	FThreadSafeCounter64 DropTicks;
+
+	/** Total duration of all audio that was ever queued (in ticks). */
+	int64 EnqueuedTicks;
+
+	/** Duration of the samples that were not released yet (in ticks). */
+	FThreadSafeCounter64 QueuedTicks;
+};
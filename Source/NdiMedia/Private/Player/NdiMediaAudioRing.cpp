@@ -0,0 +1,202 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaAudioRing.h"
+#include "NdiMediaPrivate.h"
+
+#include "Containers/Map.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformTime.h"
+#include "Math/UnrealMathUtility.h"
+#include "Misc/ScopeLock.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* FNdiMediaAudioRing structors
+ *****************************************************************************/
+
+FNdiMediaAudioRing::FNdiMediaAudioRing(uint32 InCapacity)
+	: CapacityMask(InCapacity - 1)
+	, ReadIndex(0)
+	, ReadRecordIndex(0)
+	, WriteIndex(0)
+	, WriteRecordIndex(0)
+{
+	check(FMath::IsPowerOfTwo(InCapacity));
+	Data.AddZeroed(InCapacity * NumChannels);
+}
+
+
+/* FNdiMediaAudioRing static functions
+ *****************************************************************************/
+
+TSharedRef<FNdiMediaAudioRing, ESPMode::ThreadSafe> FNdiMediaAudioRing::FindOrCreate(const FString& Url)
+{
+	static FCriticalSection RingsCriticalSection;
+	static TMap<FString, TWeakPtr<FNdiMediaAudioRing, ESPMode::ThreadSafe>> Rings;
+
+	FScopeLock Lock(&RingsCriticalSection);
+
+	// remove expired buffers
+	for (auto It = Rings.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TSharedPtr<FNdiMediaAudioRing, ESPMode::ThreadSafe> Ring = Rings.FindRef(Url).Pin();
+
+	if (!Ring.IsValid())
+	{
+		Ring = MakeShared<FNdiMediaAudioRing, ESPMode::ThreadSafe>(8192);
+		Rings.Add(Url, Ring);
+	}
+
+	return Ring.ToSharedRef();
+}
+
+
+/* FNdiMediaAudioRing interface
+ *****************************************************************************/
+
+int32 FNdiMediaAudioRing::Read(float* OutAudio, int32 NumFrames, int32 MaxLatencyFrames)
+{
+	uint32 CurrentRead = ReadIndex;
+	uint32 CurrentReadRecord = ReadRecordIndex;
+	const uint32 CurrentWrite = WriteIndex;
+
+	FPlatformMisc::MemoryBarrier();
+
+	const uint32 CurrentWriteRecord = WriteRecordIndex;
+	int32 Available = (int32)(CurrentWrite - CurrentRead);
+
+	// carry out pending reset requests
+	if (ResetRequested.AtomicSet(false))
+	{
+		CurrentRead = CurrentWrite;
+		Available = 0;
+
+		LatencyMicroseconds.Reset();
+		MaxLatencyMicroseconds.Reset();
+		NumSkippedFrames.Reset();
+		NumUnderruns.Reset();
+	}
+
+	// discard oldest frames beyond the maximum latency
+	const int32 MaxAvailable = NumFrames + LastWriteFrames.GetValue() + MaxLatencyFrames;
+
+	if (Available > MaxAvailable)
+	{
+		const int32 Skipped = Available - MaxAvailable;
+
+		CurrentRead += Skipped;
+		Available -= Skipped;
+		NumSkippedFrames.Add(Skipped);
+	}
+
+	// find the write record of the oldest frame, and measure the time since it was received
+	while ((CurrentReadRecord + 1 != CurrentWriteRecord) && ((int32)(WriteRecords[(CurrentReadRecord + 1) & (NumWriteRecords - 1)].StartIndex - CurrentRead) <= 0))
+	{
+		++CurrentReadRecord;
+	}
+
+	if ((Available > 0) && (CurrentReadRecord != CurrentWriteRecord))
+	{
+		const uint64 CaptureCycles = WriteRecords[CurrentReadRecord & (NumWriteRecords - 1)].Cycles;
+		const int32 Latency = (int32)(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - CaptureCycles) * 1000000.0);
+
+		LatencyMicroseconds.Set((LatencyMicroseconds.GetValue() * 15 + Latency) / 16);
+
+		if (Latency > MaxLatencyMicroseconds.GetValue())
+		{
+			MaxLatencyMicroseconds.Set(Latency);
+		}
+	}
+
+	// copy frames
+	const int32 NumRead = FMath::Min(Available, NumFrames);
+
+	for (int32 Frame = 0; Frame < NumRead; ++Frame)
+	{
+		const uint32 Position = ((CurrentRead + Frame) & CapacityMask) * NumChannels;
+
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			*OutAudio++ = Data[Position + Channel];
+		}
+	}
+
+	if (NumRead < NumFrames)
+	{
+		FMemory::Memzero(OutAudio, (NumFrames - NumRead) * NumChannels * sizeof(float));
+		NumUnderruns.Increment();
+	}
+
+	FPlatformMisc::MemoryBarrier();
+
+	ReadIndex = CurrentRead + NumRead;
+	ReadRecordIndex = CurrentReadRecord;
+
+	return NumRead;
+}
+
+
+int32 FNdiMediaAudioRing::Write(const NDIlib_audio_frame_v2_t& Frame, int32 FirstChannel, int32 NumFrameChannels, int32 ReferenceLevel, uint64 CaptureCycles)
+{
+	if ((Frame.p_data == nullptr) || (Frame.no_samples <= 0) || (NumFrameChannels <= 0) || (FirstChannel + NumFrameChannels > Frame.no_channels))
+	{
+		return 0;
+	}
+
+	const uint32 CurrentRead = ReadIndex;
+	const uint32 CurrentReadRecord = ReadRecordIndex;
+	const uint32 CurrentWrite = WriteIndex;
+	const uint32 CurrentWriteRecord = WriteRecordIndex;
+
+	FPlatformMisc::MemoryBarrier();
+
+	const int32 Free = (int32)(CapacityMask + 1 - (CurrentWrite - CurrentRead));
+
+	if ((Free < Frame.no_samples) || (CurrentWriteRecord - CurrentReadRecord >= NumWriteRecords))
+	{
+		return 0;
+	}
+
+	// convert planar float samples to interleaved stereo
+	const float Gain = FMath::Pow(10.0f, -ReferenceLevel / 20.0f);
+	const float* Left = (const float*)((const uint8*)Frame.p_data + FirstChannel * Frame.channel_stride_in_bytes);
+	const float* Right = (NumFrameChannels > 1) ? (const float*)((const uint8*)Left + Frame.channel_stride_in_bytes) : Left;
+
+	for (int32 Sample = 0; Sample < Frame.no_samples; ++Sample)
+	{
+		const uint32 Position = ((CurrentWrite + Sample) & CapacityMask) * NumChannels;
+
+		Data[Position] = FMath::Clamp(Left[Sample] * Gain, -1.0f, 1.0f);
+		Data[Position + 1] = FMath::Clamp(Right[Sample] * Gain, -1.0f, 1.0f);
+	}
+
+	FWriteRecord& Record = WriteRecords[CurrentWriteRecord & (NumWriteRecords - 1)];
+	{
+		Record.Cycles = CaptureCycles;
+		Record.StartIndex = CurrentWrite;
+	}
+
+	LastWriteFrames.Set(Frame.no_samples);
+	SampleRate.Set(Frame.sample_rate);
+
+	FPlatformMisc::MemoryBarrier();
+
+	// the record must be visible before the frames it describes
+	WriteRecordIndex = CurrentWriteRecord + 1;
+
+	FPlatformMisc::MemoryBarrier();
+
+	WriteIndex = CurrentWrite + Frame.no_samples;
+
+	return Frame.no_samples;
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
@@ -0,0 +1,260 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/SharedPointer.h"
+
+struct NDIlib_audio_frame_v2_t;
+
+
+/**
+ * Implements a lock-free ring buffer for low-latency audio.
+ *
+ * The ring buffer bypasses the media sample queues for sources that require
+ * minimal latency, such as talkback feeds. A single media player writes converted
+ * audio frames into the buffer on the media ticker thread, and a single sound
+ * component reads them on the audio render thread. The buffer is not safe for
+ * multiple producers or consumers, so each must be attached before it is used,
+ * and attaching a second one fails.
+ *
+ * The consumer discards the oldest audio if more than the maximum latency has been
+ * buffered, so that the latency recovers automatically after stalls.
+ */
+class FNdiMediaAudioRing
+{
+public:
+
+	/** Number of interleaved channels in the ring buffer. */
+	static const int32 NumChannels = 2;
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InCapacity Maximum number of frames in the buffer (must be a power of two).
+	 */
+	FNdiMediaAudioRing(uint32 InCapacity);
+
+public:
+
+	/**
+	 * Get the ring buffer for the specified media URL, or create it if needed.
+	 *
+	 * The ring buffer is shared between the media player that receives the audio
+	 * and the sound component that plays it, regardless of which is created first.
+	 * Callers must attach to the returned buffer as producer or consumer.
+	 *
+	 * @param Url The URL of the NDI media source.
+	 * @return The ring buffer.
+	 */
+	static TSharedRef<FNdiMediaAudioRing, ESPMode::ThreadSafe> FindOrCreate(const FString& Url);
+
+public:
+
+	/**
+	 * Attach the buffer's consumer.
+	 *
+	 * @return true on success, false if another consumer is attached.
+	 * @see AttachProducer, DetachConsumer
+	 */
+	bool AttachConsumer()
+	{
+		return !ConsumerAttached.AtomicSet(true);
+	}
+
+	/**
+	 * Attach the buffer's producer.
+	 *
+	 * @return true on success, false if another producer is attached.
+	 * @see AttachConsumer, DetachProducer
+	 */
+	bool AttachProducer()
+	{
+		return !ProducerAttached.AtomicSet(true);
+	}
+
+	/**
+	 * Detach the buffer's consumer.
+	 *
+	 * @see AttachConsumer
+	 */
+	void DetachConsumer()
+	{
+		ConsumerAttached = false;
+	}
+
+	/**
+	 * Detach the buffer's producer.
+	 *
+	 * @see AttachProducer
+	 */
+	void DetachProducer()
+	{
+		ProducerAttached = false;
+	}
+
+	/**
+	 * Read audio frames from the buffer (consumer only).
+	 *
+	 * Missing frames are filled with silence.
+	 *
+	 * @param OutAudio Will contain the interleaved audio frames.
+	 * @param NumFrames The number of frames to read.
+	 * @param MaxLatencyFrames Maximum number of frames to keep buffered beyond one received frame.
+	 * @return Number of frames that were read from the buffer.
+	 */
+	int32 Read(float* OutAudio, int32 NumFrames, int32 MaxLatencyFrames);
+
+	/**
+	 * Write an NDI audio frame into the buffer (producer only).
+	 *
+	 * Mono tracks are duplicated into both channels, and only the first two
+	 * channels of tracks with more channels are used. Frames that do not fit
+	 * into the buffer are dropped.
+	 *
+	 * @param Frame The audio frame to write.
+	 * @param FirstChannel Index of the first frame channel to write.
+	 * @param NumFrameChannels Number of frame channels to write.
+	 * @param ReferenceLevel Reference level (in dB).
+	 * @param CaptureCycles Time at which the frame was received from NDI (in CPU cycles).
+	 * @return Number of frames written.
+	 */
+	int32 Write(const NDIlib_audio_frame_v2_t& Frame, int32 FirstChannel, int32 NumFrameChannels, int32 ReferenceLevel, uint64 CaptureCycles);
+
+public:
+
+	/**
+	 * Get the average latency of the audio read from the buffer.
+	 *
+	 * The latency is measured from the time an audio frame was received from NDI,
+	 * i.e. when NDIlib_recv_capture_v2 returned, until it is read for rendering.
+	 *
+	 * @return Latency (in milliseconds).
+	 * @see GetMaxLatency, GetNumSkippedFrames, GetNumUnderruns
+	 */
+	float GetAverageLatency() const
+	{
+		return LatencyMicroseconds.GetValue() / 1000.0f;
+	}
+
+	/**
+	 * Get the highest latency of the audio read from the buffer.
+	 *
+	 * @return Latency (in milliseconds).
+	 * @see GetAverageLatency, GetNumSkippedFrames, GetNumUnderruns
+	 */
+	float GetMaxLatency() const
+	{
+		return MaxLatencyMicroseconds.GetValue() / 1000.0f;
+	}
+
+	/**
+	 * Get the number of frames that were discarded to bound the latency.
+	 *
+	 * @return Number of frames.
+	 * @see GetAverageLatency, GetMaxLatency, GetNumUnderruns
+	 */
+	int32 GetNumSkippedFrames() const
+	{
+		return NumSkippedFrames.GetValue();
+	}
+
+	/**
+	 * Get the number of reads that did not find enough buffered frames.
+	 *
+	 * @return Number of underruns.
+	 * @see GetAverageLatency, GetMaxLatency, GetNumSkippedFrames
+	 */
+	int32 GetNumUnderruns() const
+	{
+		return NumUnderruns.GetValue();
+	}
+
+	/**
+	 * Get the sample rate of the audio in the buffer.
+	 *
+	 * @return Sample rate (in samples per second), or 0 if unknown.
+	 */
+	int32 GetSampleRate() const
+	{
+		return SampleRate.GetValue();
+	}
+
+	/**
+	 * Discard all buffered frames and reset the statistics.
+	 *
+	 * The request is carried out by the consumer the next time it reads from the buffer.
+	 */
+	void RequestReset()
+	{
+		ResetRequested = true;
+	}
+
+private:
+
+	/** Capture time of the audio frames written to the buffer. */
+	struct FWriteRecord
+	{
+		/** Time at which the frames were received (in CPU cycles). */
+		uint64 Cycles;
+
+		/** Index of the first written frame. */
+		uint32 StartIndex;
+	};
+
+	/** Number of write records (must be a power of two). */
+	static const uint32 NumWriteRecords = 256;
+
+	/** Mask for converting frame indices to buffer positions. */
+	const uint32 CapacityMask;
+
+	/** Whether a consumer is attached. */
+	FThreadSafeBool ConsumerAttached;
+
+	/** The interleaved audio frames. */
+	TArray<float> Data;
+
+	/** Number of frames in the last written NDI frame. */
+	FThreadSafeCounter LastWriteFrames;
+
+	/** Average latency of read audio (in microseconds). */
+	FThreadSafeCounter LatencyMicroseconds;
+
+	/** Highest latency of read audio (in microseconds). */
+	FThreadSafeCounter MaxLatencyMicroseconds;
+
+	/** Number of frames discarded to bound the latency. */
+	FThreadSafeCounter NumSkippedFrames;
+
+	/** Number of reads that found too few frames. */
+	FThreadSafeCounter NumUnderruns;
+
+	/** Whether a producer is attached. */
+	FThreadSafeBool ProducerAttached;
+
+	/** Index of the next frame to read. */
+	volatile uint32 ReadIndex;
+
+	/** Index of the write record that contains the next frame to read. */
+	volatile uint32 ReadRecordIndex;
+
+	/** Whether the consumer should discard all buffered frames. */
+	FThreadSafeBool ResetRequested;
+
+	/** Sample rate of the buffered audio. */
+	FThreadSafeCounter SampleRate;
+
+	/** Index of the next frame to write. */
+	volatile uint32 WriteIndex;
+
+	/** Index of the next write record. */
+	volatile uint32 WriteRecordIndex;
+
+	/** Capture times of the written frames. */
+	FWriteRecord WriteRecords[NumWriteRecords];
+};
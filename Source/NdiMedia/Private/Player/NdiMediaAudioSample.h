@@ -2,12 +2,22 @@
 
 #pragma once
 
+#include "Containers/Array.h"
+#include "HAL/PlatformMisc.h"
 #include "IMediaAudioSample.h"
 #include "MediaObjectPool.h"
+#include "Templates/SharedPointer.h"
+
+#include "NdiMediaAudioBufferArena.h"
+#include "NdiMediaAudioQueue.h"
 
 
 /**
  * Implements a media audio sample for NdiMedia.
+ *
+ * The interleaved sample buffer is allocated from the player's buffer arena, if
+ * one was assigned, and it is kept while the sample is recycled by the pool.
+ * Samples that were discarded by the player's audio queue report no frames.
  */
 class FNdiMediaAudioSample
 	: public IMediaAudioSample
@@ -18,11 +28,16 @@ public:
 	/** Default constructor. */
 	FNdiMediaAudioSample()
 		: Duration(FTimespan::Zero())
+		, FirstChannel(0)
 		, Frame()
 		, FrameInterleaved()
 		, FrameInterleavedSize(0)
+		, NumChannels(0)
+		, NumFrames(0)
+		, QueuePosition(0)
 		, ReceiverInstance(nullptr)
 		, ReferenceLevel(0)
+		, SampleRate(0)
 		, Time(FTimespan::Zero())
 	{ }
 
@@ -40,11 +55,15 @@ public:
 	 *
 	 * @param InReceiverInstance The receiver instance that generated the sample.
 	 * @param InFrame The audio frame data.
+	 * @param InFirstChannel Index of the first frame channel to include in the sample.
+	 * @param InNumChannels Number of frame channels to include in the sample.
+	 * @param InNumFrames Number of output frames (the frame's samples are compressed if less than its sample count).
 	 * @param InReferenceLevel Reference level (in dB).
 	 * @param InTime The sample time (in the player's own clock).
+	 * @param InQueue The audio queue that tracks the samples that have not been released yet (optional).
 	 * @result true on success, false otherwise.
 	 */
-	bool Initialize(void* InReceiverInstance, const NDIlib_audio_frame_v2_t& InFrame, int32 InReferenceLevel, FTimespan InTime)
+	bool Initialize(void* InReceiverInstance, const NDIlib_audio_frame_v2_t& InFrame, int32 InFirstChannel, int32 InNumChannels, int32 InNumFrames, int32 InReferenceLevel, FTimespan InTime, const TSharedPtr<FNdiMediaAudioQueue, ESPMode::ThreadSafe>& InQueue)
 	{
 		FreeFrame();
 
@@ -58,15 +77,163 @@ public:
 			return false;
 		}
 
-		Duration = ETimespan::TicksPerSecond * InFrame.no_samples / InFrame.sample_rate;
+		if ((InFirstChannel < 0) || (InNumChannels <= 0) || (InFirstChannel + InNumChannels > InFrame.no_channels))
+		{
+			return false;
+		}
+
+		if ((InNumFrames <= 0) || (InNumFrames > InFrame.no_samples))
+		{
+			return false;
+		}
+
+		Duration = ETimespan::TicksPerSecond * InNumFrames / InFrame.sample_rate;
+		FirstChannel = InFirstChannel;
 		Frame = InFrame;
+		FrameInterleaved.no_samples = 0;
+		NumChannels = InNumChannels;
+		NumFrames = InNumFrames;
+		Queue = InQueue;
 		ReceiverInstance = InReceiverInstance;
 		ReferenceLevel = InReferenceLevel;
+		SampleRate = InFrame.sample_rate;
 		Time = InTime;
 
+		if (Queue.IsValid())
+		{
+			QueuePosition = Queue->Add(Duration);
+		}
+
 		return true;
 	}
 
+	/**
+	 * Initialize the sample with interleaved audio frames that are provided by the caller.
+	 *
+	 * @param InNumChannels Number of interleaved channels.
+	 * @param InNumFrames Number of audio frames.
+	 * @param InSampleRate The sample rate (in samples per second).
+	 * @param InTime The sample time (in the player's own clock).
+	 * @param InQueue The audio queue that tracks the samples that have not been released yet (optional).
+	 * @return The buffer that the caller must write the interleaved audio frames to, or nullptr on failure.
+	 */
+	short* InitializeBuffer(int32 InNumChannels, int32 InNumFrames, int32 InSampleRate, FTimespan InTime, const TSharedPtr<FNdiMediaAudioQueue, ESPMode::ThreadSafe>& InQueue)
+	{
+		FreeFrame();
+
+		if ((InNumChannels <= 0) || (InNumFrames <= 0) || (InSampleRate <= 0))
+		{
+			return nullptr;
+		}
+
+		AllocateFrameInterleaved(InNumChannels * InNumFrames);
+
+		Duration = ETimespan::TicksPerSecond * InNumFrames / InSampleRate;
+		FirstChannel = 0;
+		FrameInterleaved.no_channels = InNumChannels;
+		FrameInterleaved.no_samples = InNumFrames;
+		FrameInterleaved.sample_rate = InSampleRate;
+		NumChannels = InNumChannels;
+		NumFrames = InNumFrames;
+		Queue = InQueue;
+		SampleRate = InSampleRate;
+		Time = InTime;
+
+		if (Queue.IsValid())
+		{
+			QueuePosition = Queue->Add(Duration);
+		}
+
+		return FrameInterleaved.p_data;
+	}
+
+public:
+
+	/**
+	 * Convert some of the channels in the given audio frame to interleaved 16-bit samples.
+	 *
+	 * @param Frame The audio frame to convert.
+	 * @param FirstChannel Index of the first frame channel to convert.
+	 * @param NumChannels Number of frame channels to convert.
+	 * @param ReferenceLevel Reference level (in dB).
+	 * @param OutData Will contain the interleaved samples (must hold Frame.no_samples * NumChannels samples).
+	 */
+	static void ConvertFrame(const NDIlib_audio_frame_v2_t& Frame, int32 FirstChannel, int32 NumChannels, int32 ReferenceLevel, short* OutData)
+	{
+		// planar channels are contiguous, so the selected channels form a sub-frame
+		NDIlib_audio_frame_v2_t ChannelFrame = Frame;
+		{
+			ChannelFrame.p_data = (float*)((uint8*)Frame.p_data + FirstChannel * Frame.channel_stride_in_bytes);
+			ChannelFrame.no_channels = NumChannels;
+		}
+
+		NDIlib_audio_frame_interleaved_16s_t InterleavedFrame = { 0 };
+		{
+			InterleavedFrame.reference_level = ReferenceLevel;
+			InterleavedFrame.p_data = OutData;
+		}
+
+		FNdi::Lib->NDIlib_util_audio_to_interleaved_16s_v2(&ChannelFrame, &InterleavedFrame);
+	}
+
+	/**
+	 * Linearly resample interleaved 16-bit samples in place to fewer frames.
+	 *
+	 * @param Data The interleaved samples.
+	 * @param NumChannels Number of interleaved channels.
+	 * @param NumInputFrames Number of frames in the input.
+	 * @param NumOutputFrames Number of frames in the output (must not be more than NumInputFrames).
+	 */
+	static void CompressFrames(short* Data, int32 NumChannels, int32 NumInputFrames, int32 NumOutputFrames)
+	{
+		const int64 LastInputFrame = NumInputFrames - 1;
+		const int64 LastOutputFrame = FMath::Max(NumOutputFrames - 1, 1);
+
+		// input positions never lag behind output positions, so this is safe in place
+		for (int32 OutputFrame = 0; OutputFrame < NumOutputFrames; ++OutputFrame)
+		{
+			const int64 Position = (OutputFrame * LastInputFrame * 256) / LastOutputFrame;
+			const int32 InputFrame = (int32)(Position >> 8);
+			const int32 Weight = (int32)(Position & 0xff);
+			const int32 NextFrame = FMath::Min<int32>(InputFrame + 1, (int32)LastInputFrame);
+
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				const int32 Current = Data[InputFrame * NumChannels + Channel];
+				const int32 Next = Data[NextFrame * NumChannels + Channel];
+
+				Data[OutputFrame * NumChannels + Channel] = (short)(Current + (((Next - Current) * Weight) >> 8));
+			}
+		}
+	}
+
+	/**
+	 * Assign the arena that the interleaved sample buffer is allocated from.
+	 *
+	 * @param InArena The buffer arena.
+	 * @see Prewarm
+	 */
+	void SetArena(const TSharedPtr<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe>& InArena)
+	{
+		if (InArena != Arena)
+		{
+			FreeFrameInterleaved();
+			Arena = InArena;
+		}
+	}
+
+	/**
+	 * Assign the buffer arena and allocate the interleaved sample buffer up front.
+	 *
+	 * @param InArena The buffer arena.
+	 * @see SetArena
+	 */
+	void Prewarm(const TSharedRef<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe>& InArena)
+	{
+		SetArena(InArena);
+		AllocateFrameInterleaved(InArena->GetBlockSize());
+	}
+
 public:
 
 	//~ IMediaAudioSample interface
@@ -80,23 +247,17 @@ public:
 				return nullptr;
 			}
 
-			// try to reuse existing frame buffer if large enough
-			const int32 TotalSamples = Frame.no_samples * Frame.no_channels;
+			AllocateFrameInterleaved(Frame.no_samples * NumChannels);
+			ConvertFrame(Frame, FirstChannel, NumChannels, ReferenceLevel, FrameInterleaved.p_data);
 
-			if (FrameInterleavedSize < TotalSamples)
+			if (NumFrames < Frame.no_samples)
 			{
-				FreeFrameInterleaved();
+				CompressFrames(FrameInterleaved.p_data, NumChannels, Frame.no_samples, NumFrames);
 			}
 
-			// allocate frame buffer
-			if (FrameInterleaved.p_data == nullptr)
-			{
-				FrameInterleaved.reference_level = ReferenceLevel;
-				FrameInterleaved.p_data = new short[TotalSamples];
-				FrameInterleavedSize = TotalSamples;
-			}
-
-			FNdi::Lib->NDIlib_util_audio_to_interleaved_16s_v2(&Frame, &FrameInterleaved);
+			FrameInterleaved.no_channels = NumChannels;
+			FrameInterleaved.no_samples = NumFrames;
+			FrameInterleaved.sample_rate = SampleRate;
 		}
 
 		return FrameInterleaved.p_data;
@@ -104,12 +265,13 @@ public:
 
 	virtual uint32 GetChannels() const override
 	{
-		return Frame.no_channels;
+		return NumChannels;
 	}
 
 	virtual FTimespan GetDuration() const override
 	{
-		return Duration;
+		// consistent with GetFrames, so that dropped samples don't advance the playback time
+		return IsDropped() ? FTimespan::Zero() : Duration;
 	}
 
 	virtual EMediaAudioSampleFormat GetFormat() const override
@@ -119,12 +281,12 @@ public:
 
 	virtual uint32 GetFrames() const override
 	{
-		return Frame.no_samples;
+		return IsDropped() ? 0 : NumFrames;
 	}
 
 	virtual uint32 GetSampleRate() const override
 	{
-		return Frame.sample_rate;
+		return SampleRate;
 	}
 
 	virtual FTimespan GetTime() const override
@@ -143,6 +305,33 @@ public:
 
 protected:
 
+	/**
+	 * Make sure that the interleaved audio frame buffer is large enough.
+	 *
+	 * @param TotalSamples The required size (in number of samples).
+	 */
+	void AllocateFrameInterleaved(int32 TotalSamples)
+	{
+		// try to reuse existing frame buffer if large enough
+		if (FrameInterleavedSize < TotalSamples)
+		{
+			FreeFrameInterleaved();
+		}
+
+		if (FrameInterleaved.p_data == nullptr)
+		{
+			if (Arena.IsValid())
+			{
+				FrameInterleaved.p_data = Arena->Allocate(TotalSamples, FrameInterleavedSize);
+			}
+			else
+			{
+				FrameInterleaved.p_data = new short[TotalSamples];
+				FrameInterleavedSize = TotalSamples;
+			}
+		}
+	}
+
 	/** Free the audio frame data. */
 	void FreeFrame()
 	{
@@ -153,6 +342,12 @@ protected:
 			ReceiverInstance = nullptr;
 			Frame = { 0 };
 		}
+
+		if (Queue.IsValid())
+		{
+			Queue->Release(Duration);
+			Queue.Reset();
+		}
 	}
 
 	/** Free the interleaved audio frame data. */
@@ -160,17 +355,41 @@ protected:
 	{
 		if (FrameInterleaved.p_data != nullptr)
 		{
-			delete[] FrameInterleaved.p_data;
+			if (Arena.IsValid())
+			{
+				Arena->Free(FrameInterleaved.p_data);
+			}
+			else
+			{
+				delete[] FrameInterleaved.p_data;
+			}
+
 			FrameInterleaved = { 0 };
 			FrameInterleavedSize = 0;
 		}
 	}
 
+	/**
+	 * Check whether the audio queue discarded this sample.
+	 *
+	 * @return true if discarded, false otherwise.
+	 */
+	bool IsDropped() const
+	{
+		return Queue.IsValid() && Queue->IsDropped(QueuePosition);
+	}
+
 private:
 
+	/** The arena that the interleaved sample buffer is allocated from (optional). */
+	TSharedPtr<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe> Arena;
+
 	/** Duration for which the sample is valid. */
 	FTimespan Duration;
 
+	/** Index of the first frame channel included in this sample. */
+	int32 FirstChannel;
+
 	/** The audio frame data. */
 	NDIlib_audio_frame_v2_t Frame;
 
@@ -180,16 +399,186 @@ private:
 	/** Current size of the interleaved audio frame buffer (in number of samples). */
 	int32 FrameInterleavedSize;
 
+	/** Number of frame channels included in this sample. */
+	int32 NumChannels;
+
+	/** Number of output frames in this sample. */
+	int32 NumFrames;
+
+	/** The audio queue that tracks unreleased samples (optional). */
+	TSharedPtr<FNdiMediaAudioQueue, ESPMode::ThreadSafe> Queue;
+
+	/** End position of this sample in the audio queue. */
+	int64 QueuePosition;
+
 	/** The receiver instance that generated this sample. */
 	void* ReceiverInstance;
 
 	/** Reference level (in dB). */
 	int32 ReferenceLevel;
 
+	/** The sample rate (in samples per second). */
+	int32 SampleRate;
+
 	/** Sample time. */
 	FTimespan Time;
 };
 
 
-/** Implements a pool for NDI audio sample objects. */
-class FNdiMediaAudioSamplePool : public TMediaObjectPool<FNdiMediaAudioSample> { };
+/**
+ * Implements a pool for NDI audio sample objects.
+ *
+ * TMediaObjectPool allocates a new shared reference controller every time that an
+ * object is acquired. This pool keeps a shared reference to each of its samples
+ * instead, and recycles the samples whose only remaining reference is its own.
+ * Released samples are recycled when the pool is reclaimed or acquired from.
+ *
+ * This class is not thread-safe, but acquired samples may be released on any thread.
+ */
+class FNdiMediaAudioSamplePool
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaAudioSamplePool()
+		: NextEntry(0)
+		, NumAllocations(0)
+	{ }
+
+public:
+
+	/**
+	 * Acquire a sample from the pool.
+	 *
+	 * A new sample is created if all samples are in use.
+	 *
+	 * @return The sample.
+	 * @see Prewarm, Reclaim
+	 */
+	TSharedRef<FNdiMediaAudioSample, ESPMode::ThreadSafe> AcquireShared()
+	{
+		for (int32 Count = 0; Count < Entries.Num(); ++Count)
+		{
+			FEntry& Entry = Entries[NextEntry];
+			NextEntry = (NextEntry + 1) % Entries.Num();
+
+			if (Entry.Acquired)
+			{
+				if (!Entry.Sample.IsUnique())
+				{
+					continue;
+				}
+
+				FPlatformMisc::MemoryBarrier();
+				Entry.Sample->ShutdownPoolable();
+			}
+
+			Entry.Acquired = true;
+
+			return Entry.Sample;
+		}
+
+		Entries.Emplace(MakeShared<FNdiMediaAudioSample, ESPMode::ThreadSafe>());
+		Entries.Last().Acquired = true;
+		++NumAllocations;
+
+		return Entries.Last().Sample;
+	}
+
+	/**
+	 * Get the number of samples that had to be created because all pooled samples were in use.
+	 *
+	 * Samples that are created by Prewarm are not included.
+	 *
+	 * @return Number of allocations.
+	 * @see AcquireShared, GetNumSamples
+	 */
+	int32 GetNumAllocations() const
+	{
+		return NumAllocations;
+	}
+
+	/**
+	 * Get the total number of samples in the pool.
+	 *
+	 * @return Number of samples.
+	 * @see GetNumAllocations
+	 */
+	int32 GetNumSamples() const
+	{
+		return Entries.Num();
+	}
+
+	/**
+	 * Create samples, and allocate their buffers from the given arena.
+	 *
+	 * @param NumSamples The number of samples that the pool should contain.
+	 * @param Arena The buffer arena.
+	 * @see AcquireShared
+	 */
+	void Prewarm(int32 NumSamples, const TSharedRef<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe>& Arena)
+	{
+		Entries.Reserve(NumSamples);
+
+		while (Entries.Num() < NumSamples)
+		{
+			Entries.Emplace(MakeShared<FNdiMediaAudioSample, ESPMode::ThreadSafe>());
+		}
+
+		for (FEntry& Entry : Entries)
+		{
+			if (!Entry.Acquired)
+			{
+				Entry.Sample->Prewarm(Arena);
+			}
+		}
+	}
+
+	/** Recycle all samples that were released by their consumers. */
+	void Reclaim()
+	{
+		for (FEntry& Entry : Entries)
+		{
+			if (Entry.Acquired && Entry.Sample.IsUnique())
+			{
+				FPlatformMisc::MemoryBarrier();
+				Entry.Sample->ShutdownPoolable();
+				Entry.Acquired = false;
+			}
+		}
+	}
+
+	/** Remove all samples from the pool (samples in use are destroyed when they are released). */
+	void Reset()
+	{
+		Entries.Empty();
+		NextEntry = 0;
+	}
+
+private:
+
+	/** A sample in the pool. */
+	struct FEntry
+	{
+		/** Whether the sample was acquired, and has not been recycled yet. */
+		bool Acquired;
+
+		/** The sample. */
+		TSharedRef<FNdiMediaAudioSample, ESPMode::ThreadSafe> Sample;
+
+		/** Create and initialize a new instance. */
+		FEntry(const TSharedRef<FNdiMediaAudioSample, ESPMode::ThreadSafe>& InSample)
+			: Acquired(false)
+			, Sample(InSample)
+		{ }
+	};
+
+	/** The samples in the pool. */
+	TArray<FEntry> Entries;
+
+	/** Index of the entry to check first when acquiring a sample. */
+	int32 NextEntry;
+
+	/** Number of samples that were created because all pooled samples were in use. */
+	int32 NumAllocations;
+};
@@ -3,7 +3,10 @@
 #include "NdiMediaPlayer.h"
 #include "NdiMediaPrivate.h"
 
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/StringConv.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
 #include "IMediaEventSink.h"
 #include "IMediaOptions.h"
 #include "MediaSamples.h"
@@ -13,11 +16,22 @@
 #include "UObject/UObjectGlobals.h"
 #include "UObject/WeakObjectPtr.h"
 
+#include "NdiMediaAudioBufferArena.h"
+#include "NdiMediaAudioChunker.h"
+#include "NdiMediaAudioQueue.h"
+#include "NdiMediaAudioRing.h"
 #include "NdiMediaAudioSample.h"
 #include "NdiMediaBinarySample.h"
+#include "NdiMediaChangeDetector.h"
+#include "NdiMediaColorConverter.h"
+#include "NdiMediaDeinterlacer.h"
+#include "NdiMediaDownscaler.h"
+#include "NdiMediaFrameHash.h"
 #include "NdiMediaSettings.h"
 #include "NdiMediaSource.h"
+#include "NdiMediaSourceResolver.h"
 #include "NdiMediaTextureSample.h"
+#include "NdiMediaVideoConversion.h"
 
 #include "NdiMediaAllowPlatformTypes.h"
 
@@ -25,27 +39,77 @@
 #define LOCTEXT_NAMESPACE "FNdiMediaPlayer"
 
 
+/* Local helpers
+ *****************************************************************************/
+
+/** Time after which a connection by resolved endpoint is considered failed (in milliseconds). */
+static const double EndpointConnectTimeout = 2000.0;
+
+
 /* FNdiVideoPlayer structors
  *****************************************************************************/
 
 FNdiMediaPlayer::FNdiMediaPlayer(IMediaEventSink& InEventSink)
-	: AudioSamplePool(new FNdiMediaAudioSamplePool)
+	: AudioChannelsPerTrack(0)
+	, AudioChunker(new FNdiMediaAudioChunker)
+	, AudioOverrun(false)
+	, AudioOverrunPolicy(ENdiMediaAudioOverrunPolicy::Drop)
+	, AudioQueue(MakeShared<FNdiMediaAudioQueue, ESPMode::ThreadSafe>())
+	, AudioSamplePool(new FNdiMediaAudioSamplePool)
+	, AudioSamplesChannels(0)
+	, AudioSamplesSampleRate(0)
+	, ChangeDetector(new FNdiMediaChangeDetector)
+	, ColorConverter(new FNdiMediaColorConverter)
+	, CompressedAudioTime(FTimespan::Zero())
+	, ConnectMilliseconds(-1.0)
+	, ConnectStartCycles(0)
+	, CopyVideoFrames(false)
+	, CropRect(FIntRect())
 	, CurrentState(EMediaState::Closed)
 	, CurrentTime(FTimespan::Zero())
+	, DeinterlaceCycles(0)
+	, Deinterlacer(new FNdiMediaDeinterlacer)
+	, DetectDirtyRows(false)
+	, DirtyRowCycles(0)
+	, DownscaleCycles(0)
+	, Downscaler(new FNdiMediaDownscaler)
+	, DuplicateFrameDetection(ENdiMediaDuplicateFrameDetection::None)
+	, DuplicateFrameHashCycles(0)
+	, DroppedAudioTime(FTimespan::Zero())
+	, EndpointFallback(false)
 	, EventSink(InEventSink)
 	, LastAudioChannels(0)
 	, LastAudioSampleRate(0)
+	, LastNumAudioTracks(1)
 	, LastVideoBitRate(0)
 	, LastVideoDim(FIntPoint::ZeroValue)
+	, LastVideoFourCC(0)
 	, LastVideoFrameRate(0.0f)
+	, LastVideoFrameHash(0)
+	, MaxAudioQueueDuration(FTimespan::Zero())
+	, MaxVideoThreads(0)
+	, NumAudioOverruns(0)
+	, NumChangeDetectedFrames(0)
+	, NumCheckedVideoRows(0)
+	, NumCopiedVideoFrames(0)
+	, NumDeinterlacedFrames(0)
+	, NumDownscaledFrames(0)
+	, NumDirtyVideoRows(0)
+	, NumHashedVideoFrames(0)
+	, NumSkippedDuplicateFrames(0)
+	, NumDroppedCopiedVideoFrames(0)
+	, NumDroppedVideoConversions(0)
 	, Paused(false)
+	, ReceiverBandwidth(0)
+	, ReceiverColorFormat(0)
 	, ReceiverInstance(nullptr)
 	, Samples(new FMediaSamples)
 	, SelectedAudioTrack(INDEX_NONE)
 	, SelectedMetadataTrack(INDEX_NONE)
 	, SelectedVideoTrack(INDEX_NONE)
 	, UseFrameTimecode(false)
-	, VideoSampleFormat(EMediaTextureSampleFormat::CharUYVY)
+	, VideoCopyCycles(0)
+	, VideoSamplePool(new FNdiMediaTextureSamplePool)
 { }
 
 
@@ -53,11 +117,29 @@ FNdiMediaPlayer::~FNdiMediaPlayer()
 {
 	Close();
 
+	delete AudioChunker;
+	AudioChunker = nullptr;
+
 	delete AudioSamplePool;
 	AudioSamplePool = nullptr;
 
+	delete ChangeDetector;
+	ChangeDetector = nullptr;
+
+	delete ColorConverter;
+	ColorConverter = nullptr;
+
+	delete Deinterlacer;
+	Deinterlacer = nullptr;
+
+	delete Downscaler;
+	Downscaler = nullptr;
+
 	delete Samples;
 	Samples = nullptr;
+
+	delete VideoSamplePool;
+	VideoSamplePool = nullptr;
 }
 
 
@@ -66,6 +148,14 @@ FNdiMediaPlayer::~FNdiMediaPlayer()
 
 void FNdiMediaPlayer::Close()
 {
+	if (VideoConversionTask.IsValid())
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(VideoConversionTask);
+		VideoConversionTask.SafeRelease();
+	}
+
+	ConvertedVideoSamples.Empty();
+
 	{
 		FScopeLock Lock(&CriticalSection);
 
@@ -75,19 +165,67 @@ void FNdiMediaPlayer::Close()
 			ReceiverInstance = nullptr;
 		}
 
+		if (DirectAudioRing.IsValid())
+		{
+			DirectAudioRing->DetachProducer();
+			DirectAudioRing.Reset();
+		}
+
+		AudioBufferArena.Reset();
+		AudioChunker->Reset();
+
+		AudioOverrun = false;
+		AudioSamplesChannels = 0;
+		AudioSamplesSampleRate = 0;
+		CompressedAudioTime = FTimespan::Zero();
+		DroppedAudioTime = FTimespan::Zero();
 		LastAudioChannels = 0;
 		LastAudioSampleRate = 0;
+		NumAudioOverruns = 0;
 	}
 
 	AudioSamplePool->Reset();
-
+	ChangeDetector->Reset();
+	ConvertedVideoBuffer.Empty();
+	Deinterlacer->Reset();
+	LastSampleDirtyRows.Empty();
+	VideoDirtyRows.Empty();
+	VideoSamplePool->Reset();
+	VideoScratchBuffer.Empty();
+
+	ConnectionMetadata.Empty();
+	EndpointHint.Empty();
+	SourceName.Empty();
+
+	ConnectMilliseconds = -1.0;
 	CurrentState = EMediaState::Closed;
 	CurrentTime = FTimespan::Zero();
 	CurrentUrl.Empty();
+	DeinterlaceCycles = 0;
+	EndpointFallback = false;
+	DirtyRowCycles = 0;
+	DownscaleCycles = 0;
+	DuplicateFrameHashCycles = 0;
 
+	LastNumAudioTracks = 1;
 	LastVideoBitRate = 0;
 	LastVideoDim = FIntPoint::ZeroValue;
+	LastVideoFourCC = 0;
 	LastVideoFrameRate = 0.0f;
+	LastVideoFrameHash = 0;
+	NumChangeDetectedFrames = 0;
+	NumCheckedVideoRows = 0;
+	NumConvertedVideoFrames.Reset();
+	NumCopiedVideoFrames = 0;
+	NumDeinterlacedFrames = 0;
+	NumDirtyVideoRows = 0;
+	NumDownscaledFrames = 0;
+	NumDroppedCopiedVideoFrames = 0;
+	NumDroppedVideoConversions = 0;
+	NumHashedVideoFrames = 0;
+	NumSkippedDuplicateFrames = 0;
+	VideoConversionCycles.Reset();
+	VideoCopyCycles = 0;
 
 	SelectedMetadataTrack = INDEX_NONE;
 	SelectedVideoTrack = INDEX_NONE;
@@ -119,6 +257,7 @@ FString FNdiMediaPlayer::GetInfo() const
 		Info += FString::Printf(TEXT("Stream\n"));
 		Info += FString::Printf(TEXT("    Type: Audio\n"));
 		Info += FString::Printf(TEXT("    Channels: %i\n"), LastAudioChannels);
+		Info += FString::Printf(TEXT("    Tracks: %i\n"), GetNumAudioTracks());
 		Info += FString::Printf(TEXT("    Sample Rate: %i Hz\n"), LastAudioSampleRate);
 		Info += FString::Printf(TEXT("    Bits Per Sample: 16\n"));
 	}
@@ -181,6 +320,130 @@ FString FNdiMediaPlayer::GetStats() const
 		StatsString += FString::Printf(TEXT("    Video: %i\n"), Queue.video_frames);
 		StatsString += FString::Printf(TEXT("    Metadata: %i\n"), Queue.metadata_frames);
 		StatsString += TEXT("\n");
+
+		if (!SourceName.IsEmpty())
+		{
+			StatsString += TEXT("Connection\n");
+			StatsString += FString::Printf(TEXT("    Endpoint Hint: %s%s\n"), EndpointHint.IsEmpty() ? TEXT("none") : *EndpointHint, EndpointFallback ? TEXT(" (failed)") : TEXT(""));
+
+			if (ConnectMilliseconds >= 0.0)
+			{
+				StatsString += FString::Printf(TEXT("    Time to Connect: %.1f ms\n"), ConnectMilliseconds);
+
+				const double AverageNameConnectMilliseconds = FNdiMediaSourceResolver::GetAverageConnectTime(false);
+
+				if (!EndpointHint.IsEmpty() && !EndpointFallback && (AverageNameConnectMilliseconds >= 0.0))
+				{
+					StatsString += FString::Printf(TEXT("    Time Saved: %.1f ms\n"), AverageNameConnectMilliseconds - ConnectMilliseconds);
+				}
+			}
+			else
+			{
+				StatsString += TEXT("    Time to Connect: connecting...\n");
+			}
+
+			StatsString += TEXT("\n");
+		}
+
+		StatsString += TEXT("Audio Queue\n");
+		StatsString += FString::Printf(TEXT("    Queued: %.1f ms\n"), AudioQueue->GetQueuedDuration().GetTotalMilliseconds());
+		StatsString += FString::Printf(TEXT("    Overruns: %i\n"), NumAudioOverruns);
+		StatsString += FString::Printf(TEXT("    Dropped: %.1f ms\n"), DroppedAudioTime.GetTotalMilliseconds());
+		StatsString += FString::Printf(TEXT("    Compressed: %.1f ms\n"), CompressedAudioTime.GetTotalMilliseconds());
+		StatsString += TEXT("\n");
+
+		if (AudioBufferArena.IsValid())
+		{
+			StatsString += TEXT("Audio Buffers\n");
+			StatsString += FString::Printf(TEXT("    Arena Blocks: %i / %i in use\n"), AudioBufferArena->GetNumBlocks() - AudioBufferArena->GetNumFreeBlocks(), AudioBufferArena->GetNumBlocks());
+			StatsString += FString::Printf(TEXT("    Heap Allocations: %i\n"), AudioBufferArena->GetNumHeapAllocations());
+			StatsString += TEXT("\n");
+		}
+
+		if (CopyVideoFrames)
+		{
+			const double CopyMilliseconds = FPlatformTime::ToMilliseconds64(VideoCopyCycles);
+
+			StatsString += TEXT("Video Copy\n");
+			StatsString += FString::Printf(TEXT("    Frames: %i\n"), NumCopiedVideoFrames);
+			StatsString += FString::Printf(TEXT("    Dropped: %i\n"), NumDroppedCopiedVideoFrames);
+			StatsString += FString::Printf(TEXT("    Average Time: %.3f ms\n"), (NumCopiedVideoFrames > 0) ? CopyMilliseconds / NumCopiedVideoFrames : 0.0);
+			StatsString += TEXT("\n");
+		}
+
+		if (NumDeinterlacedFrames > 0)
+		{
+			const double DeinterlaceMilliseconds = FPlatformTime::ToMilliseconds64(DeinterlaceCycles);
+
+			StatsString += TEXT("Deinterlacing\n");
+			StatsString += FString::Printf(TEXT("    Frames: %i\n"), NumDeinterlacedFrames);
+			StatsString += FString::Printf(TEXT("    Average Time: %.3f ms\n"), DeinterlaceMilliseconds / NumDeinterlacedFrames);
+			StatsString += TEXT("\n");
+		}
+
+		if (NumDownscaledFrames > 0)
+		{
+			const double DownscaleMilliseconds = FPlatformTime::ToMilliseconds64(DownscaleCycles);
+
+			StatsString += TEXT("Downscaling\n");
+			StatsString += FString::Printf(TEXT("    Frames: %i\n"), NumDownscaledFrames);
+			StatsString += FString::Printf(TEXT("    Average Time: %.3f ms\n"), DownscaleMilliseconds / NumDownscaledFrames);
+			StatsString += TEXT("\n");
+		}
+
+		if ((NumHashedVideoFrames > 0) || (NumSkippedDuplicateFrames > 0))
+		{
+			const double HashMilliseconds = FPlatformTime::ToMilliseconds64(DuplicateFrameHashCycles);
+
+			StatsString += TEXT("Duplicate Frames\n");
+			StatsString += FString::Printf(TEXT("    Checked: %i\n"), NumHashedVideoFrames);
+			StatsString += FString::Printf(TEXT("    Skipped Uploads: %i\n"), NumSkippedDuplicateFrames);
+			StatsString += FString::Printf(TEXT("    Average Time: %.3f ms\n"), (NumHashedVideoFrames > 0) ? HashMilliseconds / NumHashedVideoFrames : 0.0);
+			StatsString += TEXT("\n");
+		}
+
+		if (NumChangeDetectedFrames > 0)
+		{
+			const double DirtyRowMilliseconds = FPlatformTime::ToMilliseconds64(DirtyRowCycles);
+
+			StatsString += TEXT("Dirty Rows\n");
+			StatsString += FString::Printf(TEXT("    Frames: %i\n"), NumChangeDetectedFrames);
+			StatsString += FString::Printf(TEXT("    Changed Rows: %.1f%%\n"), (NumCheckedVideoRows > 0) ? 100.0 * NumDirtyVideoRows / NumCheckedVideoRows : 0.0);
+
+			FString LastSampleRows;
+
+			for (const FInt32Range& Rows : LastSampleDirtyRows)
+			{
+				LastSampleRows += FString::Printf(TEXT("%s%i-%i"), LastSampleRows.IsEmpty() ? TEXT("") : TEXT(", "), Rows.GetLowerBoundValue(), Rows.GetUpperBoundValue());
+			}
+
+			StatsString += FString::Printf(TEXT("    Last Sample: %s\n"), LastSampleRows.IsEmpty() ? TEXT("unchanged") : *LastSampleRows);
+			StatsString += FString::Printf(TEXT("    Average Time: %.3f ms\n"), DirtyRowMilliseconds / NumChangeDetectedFrames);
+			StatsString += TEXT("\n");
+		}
+
+		const int32 ConvertedVideoFrames = NumConvertedVideoFrames.GetValue();
+
+		if ((ConvertedVideoFrames > 0) || (NumDroppedVideoConversions > 0))
+		{
+			const double ConversionMilliseconds = FPlatformTime::ToMilliseconds64(VideoConversionCycles.GetValue());
+
+			StatsString += TEXT("Video Conversion\n");
+			StatsString += FString::Printf(TEXT("    Frames: %i\n"), ConvertedVideoFrames);
+			StatsString += FString::Printf(TEXT("    Dropped: %i\n"), NumDroppedVideoConversions);
+			StatsString += FString::Printf(TEXT("    Average Time: %.3f ms\n"), (ConvertedVideoFrames > 0) ? ConversionMilliseconds / ConvertedVideoFrames : 0.0);
+			StatsString += TEXT("\n");
+		}
+
+		if (DirectAudioRing.IsValid())
+		{
+			StatsString += TEXT("Direct Audio\n");
+			StatsString += FString::Printf(TEXT("    Capture to Render: %.1f ms\n"), DirectAudioRing->GetAverageLatency());
+			StatsString += FString::Printf(TEXT("    Max Capture to Render: %.1f ms\n"), DirectAudioRing->GetMaxLatency());
+			StatsString += FString::Printf(TEXT("    Skipped Frames: %i\n"), DirectAudioRing->GetNumSkippedFrames());
+			StatsString += FString::Printf(TEXT("    Underruns: %i\n"), DirectAudioRing->GetNumUnderruns());
+			StatsString += TEXT("\n");
+		}
 	}
 
 	return StatsString;
@@ -223,34 +486,55 @@ bool FNdiMediaPlayer::Open(const FString& Url, const IMediaOptions* Options)
 
 	if (Options != nullptr)
 	{
+		AudioChannelsPerTrack = FMath::Max(0, (int32)Options->GetMediaOption(NdiMedia::AudioChannelsPerTrackOption, 0LL));
+		AudioChunker->SetChunkFrames((int32)Options->GetMediaOption(NdiMedia::AudioFramesPerSampleOption, 0LL));
+		AudioOverrunPolicy = (ENdiMediaAudioOverrunPolicy)Options->GetMediaOption(NdiMedia::AudioOverrunPolicyOption, (int64)ENdiMediaAudioOverrunPolicy::Drop);
 		Bandwidth = Options->GetMediaOption(NdiMedia::BandwidthOption, (int64)NDIlib_recv_bandwidth_highest);
 		ColorFormat = (NDIlib_recv_color_format_e)Options->GetMediaOption(NdiMedia::ColorFormatOption, 0LL);
+		ColorConverter->SetMode((ENdiMediaColorSpace)Options->GetMediaOption(NdiMedia::ColorSpaceOption, (int64)ENdiMediaColorSpace::Engine), (ENdiMediaColorRange)Options->GetMediaOption(NdiMedia::ColorRangeOption, (int64)ENdiMediaColorRange::Limited));
+		CopyVideoFrames = Options->GetMediaOption(NdiMedia::CopyVideoFramesOption, false);
+		CropRect.Min.X = FMath::Max(0, (int32)Options->GetMediaOption(NdiMedia::CropXOption, 0LL));
+		CropRect.Min.Y = FMath::Max(0, (int32)Options->GetMediaOption(NdiMedia::CropYOption, 0LL));
+		CropRect.Max.X = CropRect.Min.X + FMath::Max(0, (int32)Options->GetMediaOption(NdiMedia::CropWidthOption, 0LL));
+		CropRect.Max.Y = CropRect.Min.Y + FMath::Max(0, (int32)Options->GetMediaOption(NdiMedia::CropHeightOption, 0LL));
+		Deinterlacer->SetMode((ENdiMediaDeinterlaceMode)Options->GetMediaOption(NdiMedia::DeinterlaceModeOption, (int64)ENdiMediaDeinterlaceMode::None), Options->GetMediaOption(NdiMedia::DeinterlaceFieldRateOption, false));
+		DetectDirtyRows = Options->GetMediaOption(NdiMedia::DetectDirtyRowsOption, false);
+		Downscaler->SetMode((ENdiMediaDownscale)Options->GetMediaOption(NdiMedia::DownscaleOption, (int64)ENdiMediaDownscale::None), (ENdiMediaDownscaleFilter)Options->GetMediaOption(NdiMedia::DownscaleFilterOption, (int64)ENdiMediaDownscaleFilter::Box));
+		DuplicateFrameDetection = (ENdiMediaDuplicateFrameDetection)Options->GetMediaOption(NdiMedia::DuplicateFrameDetectionOption, (int64)ENdiMediaDuplicateFrameDetection::None);
+		MaxAudioQueueDuration = FTimespan::FromMilliseconds(FMath::Max(0LL, Options->GetMediaOption(NdiMedia::MaxAudioQueueDurationOption, 0LL)));
+		MaxVideoThreads = FMath::Max(0, (int32)Options->GetMediaOption(NdiMedia::MaxVideoThreadsOption, 0LL));
 		ReceiveAudioReferenceLevel = (int32)Options->GetMediaOption(NdiMedia::AudioReferenceLevelOption, 5LL);
 		ReceiverName = Options->GetMediaOption(NdiMedia::ReceiverName, FString());
 		UseFrameTimecode = Options->GetMediaOption(NdiMedia::UseTimecodeOption, false);
 	}
 	else
 	{
+		AudioChannelsPerTrack = 0;
+		AudioChunker->SetChunkFrames(0);
+		AudioOverrunPolicy = ENdiMediaAudioOverrunPolicy::Drop;
 		Bandwidth = (int64)NDIlib_recv_bandwidth_highest;
 		ColorFormat = NDIlib_recv_color_format_e_UYVY_BGRA;
+		ColorConverter->SetMode(ENdiMediaColorSpace::Engine, ENdiMediaColorRange::Limited);
+		CopyVideoFrames = false;
+		CropRect = FIntRect();
+		Deinterlacer->SetMode(ENdiMediaDeinterlaceMode::None, false);
+		DetectDirtyRows = false;
+		Downscaler->SetMode(ENdiMediaDownscale::None, ENdiMediaDownscaleFilter::Box);
+		DuplicateFrameDetection = ENdiMediaDuplicateFrameDetection::None;
+		MaxAudioQueueDuration = FTimespan::Zero();
+		MaxVideoThreads = 0;
 		ReceiveAudioReferenceLevel = 5;
 		UseFrameTimecode = false;
 	}
 
-	if (ColorFormat == NDIlib_recv_color_format_e_BGRX_BGRA)
-	{
-		VideoSampleFormat = EMediaTextureSampleFormat::CharBGRA;
-	}
-	else if (ColorFormat == NDIlib_recv_color_format_e_UYVY_BGRA)
-	{
-		VideoSampleFormat = EMediaTextureSampleFormat::CharUYVY;
-	}
-	else
+	if ((ColorFormat != NDIlib_recv_color_format_e_BGRX_BGRA) &&
+		(ColorFormat != NDIlib_recv_color_format_e_UYVY_BGRA) &&
+		(ColorFormat != NDIlib_recv_color_format_e_fastest) &&
+		(ColorFormat != NdiMedia::ColorFormatBest))
 	{
 		UE_LOG(LogNdiMedia, Warning, TEXT("Unsupported ColorFormat option in media source %s. Falling back to UYVY."), *SourceStr);
 
 		ColorFormat = NDIlib_recv_color_format_e_UYVY_BGRA;
-		VideoSampleFormat = EMediaTextureSampleFormat::CharUYVY;
 	}
 
 	if (ReceiverName.IsEmpty())
@@ -261,41 +545,29 @@ bool FNdiMediaPlayer::Open(const FString& Url, const IMediaOptions* Options)
 	const FString UniqueReceiverName = FString::Printf(TEXT("%s %s %s"), *FApp::GetName(), *FApp::GetInstanceName(), *ReceiverName);
 
 	// create receiver
-	NDIlib_source_t Source;
+	FString SourceEndpoint;
+
+	if (SourceStr.Find(TEXT(":")) != INDEX_NONE)
+	{
+		SourceEndpoint = SourceStr;
+	}
+	else
 	{
-		if (SourceStr.Find(TEXT(":")) != INDEX_NONE)
+		if (SourceStr.StartsWith(TEXT("localhost ")))
 		{
-			Source.p_ip_address = TCHAR_TO_ANSI(*SourceStr);
-			Source.p_ndi_name = nullptr;
+			SourceStr.ReplaceInline(TEXT("localhost"), FPlatformProcess::ComputerName());
 		}
-		else
-		{
-			if (SourceStr.StartsWith(TEXT("localhost ")))
-			{
-				SourceStr.ReplaceInline(TEXT("localhost"), FPlatformProcess::ComputerName());
-			}
 
-			Source.p_ip_address = nullptr;
-			Source.p_ndi_name = TCHAR_TO_ANSI(*SourceStr);
-		}
+		// connecting by endpoint skips waiting for the source to be discovered
+		SourceName = SourceStr;
+		EndpointHint = FNdiMediaSourceResolver::Resolve(SourceName);
+		SourceEndpoint = EndpointHint;
 	}
 
-	NDIlib_recv_create_t RcvCreateDesc;
-	{
-		RcvCreateDesc.source_to_connect_to = Source;
-		RcvCreateDesc.color_format = ColorFormat;
-		RcvCreateDesc.bandwidth = (NDIlib_recv_bandwidth_e)Bandwidth;
-		RcvCreateDesc.allow_video_fields = true;
-//		RcvCreateDesc.p_ndi_name = TCHAR_TO_ANSI(*UniqueReceiverName);
-	};
-	
-	{
-		FScopeLock Lock(&CriticalSection);
-
-		ReceiverInstance = FNdi::Lib->NDIlib_recv_create_v2(&RcvCreateDesc);
-	}
+	ReceiverBandwidth = Bandwidth;
+	ReceiverColorFormat = ColorFormat;
 
-	if (ReceiverInstance == nullptr)
+	if (!CreateReceiver(SourceName, SourceEndpoint))
 	{
 		UE_LOG(LogNdiMedia, Error, TEXT("Failed to open NDI media source %s: couldn't create receiver"), *SourceStr);
 
@@ -392,6 +664,31 @@ bool FNdiMediaPlayer::Open(const FString& Url, const IMediaOptions* Options)
 		SendMetadata(CustomMetadata);
 	}
 
+	// set up direct audio path, or pre-warm audio samples
+	TSharedPtr<FNdiMediaAudioRing, ESPMode::ThreadSafe> AudioRing;
+
+	if ((Options != nullptr) && Options->GetMediaOption(NdiMedia::DirectAudioOption, false))
+	{
+		AudioRing = FNdiMediaAudioRing::FindOrCreate(Url);
+
+		if (!AudioRing->AttachProducer())
+		{
+			UE_LOG(LogNdiMedia, Warning, TEXT("Direct audio of NDI media source %s is already received by another player. Falling back to the media sample queues."), *SourceStr);
+
+			AudioRing.Reset();
+		}
+	}
+
+	if (AudioRing.IsValid())
+	{
+		FScopeLock Lock(&CriticalSection);
+		DirectAudioRing = AudioRing;
+	}
+	else
+	{
+		PrewarmAudio(Options);
+	}
+
 	// finalize
 	CurrentUrl = Url;
 
@@ -423,6 +720,7 @@ void FNdiMediaPlayer::TickFetch(FTimespan DeltaTime, FTimespan /*Timecode*/)
 {
 	if (ReceiverInstance != nullptr)
 	{
+		FetchConvertedVideo();
 		ProcessMetadataAndVideo();
 	}
 }
@@ -437,6 +735,46 @@ void FNdiMediaPlayer::TickInput(FTimespan DeltaTime, FTimespan Timecode)
 
 	// update player state
 	const bool IsConnected = (FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) > 0);
+
+	if (ConnectMilliseconds < 0.0)
+	{
+		const double Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ConnectStartCycles);
+
+		if (IsConnected)
+		{
+			ConnectMilliseconds = Milliseconds;
+			ConnectionMetadata.Empty();
+
+			if (!SourceName.IsEmpty())
+			{
+				FNdiMediaSourceResolver::ReportConnectTime(!EndpointHint.IsEmpty() && !EndpointFallback, Milliseconds);
+			}
+		}
+		else if (!EndpointHint.IsEmpty() && !EndpointFallback && (Milliseconds > EndpointConnectTimeout))
+		{
+			UE_LOG(LogNdiMedia, Verbose, TEXT("Failed to connect to NDI source %s at %s, falling back to connecting by name"), *SourceName, *EndpointHint);
+
+			// the source may have moved to a different endpoint
+			FNdiMediaSourceResolver::RemoveEndpoint(SourceName);
+			EndpointFallback = true;
+
+			if (!CreateReceiver(SourceName, FString()))
+			{
+				UE_LOG(LogNdiMedia, Error, TEXT("Failed to reconnect to NDI media source %s: couldn't create receiver"), *SourceName);
+				return;
+			}
+
+			// connection metadata belongs to the receiver
+			TArray<FString> Metadata = MoveTemp(ConnectionMetadata);
+			ConnectionMetadata.Reset();
+
+			for (const FString& MetadataString : Metadata)
+			{
+				SendMetadata(MetadataString);
+			}
+		}
+	}
+
 	const EMediaState State = Paused ? EMediaState::Paused : (IsConnected ? EMediaState::Playing : EMediaState::Preparing);
 
 	if (State != CurrentState)
@@ -445,6 +783,15 @@ void FNdiMediaPlayer::TickInput(FTimespan DeltaTime, FTimespan Timecode)
 		EventSink.ReceiveMediaEvent(State == EMediaState::Playing ? EMediaEvent::PlaybackResumed : EMediaEvent::PlaybackSuspended);
 	}
 
+	// the number of audio tracks depends on the channels in the stream
+	const int32 NumAudioTracks = GetNumAudioTracks();
+
+	if (NumAudioTracks != LastNumAudioTracks)
+	{
+		LastNumAudioTracks = NumAudioTracks;
+		EventSink.ReceiveMediaEvent(EMediaEvent::TracksChanged);
+	}
+
 	if (!UseFrameTimecode)
 	{
 		CurrentTime = Timecode;
@@ -554,13 +901,16 @@ bool FNdiMediaPlayer::SetRate(float Rate)
 
 bool FNdiMediaPlayer::GetAudioTrackFormat(int32 TrackIndex, int32 FormatIndex, FMediaAudioTrackFormat& OutFormat) const
 {
-	if ((ReceiverInstance == nullptr) || (TrackIndex != 0) || (FormatIndex != 0))
+	int32 FirstChannel = 0;
+	int32 NumChannels = 0;
+
+	if ((ReceiverInstance == nullptr) || (FormatIndex != 0) || !GetAudioTrackChannels(TrackIndex, FirstChannel, NumChannels))
 	{
 		return false;
 	}
 
 	OutFormat.BitsPerSample = 16;
-	OutFormat.NumChannels = LastAudioChannels;
+	OutFormat.NumChannels = NumChannels;
 	OutFormat.SampleRate = LastAudioSampleRate;
 	OutFormat.TypeName = TEXT("PCM");
 
@@ -572,8 +922,12 @@ int32 FNdiMediaPlayer::GetNumTracks(EMediaTrackType TrackType) const
 {
 	if (ReceiverInstance != nullptr)
 	{
-		if ((TrackType == EMediaTrackType::Audio) ||
-			(TrackType == EMediaTrackType::Metadata) ||
+		if (TrackType == EMediaTrackType::Audio)
+		{
+			return GetNumAudioTracks();
+		}
+
+		if ((TrackType == EMediaTrackType::Metadata) ||
 			(TrackType == EMediaTrackType::Video))
 		{
 			return 1;
@@ -586,7 +940,7 @@ int32 FNdiMediaPlayer::GetNumTracks(EMediaTrackType TrackType) const
 
 int32 FNdiMediaPlayer::GetNumTrackFormats(EMediaTrackType TrackType, int32 TrackIndex) const
 {
-	return ((TrackIndex == 0) && (GetNumTracks(TrackType) > 0)) ? 1 : 0;
+	return ((TrackIndex >= 0) && (TrackIndex < GetNumTracks(TrackType))) ? 1 : 0;
 }
 
 
@@ -611,7 +965,7 @@ int32 FNdiMediaPlayer::GetSelectedTrack(EMediaTrackType TrackType) const
 
 FText FNdiMediaPlayer::GetTrackDisplayName(EMediaTrackType TrackType, int32 TrackIndex) const
 {
-	if ((ReceiverInstance == nullptr) || (TrackIndex != 0))
+	if ((ReceiverInstance == nullptr) || (TrackIndex < 0) || (TrackIndex >= GetNumTracks(TrackType)))
 	{
 		return FText::GetEmpty();
 	}
@@ -619,7 +973,20 @@ FText FNdiMediaPlayer::GetTrackDisplayName(EMediaTrackType TrackType, int32 Trac
 	switch (TrackType)
 	{
 	case EMediaTrackType::Audio:
-		return LOCTEXT("DefaultAudioTrackName", "Audio Track");
+		{
+			int32 FirstChannel = 0;
+			int32 NumChannels = 0;
+
+			if ((AudioChannelsPerTrack <= 0) || !GetAudioTrackChannels(TrackIndex, FirstChannel, NumChannels))
+			{
+				return LOCTEXT("DefaultAudioTrackName", "Audio Track");
+			}
+
+			return FText::Format(LOCTEXT("ChannelAudioTrackNameFormat", "Audio Track {0} (Channels {1}-{2})"),
+				FText::AsNumber(TrackIndex + 1),
+				FText::AsNumber(FirstChannel + 1),
+				FText::AsNumber(FirstChannel + NumChannels));
+		}
 
 	case EMediaTrackType::Metadata:
 		return LOCTEXT("DefaultMetadataTrackName", "Metadata Track");
@@ -641,7 +1008,7 @@ int32 FNdiMediaPlayer::GetTrackFormat(EMediaTrackType TrackType, int32 TrackInde
 
 FString FNdiMediaPlayer::GetTrackLanguage(EMediaTrackType TrackType, int32 TrackIndex) const
 {
-	return ((ReceiverInstance != nullptr) && (TrackIndex == 0)) ? TEXT("und") : FString();
+	return ((ReceiverInstance != nullptr) && (TrackIndex >= 0) && (TrackIndex < GetNumTracks(TrackType))) ? TEXT("und") : FString();
 }
 
 
@@ -661,7 +1028,7 @@ bool FNdiMediaPlayer::GetVideoTrackFormat(int32 TrackIndex, int32 FormatIndex, F
 	OutFormat.Dim = LastVideoDim;
 	OutFormat.FrameRate = LastVideoFrameRate;
 	OutFormat.FrameRates = TRange<float>(LastVideoFrameRate);
-	OutFormat.TypeName = (VideoSampleFormat == EMediaTextureSampleFormat::CharBGRA) ? TEXT("UYVY") : TEXT("RGBA");
+	OutFormat.TypeName = FString::Printf(TEXT("%c%c%c%c"), LastVideoFourCC & 0xff, (LastVideoFourCC >> 8) & 0xff, (LastVideoFourCC >> 16) & 0xff, (LastVideoFourCC >> 24) & 0xff);
 
 	return true;
 }
@@ -669,7 +1036,7 @@ bool FNdiMediaPlayer::GetVideoTrackFormat(int32 TrackIndex, int32 FormatIndex, F
 
 bool FNdiMediaPlayer::SelectTrack(EMediaTrackType TrackType, int32 TrackIndex)
 {
-	if ((ReceiverInstance == nullptr) || (TrackIndex < INDEX_NONE) || (TrackIndex > 0))
+	if ((ReceiverInstance == nullptr) || (TrackIndex < INDEX_NONE) || (TrackIndex >= GetNumTracks(TrackType)))
 	{
 		return false;
 	}
@@ -711,7 +1078,7 @@ bool FNdiMediaPlayer::SelectTrack(EMediaTrackType TrackType, int32 TrackIndex)
 
 bool FNdiMediaPlayer::SetTrackFormat(EMediaTrackType TrackType, int32 TrackIndex, int32 FormatIndex)
 {
-	if ((ReceiverInstance == nullptr) || (TrackIndex != 0) || (FormatIndex != 0))
+	if ((ReceiverInstance == nullptr) || (TrackIndex < 0) || (TrackIndex >= GetNumTracks(TrackType)) || (FormatIndex != 0))
 	{
 		return false;
 	}
@@ -725,93 +1092,618 @@ bool FNdiMediaPlayer::SetTrackFormat(EMediaTrackType TrackType, int32 TrackIndex
 /* FNdiMediaPlayer implementation
  *****************************************************************************/
 
-void FNdiMediaPlayer::ProcessAudio()
+void FNdiMediaPlayer::CommitDirtyRows()
 {
-	check(ReceiverInstance != nullptr);
-
-	while (true)
+	if (DetectDirtyRows)
 	{
-		NDIlib_audio_frame_v2_t AudioFrame;
-		NDIlib_frame_type_e FrameType = FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, nullptr, &AudioFrame, nullptr, 0);
+		ChangeDetector->Commit();
+		LastSampleDirtyRows = VideoDirtyRows;
+	}
+}
 
-		if (FrameType == NDIlib_frame_type_error)
-		{
-			UE_LOG(LogNdiMedia, Verbose, TEXT("Failed to receive audio frame"));
-			return;
-		}
 
-		if (FrameType == NDIlib_frame_type_none)
-		{
-			break; // no more frames available
-		}
+bool FNdiMediaPlayer::ConvertVideo(NDIlib_video_frame_v2_t& VideoFrame, FNdiMediaTextureSample& TextureSample, EMediaTextureSampleFormat SampleFormat, FTimespan Time, const TArray<FInt32Range>& DirtyRows, int32 MaxThreads)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint32 BytesPerPixel = (SampleFormat == EMediaTextureSampleFormat::FloatRGBA) ? 8 : 4;
+	const FIntPoint Dim(VideoFrame.xres, VideoFrame.yres);
+	const FTimespan Duration(VideoFrame.frame_rate_D * ETimespan::TicksPerSecond / VideoFrame.frame_rate_N);
 
-		if (FrameType == NDIlib_frame_type_audio)
+	uint8* Buffer = (uint8*)TextureSample.InitializeBuffer(Dim, Dim, Dim.X * BytesPerPixel, SampleFormat, Time, Duration);
+
+	if (Buffer != nullptr)
+	{
+		switch ((uint32)VideoFrame.FourCC)
 		{
-			LastAudioChannels = AudioFrame.no_channels;
-			LastAudioSampleRate = AudioFrame.sample_rate;
+		case NdiMedia::FourCC_P216:
+			FNdiMediaVideoConversion::P216ToBgr10A2(VideoFrame, Buffer, Dim.X * BytesPerPixel, MaxThreads);
+			break;
 
-			if (UseFrameTimecode)
-			{
-				CurrentTime = FTimespan(AudioFrame.timecode);
-			}
+		case NdiMedia::FourCC_PA16:
+			FNdiMediaVideoConversion::Pa16ToFloatRgba(VideoFrame, Buffer, Dim.X * BytesPerPixel, MaxThreads);
+			break;
 
-			// // create & add sample to queue, or release frame
-			if ((CurrentState == EMediaState::Playing) && (SelectedAudioTrack == 0))
+		case NDIlib_FourCC_type_UYVA:
+			if (SampleFormat == EMediaTextureSampleFormat::CharBGRA)
 			{
-				auto AudioSample = AudioSamplePool->AcquireShared();
-				
-				if (AudioSample->Initialize(ReceiverInstance, AudioFrame, ReceiveAudioReferenceLevel, CurrentTime))
-				{
-					Samples->AddAudio(AudioSample);
-				}
+				ColorConverter->Convert(VideoFrame, Buffer, Dim.X * BytesPerPixel, MaxThreads);
 			}
 			else
 			{
-				FNdi::Lib->NDIlib_recv_free_audio_v2(ReceiverInstance, &AudioFrame);
+				// interleave alpha plane into AYUV texels, which are converted to RGB on the GPU
+				FNdiMediaVideoConversion::UyvaToAyuv(VideoFrame, Buffer, Dim.X * BytesPerPixel, MaxThreads);
+			}
+			break;
+
+		case NDIlib_FourCC_type_UYVY:
+			ColorConverter->Convert(VideoFrame, Buffer, Dim.X * BytesPerPixel, MaxThreads);
+			break;
+
+		default:
+			Buffer = nullptr;
+		}
+
+		if (Buffer != nullptr)
+		{
+			if (DetectDirtyRows)
+			{
+				TextureSample.SetDirtyRows(DirtyRows);
 			}
+
+			TextureSample.Crop(CropRect);
 		}
 	}
+
+	FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+
+	VideoConversionCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+	NumConvertedVideoFrames.Increment();
+
+	return (Buffer != nullptr);
 }
 
 
-void FNdiMediaPlayer::ProcessMetadataAndVideo()
+bool FNdiMediaPlayer::CreateReceiver(const FString& Name, const FString& Endpoint)
 {
-	check(ReceiverInstance != nullptr);
+	// the converted strings must outlive the call to NDIlib_recv_create_v2
+	auto EndpointAnsi = StringCast<ANSICHAR>(*Endpoint);
+	auto NameAnsi = StringCast<ANSICHAR>(*Name);
 
-	while (true)
+	NDIlib_source_t Source;
 	{
-		NDIlib_metadata_frame_t MetadataFrame;
-		NDIlib_video_frame_v2_t VideoFrame;
+		Source.p_ip_address = Endpoint.IsEmpty() ? nullptr : EndpointAnsi.Get();
+		Source.p_ndi_name = Name.IsEmpty() ? nullptr : NameAnsi.Get();
+	}
 
-		const NDIlib_frame_type_e FrameType = FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, &VideoFrame, nullptr, &MetadataFrame, 0);
+	NDIlib_recv_create_t RcvCreateDesc;
+	{
+		RcvCreateDesc.source_to_connect_to = Source;
+		RcvCreateDesc.color_format = (NDIlib_recv_color_format_e)ReceiverColorFormat;
+		RcvCreateDesc.bandwidth = (NDIlib_recv_bandwidth_e)ReceiverBandwidth;
+		RcvCreateDesc.allow_video_fields = true;
+	};
 
-		if (FrameType == NDIlib_frame_type_error)
+	void* NewReceiverInstance = FNdi::Lib->NDIlib_recv_create_v2(&RcvCreateDesc);
+
+	if ((NewReceiverInstance == nullptr) && (ReceiverColorFormat == NdiMedia::ColorFormatBest))
+	{
+		// runtimes before NDI 4 don't know the best color format
+		UE_LOG(LogNdiMedia, Warning, TEXT("The installed NDI runtime does not support the Best color format. Falling back to Fastest."));
+
+		ReceiverColorFormat = NDIlib_recv_color_format_e_fastest;
+		RcvCreateDesc.color_format = NDIlib_recv_color_format_e_fastest;
+		NewReceiverInstance = FNdi::Lib->NDIlib_recv_create_v2(&RcvCreateDesc);
+	}
+
+	if (NewReceiverInstance == nullptr)
+	{
+		return false;
+	}
+
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (ReceiverInstance != nullptr)
 		{
-			UE_LOG(LogNdiMedia, Verbose, TEXT("Failed to receive NDI frame"));
-			return;
+			FNdi::Lib->NDIlib_recv_destroy(ReceiverInstance);
 		}
 
-		if (FrameType == NDIlib_frame_type_none)
+		ReceiverInstance = NewReceiverInstance;
+	}
+
+	ConnectMilliseconds = -1.0;
+	ConnectStartCycles = FPlatformTime::Cycles64();
+
+	return true;
+}
+
+
+void FNdiMediaPlayer::DeinterlaceVideo(NDIlib_video_frame_v2_t& VideoFrame, EMediaTextureSampleFormat SampleFormat, bool ReleaseFrame)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const int32 RowBytes = VideoFrame.line_stride_in_bytes;
+	const FTimespan Duration(VideoFrame.frame_rate_D * ETimespan::TicksPerSecond / VideoFrame.frame_rate_N);
+
+	// the frame may be released before it is deinterlaced
+	const int32 Width = VideoFrame.xres;
+	const int32 Height = VideoFrame.yres;
+
+	const uint8* Data;
+	bool Released;
+	int32 NumRows;
+	uint32 Stride;
+
+	if ((VideoFrame.frame_format_type == NDIlib_frame_format_type_field_0) || (VideoFrame.frame_format_type == NDIlib_frame_format_type_field_1))
+	{
+		// weave separate fields into interleaved frames first
+		const int32 Field = (VideoFrame.frame_format_type == NDIlib_frame_format_type_field_1) ? 1 : 0;
+		const bool Complete = Deinterlacer->AddField((const uint8*)VideoFrame.p_data, VideoFrame.line_stride_in_bytes, RowBytes, Height, Field);
+
+		if (ReleaseFrame)
 		{
-			break; // no more frames available
+			FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
 		}
 
-		if (FrameType == NDIlib_frame_type_metadata)
+		if (!Complete)
 		{
-			if (UseFrameTimecode)
-			{
-				CurrentTime = FTimespan(MetadataFrame.timecode);
-			}
+			return;
+		}
 
-			// // create & add sample to queue, or release frame
-			if ((CurrentState == EMediaState::Playing) && (SelectedMetadataTrack == 0))
-			{
-				auto BinarySample = MakeShared<FNdiMediaBinarySample, ESPMode::ThreadSafe>();
+		Data = Deinterlacer->GetWovenFrame();
+		Released = true;
+		NumRows = Height * 2;
+		Stride = RowBytes;
+	}
+	else
+	{
+		Data = (const uint8*)VideoFrame.p_data;
+		Released = !ReleaseFrame;
+		NumRows = Height;
+		Stride = VideoFrame.line_stride_in_bytes;
+	}
 
-				if (BinarySample->Initialize(ReceiverInstance, MetadataFrame, CurrentTime))
-				{
-					Samples->AddMetadata(BinarySample);
-				}
+	// create one progressive sample per frame or per field
+	const int32 NumOutputFrames = Deinterlacer->GetNumOutputFrames();
+	const FTimespan OutputDuration = FTimespan(Duration.GetTicks() / NumOutputFrames);
+
+	for (int32 Field = 0; Field < NumOutputFrames; ++Field)
+	{
+		const FTimespan Time = CurrentTime + FTimespan(OutputDuration.GetTicks() * Field);
+
+		if (Downscaler->IsEnabled())
+		{
+			// deinterlace into scratch buffer first
+			VideoScratchBuffer.SetNumUninitialized(RowBytes * NumRows);
+			Deinterlacer->Deinterlace(Data, Stride, RowBytes, NumRows, Field, VideoScratchBuffer.GetData(), RowBytes, MaxVideoThreads);
+			DownscaleVideo(VideoScratchBuffer.GetData(), RowBytes, FIntPoint(Width, NumRows), SampleFormat, Time, OutputDuration);
+
+			continue;
+		}
+
+		auto TextureSample = VideoSamplePool->AcquireShared();
+		uint8* Buffer = (uint8*)TextureSample->InitializeBuffer(FIntPoint(RowBytes / 4, NumRows), FIntPoint(Width, NumRows), RowBytes, SampleFormat, Time, OutputDuration);
+
+		if (Buffer != nullptr)
+		{
+			Deinterlacer->Deinterlace(Data, Stride, RowBytes, NumRows, Field, Buffer, RowBytes, MaxVideoThreads);
+			TextureSample->Crop(CropRect);
+			Samples->AddVideo(TextureSample);
+		}
+	}
+
+	Deinterlacer->FinishFrame(Data, Stride, RowBytes, NumRows);
+
+	if (!Released)
+	{
+		FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+	}
+
+	DeinterlaceCycles += FPlatformTime::Cycles64() - StartCycles;
+	++NumDeinterlacedFrames;
+}
+
+
+void FNdiMediaPlayer::DownscaleVideo(const uint8* Data, uint32 Stride, const FIntPoint& Dim, EMediaTextureSampleFormat SampleFormat, FTimespan Time, FTimespan Duration)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// restrict the source to the region of interest, so that only visible pixels are filtered
+	FIntPoint SourceDim = Dim;
+
+	if ((CropRect.Width() > 0) && (CropRect.Height() > 0))
+	{
+		const int32 PixelsPerTexel = (SampleFormat == EMediaTextureSampleFormat::CharUYVY) ? 2 : 1;
+		const int32 Left = FMath::Min(CropRect.Min.X, Dim.X) / PixelsPerTexel * PixelsPerTexel;
+		const int32 Right = FMath::Min(CropRect.Max.X, Dim.X);
+		const int32 Top = FMath::Min(CropRect.Min.Y, Dim.Y);
+		const int32 Bottom = FMath::Min(CropRect.Max.Y, Dim.Y);
+
+		if ((Right > Left) && (Bottom > Top))
+		{
+			Data += Top * Stride + Left * (4 / PixelsPerTexel);
+			SourceDim = FIntPoint(Right - Left, Bottom - Top);
+		}
+	}
+
+	const FIntPoint OutputDim = Downscaler->GetOutputDim(SourceDim, SampleFormat);
+
+	// UYVY texels hold two pixels
+	const FIntPoint BufferDim = (SampleFormat == EMediaTextureSampleFormat::CharUYVY) ? FIntPoint(OutputDim.X / 2, OutputDim.Y) : OutputDim;
+
+	auto TextureSample = VideoSamplePool->AcquireShared();
+	uint8* Buffer = (uint8*)TextureSample->InitializeBuffer(BufferDim, OutputDim, BufferDim.X * 4, SampleFormat, Time, Duration);
+
+	if (Buffer != nullptr)
+	{
+		Downscaler->Downscale(Data, Stride, SourceDim, SampleFormat, Buffer, BufferDim.X * 4, MaxVideoThreads);
+		Samples->AddVideo(TextureSample);
+	}
+
+	DownscaleCycles += FPlatformTime::Cycles64() - StartCycles;
+	++NumDownscaledFrames;
+}
+
+
+bool FNdiMediaPlayer::FetchConvertedVideo()
+{
+	// conversions that complete while fetching are picked up next time
+	const bool Completed = !VideoConversionTask.IsValid() || VideoConversionTask->IsComplete();
+	TSharedPtr<FNdiMediaTextureSample, ESPMode::ThreadSafe> TextureSample;
+
+	while (ConvertedVideoSamples.Dequeue(TextureSample))
+	{
+		Samples->AddVideo(TextureSample.ToSharedRef());
+	}
+
+	if (Completed)
+	{
+		VideoConversionTask.SafeRelease();
+	}
+
+	return Completed;
+}
+
+
+bool FNdiMediaPlayer::GetAudioTrackChannels(int32 TrackIndex, int32& OutFirstChannel, int32& OutNumChannels) const
+{
+	if ((TrackIndex < 0) || (TrackIndex >= GetNumAudioTracks()))
+	{
+		return false;
+	}
+
+	if (AudioChannelsPerTrack <= 0)
+	{
+		OutFirstChannel = 0;
+		OutNumChannels = LastAudioChannels;
+	}
+	else
+	{
+		OutFirstChannel = TrackIndex * AudioChannelsPerTrack;
+		OutNumChannels = FMath::Min(AudioChannelsPerTrack, LastAudioChannels - OutFirstChannel);
+	}
+
+	return true;
+}
+
+
+int32 FNdiMediaPlayer::GetNumAudioTracks() const
+{
+	// a single track is exposed until the channel layout is known
+	if ((AudioChannelsPerTrack <= 0) || (LastAudioChannels <= 0))
+	{
+		return 1;
+	}
+
+	return FMath::DivideAndRoundUp(LastAudioChannels, AudioChannelsPerTrack);
+}
+
+
+bool FNdiMediaPlayer::IsDuplicateVideoFrame(const NDIlib_video_frame_v2_t& VideoFrame)
+{
+	if (DetectDirtyRows)
+	{
+		// the row bands already tell whether anything changed, so the frame isn't hashed again
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		ChangeDetector->Detect(VideoFrame, MaxVideoThreads, VideoDirtyRows);
+
+		for (const FInt32Range& Rows : VideoDirtyRows)
+		{
+			NumDirtyVideoRows += Rows.Size<int32>();
+		}
+
+		DirtyRowCycles += FPlatformTime::Cycles64() - StartCycles;
+		NumCheckedVideoRows += VideoFrame.yres;
+		++NumChangeDetectedFrames;
+
+		if ((DuplicateFrameDetection == ENdiMediaDuplicateFrameDetection::None) || (VideoDirtyRows.Num() > 0))
+		{
+			return false;
+		}
+
+		++NumSkippedDuplicateFrames;
+
+		return true;
+	}
+
+	if (DuplicateFrameDetection == ENdiMediaDuplicateFrameDetection::None)
+	{
+		return false;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint64 Hash = FNdiMediaFrameHash::HashFrame(VideoFrame, DuplicateFrameDetection == ENdiMediaDuplicateFrameDetection::Sampled);
+	const bool Duplicate = (Hash == LastVideoFrameHash);
+
+	LastVideoFrameHash = Hash;
+
+	DuplicateFrameHashCycles += FPlatformTime::Cycles64() - StartCycles;
+	++NumHashedVideoFrames;
+
+	if (Duplicate)
+	{
+		++NumSkippedDuplicateFrames;
+	}
+
+	return Duplicate;
+}
+
+
+void FNdiMediaPlayer::PrewarmAudio(const IMediaOptions* Options)
+{
+	// estimate the audio format until the first frame is received
+	int32 NumChannels = 2;
+	int32 SampleRate = 48000;
+
+	if (Options != nullptr)
+	{
+		const int32 PreferredChannels = (int32)Options->GetMediaOption(NdiMedia::AudioChannelsOption, 0LL);
+		const int32 PreferredSampleRate = (int32)Options->GetMediaOption(NdiMedia::AudioSampleRateOption, 0LL);
+
+		if (PreferredChannels > 0)
+		{
+			NumChannels = PreferredChannels;
+		}
+
+		if (PreferredSampleRate > 0)
+		{
+			SampleRate = PreferredSampleRate;
+		}
+	}
+
+	if (AudioChannelsPerTrack > 0)
+	{
+		NumChannels = FMath::Min(NumChannels, AudioChannelsPerTrack);
+	}
+
+	PrewarmAudioSamples(NumChannels, SampleRate, 0);
+}
+
+
+void FNdiMediaPlayer::PrewarmAudioSamples(int32 NumChannels, int32 SampleRate, int32 MinFrames)
+{
+	// NDI senders typically deliver one audio frame per video frame, so
+	// blocks hold 40 ms to accommodate uneven frame sizes up to 25 fps
+	int32 NumFrames = FMath::Max(SampleRate / 25, MinFrames);
+	int32 NumTypicalFrames = SampleRate / 30;
+
+	if (AudioChunker->IsEnabled())
+	{
+		NumFrames = AudioChunker->GetChunkFrames();
+		NumTypicalFrames = NumFrames;
+	}
+
+	// enough samples for a full queue, plus the ones held by the sinks
+	const FTimespan SampleDuration(ETimespan::TicksPerSecond * NumTypicalFrames / SampleRate);
+	const FTimespan QueueDuration = (MaxAudioQueueDuration > FTimespan::Zero()) ? MaxAudioQueueDuration : FTimespan::FromMilliseconds(250);
+	const int32 NumSamples = FMath::Clamp((int32)(QueueDuration.GetTicks() / SampleDuration.GetTicks()) + 4, 8, 64);
+
+	// allocate samples
+	auto Arena = MakeShared<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe>(NumChannels * NumFrames, NumSamples);
+
+	FScopeLock Lock(&CriticalSection);
+
+	AudioSamplePool->Prewarm(NumSamples, Arena);
+	AudioBufferArena = Arena;
+	AudioSamplesChannels = NumChannels;
+	AudioSamplesSampleRate = SampleRate;
+}
+
+
+void FNdiMediaPlayer::ProcessAudio()
+{
+	check(ReceiverInstance != nullptr);
+
+	// samples must be recycled before the queue duration is checked
+	AudioSamplePool->Reclaim();
+
+	while (true)
+	{
+		NDIlib_audio_frame_v2_t AudioFrame;
+		NDIlib_frame_type_e FrameType = FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, nullptr, &AudioFrame, nullptr, 0);
+
+		if (FrameType == NDIlib_frame_type_error)
+		{
+			UE_LOG(LogNdiMedia, Verbose, TEXT("Failed to receive audio frame"));
+			return;
+		}
+
+		if (FrameType == NDIlib_frame_type_none)
+		{
+			break; // no more frames available
+		}
+
+		if (FrameType == NDIlib_frame_type_audio)
+		{
+			const uint64 CaptureCycles = FPlatformTime::Cycles64();
+
+			LastAudioChannels = AudioFrame.no_channels;
+			LastAudioSampleRate = AudioFrame.sample_rate;
+
+			if (UseFrameTimecode)
+			{
+				CurrentTime = FTimespan(AudioFrame.timecode);
+			}
+
+			int32 FirstChannel = 0;
+			int32 NumChannels = 0;
+
+			// write directly into ring buffer (the ring renders silence while no track is selected)
+			if (DirectAudioRing.IsValid())
+			{
+				if ((CurrentState == EMediaState::Playing) && GetAudioTrackChannels(SelectedAudioTrack, FirstChannel, NumChannels))
+				{
+					DirectAudioRing->Write(AudioFrame, FirstChannel, NumChannels, ReceiveAudioReferenceLevel, CaptureCycles);
+				}
+
+				FNdi::Lib->NDIlib_recv_free_audio_v2(ReceiverInstance, &AudioFrame);
+
+				continue;
+			}
+
+			// detect queue overruns, and recover until half the queue has drained
+			const FTimespan QueuedDuration = AudioQueue->GetQueuedDuration();
+
+			if (MaxAudioQueueDuration > FTimespan::Zero())
+			{
+				if (QueuedDuration > MaxAudioQueueDuration)
+				{
+					if (!AudioOverrun)
+					{
+						AudioOverrun = true;
+						++NumAudioOverruns;
+					}
+				}
+				else if (QueuedDuration.GetTicks() <= MaxAudioQueueDuration.GetTicks() / 2)
+				{
+					AudioOverrun = false;
+				}
+			}
+			else
+			{
+				AudioOverrun = false;
+			}
+
+			const FTimespan FrameDuration = (AudioFrame.sample_rate > 0)
+				? FTimespan(ETimespan::TicksPerSecond * AudioFrame.no_samples / AudioFrame.sample_rate)
+				: FTimespan::Zero();
+
+			if (AudioOverrun && (AudioOverrunPolicy == ENdiMediaAudioOverrunPolicy::Drop))
+			{
+				// discard the oldest queued audio, so that the newest audio plays with the least latency
+				DroppedAudioTime += AudioQueue->DropOldest(FTimespan(MaxAudioQueueDuration.GetTicks() / 2));
+
+				// the consumer isn't releasing discarded samples either, so stop queuing
+				if (QueuedDuration > MaxAudioQueueDuration * 2)
+				{
+					DroppedAudioTime += FrameDuration;
+					FNdi::Lib->NDIlib_recv_free_audio_v2(ReceiverInstance, &AudioFrame);
+
+					continue;
+				}
+			}
+
+			if ((CurrentState != EMediaState::Playing) || !GetAudioTrackChannels(SelectedAudioTrack, FirstChannel, NumChannels))
+			{
+				FNdi::Lib->NDIlib_recv_free_audio_v2(ReceiverInstance, &AudioFrame);
+
+				continue;
+			}
+
+			// the pre-allocated buffers may not fit the received audio
+			if (AudioBufferArena.IsValid() && (AudioFrame.sample_rate > 0) &&
+				((NumChannels != AudioSamplesChannels) || (AudioFrame.sample_rate != AudioSamplesSampleRate) ||
+				(!AudioChunker->IsEnabled() && (NumChannels * AudioFrame.no_samples > AudioBufferArena->GetBlockSize()))))
+			{
+				PrewarmAudioSamples(NumChannels, AudioFrame.sample_rate, AudioFrame.no_samples);
+			}
+
+			// time compression plays overrun audio about 7% faster, which raises its pitch by about a semitone
+			const bool CompressAudio = AudioOverrun && (AudioOverrunPolicy == ENdiMediaAudioOverrunPolicy::Compress);
+			const int32 NumFrames = CompressAudio ? FMath::Max(1, (AudioFrame.no_samples * 15) / 16) : AudioFrame.no_samples;
+
+			// convert & re-chunk frame
+			if (AudioChunker->IsEnabled())
+			{
+				AudioConversionBuffer.SetNumUninitialized(AudioFrame.no_samples * NumChannels, false);
+
+				FNdiMediaAudioSample::ConvertFrame(AudioFrame, FirstChannel, NumChannels, ReceiveAudioReferenceLevel, AudioConversionBuffer.GetData());
+
+				if ((NumFrames < AudioFrame.no_samples) && (AudioFrame.sample_rate > 0))
+				{
+					FNdiMediaAudioSample::CompressFrames(AudioConversionBuffer.GetData(), NumChannels, AudioFrame.no_samples, NumFrames);
+					CompressedAudioTime += FrameDuration - FTimespan(ETimespan::TicksPerSecond * NumFrames / AudioFrame.sample_rate);
+				}
+
+				AudioChunker->Append(AudioConversionBuffer.GetData(), NumFrames, NumChannels, AudioFrame.sample_rate, CurrentTime);
+				FNdi::Lib->NDIlib_recv_free_audio_v2(ReceiverInstance, &AudioFrame);
+
+				while (AudioChunker->CanPop())
+				{
+					auto AudioSample = AudioSamplePool->AcquireShared();
+					AudioSample->SetArena(AudioBufferArena);
+
+					if (AudioChunker->Pop(*AudioSample, AudioQueue))
+					{
+						Samples->AddAudio(AudioSample);
+					}
+				}
+
+				continue;
+			}
+
+			// // create & add sample to queue
+			auto AudioSample = AudioSamplePool->AcquireShared();
+			AudioSample->SetArena(AudioBufferArena);
+				
+			if (AudioSample->Initialize(ReceiverInstance, AudioFrame, FirstChannel, NumChannels, NumFrames, ReceiveAudioReferenceLevel, CurrentTime, AudioQueue))
+			{
+				CompressedAudioTime += FrameDuration - AudioSample->GetDuration();
+				Samples->AddAudio(AudioSample);
+			}
+		}
+	}
+}
+
+
+void FNdiMediaPlayer::ProcessMetadataAndVideo()
+{
+	check(ReceiverInstance != nullptr);
+
+	while (true)
+	{
+		NDIlib_metadata_frame_t MetadataFrame;
+		NDIlib_video_frame_v2_t VideoFrame;
+
+		const NDIlib_frame_type_e FrameType = FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, &VideoFrame, nullptr, &MetadataFrame, 0);
+
+		if (FrameType == NDIlib_frame_type_error)
+		{
+			UE_LOG(LogNdiMedia, Verbose, TEXT("Failed to receive NDI frame"));
+			return;
+		}
+
+		if (FrameType == NDIlib_frame_type_none)
+		{
+			break; // no more frames available
+		}
+
+		if (FrameType == NDIlib_frame_type_metadata)
+		{
+			if (UseFrameTimecode)
+			{
+				CurrentTime = FTimespan(MetadataFrame.timecode);
+			}
+
+			// // create & add sample to queue, or release frame
+			if ((CurrentState == EMediaState::Playing) && (SelectedMetadataTrack == 0))
+			{
+				auto BinarySample = MakeShared<FNdiMediaBinarySample, ESPMode::ThreadSafe>();
+
+				if (BinarySample->Initialize(ReceiverInstance, MetadataFrame, CurrentTime))
+				{
+					Samples->AddMetadata(BinarySample);
+				}
 			}
 			else
 			{
@@ -821,6 +1713,7 @@ void FNdiMediaPlayer::ProcessMetadataAndVideo()
 		else if (FrameType == NDIlib_frame_type_video)
 		{
 			LastVideoDim = FIntPoint(VideoFrame.xres, VideoFrame.yres);
+			LastVideoFourCC = VideoFrame.FourCC;
 			LastVideoFrameRate = (float)VideoFrame.frame_rate_N / (float)VideoFrame.frame_rate_D;
 			LastVideoBitRate = (uint64)(VideoFrame.line_stride_in_bytes * VideoFrame.yres * LastVideoFrameRate);
 
@@ -830,14 +1723,9 @@ void FNdiMediaPlayer::ProcessMetadataAndVideo()
 			}
 
 			// // create & add sample to queue, or release frame
-			if ((CurrentState == EMediaState::Playing) && (SelectedVideoTrack == 0))
+			if ((CurrentState == EMediaState::Playing) && (SelectedVideoTrack == 0) && !IsDuplicateVideoFrame(VideoFrame))
 			{
-				auto TextureSample = MakeShared<FNdiMediaTextureSample, ESPMode::ThreadSafe>();
-
-				if (TextureSample->Initialize(ReceiverInstance, VideoFrame, VideoSampleFormat, CurrentTime))
-				{
-					Samples->AddVideo(TextureSample);
-				}
+				ProcessVideo(VideoFrame);
 			}
 			else
 			{
@@ -848,10 +1736,228 @@ void FNdiMediaPlayer::ProcessMetadataAndVideo()
 }
 
 
+void FNdiMediaPlayer::ProcessVideo(NDIlib_video_frame_v2_t& VideoFrame)
+{
+	EMediaTextureSampleFormat SampleFormat;
+
+	switch ((uint32)VideoFrame.FourCC)
+	{
+	case NDIlib_FourCC_type_BGRA:
+	case NDIlib_FourCC_type_BGRX:
+		SampleFormat = EMediaTextureSampleFormat::CharBGRA;
+		break;
+
+	case NdiMedia::FourCC_P216:
+		SampleFormat = EMediaTextureSampleFormat::CharBGR10A2;
+		break;
+
+	case NdiMedia::FourCC_PA16:
+		SampleFormat = EMediaTextureSampleFormat::FloatRGBA;
+		break;
+
+	case NDIlib_FourCC_type_UYVA:
+		SampleFormat = EMediaTextureSampleFormat::CharAYUV;
+		break;
+
+	case NDIlib_FourCC_type_UYVY:
+		SampleFormat = EMediaTextureSampleFormat::CharUYVY;
+		break;
+
+	default:
+		SampleFormat = EMediaTextureSampleFormat::Undefined;
+	}
+
+	// 8-bit YUV frames are converted on the CPU if a color space was selected
+	const bool ConvertColors = ColorConverter->IsEnabled() && ((VideoFrame.FourCC == NDIlib_FourCC_type_UYVA) || (VideoFrame.FourCC == NDIlib_FourCC_type_UYVY));
+
+	if (ConvertColors)
+	{
+		SampleFormat = EMediaTextureSampleFormat::CharBGRA;
+	}
+
+	if ((SampleFormat == EMediaTextureSampleFormat::Undefined) || (VideoFrame.frame_rate_D == 0) || (VideoFrame.frame_rate_N == 0))
+	{
+		UE_LOG(LogNdiMedia, Verbose, TEXT("Discarding unsupported NDI video frame (FourCC 0x%08x)"), (uint32)VideoFrame.FourCC);
+		FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+
+		return;
+	}
+
+	if ((SampleFormat == EMediaTextureSampleFormat::CharBGR10A2) || (SampleFormat == EMediaTextureSampleFormat::FloatRGBA))
+	{
+		// high-bit-depth conversions are too expensive for the game thread
+		const int32 MaxPendingVideoConversions = 2;
+
+		if (NumPendingVideoConversions.GetValue() >= MaxPendingVideoConversions)
+		{
+			FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+			++NumDroppedVideoConversions;
+
+			// the frame was never shown, so its repetitions must not be skipped, and its changes go into the next sample
+			LastVideoFrameHash = 0;
+
+			return;
+		}
+
+		// chain the conversion tasks, so that the samples are added in order
+		FGraphEventArray Prerequisites;
+
+		if (VideoConversionTask.IsValid())
+		{
+			Prerequisites.Add(VideoConversionTask);
+		}
+
+		auto TextureSample = VideoSamplePool->AcquireShared();
+		const TArray<FInt32Range> DirtyRows = VideoDirtyRows;
+		const FTimespan Time = CurrentTime;
+
+		CommitDirtyRows();
+		NumPendingVideoConversions.Increment();
+
+		// converted on a single worker, because parallel loops inside tasks can starve the task graph
+		VideoConversionTask = FFunctionGraphTask::CreateAndDispatchWhenReady([this, VideoFrame, TextureSample, SampleFormat, Time, DirtyRows]() mutable
+		{
+			if (ConvertVideo(VideoFrame, *TextureSample, SampleFormat, Time, DirtyRows, 1))
+			{
+				ConvertedVideoSamples.Enqueue(TextureSample);
+			}
+
+			NumPendingVideoConversions.Decrement();
+		}, TStatId(), &Prerequisites);
+
+		return;
+	}
+
+	// samples must be added in order, so frames that arrive during pending conversions are dropped
+	if (!FetchConvertedVideo())
+	{
+		FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+		++NumDroppedVideoConversions;
+
+		LastVideoFrameHash = 0;
+
+		return;
+	}
+
+	const bool Deinterlace = (VideoFrame.frame_format_type != NDIlib_frame_format_type_progressive) && Deinterlacer->IsEnabled();
+	bool Released = false;
+
+	if (ConvertColors && (Deinterlace || Downscaler->IsEnabled()))
+	{
+		// converted frames are deinterlaced and downscaled in BGRA
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		const int32 Stride = VideoFrame.xres * 4;
+
+		ConvertedVideoBuffer.SetNumUninitialized(Stride * VideoFrame.yres);
+		ColorConverter->Convert(VideoFrame, ConvertedVideoBuffer.GetData(), Stride, MaxVideoThreads);
+		FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+
+		VideoConversionCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		NumConvertedVideoFrames.Increment();
+
+		VideoFrame.FourCC = NDIlib_FourCC_type_BGRA;
+		VideoFrame.p_data = ConvertedVideoBuffer.GetData();
+		VideoFrame.line_stride_in_bytes = Stride;
+		Released = true;
+	}
+
+	if (Deinterlace && ((SampleFormat == EMediaTextureSampleFormat::CharBGRA) || (SampleFormat == EMediaTextureSampleFormat::CharUYVY)))
+	{
+		DeinterlaceVideo(VideoFrame, SampleFormat, !Released);
+		CommitDirtyRows();
+
+		return;
+	}
+
+	if (Downscaler->IsEnabled() && ((SampleFormat == EMediaTextureSampleFormat::CharBGRA) || (SampleFormat == EMediaTextureSampleFormat::CharUYVY)))
+	{
+		const FTimespan Duration(VideoFrame.frame_rate_D * ETimespan::TicksPerSecond / VideoFrame.frame_rate_N);
+
+		DownscaleVideo((const uint8*)VideoFrame.p_data, VideoFrame.line_stride_in_bytes, FIntPoint(VideoFrame.xres, VideoFrame.yres), SampleFormat, CurrentTime, Duration);
+
+		if (!Released)
+		{
+			FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+		}
+
+		CommitDirtyRows();
+
+		return;
+	}
+
+	auto TextureSample = VideoSamplePool->AcquireShared();
+
+	if ((SampleFormat == EMediaTextureSampleFormat::CharAYUV) || ConvertColors)
+	{
+		if (ConvertVideo(VideoFrame, *TextureSample, SampleFormat, CurrentTime, VideoDirtyRows, MaxVideoThreads))
+		{
+			Samples->AddVideo(TextureSample);
+			CommitDirtyRows();
+		}
+	}
+	else if (CopyVideoFrames)
+	{
+		// copy the region of interest, so that NDI can reuse its buffer right away
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		bool Copied = false;
+
+		if (TextureSample->Initialize(ReceiverInstance, VideoFrame, SampleFormat, CurrentTime))
+		{
+			if (DetectDirtyRows)
+			{
+				TextureSample->SetDirtyRows(VideoDirtyRows);
+			}
+
+			TextureSample->Crop(CropRect);
+			Copied = TextureSample->Detach(MaxVideoThreads);
+		}
+		else
+		{
+			FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+		}
+
+		VideoCopyCycles += FPlatformTime::Cycles64() - StartCycles;
+		++NumCopiedVideoFrames;
+
+		if (Copied)
+		{
+			Samples->AddVideo(TextureSample);
+			CommitDirtyRows();
+		}
+		else
+		{
+			++NumDroppedCopiedVideoFrames;
+		}
+	}
+	else if (TextureSample->Initialize(ReceiverInstance, VideoFrame, SampleFormat, CurrentTime))
+	{
+		if (DetectDirtyRows)
+		{
+			TextureSample->SetDirtyRows(VideoDirtyRows);
+		}
+
+		// the sample points into the frame, so cropping is free
+		TextureSample->Crop(CropRect);
+		Samples->AddVideo(TextureSample);
+		CommitDirtyRows();
+	}
+	else
+	{
+		FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+	}
+}
+
+
 void FNdiMediaPlayer::SendMetadata(const FString& Metadata, int64 Timecode)
 {
 	check(ReceiverInstance != nullptr);
 
+	// only needed if the receiver may still be replaced by one that connects by name
+	if ((ConnectMilliseconds < 0.0) && !EndpointHint.IsEmpty() && !EndpointFallback)
+	{
+		ConnectionMetadata.Add(Metadata);
+	}
+
 	NDIlib_metadata_frame_t MetadataFrame;
 	{
 		MetadataFrame.length = Metadata.Len() + 1;
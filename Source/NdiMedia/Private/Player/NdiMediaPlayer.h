@@ -3,22 +3,42 @@
 #pragma once
 
 #include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/Queue.h"
 #include "Containers/UnrealString.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
 #include "IMediaCache.h"
 #include "IMediaControls.h"
 #include "IMediaPlayer.h"
 #include "IMediaTracks.h"
 #include "IMediaView.h"
 #include "Math/IntPoint.h"
+#include "Math/IntRect.h"
+#include "Math/Range.h"
 #include "Misc/Timespan.h"
+#include "Templates/SharedPointer.h"
 
 class FMediaSamples;
+class FNdiMediaAudioBufferArena;
+class FNdiMediaAudioChunker;
+class FNdiMediaAudioQueue;
+class FNdiMediaAudioRing;
 class FNdiMediaAudioSamplePool;
 class FNdiMediaBinarySamplePool;
+class FNdiMediaChangeDetector;
+class FNdiMediaColorConverter;
+class FNdiMediaDeinterlacer;
+class FNdiMediaDownscaler;
+class FNdiMediaTextureSample;
 class FNdiMediaTextureSamplePool;
 class IMediaEventSink;
+class IMediaOptions;
 
+enum class ENdiMediaAudioOverrunPolicy : uint8;
+enum class ENdiMediaDuplicateFrameDetection : uint8;
 enum class EMediaTextureSampleFormat;
 
 struct NDIlib_audio_frame_v2_t;
@@ -29,7 +49,17 @@ struct NDIlib_video_frame_v2_t;
  * Implements a media player using Newtek's Network Device Interface (NDI).
  *
  * Audio samples are fetched on the high-frequency media ticker thread (TickTickable)
- * to prevent NDI audio queue overruns and UE4 sound buffer underruns.
+ * to prevent NDI audio queue overruns and UE4 sound buffer underruns. The duration
+ * of audio samples that have not been released by the consumer yet is tracked, so
+ * that the latency can recover automatically after the consumer stalled, either by
+ * discarding the oldest queued audio or by playing the received audio faster. If the
+ * media source enables direct audio, audio frames bypass the sample queues and are
+ * written into a ring buffer that is consumed by NdiMediaSoundComponents instead.
+ * Otherwise, the audio may optionally be re-chunked into samples of a fixed size.
+ * The audio sample pool and its buffer arena are pre-warmed when a source is opened,
+ * and again when the format of the received audio is known, so that the player's
+ * own audio processing performs no heap allocations in the steady state. The Engine's
+ * media sample queues still allocate a queue node for each added sample.
  *
  * The processing of metadata and video frames is delayed until the fetch stage
  * (TickFetch) in order to increase the window of opportunity for receiving NDI
@@ -112,6 +142,121 @@ protected:
 
 protected:
 
+	/**
+	 * Make the current video frame the one that later frames are checked for changed rows against.
+	 *
+	 * Call this method whenever the current frame was turned into a sample, so that the
+	 * changed rows of the next sample cover everything that changed since this one.
+	 *
+	 * @see IsDuplicateVideoFrame
+	 */
+	void CommitDirtyRows();
+
+	/**
+	 * Convert the given video frame into the given texture sample, and release the frame.
+	 *
+	 * This method may be called on worker threads.
+	 *
+	 * @param VideoFrame The video frame to convert (must be P216, PA16, UYVA or UYVY).
+	 * @param TextureSample The texture sample to initialize.
+	 * @param SampleFormat The sample format to convert to.
+	 * @param Time The sample time.
+	 * @param DirtyRows The rows that changed since the previous sample (only used if dirty row detection is enabled).
+	 * @param MaxThreads Maximum number of threads to convert with (0 = all worker threads).
+	 * @return true on success, false otherwise.
+	 * @see FetchConvertedVideo, ProcessVideo
+	 */
+	bool ConvertVideo(NDIlib_video_frame_v2_t& VideoFrame, FNdiMediaTextureSample& TextureSample, EMediaTextureSampleFormat SampleFormat, FTimespan Time, const TArray<FInt32Range>& DirtyRows, int32 MaxThreads);
+
+	/**
+	 * Create a receiver that connects to the given source, and replace the current receiver.
+	 *
+	 * @param Name The name of the source (optional if the endpoint is set).
+	 * @param Endpoint The IP endpoint of the source (optional if the name is set).
+	 * @return true on success, false otherwise.
+	 * @see Open
+	 */
+	bool CreateReceiver(const FString& Name, const FString& Endpoint);
+
+	/**
+	 * Deinterlace the given fielded video frame into progressive samples, and release the frame.
+	 *
+	 * @param VideoFrame The video frame to deinterlace (must be BGRA or UYVY).
+	 * @param SampleFormat The sample format.
+	 * @param ReleaseFrame Whether to release the frame to NDI (false if it was already released, i.e. after color conversion).
+	 * @see ProcessVideo
+	 */
+	void DeinterlaceVideo(NDIlib_video_frame_v2_t& VideoFrame, EMediaTextureSampleFormat SampleFormat, bool ReleaseFrame);
+
+	/**
+	 * Create a reduced resolution video sample from the given frame and add it to the sample queue.
+	 *
+	 * @param Data The frame's pixel data.
+	 * @param Stride Number of bytes per row in the frame.
+	 * @param Dim Dimensions of the frame (in pixels).
+	 * @param SampleFormat The sample format (must be BGRA or UYVY).
+	 * @param Time The sample time.
+	 * @param Duration The sample duration.
+	 * @see ProcessVideo
+	 */
+	void DownscaleVideo(const uint8* Data, uint32 Stride, const FIntPoint& Dim, EMediaTextureSampleFormat SampleFormat, FTimespan Time, FTimespan Duration);
+
+	/**
+	 * Add the samples of completed video conversion tasks to the sample queue.
+	 *
+	 * @return true if all conversion tasks completed, false if some are still pending.
+	 * @see ConvertVideo
+	 */
+	bool FetchConvertedVideo();
+
+	/**
+	 * Get the range of audio channels that make up the specified audio track.
+	 *
+	 * @param TrackIndex The index of the audio track.
+	 * @param OutFirstChannel Will contain the index of the track's first channel.
+	 * @param OutNumChannels Will contain the number of channels in the track.
+	 * @return true on success, false if the track doesn't exist.
+	 * @see GetNumAudioTracks
+	 */
+	bool GetAudioTrackChannels(int32 TrackIndex, int32& OutFirstChannel, int32& OutNumChannels) const;
+
+	/**
+	 * Get the number of audio tracks exposed by the current audio stream.
+	 *
+	 * @return Number of audio tracks.
+	 * @see GetAudioTrackChannels
+	 */
+	int32 GetNumAudioTracks() const;
+
+	/**
+	 * Check whether the given video frame is identical to the previously received frame.
+	 *
+	 * If dirty row detection is enabled, this method also determines the rows that changed.
+	 *
+	 * @param VideoFrame The video frame to check.
+	 * @return true if the frame is a duplicate, false otherwise or if detection is disabled.
+	 * @see ProcessMetadataAndVideo
+	 */
+	bool IsDuplicateVideoFrame(const NDIlib_video_frame_v2_t& VideoFrame);
+
+	/**
+	 * Pre-allocate audio samples and their buffers for the given media options.
+	 *
+	 * @param Options The media options.
+	 * @see PrewarmAudioSamples, ProcessAudio
+	 */
+	void PrewarmAudio(const IMediaOptions* Options);
+
+	/**
+	 * Pre-allocate audio samples and their buffers for the given audio format.
+	 *
+	 * @param NumChannels Number of channels in each audio sample.
+	 * @param SampleRate The sample rate (in samples per second).
+	 * @param MinFrames Minimum number of frames that each sample buffer must hold.
+	 * @see PrewarmAudio, ProcessAudio
+	 */
+	void PrewarmAudioSamples(int32 NumChannels, int32 SampleRate, int32 MinFrames);
+
 	/**
 	 * Process pending audio frames, and forward them to the audio sink.
 	 *
@@ -126,6 +271,16 @@ protected:
 	 */
 	void ProcessMetadataAndVideo();
 
+	/**
+	 * Create a video sample from the given video frame and add it to the sample queue.
+	 *
+	 * The video frame is released either immediately or together with the sample.
+	 *
+	 * @param VideoFrame The video frame to process.
+	 * @see ProcessMetadataAndVideo
+	 */
+	void ProcessVideo(NDIlib_video_frame_v2_t& VideoFrame);
+
 	/**
 	 * Send the given metadata to the connection.
 	 *
@@ -136,9 +291,90 @@ protected:
 
 private:
 
+	/** Arena for the interleaved buffers of audio samples. */
+	TSharedPtr<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe> AudioBufferArena;
+
+	/** Number of audio channels per audio track (0 = all channels in one track). */
+	int32 AudioChannelsPerTrack;
+
+	/** Re-chunks audio into samples of a fixed size (if enabled). */
+	FNdiMediaAudioChunker* AudioChunker;
+
+	/** Buffer for converting audio frames before they are re-chunked. */
+	TArray<short> AudioConversionBuffer;
+
+	/** Whether the audio queue is currently recovering from an overrun. */
+	bool AudioOverrun;
+
+	/** How to recover from audio queue overruns. */
+	ENdiMediaAudioOverrunPolicy AudioOverrunPolicy;
+
+	/** Tracks the audio samples that were queued, but not released yet. */
+	TSharedPtr<FNdiMediaAudioQueue, ESPMode::ThreadSafe> AudioQueue;
+
 	/** Audio sample object pool. */
 	FNdiMediaAudioSamplePool* AudioSamplePool;
 
+	/** Number of channels that the audio samples were pre-allocated for. */
+	int32 AudioSamplesChannels;
+
+	/** Sample rate that the audio samples were pre-allocated for. */
+	int32 AudioSamplesSampleRate;
+
+	/** Detects the rows of video frames that changed. */
+	FNdiMediaChangeDetector* ChangeDetector;
+
+	/** Converts YUV video frames to RGB in the selected color space. */
+	FNdiMediaColorConverter* ColorConverter;
+
+	/** Total duration of audio that was removed by time compression. */
+	FTimespan CompressedAudioTime;
+
+	/** Time it took to connect to the source (in milliseconds, negative until connected). */
+	double ConnectMilliseconds;
+
+	/** Time at which the current receiver started connecting (in CPU cycles). */
+	uint64 ConnectStartCycles;
+
+	/** Metadata that was sent to a receiver connecting by endpoint, so that it can be sent again if it falls back to connecting by name. */
+	TArray<FString> ConnectionMetadata;
+
+	/** Color converted video frame that is deinterlaced or downscaled. */
+	TArray<uint8> ConvertedVideoBuffer;
+
+	/** Samples of completed video conversion tasks that weren't added to the sample queue yet. */
+	TQueue<TSharedPtr<FNdiMediaTextureSample, ESPMode::ThreadSafe>, EQueueMode::Spsc> ConvertedVideoSamples;
+
+	/** Whether to copy video frames and release them to NDI immediately. */
+	bool CopyVideoFrames;
+
+	/** Region of interest in received video frames (in pixels, empty = full frame). */
+	FIntRect CropRect;
+
+	/** Total time spent deinterlacing video frames (in CPU cycles). */
+	uint64 DeinterlaceCycles;
+
+	/** The video deinterlacer. */
+	FNdiMediaDeinterlacer* Deinterlacer;
+
+	/** Whether to detect the rows of video frames that changed. */
+	bool DetectDirtyRows;
+
+	/** Total time spent detecting changed rows in video frames (in CPU cycles). */
+	uint64 DirtyRowCycles;
+
+	/** Total time spent downscaling video frames (in CPU cycles). */
+	uint64 DownscaleCycles;
+
+	/** The video downscaler. */
+	FNdiMediaDownscaler* Downscaler;
+
+	/** How to detect repeated video frames. */
+	ENdiMediaDuplicateFrameDetection DuplicateFrameDetection;
+
+	/** Total time spent hashing video frames for duplicate detection (in CPU cycles). */
+	uint64 DuplicateFrameHashCycles;
+
 	/** Critical section for synchronizing access to receiver and sinks. */
 	FCriticalSection CriticalSection;
 
@@ -151,6 +387,18 @@ private:
 	/** The currently opened URL. */
 	FString CurrentUrl;
 
+	/** Total duration of audio that was dropped due to queue overruns. */
+	FTimespan DroppedAudioTime;
+
+	/** Ring buffer for direct audio playback (only valid if direct audio is enabled). */
+	TSharedPtr<FNdiMediaAudioRing, ESPMode::ThreadSafe> DirectAudioRing;
+
+	/** Whether connecting to the resolved endpoint failed, and the player fell back to connecting by name. */
+	bool EndpointFallback;
+
+	/** The endpoint that was resolved from the source name (empty if unknown or opened by endpoint). */
+	FString EndpointHint;
+
 	/** The media event handler. */
 	IMediaEventSink& EventSink;
 
@@ -160,21 +408,84 @@ private:
 	/** Audio sample rate in the last received sample. */
 	int32 LastAudioSampleRate;
 
+	/** Number of audio tracks that were last reported to the event sink. */
+	int32 LastNumAudioTracks;
+
+	/** Rows that changed in the last video sample, as shown in the stats (only if dirty row detection is enabled). */
+	TArray<FInt32Range> LastSampleDirtyRows;
+
 	/** Video bit rate based on the last received sample. */
 	uint64 LastVideoBitRate;
 
 	/** Video dimensions in the last received sample. */
 	FIntPoint LastVideoDim;
 
+	/** Pixel format (FourCC) of the last received sample. */
+	uint32 LastVideoFourCC;
+
 	/** Video frame rate in the last received sample. */
 	float LastVideoFrameRate;
 
+	/** Hash of the last received video frame (only if duplicate detection is enabled). */
+	uint64 LastVideoFrameHash;
+
+	/** Maximum duration of queued audio samples (zero = unlimited). */
+	FTimespan MaxAudioQueueDuration;
+
+	/** Maximum number of threads for processing a video frame (0 = all worker threads). */
+	int32 MaxVideoThreads;
+
+	/** Number of audio queue overruns. */
+	int32 NumAudioOverruns;
+
+	/** Number of video frames that were compared with the previous frame for changed rows. */
+	int32 NumChangeDetectedFrames;
+
+	/** Total number of rows in the video frames that were compared with the previous frame. */
+	int64 NumCheckedVideoRows;
+
+	/** Number of fielded video frames that were deinterlaced. */
+	int32 NumDeinterlacedFrames;
+
+	/** Number of video frames that were downscaled. */
+	int32 NumDownscaledFrames;
+
+	/** Total number of video frame rows that changed since the previous frame. */
+	int64 NumDirtyVideoRows;
+
+	/** Number of video frames that were hashed for duplicate detection. */
+	int32 NumHashedVideoFrames;
+
+	/** Number of video frames that were skipped because they were identical to the previous frame. */
+	int32 NumSkippedDuplicateFrames;
+
+	/** Number of video frames that were copied. */
+	int32 NumCopiedVideoFrames;
+
+	/** Number of video frames that were converted to a different pixel format. */
+	FThreadSafeCounter NumConvertedVideoFrames;
+
+	/** Number of copied video frames that could not be added as samples. */
+	int32 NumDroppedCopiedVideoFrames;
+
+	/** Number of video frames that were dropped because too many conversions were pending. */
+	int32 NumDroppedVideoConversions;
+
+	/** Number of video conversion tasks that haven't completed yet. */
+	FThreadSafeCounter NumPendingVideoConversions;
+
 	/** Whether the player is paused. */
 	bool Paused;
 
 	/** Reference level for received audio (cached from settings). */
 	int32 ReceiveAudioReferenceLevel;
 
+	/** Bandwidth of the current receiver. */
+	int64 ReceiverBandwidth;
+
+	/** Color format of the current receiver. */
+	int64 ReceiverColorFormat;
+
 	/** The current receiver instance. */
 	void* ReceiverInstance;
 
@@ -190,9 +501,27 @@ private:
 	/** Index of the selected video track. */
 	int32 SelectedVideoTrack;
 
+	/** The name of the opened source (empty if opened by endpoint). */
+	FString SourceName;
+
 	/** Whether to use the time code embedded in NDI frames. */
 	bool UseFrameTimecode;
 
-	/** The current video sample format. */
-	EMediaTextureSampleFormat VideoSampleFormat;
+	/** Total time spent converting video frames (in CPU cycles). */
+	FThreadSafeCounter64 VideoConversionCycles;
+
+	/** The most recently dispatched video conversion task. */
+	FGraphEventRef VideoConversionTask;
+
+	/** Total time spent copying video frames (in CPU cycles). */
+	uint64 VideoCopyCycles;
+
+	/** Rows of the current video frame that changed since the previous sample. */
+	TArray<FInt32Range> VideoDirtyRows;
+
+	/** Video sample object pool. */
+	FNdiMediaTextureSamplePool* VideoSamplePool;
+
+	/** Buffer for intermediate results of video processing stages. */
+	TArray<uint8> VideoScratchBuffer;
 };
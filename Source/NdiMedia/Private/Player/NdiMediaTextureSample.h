@@ -2,23 +2,44 @@
 
 #pragma once
 
+#include "HAL/UnrealMemory.h"
+#include "Containers/Array.h"
 #include "IMediaTextureSample.h"
+#include "Math/IntRect.h"
+#include "Math/Range.h"
+#include "Math/UnrealMathUtility.h"
+#include "MediaObjectPool.h"
+
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaVideoCopy.h"
 
 
 /**
  * Implements a media texture sample for NdiMedia.
+ *
+ * The sample either references the NDI video frame directly (zero-copy), in which
+ * case the frame is held until the sample is released, or it owns a 64-byte aligned
+ * buffer that is populated by the player and kept while the sample is recycled.
  */
 class FNdiMediaTextureSample
 	: public IMediaTextureSample
+	, public IMediaPoolable
 {
 public:
 
 	/** Default constructor. */
 	FNdiMediaTextureSample()
-		: Duration(FTimespan::Zero())
+		: Buffer(nullptr)
+		, Dim(FIntPoint::ZeroValue)
+		, DirtyRowsKnown(false)
+		, Duration(FTimespan::Zero())
 		, Frame()
+		, OutputDim(FIntPoint::ZeroValue)
+		, OwnedBuffer(nullptr)
+		, OwnedBufferSize(0)
 		, ReceiverInstance(nullptr)
 		, SampleFormat(EMediaTextureSampleFormat::Undefined)
+		, Stride(0)
 		, Time(FTimespan::Zero())
 	{ }
 
@@ -26,17 +47,141 @@ public:
 	virtual ~FNdiMediaTextureSample()
 	{
 		FreeFrame();
+
+		if (OwnedBuffer != nullptr)
+		{
+			FMemory::Free(OwnedBuffer);
+		}
 	}
 
 public:
 
 	/**
-	 * Initialize the sample.
+	 * Restrict the sample to a region of interest without copying.
+	 *
+	 * The region is clamped to the sample and widened to whole texels. Empty regions
+	 * are ignored.
+	 *
+	 * @param Rect The region of interest (in pixels).
+	 * @see Detach
+	 */
+	void Crop(const FIntRect& Rect)
+	{
+		if ((Buffer == nullptr) || (Rect.Width() <= 0) || (Rect.Height() <= 0))
+		{
+			return;
+		}
+
+		const int32 PixelsPerTexel = GetPixelsPerTexel(SampleFormat);
+		const int32 Left = FMath::Clamp(Rect.Min.X, 0, OutputDim.X) / PixelsPerTexel;
+		const int32 Right = FMath::Min(FMath::DivideAndRoundUp(FMath::Clamp(Rect.Max.X, 0, OutputDim.X), PixelsPerTexel), Dim.X);
+		const int32 Top = FMath::Clamp(Rect.Min.Y, 0, OutputDim.Y);
+		const int32 Bottom = FMath::Clamp(Rect.Max.Y, 0, OutputDim.Y);
+
+		if ((Right <= Left) || (Bottom <= Top))
+		{
+			return;
+		}
+
+		Buffer = (const uint8*)Buffer + Top * Stride + Left * GetBytesPerTexel(SampleFormat);
+		Dim = FIntPoint(Right - Left, Bottom - Top);
+		OutputDim = FIntPoint(FMath::Min((Right - Left) * PixelsPerTexel, OutputDim.X - Left * PixelsPerTexel), Bottom - Top);
+
+		// move dirty rows into the cropped region
+		for (int32 Index = DirtyRows.Num() - 1; Index >= 0; --Index)
+		{
+			const int32 First = FMath::Max(DirtyRows[Index].GetLowerBoundValue(), Top) - Top;
+			const int32 Last = FMath::Min(DirtyRows[Index].GetUpperBoundValue(), Bottom) - Top;
+
+			if (Last > First)
+			{
+				DirtyRows[Index] = FInt32Range(First, Last);
+			}
+			else
+			{
+				DirtyRows.RemoveAt(Index);
+			}
+		}
+	}
+
+	/**
+	 * Copy the referenced video frame data into the owned buffer, and release the frame.
+	 *
+	 * Only the visible region is copied if the sample was cropped.
+	 *
+	 * @param MaxThreads Maximum number of threads to copy with (0 = all worker threads).
+	 * @return true on success, false otherwise.
+	 * @see Crop, Initialize
+	 */
+	bool Detach(int32 MaxThreads)
+	{
+		if (ReceiverInstance == nullptr)
+		{
+			return (Buffer != nullptr);
+		}
+
+		const uint8* Source = (const uint8*)Buffer;
+		const uint32 SourceStride = Stride;
+		const uint32 RowBytes = Dim.X * GetBytesPerTexel(SampleFormat);
+		uint8* Dest = (uint8*)ReserveOwnedBuffer((SIZE_T)RowBytes * Dim.Y);
+
+		FNdiMediaParallelRows::ParallelFor(Dim.Y, RowBytes * 2, MaxThreads, [=](int32 FirstRow, int32 NumRows)
+		{
+			if (SourceStride == RowBytes)
+			{
+				// rows are contiguous, so each band is copied as one block
+				FNdiMediaVideoCopy::StreamCopy(Dest + FirstRow * RowBytes, Source + FirstRow * RowBytes, (SIZE_T)NumRows * RowBytes);
+			}
+			else
+			{
+				for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+				{
+					FNdiMediaVideoCopy::StreamCopy(Dest + Row * RowBytes, Source + Row * SourceStride, RowBytes);
+				}
+			}
+		});
+
+		FreeFrame();
+
+		Buffer = Dest;
+		Stride = RowBytes;
+
+		return true;
+	}
+
+	/**
+	 * Get the ranges of rows that changed since the previous sample.
+	 *
+	 * The information is only valid if HasDirtyRows returns true. Consumers that
+	 * keep the previous sample's texture can update only these rows.
+	 *
+	 * @return Ranges of changed rows (in pixels, upper bounds are exclusive).
+	 * @see HasDirtyRows, SetDirtyRows
+	 */
+	const TArray<FInt32Range>& GetDirtyRows() const
+	{
+		return DirtyRows;
+	}
+
+	/**
+	 * Whether the sample knows which of its rows changed since the previous sample.
+	 *
+	 * @return true if the dirty rows are known, false if all rows must be updated.
+	 * @see GetDirtyRows
+	 */
+	bool HasDirtyRows() const
+	{
+		return DirtyRowsKnown;
+	}
+
+	/**
+	 * Initialize the sample with a reference to the given video frame.
 	 *
 	 * @param InReceiverInstance The receiver instance that generated the sample.
 	 * @param InFrame The video frame data.
 	 * @param InSampleFormat The sample format.
 	 * @param InTime The sample time (in the player's own clock).
+	 * @see Detach, InitializeBuffer
 	 */
 	bool Initialize(void* InReceiverInstance, const NDIlib_video_frame_v2_t& InFrame, EMediaTextureSampleFormat InSampleFormat, FTimespan InTime)
 	{
@@ -52,32 +197,86 @@ public:
 			return false;
 		}
 
-		Duration = FTimespan::FromMicroseconds((InFrame.frame_rate_D * 1000000) / InFrame.frame_rate_N);
+		Buffer = InFrame.p_data;
+		Dim = FIntPoint(InFrame.line_stride_in_bytes / 4, InFrame.yres);
+		DirtyRows.Reset();
+		DirtyRowsKnown = false;
+		Duration = FTimespan(InFrame.frame_rate_D * ETimespan::TicksPerSecond / InFrame.frame_rate_N);
 		Frame = InFrame;
+		OutputDim = FIntPoint(InFrame.xres, InFrame.yres);
 		ReceiverInstance = InReceiverInstance;
 		SampleFormat = InSampleFormat;
+		Stride = InFrame.line_stride_in_bytes;
 		Time = InTime;
 
 		return true;
 	}
 
+	/**
+	 * Initialize the sample with an owned buffer that the caller populates.
+	 *
+	 * @param InDim The buffer dimensions (in texels of the sample format).
+	 * @param InOutputDim The output dimensions (in pixels).
+	 * @param InStride Number of bytes per buffer row.
+	 * @param InSampleFormat The sample format.
+	 * @param InTime The sample time (in the player's own clock).
+	 * @param InDuration Duration for which the sample is valid.
+	 * @return The buffer to populate (64-byte aligned), or nullptr on failure.
+	 * @see Initialize
+	 */
+	void* InitializeBuffer(const FIntPoint& InDim, const FIntPoint& InOutputDim, uint32 InStride, EMediaTextureSampleFormat InSampleFormat, FTimespan InTime, FTimespan InDuration)
+	{
+		FreeFrame();
+
+		if ((InSampleFormat == EMediaTextureSampleFormat::Undefined) || (InDim.X <= 0) || (InDim.Y <= 0) || (InStride == 0))
+		{
+			return nullptr;
+		}
+
+		Buffer = ReserveOwnedBuffer((SIZE_T)InStride * InDim.Y);
+		Dim = InDim;
+		DirtyRows.Reset();
+		DirtyRowsKnown = false;
+		Duration = InDuration;
+		OutputDim = InOutputDim;
+		SampleFormat = InSampleFormat;
+		Stride = InStride;
+		Time = InTime;
+
+		return OwnedBuffer;
+	}
+
+	/**
+	 * Set the ranges of rows that changed since the previous sample.
+	 *
+	 * Call this method after initializing the sample and before cropping it.
+	 *
+	 * @param InDirtyRows Ranges of changed rows (in pixels, upper bounds are exclusive).
+	 * @see GetDirtyRows
+	 */
+	void SetDirtyRows(const TArray<FInt32Range>& InDirtyRows)
+	{
+		DirtyRows = InDirtyRows;
+		DirtyRowsKnown = true;
+	}
+
 public:
 
 	//~ IMediaTextureSample interface
 
 	virtual const void* GetBuffer() override
 	{
-		return Frame.p_data;
+		return Buffer;
 	}
 
 	virtual FIntPoint GetDim() const override
 	{
-		return FIntPoint(Frame.line_stride_in_bytes / 4, Frame.yres);
+		return Dim;
 	}
 
 	virtual FTimespan GetDuration() const override
 	{
-		return FTimespan(Frame.frame_rate_D * ETimespan::TicksPerSecond / Frame.frame_rate_N);
+		return Duration;
 	}
 
 	virtual EMediaTextureSampleFormat GetFormat() const override
@@ -87,12 +286,12 @@ public:
 
 	virtual FIntPoint GetOutputDim() const override
 	{
-		return FIntPoint(Frame.xres, Frame.yres);
+		return OutputDim;
 	}
 
 	virtual uint32 GetStride() const override
 	{
-		return Frame.line_stride_in_bytes;
+		return Stride;
 	}
 
 #if WITH_ENGINE
@@ -117,8 +316,64 @@ public:
 		return true;
 	}
 
+public:
+
+	//~ IMediaPoolable interface
+
+	virtual void ShutdownPoolable() override
+	{
+		FreeFrame();
+	}
+
 protected:
 
+	/**
+	 * Get the number of bytes per texel in the given sample format.
+	 *
+	 * @param Format The sample format.
+	 * @return Number of bytes.
+	 * @see GetPixelsPerTexel
+	 */
+	static int32 GetBytesPerTexel(EMediaTextureSampleFormat Format)
+	{
+		return (Format == EMediaTextureSampleFormat::FloatRGBA) ? 8 : 4;
+	}
+
+	/**
+	 * Get the number of pixels per texel in the given sample format.
+	 *
+	 * @param Format The sample format.
+	 * @return Number of pixels.
+	 * @see GetBytesPerTexel
+	 */
+	static int32 GetPixelsPerTexel(EMediaTextureSampleFormat Format)
+	{
+		return (Format == EMediaTextureSampleFormat::CharUYVY) ? 2 : 1;
+	}
+
+	/**
+	 * Make sure that the owned buffer is large enough.
+	 *
+	 * @param Size The required size (in bytes).
+	 * @return The owned buffer.
+	 */
+	void* ReserveOwnedBuffer(SIZE_T Size)
+	{
+		// try to reuse existing buffer if large enough
+		if (OwnedBufferSize < Size)
+		{
+			if (OwnedBuffer != nullptr)
+			{
+				FMemory::Free(OwnedBuffer);
+			}
+
+			OwnedBuffer = FMemory::Malloc(Size, 64);
+			OwnedBufferSize = Size;
+		}
+
+		return OwnedBuffer;
+	}
+
 	/** Free the video frame data. */
 	void FreeFrame()
 	{
@@ -129,22 +384,52 @@ protected:
 			ReceiverInstance = nullptr;
 			Frame = { 0 };
 		}
+
+		Buffer = nullptr;
 	}
 
 private:
 
+	/** The sample's pixel data (either the video frame's or the owned buffer). */
+	const void* Buffer;
+
+	/** Dimensions of the pixel data (in texels of the sample format). */
+	FIntPoint Dim;
+
+	/** Ranges of rows that changed since the previous sample. */
+	TArray<FInt32Range> DirtyRows;
+
+	/** Whether the dirty rows are known. */
+	bool DirtyRowsKnown;
+
 	/** Duration for which the sample is valid. */
 	FTimespan Duration;
 
-	/** The video frame data. */
+	/** The video frame data (only in zero-copy mode). */
 	NDIlib_video_frame_v2_t Frame;
 
-	/** The receiver instance that generated this sample. */
+	/** Output dimensions (in pixels). */
+	FIntPoint OutputDim;
+
+	/** The owned pixel buffer (64-byte aligned). */
+	void* OwnedBuffer;
+
+	/** Size of the owned pixel buffer (in bytes). */
+	SIZE_T OwnedBufferSize;
+
+	/** The receiver instance that generated this sample (only in zero-copy mode). */
 	void* ReceiverInstance;
 
 	/** Sample format. */
 	EMediaTextureSampleFormat SampleFormat;
 
+	/** Number of bytes per row of pixel data. */
+	uint32 Stride;
+
 	/** Sample time. */
 	FTimespan Time;
 };
+
+
+/** Implements a pool for NDI texture sample objects. */
+class FNdiMediaTextureSamplePool : public TMediaObjectPool<FNdiMediaTextureSample> { };
@@ -0,0 +1,78 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaChangeDetector.h"
+#include "NdiMediaPrivate.h"
+
+#include "Math/UnrealMathUtility.h"
+
+#include "NdiMediaFrameHash.h"
+#include "NdiMediaParallelRows.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/** Number of rows per band. */
+static const int32 BandRows = 16;
+
+
+/* FNdiMediaChangeDetector interface
+ *****************************************************************************/
+
+void FNdiMediaChangeDetector::Commit()
+{
+	BandHashes = NewBandHashes;
+}
+
+
+void FNdiMediaChangeDetector::Detect(const NDIlib_video_frame_v2_t& Frame, int32 MaxThreads, TArray<FInt32Range>& OutDirtyRows)
+{
+	const int32 NumBands = FMath::DivideAndRoundUp(Frame.yres, BandRows);
+
+	NewBandHashes.SetNumUninitialized(NumBands);
+
+	// hash the bands in parallel
+	uint64* Hashes = NewBandHashes.GetData();
+
+	FNdiMediaParallelRows::ParallelFor(NumBands, Frame.line_stride_in_bytes * BandRows, MaxThreads, [&Frame, Hashes](int32 FirstBand, int32 NumBandsToHash)
+	{
+		for (int32 Band = FirstBand; Band < FirstBand + NumBandsToHash; ++Band)
+		{
+			Hashes[Band] = FNdiMediaFrameHash::HashRows(Frame, Band * BandRows, BandRows, 1);
+		}
+	});
+
+	// merge adjacent changed bands into row ranges
+	const bool HasPrevious = (BandHashes.Num() == NumBands);
+
+	OutDirtyRows.Reset();
+
+	for (int32 Band = 0; Band < NumBands; ++Band)
+	{
+		if (HasPrevious && (BandHashes[Band] == Hashes[Band]))
+		{
+			continue;
+		}
+
+		const int32 FirstRow = Band * BandRows;
+		const int32 LastRow = FMath::Min(FirstRow + BandRows, (int32)Frame.yres);
+
+		if ((OutDirtyRows.Num() > 0) && (OutDirtyRows.Last().GetUpperBoundValue() == FirstRow))
+		{
+			OutDirtyRows.Last() = FInt32Range(OutDirtyRows.Last().GetLowerBoundValue(), LastRow);
+		}
+		else
+		{
+			OutDirtyRows.Add(FInt32Range(FirstRow, LastRow));
+		}
+	}
+}
+
+
+void FNdiMediaChangeDetector::Reset()
+{
+	BandHashes.Empty();
+	NewBandHashes.Empty();
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
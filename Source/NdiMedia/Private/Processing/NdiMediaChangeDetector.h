@@ -0,0 +1,63 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Math/Range.h"
+
+struct NDIlib_video_frame_v2_t;
+
+
+/**
+ * Detects the rows of video frames that changed since the last committed frame.
+ *
+ * Frames are divided into bands of rows, and a hash of each band is compared with
+ * the hash of the same band in the last frame that was committed, which is the last
+ * frame that was turned into a sample. Frames that are dropped are never committed,
+ * so the rows they changed are still reported for the next sample. Comparing hashes
+ * avoids keeping a copy of the committed frame, and the hashing reads each byte once.
+ *
+ * This class is not thread-safe.
+ */
+class FNdiMediaChangeDetector
+{
+public:
+
+	/**
+	 * Make the most recently detected frame the one that later frames are compared with.
+	 *
+	 * Call this method once the frame was turned into a sample.
+	 *
+	 * @see Detect
+	 */
+	void Commit();
+
+	/**
+	 * Compare a frame with the last committed frame.
+	 *
+	 * All rows are reported as changed if the frame has a different layout than the
+	 * committed frame, or if no frame was committed yet.
+	 *
+	 * @param Frame The video frame to check.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @param OutDirtyRows Will contain the ranges of changed rows (empty if nothing changed).
+	 * @see Commit, Reset
+	 */
+	void Detect(const NDIlib_video_frame_v2_t& Frame, int32 MaxThreads, TArray<FInt32Range>& OutDirtyRows);
+
+	/**
+	 * Forget the committed frame, so that all rows of the next frame are reported as changed.
+	 *
+	 * @see Detect
+	 */
+	void Reset();
+
+private:
+
+	/** Hashes of the bands in the last committed frame. */
+	TArray<uint64> BandHashes;
+
+	/** Hashes of the bands in the most recently detected frame. */
+	TArray<uint64> NewBandHashes;
+};
@@ -0,0 +1,280 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaColorConverter.h"
+#include "NdiMediaPrivate.h"
+
+#include "Math/UnrealMathUtility.h"
+
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaSource.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Number of fractional bits in the YUV to RGB coefficients. */
+static const int32 FractionBits = 13;
+
+/** Number of fractional bits in the gamut matrix. */
+static const int32 GamutBits = 14;
+
+/** Linear BT.2020 to BT.709 conversion matrix (ITU-R BT.2087, rows sum up to one). */
+static const int32 GamutMatrix[9] =
+{
+	27206, -9628, -1194,
+	-2041, 18561, -136,
+	-298, -1647, 18329,
+};
+
+
+/** Clamp a fixed-point value to a color component. */
+FORCEINLINE uint8 ClampComponent(int32 Value)
+{
+	return (uint8)FMath::Clamp(Value >> FractionBits, 0, 255);
+}
+
+
+#if NDIMEDIA_SSE2
+
+/** Add the chroma terms of four texels to the luma terms of their eight pixels, and scale to 16-bit components. */
+FORCEINLINE __m128i CombineLumaChroma(__m128i Luma0, __m128i Luma1, __m128i Chroma)
+{
+	// each texel's chroma applies to two pixels
+	const __m128i Sum0 = _mm_add_epi32(Luma0, _mm_shuffle_epi32(Chroma, _MM_SHUFFLE(1, 1, 0, 0)));
+	const __m128i Sum1 = _mm_add_epi32(Luma1, _mm_shuffle_epi32(Chroma, _MM_SHUFFLE(3, 3, 2, 2)));
+
+	return _mm_packs_epi32(_mm_srai_epi32(Sum0, FractionBits), _mm_srai_epi32(Sum1, FractionBits));
+}
+
+#endif
+
+
+/* FNdiMediaColorConverter structors
+ *****************************************************************************/
+
+FNdiMediaColorConverter::FNdiMediaColorConverter()
+	: ColorSpace(ENdiMediaColorSpace::Engine)
+{
+	SetMode(ENdiMediaColorSpace::Engine, ENdiMediaColorRange::Limited);
+
+	// BT.1886 display gamma
+	for (int32 Value = 0; Value < 256; ++Value)
+	{
+		LinearTable[Value] = (uint16)FMath::RoundToInt(FMath::Pow(Value / 255.0f, 2.4f) * 65535.0f);
+	}
+
+	for (int32 Index = 0; Index < 4096; ++Index)
+	{
+		const float Linear = (Index + 0.5f) / 4096.0f;
+		const float Encoded = (Linear <= 0.0031308f) ? Linear * 12.92f : 1.055f * FMath::Pow(Linear, 1.0f / 2.4f) - 0.055f;
+
+		SrgbTable[Index] = (uint8)FMath::Clamp(FMath::RoundToInt(Encoded * 255.0f), 0, 255);
+	}
+}
+
+
+/* FNdiMediaColorConverter interface
+ *****************************************************************************/
+
+void FNdiMediaColorConverter::Convert(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads) const
+{
+	check((Frame.FourCC == NDIlib_FourCC_type_UYVY) || (Frame.FourCC == NDIlib_FourCC_type_UYVA));
+	check(IsEnabled());
+
+	const FCoefficients* Coefficients = &Bt601;
+
+	switch (ColorSpace)
+	{
+	case ENdiMediaColorSpace::Auto:
+		// NDI does not signal the color space, so SD and HD conventions are assumed
+		Coefficients = (Frame.yres < 720) ? &Bt601 : &Bt709;
+		break;
+
+	case ENdiMediaColorSpace::BT2020:
+		Coefficients = &Bt2020;
+		break;
+
+	case ENdiMediaColorSpace::BT601:
+	case ENdiMediaColorSpace::Engine:
+		break;
+
+	case ENdiMediaColorSpace::BT709:
+		Coefficients = &Bt709;
+		break;
+	}
+
+	const uint8* Uyvy = (const uint8*)Frame.p_data;
+	const uint8* Alpha = (Frame.FourCC == NDIlib_FourCC_type_UYVA) ? Uyvy + Frame.line_stride_in_bytes * Frame.yres : nullptr;
+	const int32 Stride = Frame.line_stride_in_bytes;
+	const int32 Width = Frame.xres;
+	const bool MapGamut = (ColorSpace == ENdiMediaColorSpace::BT2020);
+
+	FNdiMediaParallelRows::ParallelFor(Frame.yres, Stride + Width * 4, MaxThreads, [=](int32 FirstRow, int32 NumRows)
+	{
+		for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+		{
+			uint8* Output = Dest + Row * DestStride;
+
+			ConvertRow(*Coefficients, Uyvy + Row * Stride, (Alpha != nullptr) ? Alpha + Row * Width : nullptr, Output, Width);
+
+			if (MapGamut)
+			{
+				MapGamutRow(Output, Width);
+			}
+		}
+	});
+}
+
+
+bool FNdiMediaColorConverter::IsEnabled() const
+{
+	return (ColorSpace != ENdiMediaColorSpace::Engine);
+}
+
+
+void FNdiMediaColorConverter::SetMode(ENdiMediaColorSpace InColorSpace, ENdiMediaColorRange InColorRange)
+{
+	const bool FullRange = (InColorRange == ENdiMediaColorRange::Full);
+
+	Bt601.Initialize(0.299f, 0.114f, FullRange);
+	Bt709.Initialize(0.2126f, 0.0722f, FullRange);
+	Bt2020.Initialize(0.2627f, 0.0593f, FullRange);
+
+	ColorSpace = InColorSpace;
+}
+
+
+/* FNdiMediaColorConverter implementation
+ *****************************************************************************/
+
+void FNdiMediaColorConverter::FCoefficients::Initialize(float Kr, float Kb, bool FullRange)
+{
+	const float Kg = 1.0f - Kr - Kb;
+	const float One = (float)(1 << FractionBits);
+	const float CScale = FullRange ? One : One * 255.0f / 224.0f;
+
+	YScale = (int16)FMath::RoundToInt(FullRange ? One : One * 255.0f / 219.0f);
+	YOffset = FullRange ? 0 : 16;
+	RV = (int16)FMath::RoundToInt(2.0f * (1.0f - Kr) * CScale);
+	GU = (int16)FMath::RoundToInt(-2.0f * Kb * (1.0f - Kb) / Kg * CScale);
+	GV = (int16)FMath::RoundToInt(-2.0f * Kr * (1.0f - Kr) / Kg * CScale);
+	BU = (int16)FMath::RoundToInt(2.0f * (1.0f - Kb) * CScale);
+
+	// the rounding term is folded into the luma table
+	for (int32 Value = 0; Value < 256; ++Value)
+	{
+		YTable[Value] = YScale * (Value - YOffset) + (1 << (FractionBits - 1));
+		RVTable[Value] = RV * (Value - 128);
+		GUTable[Value] = GU * (Value - 128);
+		GVTable[Value] = GV * (Value - 128);
+		BUTable[Value] = BU * (Value - 128);
+	}
+}
+
+
+void FNdiMediaColorConverter::ConvertRow(const FCoefficients& Coefficients, const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 Width)
+{
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i LowMask = _mm_set1_epi32(0xffff);
+	const __m128i ChromaBias = _mm_set1_epi16(128);
+	const __m128i Opaque = _mm_set1_epi8((char)0xff);
+
+	// coefficient pairs for multiplying (U, V) and (Y, 0)
+	const __m128i YCoefficient = _mm_set1_epi32((uint16)Coefficients.YScale);
+	const __m128i YBase = _mm_set1_epi32((1 << (FractionBits - 1)) - Coefficients.YScale * Coefficients.YOffset);
+	const __m128i RCoefficients = _mm_set1_epi32((int32)((uint32)(uint16)Coefficients.RV << 16));
+	const __m128i GCoefficients = _mm_set1_epi32((int32)((uint32)(uint16)Coefficients.GU | ((uint32)(uint16)Coefficients.GV << 16)));
+	const __m128i BCoefficients = _mm_set1_epi32((uint16)Coefficients.BU);
+
+	for (; Pixel + 8 <= Width; Pixel += 8)
+	{
+		const __m128i Texels = _mm_loadu_si128((const __m128i*)(Uyvy + Pixel * 2));
+		const __m128i Low = _mm_unpacklo_epi8(Texels, Zero);
+		const __m128i High = _mm_unpackhi_epi8(Texels, Zero);
+
+		// (U, V) pairs of the four texels
+		const __m128i Chroma = _mm_sub_epi16(_mm_packs_epi32(_mm_and_si128(Low, LowMask), _mm_and_si128(High, LowMask)), ChromaBias);
+		const __m128i RChroma = _mm_madd_epi16(Chroma, RCoefficients);
+		const __m128i GChroma = _mm_madd_epi16(Chroma, GCoefficients);
+		const __m128i BChroma = _mm_madd_epi16(Chroma, BCoefficients);
+
+		// scaled luma of pixels 0-3 and 4-7
+		const __m128i Luma0 = _mm_add_epi32(_mm_madd_epi16(_mm_srli_epi32(Low, 16), YCoefficient), YBase);
+		const __m128i Luma1 = _mm_add_epi32(_mm_madd_epi16(_mm_srli_epi32(High, 16), YCoefficient), YBase);
+
+		const __m128i R = CombineLumaChroma(Luma0, Luma1, RChroma);
+		const __m128i G = CombineLumaChroma(Luma0, Luma1, GChroma);
+		const __m128i B = CombineLumaChroma(Luma0, Luma1, BChroma);
+		const __m128i A = (Alpha != nullptr) ? _mm_loadl_epi64((const __m128i*)(Alpha + Pixel)) : Opaque;
+
+		// interleave into BGRA
+		const __m128i BG = _mm_unpacklo_epi8(_mm_packus_epi16(B, B), _mm_packus_epi16(G, G));
+		const __m128i RA = _mm_unpacklo_epi8(_mm_packus_epi16(R, R), A);
+
+		_mm_storeu_si128((__m128i*)(Dest + Pixel * 4), _mm_unpacklo_epi16(BG, RA));
+		_mm_storeu_si128((__m128i*)(Dest + Pixel * 4 + 16), _mm_unpackhi_epi16(BG, RA));
+	}
+#endif
+
+	ConvertRowScalar(Coefficients, Uyvy + Pixel * 2, (Alpha != nullptr) ? Alpha + Pixel : nullptr, Dest + Pixel * 4, Width - Pixel);
+}
+
+
+void FNdiMediaColorConverter::ConvertRowScalar(const FCoefficients& Coefficients, const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 Width)
+{
+	for (int32 Pixel = 0; Pixel < Width; Pixel += 2)
+	{
+		const uint8* Texel = Uyvy + Pixel * 2;
+		const int32 U = Texel[0];
+		const int32 V = Texel[2];
+		const int32 RChroma = Coefficients.RVTable[V];
+		const int32 GChroma = Coefficients.GUTable[U] + Coefficients.GVTable[V];
+		const int32 BChroma = Coefficients.BUTable[U];
+
+		// the last texel of odd width rows holds a single pixel
+		const int32 NumPixels = FMath::Min(2, Width - Pixel);
+
+		for (int32 Index = 0; Index < NumPixels; ++Index)
+		{
+			const int32 Luma = Coefficients.YTable[Texel[1 + Index * 2]];
+			uint8* Output = Dest + (Pixel + Index) * 4;
+
+			Output[0] = ClampComponent(Luma + BChroma);
+			Output[1] = ClampComponent(Luma + GChroma);
+			Output[2] = ClampComponent(Luma + RChroma);
+			Output[3] = (Alpha != nullptr) ? Alpha[Pixel + Index] : 255;
+		}
+	}
+}
+
+
+void FNdiMediaColorConverter::MapGamutRow(uint8* Row, int32 Width) const
+{
+	for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+	{
+		uint8* Output = Row + Pixel * 4;
+
+		const int32 R = LinearTable[Output[2]];
+		const int32 G = LinearTable[Output[1]];
+		const int32 B = LinearTable[Output[0]];
+
+		// 16-bit linear values are reduced to 12 bits for the sRGB table
+		const int32 Shift = GamutBits + 4;
+
+		Output[0] = SrgbTable[FMath::Clamp((GamutMatrix[6] * R + GamutMatrix[7] * G + GamutMatrix[8] * B) >> Shift, 0, 4095)];
+		Output[1] = SrgbTable[FMath::Clamp((GamutMatrix[3] * R + GamutMatrix[4] * G + GamutMatrix[5] * B) >> Shift, 0, 4095)];
+		Output[2] = SrgbTable[FMath::Clamp((GamutMatrix[0] * R + GamutMatrix[1] * G + GamutMatrix[2] * B) >> Shift, 0, 4095)];
+	}
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
@@ -0,0 +1,150 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+enum class ENdiMediaColorRange : uint8;
+enum class ENdiMediaColorSpace : uint8;
+struct NDIlib_video_frame_v2_t;
+
+
+/**
+ * Converts 8-bit YUV video frames to sRGB encoded BGRA with a selectable color space and range.
+ *
+ * The conversion uses fixed-point arithmetic with 13 fractional bits. Rows are
+ * converted with SSE2 where available, and with lookup tables otherwise; both
+ * produce identical results. BT.2020 frames are additionally mapped to the BT.709
+ * primaries in linear space.
+ */
+class FNdiMediaColorConverter
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaColorConverter();
+
+public:
+
+	/**
+	 * Convert a frame to BGRA.
+	 *
+	 * @param Frame The frame to convert (must be UYVY or UYVA).
+	 * @param Dest The output buffer (must hold Frame.yres rows).
+	 * @param DestStride Number of bytes per output row.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @see IsEnabled
+	 */
+	void Convert(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads) const;
+
+	/**
+	 * Whether frames should be converted on the CPU.
+	 *
+	 * @return true if enabled, false if the engine converts frames on the GPU.
+	 * @see SetMode
+	 */
+	bool IsEnabled() const;
+
+	/**
+	 * Set the color space and range of received frames.
+	 *
+	 * @param InColorSpace The color space.
+	 * @param InColorRange The color range.
+	 * @see IsEnabled
+	 */
+	void SetMode(ENdiMediaColorSpace InColorSpace, ENdiMediaColorRange InColorRange);
+
+protected:
+
+	/** Fixed-point YUV to RGB coefficients and lookup tables of a color space. */
+	struct FCoefficients
+	{
+		/** Scale of luma. */
+		int16 YScale;
+
+		/** Offset of black in luma. */
+		int16 YOffset;
+
+		/** Contribution of Cr (V) to red. */
+		int16 RV;
+
+		/** Contribution of Cb (U) to green. */
+		int16 GU;
+
+		/** Contribution of Cr (V) to green. */
+		int16 GV;
+
+		/** Contribution of Cb (U) to blue. */
+		int16 BU;
+
+		/** Scaled luma values, including the rounding term. */
+		int32 YTable[256];
+
+		/** Scaled contributions of chroma values. */
+		int32 RVTable[256];
+		int32 GUTable[256];
+		int32 GVTable[256];
+		int32 BUTable[256];
+
+		/**
+		 * Compute the coefficients.
+		 *
+		 * @param Kr Weight of red in luma.
+		 * @param Kb Weight of blue in luma.
+		 * @param FullRange Whether components use the full range of values.
+		 */
+		void Initialize(float Kr, float Kb, bool FullRange);
+	};
+
+	/**
+	 * Convert a row of UYVY texels to BGRA.
+	 *
+	 * @param Coefficients The color space coefficients.
+	 * @param Uyvy The source row.
+	 * @param Alpha The row's alpha values (optional).
+	 * @param Dest The output row.
+	 * @param Width Number of pixels (the last texel holds a single pixel if odd).
+	 * @see ConvertRowScalar
+	 */
+	static void ConvertRow(const FCoefficients& Coefficients, const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 Width);
+
+	/**
+	 * Convert a row of UYVY texels to BGRA without SIMD instructions.
+	 *
+	 * @param Coefficients The color space coefficients.
+	 * @param Uyvy The source row.
+	 * @param Alpha The row's alpha values (optional).
+	 * @param Dest The output row.
+	 * @param Width Number of pixels (the last texel holds a single pixel if odd).
+	 * @see ConvertRow
+	 */
+	static void ConvertRowScalar(const FCoefficients& Coefficients, const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 Width);
+
+	/**
+	 * Map a row of BT.2020 pixels to the BT.709 primaries and the sRGB transfer function.
+	 *
+	 * @param Row The row of BGRA pixels to map in place.
+	 * @param Width Number of pixels.
+	 */
+	void MapGamutRow(uint8* Row, int32 Width) const;
+
+private:
+
+	/** Coefficients for BT.601. */
+	FCoefficients Bt601;
+
+	/** Coefficients for BT.709. */
+	FCoefficients Bt709;
+
+	/** Coefficients for BT.2020. */
+	FCoefficients Bt2020;
+
+	/** The color space of received frames. */
+	ENdiMediaColorSpace ColorSpace;
+
+	/** Maps BT.1886 encoded values to 16-bit linear values. */
+	uint16 LinearTable[256];
+
+	/** Maps 12-bit linear values to sRGB encoded values. */
+	uint8 SrgbTable[4096];
+};
@@ -0,0 +1,190 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaColorPacker.h"
+#include "NdiMediaPrivate.h"
+
+#include "Math/UnrealMathUtility.h"
+#include "Templates/UnrealTemplate.h"
+
+#include "NdiMediaParallelRows.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Number of fractional bits in the RGB to YUV coefficients. */
+static const int32 FractionBits = 15;
+
+/** Offset of black in luma, including the rounding term. */
+static const int32 LumaBias = (16 << FractionBits) + (1 << (FractionBits - 1));
+
+/** Offset of zero in chroma, including the rounding term (chroma is computed from the sum of two pixels). */
+static const int32 ChromaBias = (128 << (FractionBits + 1)) + (1 << FractionBits);
+
+
+#if NDIMEDIA_SSE2
+
+/** Sum up the pairs of 32-bit products of two vectors, returning the first vector's sums followed by the second's. */
+FORCEINLINE __m128i SumProductPairs(__m128i Products0, __m128i Products1)
+{
+	const __m128 Even = _mm_shuffle_ps(_mm_castsi128_ps(Products0), _mm_castsi128_ps(Products1), _MM_SHUFFLE(2, 0, 2, 0));
+	const __m128 Odd = _mm_shuffle_ps(_mm_castsi128_ps(Products0), _mm_castsi128_ps(Products1), _MM_SHUFFLE(3, 1, 3, 1));
+
+	return _mm_add_epi32(_mm_castps_si128(Even), _mm_castps_si128(Odd));
+}
+
+
+/** Sum up the components of the two pixels in a vector of 16-bit components, keeping the result in the lower half. */
+FORCEINLINE __m128i SumPixelPair(__m128i Pixels)
+{
+	return _mm_add_epi16(Pixels, _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+#endif
+
+
+/* FNdiMediaColorPacker structors
+ *****************************************************************************/
+
+FNdiMediaColorPacker::FNdiMediaColorPacker()
+{
+	Bt601.Initialize(0.299f, 0.114f);
+	Bt709.Initialize(0.2126f, 0.0722f);
+}
+
+
+/* FNdiMediaColorPacker interface
+ *****************************************************************************/
+
+void FNdiMediaColorPacker::Pack(const uint8* Data, uint32 Stride, const FIntPoint& Dim, bool Rgba, uint8* Dest, uint32 DestStride, uint8* AlphaDest, int32 MaxThreads) const
+{
+	FCoefficients Coefficients = (Dim.Y < 720) ? Bt601 : Bt709;
+
+	// RGBA pixels are handled by swapping the red and blue coefficients
+	if (Rgba)
+	{
+		Swap(Coefficients.YB, Coefficients.YR);
+		Swap(Coefficients.UB, Coefficients.UR);
+		Swap(Coefficients.VB, Coefficients.VR);
+	}
+
+	const int32 Width = Dim.X & ~1;
+
+	FNdiMediaParallelRows::ParallelFor(Dim.Y, Stride + DestStride, MaxThreads, [&](int32 FirstRow, int32 NumRows)
+	{
+		for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+		{
+			PackRow(Coefficients, Data + Row * Stride, Dest + Row * DestStride, (AlphaDest != nullptr) ? AlphaDest + Row * Dim.X : nullptr, Width);
+		}
+	});
+}
+
+
+/* FNdiMediaColorPacker implementation
+ *****************************************************************************/
+
+void FNdiMediaColorPacker::FCoefficients::Initialize(float Kr, float Kb)
+{
+	const float Kg = 1.0f - Kr - Kb;
+	const float One = (float)(1 << FractionBits);
+	const float YScale = One * 219.0f / 255.0f;
+	const float CScale = One * 224.0f / 255.0f;
+
+	YB = (int16)FMath::RoundToInt(Kb * YScale);
+	YG = (int16)FMath::RoundToInt(Kg * YScale);
+	YR = (int16)FMath::RoundToInt(Kr * YScale);
+
+	UB = (int16)FMath::RoundToInt(0.5f * CScale);
+	UG = (int16)FMath::RoundToInt(-0.5f * Kg / (1.0f - Kb) * CScale);
+	UR = (int16)FMath::RoundToInt(-0.5f * Kr / (1.0f - Kb) * CScale);
+
+	VB = (int16)FMath::RoundToInt(-0.5f * Kb / (1.0f - Kr) * CScale);
+	VG = (int16)FMath::RoundToInt(-0.5f * Kg / (1.0f - Kr) * CScale);
+	VR = (int16)FMath::RoundToInt(0.5f * CScale);
+}
+
+
+void FNdiMediaColorPacker::PackRow(const FCoefficients& Coefficients, const uint8* Bgra, uint8* Uyvy, uint8* Alpha, int32 Width)
+{
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i LumaBiasVector = _mm_set1_epi32(LumaBias);
+	const __m128i ChromaBiasVector = _mm_set1_epi32(ChromaBias);
+
+	// coefficients for multiplying (B, G) and (R, A) of two pixels
+	const __m128i YCoefficients = _mm_setr_epi16(Coefficients.YB, Coefficients.YG, Coefficients.YR, 0, Coefficients.YB, Coefficients.YG, Coefficients.YR, 0);
+	const __m128i UCoefficients = _mm_setr_epi16(Coefficients.UB, Coefficients.UG, Coefficients.UR, 0, Coefficients.UB, Coefficients.UG, Coefficients.UR, 0);
+	const __m128i VCoefficients = _mm_setr_epi16(Coefficients.VB, Coefficients.VG, Coefficients.VR, 0, Coefficients.VB, Coefficients.VG, Coefficients.VR, 0);
+
+	for (; Pixel + 8 <= Width; Pixel += 8)
+	{
+		const __m128i Pixels0 = _mm_loadu_si128((const __m128i*)(Bgra + Pixel * 4));
+		const __m128i Pixels1 = _mm_loadu_si128((const __m128i*)(Bgra + Pixel * 4 + 16));
+
+		// 16-bit components of pixels 0-1, 2-3, 4-5 and 6-7
+		const __m128i Pixels01 = _mm_unpacklo_epi8(Pixels0, Zero);
+		const __m128i Pixels23 = _mm_unpackhi_epi8(Pixels0, Zero);
+		const __m128i Pixels45 = _mm_unpacklo_epi8(Pixels1, Zero);
+		const __m128i Pixels67 = _mm_unpackhi_epi8(Pixels1, Zero);
+
+		// luma of pixels 0-3 and 4-7
+		const __m128i Luma0 = _mm_add_epi32(SumProductPairs(_mm_madd_epi16(Pixels01, YCoefficients), _mm_madd_epi16(Pixels23, YCoefficients)), LumaBiasVector);
+		const __m128i Luma1 = _mm_add_epi32(SumProductPairs(_mm_madd_epi16(Pixels45, YCoefficients), _mm_madd_epi16(Pixels67, YCoefficients)), LumaBiasVector);
+		const __m128i Luma = _mm_packs_epi32(_mm_srai_epi32(Luma0, FractionBits), _mm_srai_epi32(Luma1, FractionBits));
+
+		// summed components of texels 0-1 and 2-3
+		const __m128i Texels01 = _mm_unpacklo_epi64(SumPixelPair(Pixels01), SumPixelPair(Pixels23));
+		const __m128i Texels23 = _mm_unpacklo_epi64(SumPixelPair(Pixels45), SumPixelPair(Pixels67));
+
+		// (U0, U1, V0, V1) and (U2, U3, V2, V3)
+		const __m128i Chroma0 = _mm_add_epi32(SumProductPairs(_mm_madd_epi16(Texels01, UCoefficients), _mm_madd_epi16(Texels01, VCoefficients)), ChromaBiasVector);
+		const __m128i Chroma1 = _mm_add_epi32(SumProductPairs(_mm_madd_epi16(Texels23, UCoefficients), _mm_madd_epi16(Texels23, VCoefficients)), ChromaBiasVector);
+		const __m128i Chroma = _mm_packs_epi32(_mm_srai_epi32(Chroma0, FractionBits + 1), _mm_srai_epi32(Chroma1, FractionBits + 1));
+
+		// interleave into UYVY
+		const __m128i UV = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Chroma, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm_storeu_si128((__m128i*)(Uyvy + Pixel * 2), _mm_packus_epi16(_mm_unpacklo_epi16(UV, Luma), _mm_unpackhi_epi16(UV, Luma)));
+
+		if (Alpha != nullptr)
+		{
+			const __m128i A = _mm_packs_epi32(_mm_srli_epi32(Pixels0, 24), _mm_srli_epi32(Pixels1, 24));
+			_mm_storel_epi64((__m128i*)(Alpha + Pixel), _mm_packus_epi16(A, A));
+		}
+	}
+#endif
+
+	PackRowScalar(Coefficients, Bgra + Pixel * 4, Uyvy + Pixel * 2, (Alpha != nullptr) ? Alpha + Pixel : nullptr, Width - Pixel);
+}
+
+
+void FNdiMediaColorPacker::PackRowScalar(const FCoefficients& Coefficients, const uint8* Bgra, uint8* Uyvy, uint8* Alpha, int32 Width)
+{
+	for (int32 Pixel = 0; Pixel < Width; Pixel += 2)
+	{
+		const uint8* Pixel0 = Bgra + Pixel * 4;
+		const uint8* Pixel1 = Pixel0 + 4;
+		uint8* Output = Uyvy + Pixel * 2;
+
+		const int32 B = Pixel0[0] + Pixel1[0];
+		const int32 G = Pixel0[1] + Pixel1[1];
+		const int32 R = Pixel0[2] + Pixel1[2];
+
+		Output[0] = (uint8)((Coefficients.UB * B + Coefficients.UG * G + Coefficients.UR * R + ChromaBias) >> (FractionBits + 1));
+		Output[1] = (uint8)((Coefficients.YB * Pixel0[0] + Coefficients.YG * Pixel0[1] + Coefficients.YR * Pixel0[2] + LumaBias) >> FractionBits);
+		Output[2] = (uint8)((Coefficients.VB * B + Coefficients.VG * G + Coefficients.VR * R + ChromaBias) >> (FractionBits + 1));
+		Output[3] = (uint8)((Coefficients.YB * Pixel1[0] + Coefficients.YG * Pixel1[1] + Coefficients.YR * Pixel1[2] + LumaBias) >> FractionBits);
+
+		if (Alpha != nullptr)
+		{
+			Alpha[Pixel] = Pixel0[3];
+			Alpha[Pixel + 1] = Pixel1[3];
+		}
+	}
+}
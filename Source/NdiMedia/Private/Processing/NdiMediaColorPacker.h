@@ -0,0 +1,102 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Math/IntPoint.h"
+
+
+/**
+ * Packs sRGB encoded BGRA video frames into limited range 8-bit UYVY, and optionally an alpha plane.
+ *
+ * Sending UYVY instead of BGRA halves the amount of data that NDI's encoder has to
+ * read, and saves its own color conversion. The conversion uses fixed-point arithmetic
+ * with 15 fractional bits, and averages the chroma of each pair of pixels. Rows are
+ * packed with SSE2 where available; the scalar fallback produces identical results.
+ * Frames with less than 720 rows use BT.601, all others BT.709, which matches what
+ * receivers assume, because NDI does not signal the color space.
+ */
+class FNdiMediaColorPacker
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaColorPacker();
+
+public:
+
+	/**
+	 * Pack a frame.
+	 *
+	 * @param Data The source frame.
+	 * @param Stride Number of bytes per row in the source frame.
+	 * @param Dim Dimensions of the source frame (in pixels, width must be even).
+	 * @param Rgba Whether the source pixels are in RGBA instead of BGRA order.
+	 * @param Dest The UYVY output buffer (must hold Dim.Y rows).
+	 * @param DestStride Number of bytes per UYVY output row.
+	 * @param AlphaDest The alpha plane output buffer, with Dim.X bytes per row (optional).
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 */
+	void Pack(const uint8* Data, uint32 Stride, const FIntPoint& Dim, bool Rgba, uint8* Dest, uint32 DestStride, uint8* AlphaDest, int32 MaxThreads) const;
+
+protected:
+
+	/** Fixed-point RGB to YUV coefficients of a color space. */
+	struct FCoefficients
+	{
+		/** Contributions of blue, green and red to luma. */
+		int16 YB;
+		int16 YG;
+		int16 YR;
+
+		/** Contributions of blue, green and red to Cb (U). */
+		int16 UB;
+		int16 UG;
+		int16 UR;
+
+		/** Contributions of blue, green and red to Cr (V). */
+		int16 VB;
+		int16 VG;
+		int16 VR;
+
+		/**
+		 * Compute the coefficients.
+		 *
+		 * @param Kr Weight of red in luma.
+		 * @param Kb Weight of blue in luma.
+		 */
+		void Initialize(float Kr, float Kb);
+	};
+
+	/**
+	 * Pack a row of BGRA pixels.
+	 *
+	 * @param Coefficients The color space coefficients (in BGRA order).
+	 * @param Bgra The source row.
+	 * @param Uyvy The UYVY output row.
+	 * @param Alpha The alpha output row (optional).
+	 * @param Width Number of pixels (must be even).
+	 * @see PackRowScalar
+	 */
+	static void PackRow(const FCoefficients& Coefficients, const uint8* Bgra, uint8* Uyvy, uint8* Alpha, int32 Width);
+
+	/**
+	 * Pack a row of BGRA pixels without SIMD instructions.
+	 *
+	 * @param Coefficients The color space coefficients (in BGRA order).
+	 * @param Bgra The source row.
+	 * @param Uyvy The UYVY output row.
+	 * @param Alpha The alpha output row (optional).
+	 * @param Width Number of pixels (must be even).
+	 * @see PackRow
+	 */
+	static void PackRowScalar(const FCoefficients& Coefficients, const uint8* Bgra, uint8* Uyvy, uint8* Alpha, int32 Width);
+
+private:
+
+	/** Coefficients for BT.601. */
+	FCoefficients Bt601;
+
+	/** Coefficients for BT.709. */
+	FCoefficients Bt709;
+};
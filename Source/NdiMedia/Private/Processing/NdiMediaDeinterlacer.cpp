@@ -0,0 +1,207 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaDeinterlacer.h"
+#include "NdiMediaPrivate.h"
+
+#include "HAL/UnrealMemory.h"
+#include "Math/UnrealMathUtility.h"
+
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaSource.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+/** Maximum change of a byte between frames that is not considered motion. */
+static const uint8 MotionThreshold = 12;
+
+
+/* FNdiMediaDeinterlacer structors
+ *****************************************************************************/
+
+FNdiMediaDeinterlacer::FNdiMediaDeinterlacer()
+	: ExpectedField(0)
+	, FieldRate(false)
+	, Mode(ENdiMediaDeinterlaceMode::None)
+	, PreviousRowBytes(0)
+	, PreviousRows(0)
+	, WovenRowBytes(0)
+	, WovenFieldRows(0)
+{ }
+
+
+/* FNdiMediaDeinterlacer interface
+ *****************************************************************************/
+
+bool FNdiMediaDeinterlacer::AddField(const uint8* Data, uint32 Stride, int32 RowBytes, int32 NumFieldRows, int32 Field)
+{
+	// restart if the fields don't match
+	if ((Field != ExpectedField) || (RowBytes != WovenRowBytes) || (NumFieldRows != WovenFieldRows))
+	{
+		if (Field != 0)
+		{
+			ExpectedField = 0;
+
+			return false;
+		}
+
+		WovenFrame.SetNumUninitialized(RowBytes * NumFieldRows * 2);
+		WovenRowBytes = RowBytes;
+		WovenFieldRows = NumFieldRows;
+	}
+
+	uint8* Dest = WovenFrame.GetData() + Field * RowBytes;
+
+	for (int32 Row = 0; Row < NumFieldRows; ++Row)
+	{
+		FMemory::Memcpy(Dest, Data, RowBytes);
+
+		Data += Stride;
+		Dest += RowBytes * 2;
+	}
+
+	ExpectedField = 1 - Field;
+
+	return (Field == 1);
+}
+
+
+void FNdiMediaDeinterlacer::Deinterlace(const uint8* Data, uint32 Stride, int32 RowBytes, int32 NumRows, int32 Field, uint8* Dest, uint32 DestStride, int32 MaxThreads) const
+{
+	const bool Adaptive = (Mode == ENdiMediaDeinterlaceMode::MotionAdaptive) && (PreviousRowBytes == RowBytes) && (PreviousRows == NumRows);
+	const bool Weave = (Mode == ENdiMediaDeinterlaceMode::Weave);
+	const uint8* Previous = PreviousFrame.GetData();
+
+	FNdiMediaParallelRows::ParallelFor(NumRows, RowBytes * 3, MaxThreads, [=](int32 FirstRow, int32 NumBandRows)
+	{
+		for (int32 Row = FirstRow; Row < FirstRow + NumBandRows; ++Row)
+		{
+			const uint8* Current = Data + Row * Stride;
+			uint8* Output = Dest + Row * DestStride;
+
+			if (((Row & 1) == Field) || Weave)
+			{
+				FMemory::Memcpy(Output, Current, RowBytes);
+				continue;
+			}
+
+			// reconstruct rows of the other field from the rows of the kept field
+			const int32 AboveRow = (Row > 0) ? Row - 1 : Row + 1;
+			const int32 BelowRow = (Row + 1 < NumRows) ? Row + 1 : AboveRow;
+			const uint8* Above = Data + AboveRow * Stride;
+			const uint8* Below = Data + BelowRow * Stride;
+
+			if (Adaptive)
+			{
+				AdaptiveRow(Above, Below, Current, Previous + Row * RowBytes, Output, RowBytes);
+			}
+			else
+			{
+				InterpolateRow(Above, Below, Output, RowBytes);
+			}
+		}
+	});
+}
+
+
+void FNdiMediaDeinterlacer::FinishFrame(const uint8* Data, uint32 Stride, int32 RowBytes, int32 NumRows)
+{
+	if (Mode != ENdiMediaDeinterlaceMode::MotionAdaptive)
+	{
+		return;
+	}
+
+	PreviousFrame.SetNumUninitialized(RowBytes * NumRows);
+	PreviousRowBytes = RowBytes;
+	PreviousRows = NumRows;
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		FMemory::Memcpy(PreviousFrame.GetData() + Row * RowBytes, Data + Row * Stride, RowBytes);
+	}
+}
+
+
+bool FNdiMediaDeinterlacer::IsEnabled() const
+{
+	return (Mode != ENdiMediaDeinterlaceMode::None);
+}
+
+
+void FNdiMediaDeinterlacer::Reset()
+{
+	ExpectedField = 0;
+	PreviousFrame.Empty();
+	PreviousRowBytes = 0;
+	PreviousRows = 0;
+	WovenFrame.Empty();
+	WovenRowBytes = 0;
+	WovenFieldRows = 0;
+}
+
+
+void FNdiMediaDeinterlacer::SetMode(ENdiMediaDeinterlaceMode InMode, bool InFieldRate)
+{
+	FieldRate = InFieldRate && (InMode != ENdiMediaDeinterlaceMode::Weave);
+	Mode = InMode;
+
+	Reset();
+}
+
+
+/* FNdiMediaDeinterlacer implementation
+ *****************************************************************************/
+
+void FNdiMediaDeinterlacer::AdaptiveRow(const uint8* Above, const uint8* Below, const uint8* Current, const uint8* Previous, uint8* Dest, int32 NumBytes)
+{
+	int32 Byte = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128i Threshold = _mm_set1_epi8((char)MotionThreshold);
+	const __m128i Zero = _mm_setzero_si128();
+
+	for (; Byte + 16 <= NumBytes; Byte += 16)
+	{
+		const __m128i A = _mm_loadu_si128((const __m128i*)(Above + Byte));
+		const __m128i B = _mm_loadu_si128((const __m128i*)(Below + Byte));
+		const __m128i C = _mm_loadu_si128((const __m128i*)(Current + Byte));
+		const __m128i P = _mm_loadu_si128((const __m128i*)(Previous + Byte));
+
+		// static bytes have an absolute difference no greater than the threshold
+		const __m128i Difference = _mm_or_si128(_mm_subs_epu8(C, P), _mm_subs_epu8(P, C));
+		const __m128i Static = _mm_cmpeq_epi8(_mm_subs_epu8(Difference, Threshold), Zero);
+		const __m128i Interpolated = _mm_avg_epu8(A, B);
+
+		_mm_storeu_si128((__m128i*)(Dest + Byte), _mm_or_si128(_mm_and_si128(Static, C), _mm_andnot_si128(Static, Interpolated)));
+	}
+#endif
+
+	for (; Byte < NumBytes; ++Byte)
+	{
+		const bool IsStatic = (FMath::Abs((int32)Current[Byte] - (int32)Previous[Byte]) <= MotionThreshold);
+		Dest[Byte] = IsStatic ? Current[Byte] : (uint8)((Above[Byte] + Below[Byte] + 1) >> 1);
+	}
+}
+
+
+void FNdiMediaDeinterlacer::InterpolateRow(const uint8* Above, const uint8* Below, uint8* Dest, int32 NumBytes)
+{
+	int32 Byte = 0;
+
+#if NDIMEDIA_SSE2
+	for (; Byte + 16 <= NumBytes; Byte += 16)
+	{
+		const __m128i A = _mm_loadu_si128((const __m128i*)(Above + Byte));
+		const __m128i B = _mm_loadu_si128((const __m128i*)(Below + Byte));
+
+		_mm_storeu_si128((__m128i*)(Dest + Byte), _mm_avg_epu8(A, B));
+	}
+#endif
+
+	for (; Byte < NumBytes; ++Byte)
+	{
+		Dest[Byte] = (uint8)((Above[Byte] + Below[Byte] + 1) >> 1);
+	}
+}
@@ -0,0 +1,169 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+
+enum class ENdiMediaDeinterlaceMode : uint8;
+
+
+/**
+ * Deinterlaces fielded video frames.
+ *
+ * The deinterlacer operates on rows of bytes, so it supports all packed pixel formats
+ * in which vertically adjacent bytes hold the same component, such as UYVY and BGRA.
+ * Frames that are received as separate fields are woven into full frames first.
+ *
+ * This class is not thread-safe.
+ */
+class FNdiMediaDeinterlacer
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaDeinterlacer();
+
+public:
+
+	/**
+	 * Add a single field of a frame.
+	 *
+	 * @param Data The field's rows.
+	 * @param Stride Number of bytes per row in the field.
+	 * @param RowBytes Number of bytes per row to copy.
+	 * @param NumFieldRows Number of rows in the field.
+	 * @param Field The field index (0 = even rows, 1 = odd rows).
+	 * @return true if both fields of the frame are available, false otherwise.
+	 * @see GetWovenFrame
+	 */
+	bool AddField(const uint8* Data, uint32 Stride, int32 RowBytes, int32 NumFieldRows, int32 Field);
+
+	/**
+	 * Create a progressive frame from an interleaved frame.
+	 *
+	 * The rows of the given field are copied, and the rows of the other field are
+	 * reconstructed according to the deinterlace mode.
+	 *
+	 * @param Data The interleaved frame.
+	 * @param Stride Number of bytes per row in the interleaved frame.
+	 * @param RowBytes Number of bytes per row to process.
+	 * @param NumRows Number of rows in the frame.
+	 * @param Field The field to keep (0 = even rows, 1 = odd rows).
+	 * @param Dest The output buffer.
+	 * @param DestStride Number of bytes per row in the output buffer.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @see FinishFrame
+	 */
+	void Deinterlace(const uint8* Data, uint32 Stride, int32 RowBytes, int32 NumRows, int32 Field, uint8* Dest, uint32 DestStride, int32 MaxThreads) const;
+
+	/**
+	 * Remember the given interleaved frame for motion detection in the next frame.
+	 *
+	 * @param Data The interleaved frame.
+	 * @param Stride Number of bytes per row in the interleaved frame.
+	 * @param RowBytes Number of bytes per row to remember.
+	 * @param NumRows Number of rows in the frame.
+	 * @see Deinterlace
+	 */
+	void FinishFrame(const uint8* Data, uint32 Stride, int32 RowBytes, int32 NumRows);
+
+	/**
+	 * Get the number of progressive frames to create per interleaved frame.
+	 *
+	 * @return 2 for field rate output, 1 otherwise.
+	 */
+	int32 GetNumOutputFrames() const
+	{
+		return FieldRate ? 2 : 1;
+	}
+
+	/**
+	 * Get the frame that was woven from separate fields.
+	 *
+	 * The frame has a stride of RowBytes and twice the number of field rows.
+	 *
+	 * @return The woven frame.
+	 * @see AddField
+	 */
+	const uint8* GetWovenFrame() const
+	{
+		return WovenFrame.GetData();
+	}
+
+	/**
+	 * Whether deinterlacing is enabled.
+	 *
+	 * @return true if enabled, false otherwise.
+	 * @see SetMode
+	 */
+	bool IsEnabled() const;
+
+	/** Discard all buffered fields and frames. */
+	void Reset();
+
+	/**
+	 * Set the deinterlace mode.
+	 *
+	 * @param InMode The deinterlace mode.
+	 * @param InFieldRate Whether to create one progressive frame per field.
+	 * @see IsEnabled
+	 */
+	void SetMode(ENdiMediaDeinterlaceMode InMode, bool InFieldRate);
+
+protected:
+
+	/**
+	 * Reconstruct a row from its neighbors and the same row in the previous frame.
+	 *
+	 * Bytes that changed by no more than the motion threshold since the previous frame
+	 * are woven, and all other bytes are interpolated.
+	 *
+	 * @param Above The row above.
+	 * @param Below The row below.
+	 * @param Current The row in the current frame.
+	 * @param Previous The row in the previous frame.
+	 * @param Dest The output row.
+	 * @param NumBytes Number of bytes per row.
+	 */
+	static void AdaptiveRow(const uint8* Above, const uint8* Below, const uint8* Current, const uint8* Previous, uint8* Dest, int32 NumBytes);
+
+	/**
+	 * Reconstruct a row by averaging its neighbors.
+	 *
+	 * @param Above The row above.
+	 * @param Below The row below.
+	 * @param Dest The output row.
+	 * @param NumBytes Number of bytes per row.
+	 */
+	static void InterpolateRow(const uint8* Above, const uint8* Below, uint8* Dest, int32 NumBytes);
+
+private:
+
+	/** Index of the field that is expected next when weaving separate fields. */
+	int32 ExpectedField;
+
+	/** Whether to create one progressive frame per field. */
+	bool FieldRate;
+
+	/** The deinterlace mode. */
+	ENdiMediaDeinterlaceMode Mode;
+
+	/** The previous interleaved frame (only used for motion adaptive deinterlacing). */
+	TArray<uint8> PreviousFrame;
+
+	/** Number of bytes per row in the previous frame. */
+	int32 PreviousRowBytes;
+
+	/** Number of rows in the previous frame. */
+	int32 PreviousRows;
+
+	/** Frame that is being woven from separate fields. */
+	TArray<uint8> WovenFrame;
+
+	/** Number of bytes per row in the woven frame. */
+	int32 WovenRowBytes;
+
+	/** Number of field rows in the woven frame. */
+	int32 WovenFieldRows;
+};
@@ -0,0 +1,289 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaDownscaler.h"
+#include "NdiMediaPrivate.h"
+
+#include "Containers/Array.h"
+#include "IMediaTextureSample.h"
+#include "Templates/AlignmentTemplates.h"
+
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaSource.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+/* FNdiMediaDownscaler structors
+ *****************************************************************************/
+
+FNdiMediaDownscaler::FNdiMediaDownscaler()
+	: Bilinear(false)
+	, Factor(1)
+{ }
+
+
+/* FNdiMediaDownscaler interface
+ *****************************************************************************/
+
+void FNdiMediaDownscaler::Downscale(const uint8* Data, uint32 Stride, const FIntPoint& Dim, EMediaTextureSampleFormat SampleFormat, uint8* Dest, uint32 DestStride, int32 MaxThreads)
+{
+	check((SampleFormat == EMediaTextureSampleFormat::CharBGRA) || (SampleFormat == EMediaTextureSampleFormat::CharUYVY));
+
+	const bool Uyvy = (SampleFormat == EMediaTextureSampleFormat::CharUYVY);
+	const FIntPoint OutputDim = GetOutputDim(Dim, SampleFormat);
+	const int32 RowBytes = Uyvy ? Dim.X * 2 : Dim.X * 4;
+	const int32 NumOutputUnits = Uyvy ? OutputDim.X / 2 : OutputDim.X;
+	const int32 LocalFactor = Factor;
+	const bool LocalBilinear = Bilinear;
+
+	// each thread needs a vertically averaged row and a horizontally halved row
+	const int32 ScratchRowBytes = Align(RowBytes, 64);
+
+	FNdiMediaParallelRows::ParallelFor(OutputDim.Y, RowBytes * LocalFactor, MaxThreads, ScratchRowBytes * 2, Scratch, [=](int32 FirstRow, int32 NumRows, uint8* ThreadScratch)
+	{
+		uint8* Vertical = ThreadScratch;
+		uint8* Horizontal = ThreadScratch + ScratchRowBytes;
+
+		for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+		{
+			const uint8* Source = Data + Row * LocalFactor * Stride;
+			uint8* Output = Dest + Row * DestStride;
+
+			// average rows
+			if (LocalFactor == 2)
+			{
+				AverageRows(Source, Source + Stride, Vertical, RowBytes);
+			}
+			else if (LocalBilinear)
+			{
+				AverageRows(Source + Stride, Source + 2 * Stride, Vertical, RowBytes);
+			}
+			else
+			{
+				AverageRows(Source, Source + Stride, Vertical, RowBytes);
+				AverageRows(Source + 2 * Stride, Source + 3 * Stride, Horizontal, RowBytes);
+				AverageRows(Vertical, Horizontal, Vertical, RowBytes);
+			}
+
+			// average columns
+			if (Uyvy)
+			{
+				if (LocalFactor == 2)
+				{
+					HalveUyvyRow(Vertical, Output, NumOutputUnits);
+				}
+				else
+				{
+					HalveUyvyRow(Vertical, Horizontal, NumOutputUnits * 2);
+					HalveUyvyRow(Horizontal, Output, NumOutputUnits);
+				}
+			}
+			else if (LocalFactor == 2)
+			{
+				HalveBgraRow(Vertical, Output, NumOutputUnits);
+			}
+			else if (LocalBilinear)
+			{
+				AverageCenterBgraPixels(Vertical, Output, NumOutputUnits);
+			}
+			else
+			{
+				HalveBgraRow(Vertical, Horizontal, NumOutputUnits * 2);
+				HalveBgraRow(Horizontal, Output, NumOutputUnits);
+			}
+		}
+	});
+}
+
+
+FIntPoint FNdiMediaDownscaler::GetOutputDim(const FIntPoint& Dim, EMediaTextureSampleFormat SampleFormat) const
+{
+	FIntPoint OutputDim(Dim.X / Factor, Dim.Y / Factor);
+
+	// UYVY texels hold two pixels
+	if (SampleFormat == EMediaTextureSampleFormat::CharUYVY)
+	{
+		OutputDim.X &= ~1;
+	}
+
+	return OutputDim;
+}
+
+
+void FNdiMediaDownscaler::SetMode(ENdiMediaDownscale Downscale, ENdiMediaDownscaleFilter Filter)
+{
+	switch (Downscale)
+	{
+	case ENdiMediaDownscale::Half:
+		Factor = 2;
+		break;
+
+	case ENdiMediaDownscale::Quarter:
+		Factor = 4;
+		break;
+
+	default:
+		Factor = 1;
+	}
+
+	Bilinear = (Filter == ENdiMediaDownscaleFilter::Bilinear);
+}
+
+
+/* FNdiMediaDownscaler implementation
+ *****************************************************************************/
+
+void FNdiMediaDownscaler::AverageCenterBgraPixels(const uint8* Row, uint8* Dest, int32 NumOutputPixels)
+{
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	for (; Pixel + 4 <= NumOutputPixels; Pixel += 4)
+	{
+		const uint8* Groups = Row + Pixel * 16;
+
+		const __m128 Group0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Groups)));
+		const __m128 Group1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Groups + 16)));
+		const __m128 Group2 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Groups + 32)));
+		const __m128 Group3 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Groups + 48)));
+
+		// gather the center pixels of each group, then separate the left and right ones
+		const __m128 Center01 = _mm_shuffle_ps(Group0, Group1, _MM_SHUFFLE(2, 1, 2, 1));
+		const __m128 Center23 = _mm_shuffle_ps(Group2, Group3, _MM_SHUFFLE(2, 1, 2, 1));
+		const __m128i Left = _mm_castps_si128(_mm_shuffle_ps(Center01, Center23, _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i Right = _mm_castps_si128(_mm_shuffle_ps(Center01, Center23, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		_mm_storeu_si128((__m128i*)(Dest + Pixel * 4), _mm_avg_epu8(Left, Right));
+	}
+#endif
+
+	AverageCenterBgraPixelsScalar(Row + Pixel * 16, Dest + Pixel * 4, NumOutputPixels - Pixel);
+}
+
+
+void FNdiMediaDownscaler::AverageCenterBgraPixelsScalar(const uint8* Row, uint8* Dest, int32 NumOutputPixels)
+{
+	for (int32 Pixel = 0; Pixel < NumOutputPixels; ++Pixel)
+	{
+		const uint8* Source = Row + Pixel * 16 + 4;
+		uint8* Output = Dest + Pixel * 4;
+
+		for (int32 Component = 0; Component < 4; ++Component)
+		{
+			Output[Component] = (uint8)((Source[Component] + Source[Component + 4] + 1) >> 1);
+		}
+	}
+}
+
+
+void FNdiMediaDownscaler::AverageRows(const uint8* Row0, const uint8* Row1, uint8* Dest, int32 NumBytes)
+{
+	int32 Byte = 0;
+
+#if NDIMEDIA_SSE2
+	for (; Byte + 16 <= NumBytes; Byte += 16)
+	{
+		const __m128i A = _mm_loadu_si128((const __m128i*)(Row0 + Byte));
+		const __m128i B = _mm_loadu_si128((const __m128i*)(Row1 + Byte));
+
+		_mm_storeu_si128((__m128i*)(Dest + Byte), _mm_avg_epu8(A, B));
+	}
+#endif
+
+	AverageRowsScalar(Row0 + Byte, Row1 + Byte, Dest + Byte, NumBytes - Byte);
+}
+
+
+void FNdiMediaDownscaler::AverageRowsScalar(const uint8* Row0, const uint8* Row1, uint8* Dest, int32 NumBytes)
+{
+	for (int32 Byte = 0; Byte < NumBytes; ++Byte)
+	{
+		Dest[Byte] = (uint8)((Row0[Byte] + Row1[Byte] + 1) >> 1);
+	}
+}
+
+
+void FNdiMediaDownscaler::HalveBgraRow(const uint8* Row, uint8* Dest, int32 NumOutputPixels)
+{
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	for (; Pixel + 4 <= NumOutputPixels; Pixel += 4)
+	{
+		const __m128 A = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Row + Pixel * 8)));
+		const __m128 B = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Row + Pixel * 8 + 16)));
+
+		// separate even and odd pixels
+		const __m128i Even = _mm_castps_si128(_mm_shuffle_ps(A, B, _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i Odd = _mm_castps_si128(_mm_shuffle_ps(A, B, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		_mm_storeu_si128((__m128i*)(Dest + Pixel * 4), _mm_avg_epu8(Even, Odd));
+	}
+#endif
+
+	HalveBgraRowScalar(Row + Pixel * 8, Dest + Pixel * 4, NumOutputPixels - Pixel);
+}
+
+
+void FNdiMediaDownscaler::HalveBgraRowScalar(const uint8* Row, uint8* Dest, int32 NumOutputPixels)
+{
+	for (int32 Pixel = 0; Pixel < NumOutputPixels; ++Pixel)
+	{
+		const uint8* Source = Row + Pixel * 8;
+		uint8* Output = Dest + Pixel * 4;
+
+		for (int32 Component = 0; Component < 4; ++Component)
+		{
+			Output[Component] = (uint8)((Source[Component] + Source[Component + 4] + 1) >> 1);
+		}
+	}
+}
+
+
+void FNdiMediaDownscaler::HalveUyvyRow(const uint8* Row, uint8* Dest, int32 NumOutputTexels)
+{
+	int32 Texel = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128i ChromaMask = _mm_set1_epi32(0x00ff00ff);
+	const __m128i Luma0Mask = _mm_set1_epi32(0x0000ff00);
+	const __m128i Luma1Mask = _mm_set1_epi32((int32)0xff000000);
+
+	for (; Texel + 4 <= NumOutputTexels; Texel += 4)
+	{
+		const __m128 A = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Row + Texel * 8)));
+		const __m128 B = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(Row + Texel * 8 + 16)));
+
+		// separate even and odd texels
+		const __m128i Even = _mm_castps_si128(_mm_shuffle_ps(A, B, _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i Odd = _mm_castps_si128(_mm_shuffle_ps(A, B, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		// chroma of both texels, luma of the even texel's pixels, luma of the odd texel's pixels
+		const __m128i Chroma = _mm_and_si128(_mm_avg_epu8(Even, Odd), ChromaMask);
+		const __m128i Luma0 = _mm_and_si128(_mm_avg_epu8(Even, _mm_srli_epi32(Even, 16)), Luma0Mask);
+		const __m128i Luma1 = _mm_and_si128(_mm_avg_epu8(Odd, _mm_slli_epi32(Odd, 16)), Luma1Mask);
+
+		_mm_storeu_si128((__m128i*)(Dest + Texel * 4), _mm_or_si128(Chroma, _mm_or_si128(Luma0, Luma1)));
+	}
+#endif
+
+	HalveUyvyRowScalar(Row + Texel * 8, Dest + Texel * 4, NumOutputTexels - Texel);
+}
+
+
+void FNdiMediaDownscaler::HalveUyvyRowScalar(const uint8* Row, uint8* Dest, int32 NumOutputTexels)
+{
+	for (int32 Texel = 0; Texel < NumOutputTexels; ++Texel)
+	{
+		const uint8* Even = Row + Texel * 8;
+		const uint8* Odd = Even + 4;
+		uint8* Output = Dest + Texel * 4;
+
+		Output[0] = (uint8)((Even[0] + Odd[0] + 1) >> 1);
+		Output[1] = (uint8)((Even[1] + Even[3] + 1) >> 1);
+		Output[2] = (uint8)((Even[2] + Odd[2] + 1) >> 1);
+		Output[3] = (uint8)((Odd[1] + Odd[3] + 1) >> 1);
+	}
+}
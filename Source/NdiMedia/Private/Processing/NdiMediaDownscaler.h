@@ -0,0 +1,171 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Math/IntPoint.h"
+
+enum class EMediaTextureSampleFormat;
+enum class ENdiMediaDownscale : uint8;
+enum class ENdiMediaDownscaleFilter : uint8;
+
+
+/**
+ * Reduces the resolution of BGRA and UYVY video frames by a factor of two or four.
+ *
+ * The box filter averages all source pixels of an output pixel, and the bilinear filter
+ * averages the 2x2 source pixels closest to the output pixel's center, which is cheaper
+ * for a factor of four, but aliases more. Both filters are identical for a factor of two.
+ * UYVY frames are always box filtered horizontally, because pixel pairs share chroma.
+ *
+ * The rows of each frame are processed in parallel, using scratch rows that are kept
+ * between frames, so instances must not be used by multiple threads at the same time.
+ */
+class FNdiMediaDownscaler
+{
+public:
+
+	/** Default constructor. */
+	FNdiMediaDownscaler();
+
+public:
+
+	/**
+	 * Downscale a frame.
+	 *
+	 * @param Data The source frame.
+	 * @param Stride Number of bytes per row in the source frame.
+	 * @param Dim Dimensions of the source frame (in pixels).
+	 * @param SampleFormat The pixel format (must be BGRA or UYVY).
+	 * @param Dest The output buffer.
+	 * @param DestStride Number of bytes per row in the output buffer.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @see GetOutputDim
+	 */
+	void Downscale(const uint8* Data, uint32 Stride, const FIntPoint& Dim, EMediaTextureSampleFormat SampleFormat, uint8* Dest, uint32 DestStride, int32 MaxThreads);
+
+	/**
+	 * Get the dimensions of a downscaled frame.
+	 *
+	 * @param Dim Dimensions of the source frame (in pixels).
+	 * @param SampleFormat The pixel format.
+	 * @return Output dimensions (in pixels).
+	 */
+	FIntPoint GetOutputDim(const FIntPoint& Dim, EMediaTextureSampleFormat SampleFormat) const;
+
+	/**
+	 * Whether downscaling is enabled.
+	 *
+	 * @return true if enabled, false otherwise.
+	 * @see SetMode
+	 */
+	bool IsEnabled() const
+	{
+		return (Factor > 1);
+	}
+
+	/**
+	 * Set the downscale mode.
+	 *
+	 * @param Downscale The downscale factor.
+	 * @param Filter The downscale filter.
+	 * @see IsEnabled
+	 */
+	void SetMode(ENdiMediaDownscale Downscale, ENdiMediaDownscaleFilter Filter);
+
+protected:
+
+	/**
+	 * Average the two center pixels of each group of four BGRA pixels.
+	 *
+	 * @param Row The source row.
+	 * @param Dest The output row.
+	 * @param NumOutputPixels Number of output pixels.
+	 * @see AverageCenterBgraPixelsScalar
+	 */
+	static void AverageCenterBgraPixels(const uint8* Row, uint8* Dest, int32 NumOutputPixels);
+
+	/**
+	 * Average the two center pixels of each group of four BGRA pixels without SIMD instructions.
+	 *
+	 * @param Row The source row.
+	 * @param Dest The output row.
+	 * @param NumOutputPixels Number of output pixels.
+	 * @see AverageCenterBgraPixels
+	 */
+	static void AverageCenterBgraPixelsScalar(const uint8* Row, uint8* Dest, int32 NumOutputPixels);
+
+	/**
+	 * Average two rows of bytes.
+	 *
+	 * @param Row0 The first row.
+	 * @param Row1 The second row.
+	 * @param Dest The output row (may be one of the source rows).
+	 * @param NumBytes Number of bytes per row.
+	 * @see AverageRowsScalar
+	 */
+	static void AverageRows(const uint8* Row0, const uint8* Row1, uint8* Dest, int32 NumBytes);
+
+	/**
+	 * Average two rows of bytes without SIMD instructions.
+	 *
+	 * @param Row0 The first row.
+	 * @param Row1 The second row.
+	 * @param Dest The output row (may be one of the source rows).
+	 * @param NumBytes Number of bytes per row.
+	 * @see AverageRows
+	 */
+	static void AverageRowsScalar(const uint8* Row0, const uint8* Row1, uint8* Dest, int32 NumBytes);
+
+	/**
+	 * Halve the width of a row of BGRA pixels.
+	 *
+	 * @param Row The source row.
+	 * @param Dest The output row.
+	 * @param NumOutputPixels Number of output pixels.
+	 * @see HalveBgraRowScalar
+	 */
+	static void HalveBgraRow(const uint8* Row, uint8* Dest, int32 NumOutputPixels);
+
+	/**
+	 * Halve the width of a row of BGRA pixels without SIMD instructions.
+	 *
+	 * @param Row The source row.
+	 * @param Dest The output row.
+	 * @param NumOutputPixels Number of output pixels.
+	 * @see HalveBgraRow
+	 */
+	static void HalveBgraRowScalar(const uint8* Row, uint8* Dest, int32 NumOutputPixels);
+
+	/**
+	 * Halve the width of a row of UYVY texels.
+	 *
+	 * @param Row The source row.
+	 * @param Dest The output row.
+	 * @param NumOutputTexels Number of output texels (two pixels each).
+	 * @see HalveUyvyRowScalar
+	 */
+	static void HalveUyvyRow(const uint8* Row, uint8* Dest, int32 NumOutputTexels);
+
+	/**
+	 * Halve the width of a row of UYVY texels without SIMD instructions.
+	 *
+	 * @param Row The source row.
+	 * @param Dest The output row.
+	 * @param NumOutputTexels Number of output texels (two pixels each).
+	 * @see HalveUyvyRow
+	 */
+	static void HalveUyvyRowScalar(const uint8* Row, uint8* Dest, int32 NumOutputTexels);
+
+private:
+
+	/** Whether to use a bilinear instead of a box filter. */
+	bool Bilinear;
+
+	/** The downscale factor (1, 2 or 4). */
+	int32 Factor;
+
+	/** Scratch rows of the threads that downscale a frame. */
+	TArray<uint8> Scratch;
+};
@@ -0,0 +1,272 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaFrameHash.h"
+#include "NdiMediaPrivate.h"
+
+#include "HAL/UnrealMemory.h"
+#include "Math/UnrealMathUtility.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Number of 64-bit accumulators (one stripe of 64 bytes). */
+static const int32 NumAccumulators = 8;
+
+/** Number of stripes after which the accumulators are scrambled. */
+static const int32 StripesPerBlock = 16;
+
+/** Number of bytes per stripe. */
+static const int32 StripeBytes = 64;
+
+/** Multiplier for scrambling the accumulators. */
+static const uint32 ScramblePrime = 0x9e3779b1;
+
+/**
+ * Pseudo-random keys.
+ *
+ * Each stripe of a block is combined with a different window of keys, so that the
+ * hash depends on the position of the data within the block.
+ */
+static const uint64 Secret[StripesPerBlock + NumAccumulators] =
+{
+	0xaba35d4b358976b7, 0x5dc4ccf2304bccb8, 0x27a40f7157d35164, 0xbba3266de5cd7212,
+	0xfa0bb79a2a6e42b3, 0xe7f2277e41c665a6, 0x586f2e249f4665be, 0x316fd9ed0ae029d2,
+	0x3271694daf111091, 0xa70210866d1c43ca, 0x99916cf4a329b4a7, 0xf23a3148a4c8e6c4,
+	0x5ee7da7114c7ef0f, 0x1bfeeda80dbec04d, 0x14e1f4f9424425e7, 0x3e7d0fc8fdc65722,
+	0x1551f32bcf821842, 0x16ae767c726fb807, 0x9ab1ec0ed2d05fb6, 0x02c409082ee8cdb8,
+	0xf53cb7f47a554ba6, 0x5a533ff815420d11, 0xd5acb962f701f37b, 0x6622bcc0398a9130,
+};
+
+
+#if NDIMEDIA_SSE2
+
+/** Add a stripe of 64 bytes to the accumulators. */
+FORCEINLINE void AccumulateStripe(__m128i* Acc, const uint8* Stripe, const uint64* Keys)
+{
+	for (int32 Lane = 0; Lane < 4; ++Lane)
+	{
+		const __m128i Data = _mm_loadu_si128((const __m128i*)(Stripe + Lane * 16));
+		const __m128i DataKey = _mm_xor_si128(Data, _mm_loadu_si128((const __m128i*)(Keys + Lane * 2)));
+
+		// multiply low and high halves of each keyed value, add data to neighboring accumulator
+		const __m128i Product = _mm_mul_epu32(DataKey, _mm_shuffle_epi32(DataKey, _MM_SHUFFLE(2, 3, 0, 1)));
+		const __m128i Swapped = _mm_shuffle_epi32(Data, _MM_SHUFFLE(1, 0, 3, 2));
+
+		Acc[Lane] = _mm_add_epi64(Acc[Lane], _mm_add_epi64(Product, Swapped));
+	}
+}
+
+/** Mix the accumulators, so that the order of blocks and rows matters. */
+FORCEINLINE void ScrambleAccumulators(__m128i* Acc, const uint64* Keys)
+{
+	const __m128i Prime = _mm_set1_epi32(ScramblePrime);
+
+	for (int32 Lane = 0; Lane < 4; ++Lane)
+	{
+		__m128i Value = _mm_xor_si128(Acc[Lane], _mm_srli_epi64(Acc[Lane], 47));
+		Value = _mm_xor_si128(Value, _mm_loadu_si128((const __m128i*)(Keys + Lane * 2)));
+
+		// 64 x 32 bit multiplication
+		const __m128i Low = _mm_mul_epu32(Value, Prime);
+		const __m128i High = _mm_mul_epu32(_mm_srli_epi64(Value, 32), Prime);
+
+		Acc[Lane] = _mm_add_epi64(Low, _mm_slli_epi64(High, 32));
+	}
+}
+
+#endif
+
+/** Add a stripe of 64 bytes to the accumulators. */
+FORCEINLINE void AccumulateStripe(uint64* Acc, const uint8* Stripe, const uint64* Keys)
+{
+	for (int32 Lane = 0; Lane < NumAccumulators; ++Lane)
+	{
+		uint64 Data;
+		FMemory::Memcpy(&Data, Stripe + Lane * 8, 8);
+
+		// multiply low and high halves of each keyed value, add data to neighboring accumulator
+		const uint64 DataKey = Data ^ Keys[Lane];
+
+		Acc[Lane ^ 1] += Data;
+		Acc[Lane] += (DataKey & 0xffffffff) * (DataKey >> 32);
+	}
+}
+
+/** Mix the accumulators, so that the order of blocks and rows matters. */
+FORCEINLINE void ScrambleAccumulators(uint64* Acc, const uint64* Keys)
+{
+	for (int32 Lane = 0; Lane < NumAccumulators; ++Lane)
+	{
+		const uint64 Value = (Acc[Lane] ^ (Acc[Lane] >> 47)) ^ Keys[Lane];
+		Acc[Lane] = Value * ScramblePrime;
+	}
+}
+
+/**
+ * Add the stripes of a row to the accumulators.
+ *
+ * @param Lanes The accumulators, either as SSE2 registers or as scalars.
+ * @param Row The row data.
+ * @param RowBytes Number of bytes in the row.
+ */
+template<typename LaneType>
+FORCEINLINE void HashStripes(LaneType* Lanes, const uint8* Row, int32 RowBytes)
+{
+	int32 Offset = 0;
+	int32 Stripe = 0;
+
+	while (RowBytes - Offset >= StripeBytes)
+	{
+		AccumulateStripe(Lanes, Row + Offset, Secret + Stripe);
+		Offset += StripeBytes;
+
+		if (++Stripe == StripesPerBlock)
+		{
+			ScrambleAccumulators(Lanes, Secret + StripesPerBlock);
+			Stripe = 0;
+		}
+	}
+
+	// zero-pad the last partial stripe
+	if (Offset < RowBytes)
+	{
+		uint8 LastStripe[StripeBytes] = { 0 };
+		FMemory::Memcpy(LastStripe, Row + Offset, RowBytes - Offset);
+		AccumulateStripe(Lanes, LastStripe, Secret + Stripe);
+	}
+
+	ScrambleAccumulators(Lanes, Secret + StripesPerBlock);
+}
+
+
+/* FNdiMediaFrameHash static functions
+ *****************************************************************************/
+
+uint64 FNdiMediaFrameHash::HashFrame(const NDIlib_video_frame_v2_t& Frame, bool Sampled)
+{
+	return HashRows(Frame, 0, Frame.yres, Sampled ? 8 : 1);
+}
+
+
+uint64 FNdiMediaFrameHash::HashRows(const NDIlib_video_frame_v2_t& Frame, int32 FirstRow, int32 NumRows, int32 RowStep)
+{
+	uint64 Acc[NumAccumulators];
+
+	for (int32 Lane = 0; Lane < NumAccumulators; ++Lane)
+	{
+		Acc[Lane] = Secret[StripesPerBlock + Lane];
+	}
+
+	// frames with different layouts never match
+	Acc[0] ^= (uint64)(uint32)Frame.FourCC | ((uint64)(uint32)Frame.frame_format_type << 32);
+	Acc[1] ^= (uint64)(uint32)Frame.xres | ((uint64)(uint32)Frame.yres << 32);
+	Acc[2] ^= (uint64)(uint32)Frame.line_stride_in_bytes;
+
+	const uint8* Data = (const uint8*)Frame.p_data;
+	const int32 Stride = Frame.line_stride_in_bytes;
+	const SIZE_T PlaneSize = (SIZE_T)Stride * Frame.yres;
+
+	NumRows = FMath::Min(NumRows, Frame.yres - FirstRow);
+
+	if ((Data != nullptr) && (FirstRow >= 0) && (NumRows > 0))
+	{
+		const uint8* First = Data + (SIZE_T)FirstRow * Stride;
+
+		switch ((uint32)Frame.FourCC)
+		{
+		case NDIlib_FourCC_type_BGRA:
+		case NDIlib_FourCC_type_BGRX:
+			HashPlane(Acc, First, Stride, Frame.xres * 4, NumRows, RowStep);
+			break;
+
+		case NDIlib_FourCC_type_UYVY:
+			HashPlane(Acc, First, Stride, Frame.xres * 2, NumRows, RowStep);
+			break;
+
+		case NDIlib_FourCC_type_UYVA:
+			HashPlane(Acc, First, Stride, Frame.xres * 2, NumRows, RowStep);
+			HashPlane(Acc, Data + PlaneSize + (SIZE_T)FirstRow * Frame.xres, Frame.xres, Frame.xres, NumRows, RowStep);
+			break;
+
+		case NdiMedia::FourCC_P216:
+			HashPlane(Acc, First, Stride, Frame.xres * 2, NumRows, RowStep);
+			HashPlane(Acc, First + PlaneSize, Stride, Frame.xres * 2, NumRows, RowStep);
+			break;
+
+		case NdiMedia::FourCC_PA16:
+			HashPlane(Acc, First, Stride, Frame.xres * 2, NumRows, RowStep);
+			HashPlane(Acc, First + PlaneSize, Stride, Frame.xres * 2, NumRows, RowStep);
+			HashPlane(Acc, First + PlaneSize * 2, Stride, Frame.xres * 2, NumRows, RowStep);
+			break;
+
+		default:
+			HashPlane(Acc, First, Stride, Stride, NumRows, RowStep);
+		}
+	}
+
+	// merge accumulators and avalanche
+	uint64 Result = 0;
+
+	for (int32 Lane = 0; Lane < NumAccumulators; ++Lane)
+	{
+		Result = (Result ^ Acc[Lane]) * 0x9e3779b97f4a7c15;
+		Result ^= Result >> 29;
+	}
+
+	Result = (Result ^ (Result >> 30)) * 0xbf58476d1ce4e5b9;
+	Result = (Result ^ (Result >> 27)) * 0x94d049bb133111eb;
+
+	return Result ^ (Result >> 31);
+}
+
+
+/* FNdiMediaFrameHash implementation
+ *****************************************************************************/
+
+void FNdiMediaFrameHash::HashPlane(uint64* Acc, const uint8* Data, int32 Stride, int32 RowBytes, int32 NumRows, int32 RowStep)
+{
+	RowBytes = FMath::Min(RowBytes, Stride);
+
+	for (int32 Row = 0; Row < NumRows; Row += RowStep)
+	{
+		HashRow(Acc, Data + (SIZE_T)Row * Stride, RowBytes);
+	}
+}
+
+
+void FNdiMediaFrameHash::HashRow(uint64* Acc, const uint8* Row, int32 RowBytes)
+{
+#if NDIMEDIA_SSE2
+	__m128i Lanes[4];
+
+	for (int32 Lane = 0; Lane < 4; ++Lane)
+	{
+		Lanes[Lane] = _mm_loadu_si128((const __m128i*)(Acc + Lane * 2));
+	}
+
+	HashStripes(Lanes, Row, RowBytes);
+
+	for (int32 Lane = 0; Lane < 4; ++Lane)
+	{
+		_mm_storeu_si128((__m128i*)(Acc + Lane * 2), Lanes[Lane]);
+	}
+#else
+	HashRowScalar(Acc, Row, RowBytes);
+#endif
+}
+
+
+void FNdiMediaFrameHash::HashRowScalar(uint64* Acc, const uint8* Row, int32 RowBytes)
+{
+	HashStripes(Acc, Row, RowBytes);
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
@@ -0,0 +1,83 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+struct NDIlib_video_frame_v2_t;
+
+
+/**
+ * Implements a fast hash for detecting repeated video frames.
+ *
+ * The hash is not cryptographic. It is designed to process memory at full
+ * bandwidth and to be sensitive to the position of every byte, so that
+ * moved or swapped image content results in a different hash.
+ */
+class FNdiMediaFrameHash
+{
+public:
+
+	/**
+	 * Compute the hash of a received video frame.
+	 *
+	 * The frame's dimensions, format and field type are part of the hash. Row padding
+	 * is excluded, because its contents are undefined.
+	 *
+	 * @param Frame The video frame to hash.
+	 * @param Sampled Whether to hash only every eighth row (faster, but may miss small changes).
+	 * @return The frame hash.
+	 * @see HashRows
+	 */
+	static uint64 HashFrame(const NDIlib_video_frame_v2_t& Frame, bool Sampled);
+
+	/**
+	 * Compute the hash of a range of rows in a received video frame.
+	 *
+	 * For planar formats, the corresponding rows of all planes are hashed.
+	 *
+	 * @param Frame The video frame to hash.
+	 * @param FirstRow Index of the first row to hash.
+	 * @param NumRows Number of rows to hash.
+	 * @param RowStep Hash only every n-th row.
+	 * @return The hash of the rows.
+	 * @see HashFrame
+	 */
+	static uint64 HashRows(const NDIlib_video_frame_v2_t& Frame, int32 FirstRow, int32 NumRows, int32 RowStep);
+
+protected:
+
+	/**
+	 * Add rows of an image plane to the hash accumulators.
+	 *
+	 * @param Acc The hash accumulators.
+	 * @param Data The plane's first row.
+	 * @param Stride Number of bytes between rows.
+	 * @param RowBytes Number of bytes per row to hash.
+	 * @param NumRows Number of rows in the plane.
+	 * @param RowStep Hash only every n-th row.
+	 */
+	static void HashPlane(uint64* Acc, const uint8* Data, int32 Stride, int32 RowBytes, int32 NumRows, int32 RowStep);
+
+	/**
+	 * Add a single row to the hash accumulators.
+	 *
+	 * @param Acc The hash accumulators.
+	 * @param Row The row data.
+	 * @param RowBytes Number of bytes in the row.
+	 * @see HashRowScalar
+	 */
+	static void HashRow(uint64* Acc, const uint8* Row, int32 RowBytes);
+
+	/**
+	 * Add a single row to the hash accumulators without SIMD instructions.
+	 *
+	 * The result is identical to HashRow.
+	 *
+	 * @param Acc The hash accumulators.
+	 * @param Row The row data.
+	 * @param RowBytes Number of bytes in the row.
+	 * @see HashRow
+	 */
+	static void HashRowScalar(uint64* Acc, const uint8* Row, int32 RowBytes);
+};
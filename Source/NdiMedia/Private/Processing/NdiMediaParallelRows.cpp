@@ -0,0 +1,74 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaPrivate.h"
+
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Math/UnrealMathUtility.h"
+#include "Templates/AlignmentTemplates.h"
+
+
+/** Number of bytes per band (roughly half of a typical L2 cache). */
+static const int32 BandBytes = 128 * 1024;
+
+/** Alignment of the scratch memory of each thread (in bytes). */
+static const int32 ScratchAlignment = 64;
+
+
+/* FNdiMediaParallelRows static functions
+ *****************************************************************************/
+
+void FNdiMediaParallelRows::ParallelFor(int32 NumRows, int32 RowBytes, int32 MaxThreads, TFunctionRef<void(int32 FirstRow, int32 NumBandRows)> Body)
+{
+	TArray<uint8> NoScratch;
+
+	ParallelFor(NumRows, RowBytes, MaxThreads, 0, NoScratch, [&Body](int32 FirstRow, int32 NumBandRows, uint8* /*ThreadScratch*/)
+	{
+		Body(FirstRow, NumBandRows);
+	});
+}
+
+
+void FNdiMediaParallelRows::ParallelFor(int32 NumRows, int32 RowBytes, int32 MaxThreads, int32 ScratchBytes, TArray<uint8>& Scratch, TFunctionRef<void(int32 FirstRow, int32 NumBandRows, uint8* ThreadScratch)> Body)
+{
+	if (NumRows <= 0)
+	{
+		return;
+	}
+
+	const int32 RowsPerBand = FMath::Max(1, BandBytes / FMath::Max(1, RowBytes));
+	const int32 NumBands = FMath::DivideAndRoundUp(NumRows, RowsPerBand);
+	const int32 NumWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumThreads = FMath::Min(NumBands, (MaxThreads > 0) ? FMath::Min(MaxThreads, NumWorkers) : NumWorkers);
+
+	// padded to whole cache lines, so that threads rarely share lines
+	const int32 ThreadScratchBytes = Align(ScratchBytes, ScratchAlignment);
+
+	if (Scratch.Num() < ThreadScratchBytes * NumThreads)
+	{
+		Scratch.SetNumUninitialized(ThreadScratchBytes * NumThreads);
+	}
+
+	if (NumThreads <= 1)
+	{
+		Body(0, NumRows, Scratch.GetData());
+
+		return;
+	}
+
+	// each thread keeps pulling bands until all rows are processed
+	FThreadSafeCounter NextBand;
+
+	::ParallelFor(NumThreads, [&](int32 Thread)
+	{
+		uint8* ThreadScratch = Scratch.GetData() + Thread * ThreadScratchBytes;
+
+		for (int32 Band = NextBand.Increment() - 1; Band < NumBands; Band = NextBand.Increment() - 1)
+		{
+			const int32 FirstRow = Band * RowsPerBand;
+			Body(FirstRow, FMath::Min(RowsPerBand, NumRows - FirstRow), ThreadScratch);
+		}
+	});
+}
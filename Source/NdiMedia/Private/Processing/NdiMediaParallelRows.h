@@ -0,0 +1,45 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Templates/Function.h"
+
+
+/**
+ * Splits per-pixel work on video frames across the task graph.
+ *
+ * Frames are divided into bands of rows that fit into the CPU caches, and the bands
+ * are processed by up to the given number of threads, including the calling thread.
+ */
+class FNdiMediaParallelRows
+{
+public:
+
+	/**
+	 * Process the rows of a frame in parallel bands.
+	 *
+	 * The function returns after all rows were processed.
+	 *
+	 * @param NumRows Total number of rows.
+	 * @param RowBytes Number of bytes touched per row (used to size the bands).
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @param Body The function to call for each band with the band's first row and number of rows.
+	 */
+	static void ParallelFor(int32 NumRows, int32 RowBytes, int32 MaxThreads, TFunctionRef<void(int32 FirstRow, int32 NumBandRows)> Body);
+
+	/**
+	 * Process the rows of a frame in parallel bands, with scratch memory for each thread.
+	 *
+	 * The scratch buffer only grows, so that reusing it for subsequent frames doesn't allocate.
+	 *
+	 * @param NumRows Total number of rows.
+	 * @param RowBytes Number of bytes touched per row (used to size the bands).
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @param ScratchBytes Number of scratch bytes that each thread needs.
+	 * @param Scratch The buffer that holds the scratch memory of all threads.
+	 * @param Body The function to call for each band with the band's first row, number of rows and the calling thread's scratch memory.
+	 */
+	static void ParallelFor(int32 NumRows, int32 RowBytes, int32 MaxThreads, int32 ScratchBytes, TArray<uint8>& Scratch, TFunctionRef<void(int32 FirstRow, int32 NumBandRows, uint8* ThreadScratch)> Body);
+};
@@ -0,0 +1,325 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaVideoConversion.h"
+#include "NdiMediaPrivate.h"
+
+#include "NdiMediaParallelRows.h"
+
+#include "HAL/UnrealMemory.h"
+#include "Math/UnrealMathUtility.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Offset of black in 16-bit limited range luma (64 << 6). */
+static const float YOffset = 4096.0f;
+
+/** Scale of 16-bit limited range luma (1 / ((940 - 64) << 6)). */
+static const float YScale = 1.0f / 56064.0f;
+
+/** Offset of zero in 16-bit chroma (512 << 6). */
+static const float COffset = 32768.0f;
+
+/** Scale of 16-bit limited range chroma (1 / ((960 - 64) << 6)). */
+static const float CScale = 1.0f / 57344.0f;
+
+/** BT.709 coefficients. */
+static const float CrToR = 1.5748f;
+static const float CbToG = -0.1873f;
+static const float CrToG = -0.4681f;
+static const float CbToB = 1.8556f;
+
+
+/** Convert a single 16-bit YUV pixel to normalized RGB. */
+static void YuvToRgb(uint16 Y, uint16 U, uint16 V, float& OutR, float& OutG, float& OutB)
+{
+	const float L = (Y - YOffset) * YScale;
+	const float Cb = (U - COffset) * CScale;
+	const float Cr = (V - COffset) * CScale;
+
+	OutR = FMath::Clamp(L + CrToR * Cr, 0.0f, 1.0f);
+	OutG = FMath::Clamp(L + (CbToG * Cb + CrToG * Cr), 0.0f, 1.0f);
+	OutB = FMath::Clamp(L + CbToB * Cb, 0.0f, 1.0f);
+}
+
+
+/** Convert a normalized float to half precision (values below 2^-14 are flushed to zero). */
+static uint16 FloatToHalf(float Value)
+{
+	if (Value < 1.0f / 16384.0f)
+	{
+		return 0;
+	}
+
+	uint32 Bits;
+	FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+
+	// round to nearest by adding half of the dropped mantissa bits, then rebias the exponent
+	return (uint16)(((Bits + 0x00001000) >> 13) - ((127 - 15) << 10));
+}
+
+
+#if NDIMEDIA_SSE2
+
+/** Convert four 16-bit YUV pixels (two chroma pairs) to normalized RGB. */
+static void YuvToRgb4(const uint16* Y, const uint16* UV, __m128& OutR, __m128& OutG, __m128& OutB)
+{
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i Y32 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)Y), Zero);
+	const __m128i UV32 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)UV), Zero);
+
+	// duplicate each chroma pair for both pixels
+	const __m128i U32 = _mm_shuffle_epi32(UV32, _MM_SHUFFLE(2, 2, 0, 0));
+	const __m128i V32 = _mm_shuffle_epi32(UV32, _MM_SHUFFLE(3, 3, 1, 1));
+
+	const __m128 L = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(Y32), _mm_set1_ps(YOffset)), _mm_set1_ps(YScale));
+	const __m128 Cb = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(U32), _mm_set1_ps(COffset)), _mm_set1_ps(CScale));
+	const __m128 Cr = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(V32), _mm_set1_ps(COffset)), _mm_set1_ps(CScale));
+
+	const __m128 Min = _mm_setzero_ps();
+	const __m128 Max = _mm_set1_ps(1.0f);
+
+	OutR = _mm_min_ps(_mm_max_ps(_mm_add_ps(L, _mm_mul_ps(Cr, _mm_set1_ps(CrToR))), Min), Max);
+	OutG = _mm_min_ps(_mm_max_ps(_mm_add_ps(L, _mm_add_ps(_mm_mul_ps(Cb, _mm_set1_ps(CbToG)), _mm_mul_ps(Cr, _mm_set1_ps(CrToG)))), Min), Max);
+	OutB = _mm_min_ps(_mm_max_ps(_mm_add_ps(L, _mm_mul_ps(Cb, _mm_set1_ps(CbToB))), Min), Max);
+}
+
+
+/** Convert four normalized floats to half precision, same as FloatToHalf. */
+static __m128i FloatToHalf4(__m128 Value)
+{
+	const __m128i Bits = _mm_castps_si128(Value);
+	const __m128i Rounded = _mm_add_epi32(Bits, _mm_set1_epi32(0x00001000));
+	const __m128i Half = _mm_sub_epi32(_mm_srli_epi32(Rounded, 13), _mm_set1_epi32((127 - 15) << 10));
+	const __m128i Denormal = _mm_castps_si128(_mm_cmplt_ps(Value, _mm_set1_ps(1.0f / 16384.0f)));
+
+	return _mm_andnot_si128(Denormal, Half);
+}
+
+#endif //NDIMEDIA_SSE2
+
+
+/* FNdiMediaVideoConversion static functions
+ *****************************************************************************/
+
+void FNdiMediaVideoConversion::P216ToBgr10A2(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads)
+{
+	check((uint32)Frame.FourCC == NdiMedia::FourCC_P216);
+
+	// the chroma plane follows the luma plane and has the same stride
+	const uint8* Y = (const uint8*)Frame.p_data;
+	const uint8* UV = Y + Frame.line_stride_in_bytes * Frame.yres;
+	const int32 Stride = Frame.line_stride_in_bytes;
+	const int32 Width = Frame.xres;
+
+	FNdiMediaParallelRows::ParallelFor(Frame.yres, Stride * 2 + DestStride, MaxThreads, [=](int32 FirstRow, int32 NumRows)
+	{
+		for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+		{
+			P216ToBgr10A2Row((const uint16*)(Y + Row * Stride), (const uint16*)(UV + Row * Stride), Dest + Row * DestStride, Width);
+		}
+	});
+}
+
+
+void FNdiMediaVideoConversion::Pa16ToFloatRgba(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads)
+{
+	check((uint32)Frame.FourCC == NdiMedia::FourCC_PA16);
+
+	// the chroma and alpha planes follow the luma plane and have the same stride
+	const uint8* Y = (const uint8*)Frame.p_data;
+	const uint8* UV = Y + Frame.line_stride_in_bytes * Frame.yres;
+	const uint8* Alpha = UV + Frame.line_stride_in_bytes * Frame.yres;
+	const int32 Stride = Frame.line_stride_in_bytes;
+	const int32 Width = Frame.xres;
+
+	FNdiMediaParallelRows::ParallelFor(Frame.yres, Stride * 3 + DestStride, MaxThreads, [=](int32 FirstRow, int32 NumRows)
+	{
+		for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+		{
+			Pa16ToFloatRgbaRow((const uint16*)(Y + Row * Stride), (const uint16*)(UV + Row * Stride), (const uint16*)(Alpha + Row * Stride), Dest + Row * DestStride, Width);
+		}
+	});
+}
+
+
+void FNdiMediaVideoConversion::UyvaToAyuv(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads)
+{
+	check(Frame.FourCC == NDIlib_FourCC_type_UYVA);
+
+	// the alpha plane follows the UYVY plane and has a stride of xres
+	const uint8* Uyvy = (const uint8*)Frame.p_data;
+	const uint8* Alpha = Uyvy + Frame.line_stride_in_bytes * Frame.yres;
+	const int32 Stride = Frame.line_stride_in_bytes;
+	const int32 Width = Frame.xres;
+
+	FNdiMediaParallelRows::ParallelFor(Frame.yres, Stride + Width + DestStride, MaxThreads, [=](int32 FirstRow, int32 NumRows)
+	{
+		for (int32 Row = FirstRow; Row < FirstRow + NumRows; ++Row)
+		{
+			UyvaToAyuvRow(Uyvy + Row * Stride, Alpha + Row * Width, Dest + Row * DestStride, Width);
+		}
+	});
+}
+
+
+/* FNdiMediaVideoConversion implementation
+ *****************************************************************************/
+
+void FNdiMediaVideoConversion::P216ToBgr10A2Row(const uint16* Y, const uint16* UV, uint8* Dest, int32 NumPixels)
+{
+	uint32* Texels = (uint32*)Dest;
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128 Scale = _mm_set1_ps(1023.0f);
+	const __m128i Alpha = _mm_set1_epi32((int32)0xc0000000);
+
+	for (; Pixel + 4 <= NumPixels; Pixel += 4)
+	{
+		__m128 R, G, B;
+		YuvToRgb4(Y + Pixel, UV + Pixel, R, G, B);
+
+		const __m128i R10 = _mm_cvtps_epi32(_mm_mul_ps(R, Scale));
+		const __m128i G10 = _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(G, Scale)), 10);
+		const __m128i B10 = _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(B, Scale)), 20);
+
+		_mm_storeu_si128((__m128i*)(Texels + Pixel), _mm_or_si128(_mm_or_si128(R10, G10), _mm_or_si128(B10, Alpha)));
+	}
+#endif
+
+	// the vector loop ends on a chroma pair boundary
+	P216ToBgr10A2RowScalar(Y + Pixel, UV + Pixel, (uint8*)(Texels + Pixel), NumPixels - Pixel);
+}
+
+
+void FNdiMediaVideoConversion::P216ToBgr10A2RowScalar(const uint16* Y, const uint16* UV, uint8* Dest, int32 NumPixels)
+{
+	uint32* Texels = (uint32*)Dest;
+
+	for (int32 Pixel = 0; Pixel < NumPixels; ++Pixel)
+	{
+		const uint16* Pair = UV + (Pixel & ~1);
+
+		float R, G, B;
+		YuvToRgb(Y[Pixel], Pair[0], Pair[1], R, G, B);
+
+		Texels[Pixel] = (uint32)FMath::RoundToInt(R * 1023.0f)
+			| ((uint32)FMath::RoundToInt(G * 1023.0f) << 10)
+			| ((uint32)FMath::RoundToInt(B * 1023.0f) << 20)
+			| 0xc0000000;
+	}
+}
+
+
+void FNdiMediaVideoConversion::Pa16ToFloatRgbaRow(const uint16* Y, const uint16* UV, const uint16* Alpha, uint8* Dest, int32 NumPixels)
+{
+	uint16* Components = (uint16*)Dest;
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128 AlphaScale = _mm_set1_ps(1.0f / 65535.0f);
+	const __m128i Zero = _mm_setzero_si128();
+
+	for (; Pixel + 4 <= NumPixels; Pixel += 4)
+	{
+		__m128 R, G, B;
+		YuvToRgb4(Y + Pixel, UV + Pixel, R, G, B);
+
+		const __m128i A32 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(Alpha + Pixel)), Zero);
+		const __m128 A = _mm_mul_ps(_mm_cvtepi32_ps(A32), AlphaScale);
+
+		// half values of normalized floats fit into signed 16-bit
+		const __m128i R16 = _mm_packs_epi32(FloatToHalf4(R), Zero);
+		const __m128i G16 = _mm_packs_epi32(FloatToHalf4(G), Zero);
+		const __m128i B16 = _mm_packs_epi32(FloatToHalf4(B), Zero);
+		const __m128i A16 = _mm_packs_epi32(FloatToHalf4(A), Zero);
+
+		const __m128i RG = _mm_unpacklo_epi16(R16, G16);
+		const __m128i BA = _mm_unpacklo_epi16(B16, A16);
+
+		_mm_storeu_si128((__m128i*)(Components + Pixel * 4), _mm_unpacklo_epi32(RG, BA));
+		_mm_storeu_si128((__m128i*)(Components + Pixel * 4 + 8), _mm_unpackhi_epi32(RG, BA));
+	}
+#endif
+
+	// the vector loop ends on a chroma pair boundary
+	Pa16ToFloatRgbaRowScalar(Y + Pixel, UV + Pixel, Alpha + Pixel, (uint8*)(Components + Pixel * 4), NumPixels - Pixel);
+}
+
+
+void FNdiMediaVideoConversion::Pa16ToFloatRgbaRowScalar(const uint16* Y, const uint16* UV, const uint16* Alpha, uint8* Dest, int32 NumPixels)
+{
+	uint16* Components = (uint16*)Dest;
+
+	for (int32 Pixel = 0; Pixel < NumPixels; ++Pixel)
+	{
+		const uint16* Pair = UV + (Pixel & ~1);
+
+		float R, G, B;
+		YuvToRgb(Y[Pixel], Pair[0], Pair[1], R, G, B);
+
+		uint16* Texel = Components + Pixel * 4;
+
+		Texel[0] = FloatToHalf(R);
+		Texel[1] = FloatToHalf(G);
+		Texel[2] = FloatToHalf(B);
+		Texel[3] = FloatToHalf(Alpha[Pixel] * (1.0f / 65535.0f));
+	}
+}
+
+
+void FNdiMediaVideoConversion::UyvaToAyuvRow(const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 NumPixels)
+{
+	int32 Pixel = 0;
+
+#if NDIMEDIA_SSE2
+	const __m128i LowByteMask = _mm_set1_epi16(0x00ff);
+	const __m128i UMask = _mm_set1_epi32(0x0000ff00);
+	const __m128i Zero = _mm_setzero_si128();
+
+	for (; Pixel + 8 <= NumPixels; Pixel += 8)
+	{
+		const __m128i Packed = _mm_loadu_si128((const __m128i*)(Uyvy + Pixel * 2));
+		const __m128i A = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(Alpha + Pixel)), Zero);
+
+		// one Y|A<<8 word per pixel
+		const __m128i YA = _mm_or_si128(_mm_srli_epi16(Packed, 8), _mm_slli_epi16(A, 8));
+
+		// one V|U<<8 word per pixel pair, duplicated for both pixels
+		const __m128i UV = _mm_and_si128(Packed, LowByteMask);
+		const __m128i VU = _mm_or_si128(_mm_srli_epi32(UV, 16), _mm_and_si128(_mm_slli_epi32(UV, 8), UMask));
+		const __m128i VUVU = _mm_or_si128(VU, _mm_slli_epi32(VU, 16));
+
+		_mm_storeu_si128((__m128i*)(Dest + Pixel * 4), _mm_unpacklo_epi16(VUVU, YA));
+		_mm_storeu_si128((__m128i*)(Dest + Pixel * 4 + 16), _mm_unpackhi_epi16(VUVU, YA));
+	}
+#endif
+
+	UyvaToAyuvRowScalar(Uyvy + Pixel * 2, Alpha + Pixel, Dest + Pixel * 4, NumPixels - Pixel);
+}
+
+
+void FNdiMediaVideoConversion::UyvaToAyuvRowScalar(const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 NumPixels)
+{
+	for (int32 Pixel = 0; Pixel < NumPixels; ++Pixel)
+	{
+		const uint8* Pair = Uyvy + (Pixel & ~1) * 2;
+		uint8* Texel = Dest + Pixel * 4;
+
+		Texel[0] = Pair[2];
+		Texel[1] = Pair[0];
+		Texel[2] = Pair[(Pixel & 1) ? 3 : 1];
+		Texel[3] = Alpha[Pixel];
+	}
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
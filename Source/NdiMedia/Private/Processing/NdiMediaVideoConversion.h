@@ -0,0 +1,132 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+struct NDIlib_video_frame_v2_t;
+
+
+/**
+ * Implements pixel format conversions for received video frames.
+ */
+class FNdiMediaVideoConversion
+{
+public:
+
+	/**
+	 * Convert a P216 frame to 10-bit RGB.
+	 *
+	 * P216 frames consist of a plane of 16-bit luma values that is followed by a plane
+	 * of interleaved 16-bit chroma pairs (4:2:2). The output contains one 32-bit texel
+	 * per pixel with 10 bits per color (red in the lowest bits) and an opaque alpha.
+	 *
+	 * @param Frame The frame to convert (must be P216).
+	 * @param Dest The output buffer (must hold Frame.yres rows).
+	 * @param DestStride Number of bytes per output row.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @see Pa16ToFloatRgba
+	 */
+	static void P216ToBgr10A2(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads);
+
+	/**
+	 * Convert a PA16 frame to half precision floating point RGBA.
+	 *
+	 * PA16 frames are P216 frames that are followed by a plane of 16-bit alpha values.
+	 * The output contains four 16-bit floating point components per pixel.
+	 *
+	 * @param Frame The frame to convert (must be PA16).
+	 * @param Dest The output buffer (must hold Frame.yres rows).
+	 * @param DestStride Number of bytes per output row.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 * @see P216ToBgr10A2
+	 */
+	static void Pa16ToFloatRgba(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads);
+
+	/**
+	 * Convert a UYVA frame to AYUV.
+	 *
+	 * UYVA frames consist of a UYVY plane that is followed by an alpha plane with one
+	 * byte per pixel. The output interleaves the alpha into one 32-bit VUYA texel per
+	 * pixel, so that the YUV to RGB conversion can happen on the GPU.
+	 *
+	 * @param Frame The frame to convert (must be UYVA).
+	 * @param Dest The output buffer (must hold Frame.yres rows).
+	 * @param DestStride Number of bytes per output row.
+	 * @param MaxThreads Maximum number of threads to use (0 = all worker threads).
+	 */
+	static void UyvaToAyuv(const NDIlib_video_frame_v2_t& Frame, uint8* Dest, uint32 DestStride, int32 MaxThreads);
+
+protected:
+
+	/**
+	 * Convert a row of P216 pixels to 10-bit RGB.
+	 *
+	 * @param Y The luma values.
+	 * @param UV The chroma pairs.
+	 * @param Dest The output texels.
+	 * @param NumPixels The number of pixels to convert.
+	 * @see P216ToBgr10A2RowScalar
+	 */
+	static void P216ToBgr10A2Row(const uint16* Y, const uint16* UV, uint8* Dest, int32 NumPixels);
+
+	/**
+	 * Convert a row of P216 pixels to 10-bit RGB without SIMD instructions.
+	 *
+	 * @param Y The luma values.
+	 * @param UV The chroma pairs.
+	 * @param Dest The output texels.
+	 * @param NumPixels The number of pixels to convert.
+	 * @see P216ToBgr10A2Row
+	 */
+	static void P216ToBgr10A2RowScalar(const uint16* Y, const uint16* UV, uint8* Dest, int32 NumPixels);
+
+	/**
+	 * Convert a row of PA16 pixels to half precision floating point RGBA.
+	 *
+	 * Components are rounded to the nearest half precision value, and values
+	 * below 2^-14 are flushed to zero.
+	 *
+	 * @param Y The luma values.
+	 * @param UV The chroma pairs.
+	 * @param Alpha The alpha values.
+	 * @param Dest The output texels.
+	 * @param NumPixels The number of pixels to convert.
+	 * @see Pa16ToFloatRgbaRowScalar
+	 */
+	static void Pa16ToFloatRgbaRow(const uint16* Y, const uint16* UV, const uint16* Alpha, uint8* Dest, int32 NumPixels);
+
+	/**
+	 * Convert a row of PA16 pixels to half precision floating point RGBA without SIMD instructions.
+	 *
+	 * @param Y The luma values.
+	 * @param UV The chroma pairs.
+	 * @param Alpha The alpha values.
+	 * @param Dest The output texels.
+	 * @param NumPixels The number of pixels to convert.
+	 * @see Pa16ToFloatRgbaRow
+	 */
+	static void Pa16ToFloatRgbaRowScalar(const uint16* Y, const uint16* UV, const uint16* Alpha, uint8* Dest, int32 NumPixels);
+
+	/**
+	 * Convert a row of UYVA pixels to AYUV.
+	 *
+	 * @param Uyvy The UYVY pixels.
+	 * @param Alpha The alpha values.
+	 * @param Dest The output texels.
+	 * @param NumPixels The number of pixels to convert.
+	 * @see UyvaToAyuvRowScalar
+	 */
+	static void UyvaToAyuvRow(const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 NumPixels);
+
+	/**
+	 * Convert a row of UYVA pixels to AYUV without SIMD instructions.
+	 *
+	 * @param Uyvy The UYVY pixels.
+	 * @param Alpha The alpha values.
+	 * @param Dest The output texels.
+	 * @param NumPixels The number of pixels to convert.
+	 * @see UyvaToAyuvRow
+	 */
+	static void UyvaToAyuvRowScalar(const uint8* Uyvy, const uint8* Alpha, uint8* Dest, int32 NumPixels);
+};
@@ -0,0 +1,51 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaVideoCopy.h"
+#include "NdiMediaPrivate.h"
+
+#include "HAL/UnrealMemory.h"
+
+#if NDIMEDIA_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+/* FNdiMediaVideoCopy static functions
+ *****************************************************************************/
+
+void FNdiMediaVideoCopy::StreamCopy(void* Dest, const void* Src, SIZE_T Size)
+{
+#if NDIMEDIA_SSE2
+	if ((UPTRINT(Dest) & 15) == 0)
+	{
+		const uint8* Source = (const uint8*)Src;
+		uint8* Destination = (uint8*)Dest;
+		const SIZE_T NumBlocks = Size / 64;
+
+		for (SIZE_T Block = 0; Block < NumBlocks; ++Block)
+		{
+			const __m128i A = _mm_loadu_si128((const __m128i*)(Source + 0));
+			const __m128i B = _mm_loadu_si128((const __m128i*)(Source + 16));
+			const __m128i C = _mm_loadu_si128((const __m128i*)(Source + 32));
+			const __m128i D = _mm_loadu_si128((const __m128i*)(Source + 48));
+
+			_mm_stream_si128((__m128i*)(Destination + 0), A);
+			_mm_stream_si128((__m128i*)(Destination + 16), B);
+			_mm_stream_si128((__m128i*)(Destination + 32), C);
+			_mm_stream_si128((__m128i*)(Destination + 48), D);
+
+			Source += 64;
+			Destination += 64;
+		}
+
+		// make streamed data visible to other threads
+		_mm_sfence();
+
+		FMemory::Memcpy(Destination, Source, Size - NumBlocks * 64);
+
+		return;
+	}
+#endif
+
+	FMemory::Memcpy(Dest, Src, Size);
+}
@@ -0,0 +1,27 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+
+/**
+ * Implements memory copy functions for video frames.
+ */
+class FNdiMediaVideoCopy
+{
+public:
+
+	/**
+	 * Copy a block of memory without polluting the CPU caches.
+	 *
+	 * Video frames are much larger than the caches and are not read by the CPU
+	 * again after they were copied, so the destination is written with non-temporal
+	 * stores where available. The source may have any alignment.
+	 *
+	 * @param Dest The destination buffer (should be 16-byte aligned).
+	 * @param Src The source buffer.
+	 * @param Size Number of bytes to copy.
+	 */
+	static void StreamCopy(void* Dest, const void* Src, SIZE_T Size);
+};
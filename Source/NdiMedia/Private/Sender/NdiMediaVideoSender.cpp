@@ -0,0 +1,512 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaVideoSender.h"
+#include "NdiMediaPrivate.h"
+
+#include "Containers/StringConv.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformAtomics.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "IMediaTextureSample.h"
+#include "Misc/ScopeLock.h"
+#include "RHICommandList.h"
+
+#include "Ndi.h"
+#include "NdiMediaColorPacker.h"
+#include "NdiMediaDownscaler.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Maximum number of frames that can be read back but not yet sent. */
+static const int32 MaxFrames = 3;
+
+/** Number of staging textures, which is also the readback latency (in captured frames). */
+static const int32 NumReadbacks = 3;
+
+/** Maximum time that the send thread blocks before checking whether it should stop. */
+static const uint32 WaitTimeoutMs = 100;
+
+
+/**
+ * Swap the red and blue channels of 8-bit four channel pixels in place.
+ *
+ * @param Data The pixel data.
+ * @param NumPixels Number of pixels.
+ */
+static void SwapRedBlue(uint8* Data, int32 NumPixels)
+{
+	for (int32 PixelIndex = 0; PixelIndex < NumPixels; ++PixelIndex, Data += 4)
+	{
+		Swap(Data[0], Data[2]);
+	}
+}
+
+
+/* FNdiMediaVideoSender structors
+ *****************************************************************************/
+
+FNdiMediaVideoSender::FNdiMediaVideoSender(const FString& InSourceName, const FString& InGroups, ENdiMediaSenderColorFormat InColorFormat, ENdiMediaDownscale InDownscale, ENdiMediaDownscaleFilter InDownscaleFilter, int32 InFrameRateNumerator, int32 InFrameRateDenominator)
+	: ColorFormat(InColorFormat)
+	, ColorPacker(new FNdiMediaColorPacker)
+	, Downscaler(new FNdiMediaDownscaler)
+	, FrameEvent(FPlatformProcess::GetSynchEventFromPool())
+	, FrameRateDenominator(FMath::Max(1, InFrameRateDenominator))
+	, FrameRateNumerator(FMath::Max(1, InFrameRateNumerator))
+	, Groups(InGroups)
+	, NumFrames(0)
+	, ReadbackIndex(0)
+	, RequestedWindow(nullptr)
+	, SendBufferIndex(0)
+	, SendInstance(nullptr)
+	, SourceName(InSourceName)
+	, StartTime(0.0)
+	, Thread(nullptr)
+	, UnsupportedFormatLogged(false)
+{
+	Downscaler->SetMode(InDownscale, InDownscaleFilter);
+	Readbacks.SetNum(NumReadbacks);
+
+	for (FReadback& Readback : Readbacks)
+	{
+		Readback.Dim = FIntPoint::ZeroValue;
+		Readback.Format = PF_Unknown;
+		Readback.Pending = false;
+	}
+}
+
+
+FNdiMediaVideoSender::~FNdiMediaVideoSender()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if ((SendInstance != nullptr) && FNdi::IsInitialized())
+	{
+		// wait for NDI to release the last send buffer
+		FNdi::Lib->NDIlib_send_send_video_async_v2(SendInstance, nullptr);
+		FNdi::Lib->NDIlib_send_destroy(SendInstance);
+	}
+
+	SendInstance = nullptr;
+
+	FFrame* Frame = nullptr;
+
+	while (PendingFrames.Dequeue(Frame))
+	{
+		delete Frame;
+	}
+
+	for (FFrame* FreeFrame : FreeFrames)
+	{
+		delete FreeFrame;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(FrameEvent);
+	FrameEvent = nullptr;
+
+	delete ColorPacker;
+	ColorPacker = nullptr;
+
+	delete Downscaler;
+	Downscaler = nullptr;
+}
+
+
+/* FNdiMediaVideoSender interface
+ *****************************************************************************/
+
+void FNdiMediaVideoSender::Capture_RenderThread(FRHICommandListImmediate& RHICmdList, FTexture2DRHIParamRef Texture)
+{
+	check(IsInRenderingThread());
+
+	if (Texture == nullptr)
+	{
+		return;
+	}
+
+	const EPixelFormat Format = Texture->GetFormat();
+
+	if ((Format != PF_B8G8R8A8) && (Format != PF_R8G8B8A8))
+	{
+		if (!UnsupportedFormatLogged)
+		{
+			UE_LOG(LogNdiMedia, Warning, TEXT("Cannot send pixel format %s as NDI source %s: Only 8-bit RGBA and BGRA are supported"), GPixelFormats[Format].Name, *SourceName);
+			UnsupportedFormatLogged = true;
+		}
+
+		return;
+	}
+
+	PollReadbacks_RenderThread(RHICmdList);
+
+	FReadback& Readback = Readbacks[ReadbackIndex];
+
+	// the GPU is more than NumReadbacks captures behind
+	if (Readback.Pending)
+	{
+		NumDroppedFrames.Increment();
+		return;
+	}
+
+	const FIntPoint Dim(Texture->GetSizeX(), Texture->GetSizeY());
+
+	if (!Readback.Texture.IsValid() || (Readback.Dim != Dim) || (Readback.Format != Format))
+	{
+		FRHIResourceCreateInfo CreateInfo;
+		Readback.Texture = RHICreateTexture2D(Dim.X, Dim.Y, Format, 1, 1, TexCreate_CPUReadback, CreateInfo);
+		Readback.Dim = Dim;
+		Readback.Format = Format;
+	}
+
+	if (!Readback.Fence.IsValid())
+	{
+		Readback.Fence = RHICreateGPUFence(TEXT("NdiMediaVideoSenderReadback"));
+	}
+
+	RHICmdList.CopyToResolveTarget(Texture, Readback.Texture, FResolveParams());
+	RHICmdList.WriteGPUFence(Readback.Fence);
+	Readback.Pending = true;
+
+	ReadbackIndex = (ReadbackIndex + 1) % Readbacks.Num();
+	NumCapturedFrames.Increment();
+}
+
+
+FString FNdiMediaVideoSender::GetStats() const
+{
+	FString Stats;
+
+	Stats += TEXT("Sender\n");
+	Stats += FString::Printf(TEXT("    Source: %s\n"), *SourceName);
+	Stats += FString::Printf(TEXT("    Connections: %i\n"), (SendInstance != nullptr) ? FNdi::Lib->NDIlib_send_get_no_connections(SendInstance, 0) : 0);
+	Stats += FString::Printf(TEXT("    Frame Rate: %i/%i\n"), FrameRateNumerator, FrameRateDenominator);
+	Stats += FString::Printf(TEXT("    Captured Frames: %i\n"), NumCapturedFrames.GetValue());
+	Stats += FString::Printf(TEXT("    Dropped Frames: %i\n"), NumDroppedFrames.GetValue());
+	Stats += FString::Printf(TEXT("    Sent Frames: %i\n"), NumSentFrames.GetValue());
+
+	const int32 NumRead = NumReadFrames.GetValue();
+
+	if (NumRead > 0)
+	{
+		Stats += FString::Printf(TEXT("    Readback Time: %.3f ms/frame\n"), FPlatformTime::ToMilliseconds64(ReadbackCycles.GetValue()) / NumRead);
+	}
+
+	const int32 NumSent = NumSentFrames.GetValue();
+
+	if (NumSent > 0)
+	{
+		Stats += FString::Printf(TEXT("    Convert Time: %.3f ms/frame\n"), FPlatformTime::ToMilliseconds64(ConvertCycles.GetValue()) / NumSent);
+
+		if ((ColorFormat == ENdiMediaSenderColorFormat::UYVY) || (ColorFormat == ENdiMediaSenderColorFormat::UYVA))
+		{
+			Stats += FString::Printf(TEXT("    Pack Time: %.3f ms/frame\n"), FPlatformTime::ToMilliseconds64(PackCycles.GetValue()) / NumSent);
+		}
+
+		Stats += FString::Printf(TEXT("    Send Wait Time: %.3f ms/frame\n"), FPlatformTime::ToMilliseconds64(SendCycles.GetValue()) / NumSent);
+		Stats += FString::Printf(TEXT("    Throughput: %.2f fps\n"), NumSent / FMath::Max(FPlatformTime::Seconds() - StartTime, 0.001));
+	}
+
+	return Stats;
+}
+
+
+bool FNdiMediaVideoSender::HasConnections() const
+{
+	return (SendInstance != nullptr) && (FNdi::Lib->NDIlib_send_get_no_connections(SendInstance, 0) > 0);
+}
+
+
+void FNdiMediaVideoSender::PollReadbacks_RenderThread(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+
+	// read back the copies that the GPU finished, oldest first
+	for (int32 Offset = 0; Offset < Readbacks.Num(); ++Offset)
+	{
+		FReadback& PendingReadback = Readbacks[(ReadbackIndex + Offset) % Readbacks.Num()];
+
+		if (PendingReadback.Pending && PendingReadback.Fence->Poll())
+		{
+			ReadFrame_RenderThread(RHICmdList, PendingReadback);
+		}
+	}
+}
+
+
+bool FNdiMediaVideoSender::RequestWindowCapture()
+{
+	const TSharedPtr<SWindow> Window = CaptureWindow.Pin();
+
+	if (!Window.IsValid())
+	{
+		return false;
+	}
+
+	FPlatformAtomics::InterlockedExchangePtr((void**)&RequestedWindow, Window.Get());
+
+	return true;
+}
+
+
+void FNdiMediaVideoSender::SetCaptureWindow(const TSharedPtr<SWindow>& Window)
+{
+	CaptureWindow = Window;
+}
+
+
+bool FNdiMediaVideoSender::Start()
+{
+	if (!FNdi::IsInitialized() || (SendInstance != nullptr))
+	{
+		return false;
+	}
+
+	// the converted strings must outlive the call to NDIlib_send_create
+	auto GroupsAnsi = StringCast<ANSICHAR>(*Groups);
+	auto SourceNameAnsi = StringCast<ANSICHAR>(*SourceName);
+
+	NDIlib_send_create_t SendCreate;
+	{
+		SendCreate.p_ndi_name = SourceNameAnsi.Get();
+		SendCreate.p_groups = Groups.IsEmpty() ? nullptr : GroupsAnsi.Get();
+		SendCreate.clock_video = false;
+		SendCreate.clock_audio = false;
+	}
+
+	SendInstance = FNdi::Lib->NDIlib_send_create(&SendCreate);
+
+	if (SendInstance == nullptr)
+	{
+		UE_LOG(LogNdiMedia, Warning, TEXT("Failed to create NDI Send instance for source %s"), *SourceName);
+		return false;
+	}
+
+	StartTime = FPlatformTime::Seconds();
+	Thread = FRunnableThread::Create(this, TEXT("NdiMediaVideoSender"), 0, TPri_AboveNormal);
+
+	if (Thread == nullptr)
+	{
+		UE_LOG(LogNdiMedia, Warning, TEXT("Failed to create NDI send thread for source %s"), *SourceName);
+		return false;
+	}
+
+	return true;
+}
+
+
+/* FNdiMediaVideoSender callbacks
+ *****************************************************************************/
+
+void FNdiMediaVideoSender::HandleBackBufferReadyToPresent(SWindow& Window, const FTexture2DRHIRef& BackBuffer)
+{
+	// the window was alive when the capture was requested on the game thread
+	if (FPlatformAtomics::InterlockedCompareExchangePointer((void**)&RequestedWindow, nullptr, &Window) != &Window)
+	{
+		return;
+	}
+
+	Capture_RenderThread(FRHICommandListExecutor::GetImmediateCommandList(), BackBuffer);
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FNdiMediaVideoSender::Run()
+{
+	while (!Stopping)
+	{
+		FFrame* Frame = nullptr;
+
+		if (!PendingFrames.Dequeue(Frame))
+		{
+			FrameEvent->Wait(WaitTimeoutMs);
+			continue;
+		}
+
+		SendFrame(*Frame);
+		ReleaseFrame(Frame);
+	}
+
+	return 0;
+}
+
+
+void FNdiMediaVideoSender::Stop()
+{
+	Stopping = true;
+	FrameEvent->Trigger();
+}
+
+
+/* FNdiMediaVideoSender implementation
+ *****************************************************************************/
+
+FNdiMediaVideoSender::FFrame* FNdiMediaVideoSender::AcquireFrame()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (FreeFrames.Num() > 0)
+	{
+		return FreeFrames.Pop(false);
+	}
+
+	if (NumFrames >= MaxFrames)
+	{
+		return nullptr;
+	}
+
+	++NumFrames;
+
+	return new FFrame;
+}
+
+
+void FNdiMediaVideoSender::ReadFrame_RenderThread(FRHICommandListImmediate& RHICmdList, FReadback& Readback)
+{
+	Readback.Pending = false;
+
+	FFrame* Frame = AcquireFrame();
+
+	if (Frame == nullptr)
+	{
+		NumDroppedFrames.Increment();
+		return;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	void* MappedData = nullptr;
+	int32 MappedWidth = 0;
+	int32 MappedHeight = 0;
+
+	RHICmdList.MapStagingSurface(Readback.Texture, MappedData, MappedWidth, MappedHeight);
+
+	if (MappedData == nullptr)
+	{
+		ReleaseFrame(Frame);
+		NumDroppedFrames.Increment();
+
+		return;
+	}
+
+	// the mapped width is the row pitch (in pixels)
+	const uint32 RowBytes = Readback.Dim.X * 4;
+	const uint32 MappedStride = MappedWidth * 4;
+
+	Frame->Data.SetNumUninitialized(RowBytes * Readback.Dim.Y);
+	Frame->Dim = Readback.Dim;
+	Frame->Rgba = (Readback.Format == PF_R8G8B8A8);
+
+	for (int32 Row = 0; Row < Readback.Dim.Y; ++Row)
+	{
+		FMemory::Memcpy(Frame->Data.GetData() + Row * RowBytes, (const uint8*)MappedData + Row * MappedStride, RowBytes);
+	}
+
+	RHICmdList.UnmapStagingSurface(Readback.Texture);
+
+	ReadbackCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+	NumReadFrames.Increment();
+
+	PendingFrames.Enqueue(Frame);
+	FrameEvent->Trigger();
+}
+
+
+void FNdiMediaVideoSender::ReleaseFrame(FFrame* Frame)
+{
+	FScopeLock Lock(&CriticalSection);
+	FreeFrames.Push(Frame);
+}
+
+
+void FNdiMediaVideoSender::SendFrame(FFrame& Frame)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const bool Packed = (ColorFormat == ENdiMediaSenderColorFormat::UYVY) || (ColorFormat == ENdiMediaSenderColorFormat::UYVA);
+
+	// the packer handles RGBA pixels itself
+	if (Frame.Rgba && !Packed)
+	{
+		SwapRedBlue(Frame.Data.GetData(), Frame.Dim.X * Frame.Dim.Y);
+	}
+
+	// NDI may still read from the other send buffer
+	TArray<uint8>& SendBuffer = SendBuffers[SendBufferIndex];
+	const uint8* Pixels = Frame.Data.GetData();
+	FIntPoint Dim = Frame.Dim;
+
+	if (Downscaler->IsEnabled())
+	{
+		TArray<uint8>& DownscaleOutput = Packed ? DownscaleBuffer : SendBuffer;
+
+		Dim = Downscaler->GetOutputDim(Frame.Dim, EMediaTextureSampleFormat::CharBGRA);
+		DownscaleOutput.SetNumUninitialized(Dim.X * Dim.Y * 4);
+		Downscaler->Downscale(Frame.Data.GetData(), Frame.Dim.X * 4, Frame.Dim, EMediaTextureSampleFormat::CharBGRA, DownscaleOutput.GetData(), Dim.X * 4, 0);
+		Pixels = DownscaleOutput.GetData();
+	}
+	else if (!Packed)
+	{
+		// the frame returns to the pool with the previous contents of the send buffer
+		Exchange(SendBuffer, Frame.Data);
+		Pixels = SendBuffer.GetData();
+	}
+
+	int32 SendWidth = Dim.X;
+	int32 SendStride = Dim.X * 4;
+	uint32 FourCC = (ColorFormat == ENdiMediaSenderColorFormat::BGRX) ? NDIlib_FourCC_type_BGRX : NDIlib_FourCC_type_BGRA;
+
+	if (Packed)
+	{
+		const uint64 PackStartCycles = FPlatformTime::Cycles64();
+		const bool WithAlpha = (ColorFormat == ENdiMediaSenderColorFormat::UYVA);
+
+		// each UYVY texel holds two pixels, so an odd last column is dropped
+		SendWidth = Dim.X & ~1;
+		SendStride = SendWidth * 2;
+		FourCC = WithAlpha ? NDIlib_FourCC_type_UYVA : NDIlib_FourCC_type_UYVY;
+
+		SendBuffer.SetNumUninitialized(SendStride * Dim.Y + (WithAlpha ? SendWidth * Dim.Y : 0));
+		ColorPacker->Pack(Pixels, Dim.X * 4, FIntPoint(SendWidth, Dim.Y), Frame.Rgba, SendBuffer.GetData(), SendStride, WithAlpha ? SendBuffer.GetData() + SendStride * Dim.Y : nullptr, 0);
+
+		PackCycles.Add(FPlatformTime::Cycles64() - PackStartCycles);
+	}
+
+	ConvertCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+
+	NDIlib_video_frame_v2_t VideoFrame;
+	{
+		VideoFrame.xres = SendWidth;
+		VideoFrame.yres = Dim.Y;
+		VideoFrame.FourCC = (NDIlib_FourCC_type_e)FourCC;
+		VideoFrame.frame_rate_N = FrameRateNumerator;
+		VideoFrame.frame_rate_D = FrameRateDenominator;
+		VideoFrame.picture_aspect_ratio = (float)SendWidth / (float)Dim.Y;
+		VideoFrame.frame_format_type = NDIlib_frame_format_type_progressive;
+		VideoFrame.timecode = NDIlib_send_timecode_synthesize;
+		VideoFrame.p_data = SendBuffer.GetData();
+		VideoFrame.line_stride_in_bytes = SendStride;
+	}
+
+	const uint64 SendStartCycles = FPlatformTime::Cycles64();
+
+	// returns once NDI is done with the previously sent buffer
+	FNdi::Lib->NDIlib_send_send_video_async_v2(SendInstance, &VideoFrame);
+
+	SendCycles.Add(FPlatformTime::Cycles64() - SendStartCycles);
+	SendBufferIndex ^= 1;
+	NumSentFrames.Increment();
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
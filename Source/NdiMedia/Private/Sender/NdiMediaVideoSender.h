@@ -0,0 +1,297 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "RHI.h"
+
+#include "NdiMediaSender.h"
+
+class FEvent;
+class FNdiMediaColorPacker;
+class FNdiMediaDownscaler;
+class FRHICommandListImmediate;
+class FRunnableThread;
+class SWindow;
+
+
+/**
+ * Sends video frames from GPU textures to NDI.
+ *
+ * Textures are copied into a ring of staging textures on the render thread, and a
+ * GPU fence is written after each copy. Staging textures are only mapped once their
+ * fence signaled, so that mapping never waits for the GPU, and captures are dropped
+ * if the GPU hasn't finished the copy into the next staging texture. Fences are polled
+ * on each capture and on each tick of the owning sender. The mapped frames are copied
+ * into pooled CPU buffers and queued for the send thread, which converts them
+ * (optionally packing them into UYVY on worker threads) and hands them to NDI
+ * asynchronously, alternating between two send buffers, so that the buffer that NDI
+ * is still reading from is never written to. Frames are dropped if all pooled
+ * buffers are in use.
+ */
+class FNdiMediaVideoSender
+	: public FRunnable
+	, public TSharedFromThis<FNdiMediaVideoSender, ESPMode::ThreadSafe>
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InSourceName The name of the published NDI source.
+	 * @param InGroups Comma separated list of NDI groups to publish the source in.
+	 * @param InColorFormat The color format of the sent video.
+	 * @param InDownscale Resolution reduction of the sent video.
+	 * @param InDownscaleFilter Filter for reducing the resolution.
+	 * @param InFrameRateNumerator Frame rate numerator of the sent video.
+	 * @param InFrameRateDenominator Frame rate denominator of the sent video.
+	 */
+	FNdiMediaVideoSender(const FString& InSourceName, const FString& InGroups, ENdiMediaSenderColorFormat InColorFormat, ENdiMediaDownscale InDownscale, ENdiMediaDownscaleFilter InDownscaleFilter, int32 InFrameRateNumerator, int32 InFrameRateDenominator);
+
+	/**
+	 * Virtual destructor.
+	 *
+	 * Waits for the send thread to exit and for NDI to release the last send buffer.
+	 * Use FNdi::ReleaseAsync to destroy senders on the game thread.
+	 */
+	virtual ~FNdiMediaVideoSender();
+
+public:
+
+	/**
+	 * Capture a texture (render thread only).
+	 *
+	 * @param RHICmdList The command list to use.
+	 * @param Texture The texture to capture (must have an 8-bit RGBA or BGRA format).
+	 */
+	void Capture_RenderThread(FRHICommandListImmediate& RHICmdList, FTexture2DRHIParamRef Texture);
+
+	/**
+	 * Get statistics about the sent video.
+	 *
+	 * @return Human readable statistics.
+	 */
+	FString GetStats() const;
+
+	/**
+	 * Whether any receivers are connected to the published source.
+	 *
+	 * @return true if connected, false otherwise.
+	 */
+	bool HasConnections() const;
+
+	/**
+	 * Read back the staging textures whose copies the GPU finished (render thread only).
+	 *
+	 * Captures also do this, but polling on every tick ensures that the last captured
+	 * frames are sent even if no further captures follow.
+	 *
+	 * @param RHICmdList The command list to use.
+	 * @see Capture_RenderThread
+	 */
+	void PollReadbacks_RenderThread(FRHICommandListImmediate& RHICmdList);
+
+	/**
+	 * Capture the next back buffer of the capture window (game thread only).
+	 *
+	 * @return true if the capture was requested, false if the window was destroyed.
+	 * @see SetCaptureWindow
+	 */
+	bool RequestWindowCapture();
+
+	/**
+	 * Set the window whose back buffer to capture (game thread only).
+	 *
+	 * @param Window The window.
+	 * @see RequestWindowCapture
+	 */
+	void SetCaptureWindow(const TSharedPtr<SWindow>& Window);
+
+	/**
+	 * Create the NDI send instance and start the send thread.
+	 *
+	 * @return true on success, false otherwise.
+	 */
+	bool Start();
+
+public:
+
+	/** Callback for the back buffer of a window being ready to present (render thread). */
+	void HandleBackBufferReadyToPresent(SWindow& Window, const FTexture2DRHIRef& BackBuffer);
+
+public:
+
+	//~ FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+
+	/** A frame that was read back from the GPU. */
+	struct FFrame
+	{
+		/** The pixel data (no row padding). */
+		TArray<uint8> Data;
+
+		/** Dimensions of the frame (in pixels). */
+		FIntPoint Dim;
+
+		/** Whether the pixels are in RGBA instead of BGRA order. */
+		bool Rgba;
+	};
+
+	/** A staging texture for reading back a captured texture. */
+	struct FReadback
+	{
+		/** Dimensions of the staging texture (in pixels). */
+		FIntPoint Dim;
+
+		/** Fence that signals when the GPU finished the copy into the staging texture. */
+		FGPUFenceRHIRef Fence;
+
+		/** Pixel format of the staging texture. */
+		EPixelFormat Format;
+
+		/** Whether a copy into the staging texture is pending. */
+		bool Pending;
+
+		/** The staging texture. */
+		FTexture2DRHIRef Texture;
+	};
+
+	/**
+	 * Get a frame from the pool.
+	 *
+	 * @return The frame, or nullptr if all frames are in use.
+	 * @see ReleaseFrame
+	 */
+	FFrame* AcquireFrame();
+
+	/**
+	 * Read back a staging texture whose fence signaled into a frame and queue it for sending (render thread only).
+	 *
+	 * @param RHICmdList The command list to use.
+	 * @param Readback The staging texture to read.
+	 */
+	void ReadFrame_RenderThread(FRHICommandListImmediate& RHICmdList, FReadback& Readback);
+
+	/**
+	 * Return a frame to the pool.
+	 *
+	 * @param Frame The frame to return.
+	 * @see AcquireFrame
+	 */
+	void ReleaseFrame(FFrame* Frame);
+
+	/**
+	 * Convert a frame and send it to NDI (send thread only).
+	 *
+	 * @param Frame The frame to send.
+	 */
+	void SendFrame(FFrame& Frame);
+
+private:
+
+	/** The window whose back buffer to capture (game thread only). */
+	TWeakPtr<SWindow> CaptureWindow;
+
+	/** The color format of the sent video. */
+	ENdiMediaSenderColorFormat ColorFormat;
+
+	/** Packs frames into UYVY (only used on the send thread). */
+	FNdiMediaColorPacker* ColorPacker;
+
+	/** Total time spent converting frames on the send thread (in cycles). */
+	FThreadSafeCounter64 ConvertCycles;
+
+	/** Critical section for synchronizing access to the frame pool. */
+	FCriticalSection CriticalSection;
+
+	/** Buffer for downscaled frames that are packed afterwards (send thread only). */
+	TArray<uint8> DownscaleBuffer;
+
+	/** Downscaler for sent frames (only used on the send thread). */
+	FNdiMediaDownscaler* Downscaler;
+
+	/** Event that is triggered when a frame was queued. */
+	FEvent* FrameEvent;
+
+	/** Frame rate denominator of the sent video. */
+	int32 FrameRateDenominator;
+
+	/** Frame rate numerator of the sent video. */
+	int32 FrameRateNumerator;
+
+	/** Frames that are not in use. */
+	TArray<FFrame*> FreeFrames;
+
+	/** Comma separated list of NDI groups to publish the source in. */
+	FString Groups;
+
+	/** Number of frames that were captured. */
+	FThreadSafeCounter NumCapturedFrames;
+
+	/** Number of frames that were dropped because all pooled frames were in use. */
+	FThreadSafeCounter NumDroppedFrames;
+
+	/** Number of frames that have been allocated. */
+	int32 NumFrames;
+
+	/** Number of frames that were read back. */
+	FThreadSafeCounter NumReadFrames;
+
+	/** Number of frames that were sent. */
+	FThreadSafeCounter NumSentFrames;
+
+	/** Total time spent packing frames into UYVY (in cycles). */
+	FThreadSafeCounter64 PackCycles;
+
+	/** Frames that were read back and wait to be sent. */
+	TQueue<FFrame*, EQueueMode::Spsc> PendingFrames;
+
+	/** Total time spent reading back frames on the render thread (in cycles). */
+	FThreadSafeCounter64 ReadbackCycles;
+
+	/** The window whose next back buffer should be captured (nullptr = none, only compared by address on the render thread). */
+	SWindow* RequestedWindow;
+
+	/** Index of the next staging texture to use, which is also the oldest pending one (render thread only). */
+	int32 ReadbackIndex;
+
+	/** The ring of staging textures (render thread only). */
+	TArray<FReadback> Readbacks;
+
+	/** The buffers that frames are sent from (send thread only). */
+	TArray<uint8> SendBuffers[2];
+
+	/** Index of the next send buffer to use (send thread only). */
+	int32 SendBufferIndex;
+
+	/** Total time spent waiting for NDI to accept frames (in cycles). */
+	FThreadSafeCounter64 SendCycles;
+
+	/** The NDI send instance. */
+	void* SendInstance;
+
+	/** The name of the published NDI source. */
+	FString SourceName;
+
+	/** The time at which sending started (in seconds). */
+	double StartTime;
+
+	/** Whether the send thread should stop. */
+	FThreadSafeBool Stopping;
+
+	/** The send thread. */
+	FRunnableThread* Thread;
+
+	/** Whether a pixel format warning has been logged (render thread only). */
+	bool UnsupportedFormatLogged;
+};
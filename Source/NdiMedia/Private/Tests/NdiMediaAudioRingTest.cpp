@@ -0,0 +1,159 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Async/Async.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaAudioRing.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaAudioRingAttachTest, "Plugin.NdiMedia.AudioRing.Attach", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaAudioRingLatencyTest, "Plugin.NdiMedia.AudioRing.Latency", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaAudioRingTest
+{
+	/** Sample rate of the simulated source. */
+	const int32 SampleRate = 48000;
+
+	/** Create an audio frame of stereo silence that points into the given buffer. */
+	NDIlib_audio_frame_v2_t MakeFrame(TArray<float>& Buffer, int32 NumFrames)
+	{
+		Buffer.SetNumZeroed(NumFrames * 2);
+
+		NDIlib_audio_frame_v2_t Frame;
+		{
+			Frame.sample_rate = SampleRate;
+			Frame.no_channels = 2;
+			Frame.no_samples = NumFrames;
+			Frame.p_data = Buffer.GetData();
+			Frame.channel_stride_in_bytes = NumFrames * sizeof(float);
+		}
+
+		return Frame;
+	}
+}
+
+
+bool FNdiMediaAudioRingAttachTest::RunTest(const FString& Parameters)
+{
+	FNdiMediaAudioRing Ring(1024);
+
+	TestTrue(TEXT("The first producer must attach"), Ring.AttachProducer());
+	TestFalse(TEXT("A second producer must be refused"), Ring.AttachProducer());
+	TestTrue(TEXT("The first consumer must attach"), Ring.AttachConsumer());
+	TestFalse(TEXT("A second consumer must be refused"), Ring.AttachConsumer());
+
+	Ring.DetachProducer();
+	Ring.DetachConsumer();
+
+	TestTrue(TEXT("A producer must attach after the previous one detached"), Ring.AttachProducer());
+	TestTrue(TEXT("A consumer must attach after the previous one detached"), Ring.AttachConsumer());
+
+	// resets are carried out by the consumer
+	TArray<float> FrameBuffer;
+	TArray<float> Output;
+	Output.SetNumUninitialized(256 * FNdiMediaAudioRing::NumChannels);
+
+	const NDIlib_audio_frame_v2_t Frame = NdiMediaAudioRingTest::MakeFrame(FrameBuffer, 256);
+
+	Ring.Write(Frame, 0, 2, 0, FPlatformTime::Cycles64());
+	Ring.RequestReset();
+
+	TestEqual(TEXT("Frames written before a reset request must be discarded"), Ring.Read(Output.GetData(), 256, 1024), 0);
+
+	Ring.Write(Frame, 0, 2, 0, FPlatformTime::Cycles64());
+
+	TestEqual(TEXT("Frames written after a reset request must be read"), Ring.Read(Output.GetData(), 256, 1024), 256);
+
+	// latency is measured from the time the frame was received
+	const uint64 CaptureCycles = FPlatformTime::Cycles64() - (uint64)(0.005 / FPlatformTime::GetSecondsPerCycle64());
+
+	Ring.Write(Frame, 0, 2, 0, CaptureCycles);
+	Ring.Read(Output.GetData(), 256, 1024);
+
+	TestTrue(TEXT("The latency must include the time since the frame was received"), Ring.GetMaxLatency() >= 5.0f);
+
+	return true;
+}
+
+
+bool FNdiMediaAudioRingLatencyTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaAudioRingTest;
+
+	// NDI senders with low latency deliver 10 ms frames, and the audio mixer renders 256 frames per callback
+	const int32 FramesPerWrite = SampleRate / 100;
+	const int32 FramesPerRead = 256;
+	const int32 MaxLatencyFrames = SampleRate / 50;
+	const double TestSeconds = 2.0;
+
+	FNdiMediaAudioRing Ring(8192);
+	FThreadSafeBool Stopped;
+
+	Ring.AttachProducer();
+	Ring.AttachConsumer();
+
+	// simulate the media ticker thread, which receives frames as they arrive
+	TFuture<void> Producer = Async<void>(EAsyncExecution::Thread, [&Ring, &Stopped, FramesPerWrite]()
+	{
+		TArray<float> FrameBuffer;
+		const NDIlib_audio_frame_v2_t Frame = MakeFrame(FrameBuffer, FramesPerWrite);
+		const double Interval = (double)FramesPerWrite / SampleRate;
+		double NextTime = FPlatformTime::Seconds();
+
+		while (!Stopped)
+		{
+			Ring.Write(Frame, 0, 2, 0, FPlatformTime::Cycles64());
+
+			NextTime += Interval;
+			FPlatformProcess::Sleep(FMath::Max(0.0, NextTime - FPlatformTime::Seconds()));
+		}
+	});
+
+	// simulate the audio render thread
+	TArray<float> Output;
+	Output.SetNumUninitialized(FramesPerRead * FNdiMediaAudioRing::NumChannels);
+
+	const double Interval = (double)FramesPerRead / SampleRate;
+	const double StartTime = FPlatformTime::Seconds();
+	double NextTime = StartTime;
+	int64 NumRead = 0;
+
+	while (FPlatformTime::Seconds() - StartTime < TestSeconds)
+	{
+		NumRead += Ring.Read(Output.GetData(), FramesPerRead, MaxLatencyFrames);
+
+		NextTime += Interval;
+		FPlatformProcess::Sleep(FMath::Max(0.0, NextTime - FPlatformTime::Seconds()));
+	}
+
+	Stopped = true;
+	Producer.Wait();
+
+	AddInfo(FString::Printf(TEXT("Capture to render latency: %.2f ms average, %.2f ms max"), Ring.GetAverageLatency(), Ring.GetMaxLatency()));
+	AddInfo(FString::Printf(TEXT("Frames read: %lld, skipped: %i, underruns: %i"), NumRead, Ring.GetNumSkippedFrames(), Ring.GetNumUnderruns()));
+
+	TestTrue(TEXT("Audio must be delivered"), NumRead > 0);
+
+	if (Ring.GetAverageLatency() >= 20.0f)
+	{
+		AddWarning(FString::Printf(TEXT("Average latency of %.2f ms exceeds the 20 ms target"), Ring.GetAverageLatency()));
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
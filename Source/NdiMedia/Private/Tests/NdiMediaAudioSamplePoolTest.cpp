@@ -0,0 +1,103 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaAudioBufferArena.h"
+#include "NdiMediaAudioChunker.h"
+#include "NdiMediaAudioQueue.h"
+#include "NdiMediaAudioSample.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaAudioSamplePoolAllocationTest, "Plugin.NdiMedia.AudioSamplePool.SteadyStateAllocations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FNdiMediaAudioSamplePoolAllocationTest::RunTest(const FString& Parameters)
+{
+	// same sizes as the player uses for 48 kHz stereo, re-chunked to the audio callback size
+	const int32 ChunkFrames = 1024;
+	const int32 NumChannels = 2;
+	const int32 NumSamples = 16;
+	const int32 NumWarmupFrames = 30;
+	const int32 NumSteadyStateFrames = 1000;
+	const int32 SampleRate = 48000;
+	const int32 NdiFrames = SampleRate / 30;
+
+	auto Arena = MakeShared<FNdiMediaAudioBufferArena, ESPMode::ThreadSafe>(NumChannels * ChunkFrames, NumSamples);
+	auto Queue = MakeShared<FNdiMediaAudioQueue, ESPMode::ThreadSafe>();
+
+	FNdiMediaAudioChunker Chunker;
+	Chunker.SetChunkFrames(ChunkFrames);
+
+	FNdiMediaAudioSamplePool Pool;
+	Pool.Prewarm(NumSamples, Arena);
+
+	TArray<short> NdiFrame;
+	NdiFrame.SetNumZeroed(NdiFrames * NumChannels);
+
+	// stands in for the media sample queue, which holds samples until the sink plays them
+	TArray<TSharedPtr<FNdiMediaAudioSample, ESPMode::ThreadSafe>> Consumer;
+	Consumer.Reserve(NumSamples);
+
+	FTimespan Time = FTimespan::Zero();
+	int32 NumWarmupAllocations = 0;
+
+	for (int32 FrameIndex = 0; FrameIndex < NumWarmupFrames + NumSteadyStateFrames; ++FrameIndex)
+	{
+		// all allocations on the audio path are counted where they happen
+		if (FrameIndex == NumWarmupFrames)
+		{
+			NumWarmupAllocations = Pool.GetNumAllocations() + Chunker.GetNumAllocations() + Arena->GetNumHeapAllocations();
+		}
+
+		// producer, as in FNdiMediaPlayer::ProcessAudio
+		Pool.Reclaim();
+		Chunker.Append(NdiFrame.GetData(), NdiFrames, NumChannels, SampleRate, Time);
+
+		while (Chunker.CanPop())
+		{
+			auto AudioSample = Pool.AcquireShared();
+			AudioSample->SetArena(Arena);
+
+			if (Chunker.Pop(*AudioSample, Queue))
+			{
+				Consumer.Add(AudioSample);
+			}
+		}
+
+		// consumer, which plays and releases the samples
+		for (const auto& AudioSample : Consumer)
+		{
+			AudioSample->GetBuffer();
+		}
+
+		Consumer.Reset();
+
+		Time += FTimespan(ETimespan::TicksPerSecond * NdiFrames / SampleRate);
+	}
+
+	const int32 NumAllocations = Pool.GetNumAllocations() + Chunker.GetNumAllocations() + Arena->GetNumHeapAllocations() - NumWarmupAllocations;
+
+	AddInfo(FString::Printf(TEXT("%i allocations in %i steady state frames, %i pooled samples (%i created on demand), %i chunk buffer allocations, %i arena fallbacks"),
+		NumAllocations, NumSteadyStateFrames, Pool.GetNumSamples(), Pool.GetNumAllocations(), Chunker.GetNumAllocations(), Arena->GetNumHeapAllocations()));
+
+	TestEqual(TEXT("Steady state allocations"), NumAllocations, 0);
+	TestEqual(TEXT("Samples created on demand"), Pool.GetNumAllocations(), 0);
+	TestEqual(TEXT("Arena heap fallbacks"), Arena->GetNumHeapAllocations(), 0);
+	TestEqual(TEXT("Pooled samples"), Pool.GetNumSamples(), NumSamples);
+
+	Pool.Reset();
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
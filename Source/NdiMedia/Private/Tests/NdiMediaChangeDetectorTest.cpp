@@ -0,0 +1,198 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaChangeDetector.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaChangeDetectorRowsTest, "Plugin.NdiMedia.ChangeDetector.Rows", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaChangeDetectorCostTest, "Plugin.NdiMedia.ChangeDetector.Cost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaChangeDetectorTest
+{
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+
+	/** Describe a progressive UYVY frame in the given buffer. */
+	NDIlib_video_frame_v2_t MakeFrame(TArray<uint8>& Buffer, int32 Width, int32 Height)
+	{
+		NDIlib_video_frame_v2_t Frame;
+		{
+			Frame.xres = Width;
+			Frame.yres = Height;
+			Frame.FourCC = NDIlib_FourCC_type_UYVY;
+			Frame.frame_rate_N = 60;
+			Frame.frame_rate_D = 1;
+			Frame.frame_format_type = NDIlib_frame_format_type_progressive;
+			Frame.p_data = Buffer.GetData();
+			Frame.line_stride_in_bytes = Width * 2;
+		}
+
+		return Frame;
+	}
+
+	/** Convert row ranges to a string, i.e. "16-32, 1072-1080". */
+	FString RowsToString(const TArray<FInt32Range>& Rows)
+	{
+		FString Result;
+
+		for (const FInt32Range& Range : Rows)
+		{
+			Result += FString::Printf(TEXT("%s%i-%i"), Result.IsEmpty() ? TEXT("") : TEXT(", "), Range.GetLowerBoundValue(), Range.GetUpperBoundValue());
+		}
+
+		return Result;
+	}
+}
+
+
+bool FNdiMediaChangeDetectorRowsTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaChangeDetectorTest;
+
+	// odd height, so that the last band is partial
+	const int32 Width = 64;
+	const int32 Height = 100;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Buffer;
+	FillRandom(Buffer, Width * Height * 2, Random);
+
+	const NDIlib_video_frame_v2_t Frame = MakeFrame(Buffer, Width, Height);
+	FNdiMediaChangeDetector Detector;
+	TArray<FInt32Range> DirtyRows;
+
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("All rows of the first frame changed"), RowsToString(DirtyRows), FString(TEXT("0-100")));
+	Detector.Commit();
+
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("No rows of a repeated frame changed"), DirtyRows.Num(), 0);
+
+	// a single changed byte is reported in its band
+	Buffer[20 * Width * 2 + 7] ^= 0x01;
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("A changed row is reported in its band"), RowsToString(DirtyRows), FString(TEXT("16-32")));
+
+	// the frame is dropped, and the next frame changes elsewhere
+	Buffer[99 * Width * 2] ^= 0x01;
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("Changes of frames that were not committed are carried over"), RowsToString(DirtyRows), FString(TEXT("16-32, 96-100")));
+	Detector.Commit();
+
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("No rows changed since the committed frame"), DirtyRows.Num(), 0);
+
+	// adjacent bands are merged
+	Buffer[40 * Width * 2] ^= 0x01;
+	Buffer[50 * Width * 2] ^= 0x01;
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("Adjacent changed bands are merged"), RowsToString(DirtyRows), FString(TEXT("32-64")));
+
+	// parallel detection finds the same rows
+	TArray<FInt32Range> ParallelDirtyRows;
+	Detector.Detect(Frame, 0, ParallelDirtyRows);
+	TestEqual(TEXT("Parallel detection finds the same rows"), RowsToString(ParallelDirtyRows), RowsToString(DirtyRows));
+	Detector.Commit();
+
+	// a different layout changes all rows
+	const NDIlib_video_frame_v2_t SmallFrame = MakeFrame(Buffer, Width, Height / 2);
+	Detector.Detect(SmallFrame, 1, DirtyRows);
+	TestEqual(TEXT("All rows of a frame with a different layout changed"), RowsToString(DirtyRows), FString(TEXT("0-50")));
+
+	Detector.Reset();
+	Detector.Detect(Frame, 1, DirtyRows);
+	TestEqual(TEXT("All rows changed after a reset"), RowsToString(DirtyRows), FString(TEXT("0-100")));
+
+	return true;
+}
+
+
+bool FNdiMediaChangeDetectorCostTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaChangeDetectorTest;
+
+	const FIntPoint Dims[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+	const int32 NumIterations = 30;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const FIntPoint& Dim : Dims)
+	{
+		// mostly static frames with an animated lower third
+		TArray<uint8> Buffer;
+		FillRandom(Buffer, Dim.X * Dim.Y * 2, Random);
+
+		const NDIlib_video_frame_v2_t Frame = MakeFrame(Buffer, Dim.X, Dim.Y);
+		const int32 LowerThirdTop = Dim.Y * 3 / 4;
+		const int32 LowerThirdRows = Dim.Y / 8;
+
+		FNdiMediaChangeDetector Detector;
+		TArray<FInt32Range> DirtyRows;
+
+		Detector.Detect(Frame, 0, DirtyRows);
+		Detector.Commit();
+
+		for (const int32 MaxThreads : { 1, 0 })
+		{
+			int64 NumDirtyRows = 0;
+			uint64 DetectCycles = 0;
+
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				FMemory::Memset(&Buffer[LowerThirdTop * Dim.X * 2], (uint8)Iteration, LowerThirdRows * Dim.X * 2);
+
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+				Detector.Detect(Frame, MaxThreads, DirtyRows);
+				DetectCycles += FPlatformTime::Cycles64() - StartCycles;
+
+				Detector.Commit();
+
+				for (const FInt32Range& Rows : DirtyRows)
+				{
+					NumDirtyRows += Rows.Size<int32>();
+				}
+			}
+
+			const double Milliseconds = FPlatformTime::ToMilliseconds64(DetectCycles) / NumIterations;
+			const double DirtyFraction = (double)NumDirtyRows / ((double)Dim.Y * NumIterations);
+
+			AddInfo(FString::Printf(TEXT("%i x %i UYVY, %s: %.3f ms per frame, %.1f%% of rows changed, %.1f MB of %.1f MB uploaded per frame"),
+				Dim.X, Dim.Y, (MaxThreads == 1) ? TEXT("1 thread") : TEXT("all threads"), Milliseconds, 100.0 * DirtyFraction,
+				DirtyFraction * Dim.X * Dim.Y * 2 / 1000000.0, (double)Dim.X * Dim.Y * 2 / 1000000.0));
+
+			TestTrue(FString::Printf(TEXT("%i x %i UYVY: only the lower third changed"), Dim.X, Dim.Y), DirtyFraction < 0.25);
+
+			// detection must stay well below a 60 fps frame period
+			if (Milliseconds > 1000.0 / 240.0)
+			{
+				AddWarning(FString::Printf(TEXT("Detecting changed rows of %i x %i frames takes longer than a quarter of a 60 fps frame period"), Dim.X, Dim.Y));
+			}
+		}
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+#include "NdiMediaHidePlatformTypes.h"
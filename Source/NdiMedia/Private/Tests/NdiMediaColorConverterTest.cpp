@@ -0,0 +1,487 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/RandomStream.h"
+#include "Math/UnrealMathUtility.h"
+#include "Misc/AutomationTest.h"
+#include "Templates/UniquePtr.h"
+
+#include "NdiMediaColorConverter.h"
+#include "NdiMediaSource.h"
+#include "NdiMediaVideoConversion.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaColorConverterAccuracyTest, "Plugin.NdiMedia.ColorConverter.Accuracy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaColorConverterAutoTest, "Plugin.NdiMedia.ColorConverter.Auto", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaColorConverterOddWidthTest, "Plugin.NdiMedia.ColorConverter.OddWidth", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaColorConverterThroughputTest, "Plugin.NdiMedia.ColorConverter.Throughput", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaColorConverterTest
+{
+	/** Exposes the row conversions of the color converter. */
+	class FColorConverter
+		: public FNdiMediaColorConverter
+	{
+	public:
+
+		using FNdiMediaColorConverter::FCoefficients;
+		using FNdiMediaColorConverter::ConvertRow;
+		using FNdiMediaColorConverter::ConvertRowScalar;
+		using FNdiMediaColorConverter::MapGamutRow;
+	};
+
+	/** Exposes the row conversions of the high-bit-depth formats. */
+	class FVideoConversion
+		: public FNdiMediaVideoConversion
+	{
+	public:
+
+		using FNdiMediaVideoConversion::P216ToBgr10A2Row;
+	};
+
+	/** A color space under test. */
+	struct FColorSpace
+	{
+		const TCHAR* Name;
+		double Kr;
+		double Kb;
+		bool MapGamut;
+	};
+
+	/** The color spaces under test. */
+	const FColorSpace ColorSpaces[] =
+	{
+		{ TEXT("BT.601"), 0.299, 0.114, false },
+		{ TEXT("BT.709"), 0.2126, 0.0722, false },
+		{ TEXT("BT.2020"), 0.2627, 0.0593, true },
+	};
+
+	/** Linear BT.2020 to BT.709 conversion matrix (ITU-R BT.2087). */
+	const double GamutMatrix[9] =
+	{
+		1.6605, -0.5876, -0.0728,
+		-0.1246, 1.1329, -0.0083,
+		-0.0182, -0.1006, 1.1187,
+	};
+
+	/** Convert a YUV pixel to 8-bit RGB in double precision. */
+	void ReferenceYuvToRgb(const FColorSpace& Space, bool FullRange, int32 Y, int32 U, int32 V, int32 OutRgb[3])
+	{
+		const double Kg = 1.0 - Space.Kr - Space.Kb;
+		const double L = FullRange ? Y / 255.0 : (Y - 16) / 219.0;
+		const double Cb = (U - 128) / (FullRange ? 255.0 : 224.0);
+		const double Cr = (V - 128) / (FullRange ? 255.0 : 224.0);
+
+		const double Rgb[3] =
+		{
+			L + 2.0 * (1.0 - Space.Kr) * Cr,
+			L - 2.0 * Space.Kb * (1.0 - Space.Kb) / Kg * Cb - 2.0 * Space.Kr * (1.0 - Space.Kr) / Kg * Cr,
+			L + 2.0 * (1.0 - Space.Kb) * Cb,
+		};
+
+		for (int32 Component = 0; Component < 3; ++Component)
+		{
+			OutRgb[Component] = FMath::RoundToInt(FMath::Clamp(Rgb[Component], 0.0, 1.0) * 255.0);
+		}
+	}
+
+	/** Map 8-bit BT.2020 RGB to 8-bit sRGB encoded BT.709 RGB in double precision. */
+	void ReferenceMapGamut(const int32 Rgb[3], int32 OutRgb[3])
+	{
+		double Linear[3];
+
+		for (int32 Component = 0; Component < 3; ++Component)
+		{
+			Linear[Component] = FMath::Pow(Rgb[Component] / 255.0, 2.4);
+		}
+
+		for (int32 Component = 0; Component < 3; ++Component)
+		{
+			const double* Row = GamutMatrix + Component * 3;
+			const double Mapped = FMath::Clamp(Row[0] * Linear[0] + Row[1] * Linear[1] + Row[2] * Linear[2], 0.0, 1.0);
+			const double Encoded = (Mapped <= 0.0031308) ? Mapped * 12.92 : 1.055 * FMath::Pow(Mapped, 1.0 / 2.4) - 0.055;
+
+			OutRgb[Component] = FMath::RoundToInt(Encoded * 255.0);
+		}
+	}
+
+	/** Get the largest difference between an output BGRA pixel and an expected RGB pixel. */
+	int32 GetError(const uint8* Bgra, const int32 Rgb[3])
+	{
+		return FMath::Max3(FMath::Abs(Bgra[2] - Rgb[0]), FMath::Abs(Bgra[1] - Rgb[1]), FMath::Abs(Bgra[0] - Rgb[2]));
+	}
+
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+}
+
+
+bool FNdiMediaColorConverterAccuracyTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaColorConverterTest;
+
+	// odd width, so that the SIMD loop, the scalar tail and a single pixel texel are covered
+	const int32 Width = 1001;
+	const int32 NumRows = 64;
+
+	FRandomStream Random(0x4e4449);
+	FColorConverter Converter;
+	TArray<uint8> Uyvy, Alpha, SimdRow, ScalarRow;
+
+	SimdRow.SetNumUninitialized(Width * 4);
+	ScalarRow.SetNumUninitialized(Width * 4);
+
+	for (const FColorSpace& Space : ColorSpaces)
+	{
+		for (const bool FullRange : { false, true })
+		{
+			TUniquePtr<FColorConverter::FCoefficients> Coefficients(new FColorConverter::FCoefficients);
+			Coefficients->Initialize((float)Space.Kr, (float)Space.Kb, FullRange);
+
+			int32 MaxError = 0;
+			int32 MaxGamutError = 0;
+			int32 NumMismatches = 0;
+			bool AlphaMatches = true;
+
+			for (int32 Row = 0; Row < NumRows; ++Row)
+			{
+				// UYVY rows are padded to whole texels
+				FillRandom(Uyvy, (Width + 1) * 2, Random);
+				FillRandom(Alpha, Width, Random);
+
+				const uint8* RowAlpha = (Row & 1) ? Alpha.GetData() : nullptr;
+
+				FColorConverter::ConvertRow(*Coefficients, Uyvy.GetData(), RowAlpha, SimdRow.GetData(), Width);
+				FColorConverter::ConvertRowScalar(*Coefficients, Uyvy.GetData(), RowAlpha, ScalarRow.GetData(), Width);
+
+				for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+				{
+					const uint8* Texel = Uyvy.GetData() + (Pixel & ~1) * 2;
+					const uint8* Simd = SimdRow.GetData() + Pixel * 4;
+
+					int32 Expected[3];
+					ReferenceYuvToRgb(Space, FullRange, Texel[(Pixel & 1) ? 3 : 1], Texel[0], Texel[2], Expected);
+
+					MaxError = FMath::Max(MaxError, GetError(Simd, Expected));
+					NumMismatches += (FMemory::Memcmp(Simd, ScalarRow.GetData() + Pixel * 4, 4) != 0) ? 1 : 0;
+					AlphaMatches &= (Simd[3] == ((RowAlpha != nullptr) ? RowAlpha[Pixel] : 255));
+				}
+
+				if (Space.MapGamut)
+				{
+					// the gamut is mapped from the 8-bit BT.2020 values, so the reference starts from those
+					TArray<uint8> Mapped = SimdRow;
+					Converter.MapGamutRow(Mapped.GetData(), Width);
+
+					for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+					{
+						const uint8* Bgra = SimdRow.GetData() + Pixel * 4;
+						const int32 Rgb[3] = { Bgra[2], Bgra[1], Bgra[0] };
+
+						int32 Expected[3];
+						ReferenceMapGamut(Rgb, Expected);
+
+						MaxGamutError = FMath::Max(MaxGamutError, GetError(Mapped.GetData() + Pixel * 4, Expected));
+					}
+				}
+			}
+
+			const FString Name = FString::Printf(TEXT("%s %s range"), Space.Name, FullRange ? TEXT("full") : TEXT("limited"));
+
+			AddInfo(FString::Printf(TEXT("%s: max error %i LSB, %i SIMD and scalar mismatches"), *Name, MaxError, NumMismatches));
+			TestTrue(FString::Printf(TEXT("%s is within 1 LSB of the reference"), *Name), MaxError <= 1);
+			TestEqual(FString::Printf(TEXT("%s SIMD and scalar results"), *Name), NumMismatches, 0);
+			TestTrue(FString::Printf(TEXT("%s keeps alpha"), *Name), AlphaMatches);
+
+			if (Space.MapGamut)
+			{
+				AddInfo(FString::Printf(TEXT("%s gamut mapping: max error %i LSB"), *Name, MaxGamutError));
+				TestTrue(FString::Printf(TEXT("%s gamut mapping is within 1 LSB of the reference"), *Name), MaxGamutError <= 1);
+			}
+		}
+	}
+
+	// P216 is always converted as limited range BT.709
+	TArray<uint16> Y, UV;
+	TArray<uint32> SimdTexels, ScalarTexels;
+
+	Y.SetNumUninitialized(Width + 1);
+	UV.SetNumUninitialized(Width + 1);
+	SimdTexels.SetNumUninitialized(Width);
+	ScalarTexels.SetNumUninitialized(Width);
+
+	int32 MaxError = 0;
+	int32 MaxMismatch = 0;
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		for (int32 Index = 0; Index <= Width; ++Index)
+		{
+			Y[Index] = (uint16)Random.RandHelper(65536);
+			UV[Index] = (uint16)Random.RandHelper(65536);
+		}
+
+		FVideoConversion::P216ToBgr10A2Row(Y.GetData(), UV.GetData(), (uint8*)SimdTexels.GetData(), Width);
+
+		// single pixels are converted without SIMD instructions
+		for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+		{
+			FVideoConversion::P216ToBgr10A2Row(Y.GetData() + Pixel, UV.GetData() + (Pixel & ~1), (uint8*)(ScalarTexels.GetData() + Pixel), 1);
+		}
+
+		for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+		{
+			const uint16* Pair = UV.GetData() + (Pixel & ~1);
+			const double L = (Y[Pixel] - 4096.0) / 56064.0;
+			const double Cb = (Pair[0] - 32768.0) / 57344.0;
+			const double Cr = (Pair[1] - 32768.0) / 57344.0;
+
+			const double Rgb[3] =
+			{
+				L + 1.5748 * Cr,
+				L - 0.1873 * Cb - 0.4681 * Cr,
+				L + 1.8556 * Cb,
+			};
+
+			for (int32 Component = 0; Component < 3; ++Component)
+			{
+				const int32 Expected = FMath::RoundToInt(FMath::Clamp(Rgb[Component], 0.0, 1.0) * 1023.0);
+				const int32 Simd = (SimdTexels[Pixel] >> (Component * 10)) & 1023;
+				const int32 Scalar = (ScalarTexels[Pixel] >> (Component * 10)) & 1023;
+
+				MaxError = FMath::Max3(MaxError, FMath::Abs(Simd - Expected), FMath::Abs(Scalar - Expected));
+				MaxMismatch = FMath::Max(MaxMismatch, FMath::Abs(Simd - Scalar));
+			}
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("P216: max error %i LSB, max SIMD and scalar difference %i LSB"), MaxError, MaxMismatch));
+	TestTrue(TEXT("P216 is within 1 LSB of the reference"), MaxError <= 1);
+	TestTrue(TEXT("P216 SIMD and scalar results are within 1 LSB"), MaxMismatch <= 1);
+
+	return true;
+}
+
+
+bool FNdiMediaColorConverterAutoTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaColorConverterTest;
+
+	const int32 Width = 16;
+	const int32 Heights[] = { 480, 576, 720, 1080 };
+
+	FRandomStream Random(0x4e4449);
+
+	for (const int32 Height : Heights)
+	{
+		TArray<uint8> Uyvy;
+		FillRandom(Uyvy, Width * 2 * Height, Random);
+
+		NDIlib_video_frame_v2_t Frame;
+		{
+			Frame.xres = Width;
+			Frame.yres = Height;
+			Frame.FourCC = NDIlib_FourCC_type_UYVY;
+			Frame.p_data = Uyvy.GetData();
+			Frame.line_stride_in_bytes = Width * 2;
+		}
+
+		// SD frames use BT.601, and HD frames use BT.709
+		const ENdiMediaColorSpace Expected = (Height < 720) ? ENdiMediaColorSpace::BT601 : ENdiMediaColorSpace::BT709;
+
+		TArray<uint8> AutoDest, ExpectedDest;
+		AutoDest.SetNumZeroed(Width * 4 * Height);
+		ExpectedDest.SetNumZeroed(Width * 4 * Height);
+
+		FNdiMediaColorConverter Converter;
+		Converter.SetMode(ENdiMediaColorSpace::Auto, ENdiMediaColorRange::Limited);
+		Converter.Convert(Frame, AutoDest.GetData(), Width * 4, 1);
+		Converter.SetMode(Expected, ENdiMediaColorRange::Limited);
+		Converter.Convert(Frame, ExpectedDest.GetData(), Width * 4, 1);
+
+		TestTrue(FString::Printf(TEXT("Auto converts %i line frames with %s"), Height, (Height < 720) ? TEXT("BT.601") : TEXT("BT.709")), AutoDest == ExpectedDest);
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaColorConverterOddWidthTest::RunTest(const FString& Parameters)
+{
+	const int32 Width = 17;
+	const int32 Height = 4;
+	const int32 Stride = (Width + 1) * 2;
+
+	// limited range white
+	TArray<uint8> Uyvy;
+	Uyvy.SetNumUninitialized(Stride * Height);
+
+	for (int32 Texel = 0; Texel < Uyvy.Num() / 4; ++Texel)
+	{
+		Uyvy[Texel * 4 + 0] = 128;
+		Uyvy[Texel * 4 + 1] = 235;
+		Uyvy[Texel * 4 + 2] = 128;
+		Uyvy[Texel * 4 + 3] = 235;
+	}
+
+	NDIlib_video_frame_v2_t Frame;
+	{
+		Frame.xres = Width;
+		Frame.yres = Height;
+		Frame.FourCC = NDIlib_FourCC_type_UYVY;
+		Frame.p_data = Uyvy.GetData();
+		Frame.line_stride_in_bytes = Stride;
+	}
+
+	TArray<uint8> Dest;
+	Dest.SetNumZeroed(Width * 4 * Height);
+
+	FNdiMediaColorConverter Converter;
+	Converter.SetMode(ENdiMediaColorSpace::BT709, ENdiMediaColorRange::Limited);
+	Converter.Convert(Frame, Dest.GetData(), Width * 4, 1);
+
+	bool AllWhite = true;
+
+	for (const uint8 Component : Dest)
+	{
+		AllWhite &= (Component == 255);
+	}
+
+	TestTrue(TEXT("All pixels of odd width frames are converted, including the last column"), AllWhite);
+
+	return true;
+}
+
+
+bool FNdiMediaColorConverterThroughputTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaColorConverterTest;
+
+	const int32 Width = 1920;
+	const int32 Height = 1080;
+	const int32 NumIterations = 20;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Uyvy, Alpha, Dest;
+
+	FillRandom(Uyvy, Width * 2 * Height, Random);
+	FillRandom(Alpha, Width * Height, Random);
+	Dest.SetNumUninitialized(Width * 4 * Height);
+
+	FColorConverter Converter;
+	TUniquePtr<FColorConverter::FCoefficients> Coefficients(new FColorConverter::FCoefficients);
+	Coefficients->Initialize(0.2126f, 0.0722f, false);
+
+	const double MegaPixels = Width * Height * NumIterations / 1000000.0;
+
+	for (const bool WithAlpha : { false, true })
+	{
+		for (const bool Simd : { true, false })
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				for (int32 Row = 0; Row < Height; ++Row)
+				{
+					const uint8* Source = Uyvy.GetData() + Row * Width * 2;
+					const uint8* RowAlpha = WithAlpha ? Alpha.GetData() + Row * Width : nullptr;
+					uint8* Output = Dest.GetData() + Row * Width * 4;
+
+					if (Simd)
+					{
+						FColorConverter::ConvertRow(*Coefficients, Source, RowAlpha, Output, Width);
+					}
+					else
+					{
+						FColorConverter::ConvertRowScalar(*Coefficients, Source, RowAlpha, Output, Width);
+					}
+				}
+			}
+
+			const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+			AddInfo(FString::Printf(TEXT("%s to BGRA, 1920 x 1080, %s, 1 thread: %.3f ms per frame, %.1f MPixels/s"),
+				WithAlpha ? TEXT("UYVA") : TEXT("UYVY"),
+				Simd ? TEXT("SIMD") : TEXT("scalar"),
+				Seconds * 1000.0 / NumIterations,
+				MegaPixels / Seconds));
+		}
+	}
+
+	// gamut mapping is applied on top of the BT.2020 conversion
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (int32 Row = 0; Row < Height; ++Row)
+			{
+				Converter.MapGamutRow(Dest.GetData() + Row * Width * 4, Width);
+			}
+		}
+
+		const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+		AddInfo(FString::Printf(TEXT("BT.2020 gamut mapping, 1920 x 1080, 1 thread: %.3f ms per frame, %.1f MPixels/s"), Seconds * 1000.0 / NumIterations, MegaPixels / Seconds));
+	}
+
+	// P216 frames on all worker threads
+	TArray<uint16> P216;
+	P216.SetNumUninitialized(Width * Height * 2);
+
+	for (uint16& Value : P216)
+	{
+		Value = (uint16)Random.RandHelper(65536);
+	}
+
+	NDIlib_video_frame_v2_t Frame;
+	{
+		Frame.xres = Width;
+		Frame.yres = Height;
+		Frame.FourCC = (NDIlib_FourCC_type_e)NdiMedia::FourCC_P216;
+		Frame.p_data = (uint8*)P216.GetData();
+		Frame.line_stride_in_bytes = Width * 2;
+	}
+
+	for (const int32 MaxThreads : { 1, 0 })
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			FNdiMediaVideoConversion::P216ToBgr10A2(Frame, Dest.GetData(), Width * 4, MaxThreads);
+		}
+
+		const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+		AddInfo(FString::Printf(TEXT("P216 to BGR10A2, 1920 x 1080, %s: %.3f ms per frame, %.1f MPixels/s"),
+			(MaxThreads == 1) ? TEXT("1 thread") : TEXT("all threads"),
+			Seconds * 1000.0 / NumIterations,
+			MegaPixels / Seconds));
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
@@ -0,0 +1,254 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/RandomStream.h"
+#include "Math/UnrealMathUtility.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaColorPacker.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaColorPackerAccuracyTest, "Plugin.NdiMedia.ColorPacker.Accuracy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaColorPackerThroughputTest, "Plugin.NdiMedia.ColorPacker.Throughput", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaColorPackerTest
+{
+	/** Exposes the row packing of the color packer. */
+	class FColorPacker
+		: public FNdiMediaColorPacker
+	{
+	public:
+
+		using FNdiMediaColorPacker::FCoefficients;
+		using FNdiMediaColorPacker::PackRow;
+		using FNdiMediaColorPacker::PackRowScalar;
+	};
+
+	/** A color space under test. */
+	struct FColorSpace
+	{
+		const TCHAR* Name;
+		double Kr;
+		double Kb;
+	};
+
+	/** The color spaces that the packer uses. */
+	const FColorSpace ColorSpaces[] =
+	{
+		{ TEXT("BT.601"), 0.299, 0.114 },
+		{ TEXT("BT.709"), 0.2126, 0.0722 },
+	};
+
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+
+	/** Compute the limited range UYVY texel of two BGRA pixels in double precision. */
+	void PackReference(const FColorSpace& ColorSpace, const uint8* Pixel0, const uint8* Pixel1, double OutTexel[4])
+	{
+		const double Kg = 1.0 - ColorSpace.Kr - ColorSpace.Kb;
+
+		auto Luma = [&](const uint8* Pixel) {
+			return 16.0 + 219.0 * (ColorSpace.Kb * Pixel[0] + Kg * Pixel[1] + ColorSpace.Kr * Pixel[2]) / 255.0;
+		};
+
+		const double B = 0.5 * (Pixel0[0] + Pixel1[0]);
+		const double G = 0.5 * (Pixel0[1] + Pixel1[1]);
+		const double R = 0.5 * (Pixel0[2] + Pixel1[2]);
+		const double Y = ColorSpace.Kb * B + Kg * G + ColorSpace.Kr * R;
+
+		OutTexel[0] = 128.0 + 224.0 * 0.5 * (B - Y) / (1.0 - ColorSpace.Kb) / 255.0;
+		OutTexel[1] = Luma(Pixel0);
+		OutTexel[2] = 128.0 + 224.0 * 0.5 * (R - Y) / (1.0 - ColorSpace.Kr) / 255.0;
+		OutTexel[3] = Luma(Pixel1);
+	}
+}
+
+
+bool FNdiMediaColorPackerAccuracyTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaColorPackerTest;
+
+	// widths that exercise the vector loop, its tail, and the tail alone
+	const int32 Widths[] = { 2, 14, 1926 };
+	const int32 NumRows = 64;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const FColorSpace& ColorSpace : ColorSpaces)
+	{
+		FColorPacker::FCoefficients Coefficients;
+		Coefficients.Initialize((float)ColorSpace.Kr, (float)ColorSpace.Kb);
+
+		for (const int32 Width : Widths)
+		{
+			TArray<uint8> Bgra, SimdUyvy, SimdAlpha, ScalarUyvy, ScalarAlpha;
+			SimdUyvy.SetNumUninitialized(Width * 2);
+			SimdAlpha.SetNumUninitialized(Width);
+			ScalarUyvy.SetNumUninitialized(Width * 2);
+			ScalarAlpha.SetNumUninitialized(Width);
+
+			bool Identical = true;
+			double MaxError = 0.0;
+
+			for (int32 Row = 0; Row < NumRows; ++Row)
+			{
+				FillRandom(Bgra, Width * 4, Random);
+
+				// include saturated colors, which are the most likely to overflow
+				if (Row < 8)
+				{
+					for (int32 Byte = 0; Byte < Width * 4; ++Byte)
+					{
+						Bgra[Byte] = ((Row >> (Byte % 3)) & 1) ? 0xff : 0x00;
+					}
+				}
+
+				FColorPacker::PackRow(Coefficients, Bgra.GetData(), SimdUyvy.GetData(), SimdAlpha.GetData(), Width);
+				FColorPacker::PackRowScalar(Coefficients, Bgra.GetData(), ScalarUyvy.GetData(), ScalarAlpha.GetData(), Width);
+
+				Identical &= (SimdUyvy == ScalarUyvy) && (SimdAlpha == ScalarAlpha);
+
+				for (int32 Pixel = 0; Pixel < Width; Pixel += 2)
+				{
+					double Reference[4];
+					PackReference(ColorSpace, &Bgra[Pixel * 4], &Bgra[Pixel * 4 + 4], Reference);
+
+					for (int32 Component = 0; Component < 4; ++Component)
+					{
+						MaxError = FMath::Max(MaxError, FMath::Abs(SimdUyvy[Pixel * 2 + Component] - Reference[Component]));
+					}
+
+					Identical &= (SimdAlpha[Pixel] == Bgra[Pixel * 4 + 3]) && (SimdAlpha[Pixel + 1] == Bgra[Pixel * 4 + 7]);
+				}
+			}
+
+			TestTrue(FString::Printf(TEXT("%s, %i pixels: SIMD and scalar packing are identical, and alpha is copied"), ColorSpace.Name, Width), Identical);
+			TestTrue(FString::Printf(TEXT("%s, %i pixels: Packing is within one step of the reference (max error %.3f)"), ColorSpace.Name, Width, MaxError), MaxError <= 1.0);
+		}
+	}
+
+	// RGBA frames must pack the same as the equivalent BGRA frames
+	const FIntPoint Dim(64, 8);
+	FNdiMediaColorPacker Packer;
+
+	TArray<uint8> Bgra, Rgba, BgraUyvy, RgbaUyvy;
+	FillRandom(Bgra, Dim.X * Dim.Y * 4, Random);
+	Rgba = Bgra;
+
+	for (int32 Pixel = 0; Pixel < Dim.X * Dim.Y; ++Pixel)
+	{
+		Swap(Rgba[Pixel * 4], Rgba[Pixel * 4 + 2]);
+	}
+
+	BgraUyvy.SetNumUninitialized(Dim.X * Dim.Y * 2);
+	RgbaUyvy.SetNumUninitialized(Dim.X * Dim.Y * 2);
+
+	Packer.Pack(Bgra.GetData(), Dim.X * 4, Dim, false, BgraUyvy.GetData(), Dim.X * 2, nullptr, 1);
+	Packer.Pack(Rgba.GetData(), Dim.X * 4, Dim, true, RgbaUyvy.GetData(), Dim.X * 2, nullptr, 1);
+
+	TestTrue(TEXT("RGBA frames pack the same as BGRA frames"), BgraUyvy == RgbaUyvy);
+
+	return true;
+}
+
+
+bool FNdiMediaColorPackerThroughputTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaColorPackerTest;
+
+	const FIntPoint Dims[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+	const int32 NumIterations = 20;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const FIntPoint& Dim : Dims)
+	{
+		TArray<uint8> Bgra;
+		FillRandom(Bgra, Dim.X * Dim.Y * 4, Random);
+
+		uint8* Uyvy = (uint8*)FMemory::Malloc((SIZE_T)Dim.X * Dim.Y * 2, 64);
+		uint8* Alpha = (uint8*)FMemory::Malloc((SIZE_T)Dim.X * Dim.Y, 64);
+
+		// the packer uses BT.709 for HD and UHD frames
+		FColorPacker::FCoefficients Coefficients;
+		Coefficients.Initialize(0.2126f, 0.0722f);
+
+		for (const bool WithAlpha : { false, true })
+		{
+			const TCHAR* FormatName = WithAlpha ? TEXT("UYVA") : TEXT("UYVY");
+			double Milliseconds[2];
+
+			for (int32 Path = 0; Path < 2; ++Path)
+			{
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+
+				for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+				{
+					for (int32 Row = 0; Row < Dim.Y; ++Row)
+					{
+						const uint8* Source = Bgra.GetData() + Row * Dim.X * 4;
+						uint8* AlphaRow = WithAlpha ? Alpha + Row * Dim.X : nullptr;
+
+						if (Path == 0)
+						{
+							FColorPacker::PackRow(Coefficients, Source, Uyvy + Row * Dim.X * 2, AlphaRow, Dim.X);
+						}
+						else
+						{
+							FColorPacker::PackRowScalar(Coefficients, Source, Uyvy + Row * Dim.X * 2, AlphaRow, Dim.X);
+						}
+					}
+				}
+
+				Milliseconds[Path] = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+			}
+
+			AddInfo(FString::Printf(TEXT("%i x %i %s, 1 thread: %.3f ms per frame SIMD, %.3f ms scalar, %.2fx speedup"),
+				Dim.X, Dim.Y, FormatName, Milliseconds[0], Milliseconds[1], Milliseconds[1] / FMath::Max(Milliseconds[0], 0.001)));
+
+			// the send thread packs on all worker threads
+			FNdiMediaColorPacker Packer;
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				Packer.Pack(Bgra.GetData(), Dim.X * 4, Dim, false, Uyvy, Dim.X * 2, WithAlpha ? Alpha : nullptr, 0);
+			}
+
+			const double PackMilliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+			const double SentBytes = (double)Dim.X * Dim.Y * (WithAlpha ? 3 : 2);
+
+			AddInfo(FString::Printf(TEXT("%i x %i %s, all threads: %.3f ms per frame, up to %.0f fps, %.0f MB/s handed to NDI (%.0f%% of BGRA)"),
+				Dim.X, Dim.Y, FormatName, PackMilliseconds, 1000.0 / FMath::Max(PackMilliseconds, 0.001), SentBytes / 1000.0 / FMath::Max(PackMilliseconds, 0.001),
+				100.0 * SentBytes / ((double)Dim.X * Dim.Y * 4)));
+
+			// the sender must keep up with 60 fps
+			if (PackMilliseconds > 1000.0 / 60.0)
+			{
+				AddWarning(FString::Printf(TEXT("Packing %i x %i %s takes longer than a 60 fps frame period"), Dim.X, Dim.Y, FormatName));
+			}
+		}
+
+		FMemory::Free(Uyvy);
+		FMemory::Free(Alpha);
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
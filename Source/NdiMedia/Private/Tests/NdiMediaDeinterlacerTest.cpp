@@ -0,0 +1,179 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaDeinterlacer.h"
+#include "NdiMediaSource.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaDeinterlacerModesTest, "Plugin.NdiMedia.Deinterlacer.Modes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaDeinterlacerCostTest, "Plugin.NdiMedia.Deinterlacer.Cost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaDeinterlacerTest
+{
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+}
+
+
+bool FNdiMediaDeinterlacerModesTest::RunTest(const FString& Parameters)
+{
+	// small UYVY frame with a width that isn't a multiple of the vector size
+	const int32 RowBytes = 37 * 2;
+	const int32 NumRows = 8;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Frame;
+	NdiMediaDeinterlacerTest::FillRandom(Frame, RowBytes * NumRows, Random);
+
+	TArray<uint8> Output;
+	Output.SetNumZeroed(RowBytes * NumRows);
+
+	FNdiMediaDeinterlacer Deinterlacer;
+
+	// weave passes both fields through
+	Deinterlacer.SetMode(ENdiMediaDeinterlaceMode::Weave, true);
+	Deinterlacer.Deinterlace(Frame.GetData(), RowBytes, RowBytes, NumRows, 0, Output.GetData(), RowBytes, 0);
+
+	TestEqual(TEXT("Weave creates one frame per interleaved frame"), Deinterlacer.GetNumOutputFrames(), 1);
+	TestTrue(TEXT("Weave keeps both fields"), Output == Frame);
+
+	// bob interpolates the other field
+	Deinterlacer.SetMode(ENdiMediaDeinterlaceMode::Bob, true);
+	TestEqual(TEXT("Field rate creates one frame per field"), Deinterlacer.GetNumOutputFrames(), 2);
+
+	for (int32 Field = 0; Field < 2; ++Field)
+	{
+		Deinterlacer.Deinterlace(Frame.GetData(), RowBytes, RowBytes, NumRows, Field, Output.GetData(), RowBytes, 0);
+
+		bool Matches = true;
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			const int32 AboveRow = (Row > 0) ? Row - 1 : Row + 1;
+			const int32 BelowRow = (Row + 1 < NumRows) ? Row + 1 : AboveRow;
+
+			for (int32 Byte = 0; Byte < RowBytes; ++Byte)
+			{
+				const uint8 Expected = ((Row & 1) == Field)
+					? Frame[Row * RowBytes + Byte]
+					: (uint8)((Frame[AboveRow * RowBytes + Byte] + Frame[BelowRow * RowBytes + Byte] + 1) >> 1);
+
+				Matches &= (Output[Row * RowBytes + Byte] == Expected);
+			}
+		}
+
+		TestTrue(FString::Printf(TEXT("Bob keeps field %i and interpolates the other"), Field), Matches);
+	}
+
+	// motion adaptive weaves static content
+	Deinterlacer.SetMode(ENdiMediaDeinterlaceMode::MotionAdaptive, false);
+	Deinterlacer.FinishFrame(Frame.GetData(), RowBytes, RowBytes, NumRows);
+	Deinterlacer.Deinterlace(Frame.GetData(), RowBytes, RowBytes, NumRows, 0, Output.GetData(), RowBytes, 0);
+
+	TestTrue(TEXT("Motion adaptive keeps static content"), Output == Frame);
+
+	// separate fields are woven into interleaved frames
+	TArray<uint8> Field0, Field1;
+	Field0.SetNumUninitialized(RowBytes * NumRows / 2);
+	Field1.SetNumUninitialized(RowBytes * NumRows / 2);
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		FMemory::Memcpy(((Row & 1) ? Field1 : Field0).GetData() + (Row / 2) * RowBytes, Frame.GetData() + Row * RowBytes, RowBytes);
+	}
+
+	TestFalse(TEXT("A single field is incomplete"), Deinterlacer.AddField(Field0.GetData(), RowBytes, RowBytes, NumRows / 2, 0));
+	TestTrue(TEXT("Both fields complete the frame"), Deinterlacer.AddField(Field1.GetData(), RowBytes, RowBytes, NumRows / 2, 1));
+	TestTrue(TEXT("Woven frame matches the interleaved frame"), FMemory::Memcmp(Deinterlacer.GetWovenFrame(), Frame.GetData(), RowBytes * NumRows) == 0);
+
+	return true;
+}
+
+
+bool FNdiMediaDeinterlacerCostTest::RunTest(const FString& Parameters)
+{
+	// 1080i UYVY, as sent by most NDI converters for broadcast sources
+	const int32 RowBytes = 1920 * 2;
+	const int32 NumRows = 1080;
+	const int32 NumIterations = 30;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Frames[2];
+	NdiMediaDeinterlacerTest::FillRandom(Frames[0], RowBytes * NumRows, Random);
+	NdiMediaDeinterlacerTest::FillRandom(Frames[1], RowBytes * NumRows, Random);
+
+	TArray<uint8> Output;
+	Output.SetNumUninitialized(RowBytes * NumRows);
+
+	const ENdiMediaDeinterlaceMode Modes[] = { ENdiMediaDeinterlaceMode::Weave, ENdiMediaDeinterlaceMode::Bob, ENdiMediaDeinterlaceMode::MotionAdaptive };
+	const TCHAR* ModeNames[] = { TEXT("Weave"), TEXT("Bob"), TEXT("Motion adaptive") };
+
+	for (int32 ModeIndex = 0; ModeIndex < ARRAY_COUNT(Modes); ++ModeIndex)
+	{
+		for (const bool FieldRate : { false, true })
+		{
+			// weaving has no field rate output
+			if (FieldRate && (Modes[ModeIndex] == ENdiMediaDeinterlaceMode::Weave))
+			{
+				continue;
+			}
+
+			FNdiMediaDeinterlacer Deinterlacer;
+			Deinterlacer.SetMode(Modes[ModeIndex], FieldRate);
+
+			// the player creates the samples on one thread or on all worker threads
+			for (const int32 MaxThreads : { 1, 0 })
+			{
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+
+				for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+				{
+					const uint8* Frame = Frames[Iteration & 1].GetData();
+
+					for (int32 Field = 0; Field < Deinterlacer.GetNumOutputFrames(); ++Field)
+					{
+						Deinterlacer.Deinterlace(Frame, RowBytes, RowBytes, NumRows, Field, Output.GetData(), RowBytes, MaxThreads);
+					}
+
+					Deinterlacer.FinishFrame(Frame, RowBytes, RowBytes, NumRows);
+				}
+
+				const double Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+
+				AddInfo(FString::Printf(TEXT("1920 x 1080i UYVY, %s, %s rate, %s: %.3f ms per frame"),
+					ModeNames[ModeIndex],
+					Deinterlacer.GetNumOutputFrames() > 1 ? TEXT("field") : TEXT("frame"),
+					(MaxThreads == 1) ? TEXT("1 thread") : TEXT("all threads"),
+					Milliseconds));
+
+				// 1080i60 delivers a frame every 33 ms, which must not be exceeded on the game thread
+				if ((MaxThreads == 0) && (Milliseconds > 1000.0 / 30.0))
+				{
+					AddWarning(FString::Printf(TEXT("%s deinterlacing takes longer than one frame period"), ModeNames[ModeIndex]));
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,383 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "IMediaTextureSample.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaDownscaler.h"
+#include "NdiMediaSource.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaDownscalerRowsTest, "Plugin.NdiMedia.Downscaler.Rows", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaDownscalerFramesTest, "Plugin.NdiMedia.Downscaler.Frames", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaDownscalerCostTest, "Plugin.NdiMedia.Downscaler.Cost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaDownscalerTest
+{
+	/** Exposes the row functions of the downscaler. */
+	class FDownscaler
+		: public FNdiMediaDownscaler
+	{
+	public:
+
+		using FNdiMediaDownscaler::AverageCenterBgraPixels;
+		using FNdiMediaDownscaler::AverageCenterBgraPixelsScalar;
+		using FNdiMediaDownscaler::AverageRows;
+		using FNdiMediaDownscaler::AverageRowsScalar;
+		using FNdiMediaDownscaler::HalveBgraRow;
+		using FNdiMediaDownscaler::HalveBgraRowScalar;
+		using FNdiMediaDownscaler::HalveUyvyRow;
+		using FNdiMediaDownscaler::HalveUyvyRowScalar;
+	};
+
+	/** A downscale mode under test. */
+	struct FMode
+	{
+		const TCHAR* Name;
+		ENdiMediaDownscale Downscale;
+		ENdiMediaDownscaleFilter Filter;
+	};
+
+	/** The downscale modes. */
+	const FMode Modes[] =
+	{
+		{ TEXT("Half Box"), ENdiMediaDownscale::Half, ENdiMediaDownscaleFilter::Box },
+		{ TEXT("Half Bilinear"), ENdiMediaDownscale::Half, ENdiMediaDownscaleFilter::Bilinear },
+		{ TEXT("Quarter Box"), ENdiMediaDownscale::Quarter, ENdiMediaDownscaleFilter::Box },
+		{ TEXT("Quarter Bilinear"), ENdiMediaDownscale::Quarter, ENdiMediaDownscaleFilter::Bilinear },
+	};
+
+	/** A row function and its scalar counterpart, which take a source row, an output row and a number of output units. */
+	struct FRowFunction
+	{
+		const TCHAR* Name;
+		void (*Simd)(const uint8*, uint8*, int32);
+		void (*Scalar)(const uint8*, uint8*, int32);
+		int32 SourceUnitBytes;
+	};
+
+	/** The row functions that process columns. */
+	const FRowFunction RowFunctions[] =
+	{
+		{ TEXT("AverageCenterBgraPixels"), &FDownscaler::AverageCenterBgraPixels, &FDownscaler::AverageCenterBgraPixelsScalar, 16 },
+		{ TEXT("HalveBgraRow"), &FDownscaler::HalveBgraRow, &FDownscaler::HalveBgraRowScalar, 8 },
+		{ TEXT("HalveUyvyRow"), &FDownscaler::HalveUyvyRow, &FDownscaler::HalveUyvyRowScalar, 8 },
+	};
+
+	/** Rounding average of two bytes, as computed by the downscaler. */
+	int32 Avg(int32 A, int32 B)
+	{
+		return (A + B + 1) >> 1;
+	}
+
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+
+	/**
+	 * Downscale a frame one byte at a time.
+	 *
+	 * @param Data The source frame.
+	 * @param Stride Number of bytes per row in the source frame.
+	 * @param Dim Dimensions of the source frame (in pixels).
+	 * @param Uyvy Whether the frame is in UYVY instead of BGRA.
+	 * @param Factor The downscale factor (2 or 4).
+	 * @param Bilinear Whether to use the bilinear filter.
+	 * @param OutputDim Dimensions of the downscaled frame (in pixels).
+	 * @param Dest The output buffer (no row padding).
+	 */
+	void DownscaleReference(const uint8* Data, int32 Stride, const FIntPoint& Dim, bool Uyvy, int32 Factor, bool Bilinear, const FIntPoint& OutputDim, uint8* Dest)
+	{
+		const int32 RowBytes = Uyvy ? Dim.X * 2 : Dim.X * 4;
+		const int32 OutputRowBytes = Uyvy ? OutputDim.X * 2 : OutputDim.X * 4;
+
+		TArray<int32> Vertical;
+		Vertical.SetNumUninitialized(RowBytes);
+
+		for (int32 Row = 0; Row < OutputDim.Y; ++Row)
+		{
+			const uint8* Source = Data + Row * Factor * Stride;
+
+			for (int32 Byte = 0; Byte < RowBytes; ++Byte)
+			{
+				auto Sample = [&](int32 SourceRow) { return (int32)Source[SourceRow * Stride + Byte]; };
+
+				if (Factor == 2)
+				{
+					Vertical[Byte] = Avg(Sample(0), Sample(1));
+				}
+				else if (Bilinear)
+				{
+					Vertical[Byte] = Avg(Sample(1), Sample(2));
+				}
+				else
+				{
+					Vertical[Byte] = Avg(Avg(Sample(0), Sample(1)), Avg(Sample(2), Sample(3)));
+				}
+			}
+
+			uint8* Output = Dest + Row * OutputRowBytes;
+
+			if (Uyvy)
+			{
+				// chroma is averaged across texels, luma within texels
+				auto Halve = [](const int32* Even, const int32* Odd, int32* Texel) {
+					Texel[0] = Avg(Even[0], Odd[0]);
+					Texel[1] = Avg(Even[1], Even[3]);
+					Texel[2] = Avg(Even[2], Odd[2]);
+					Texel[3] = Avg(Odd[1], Odd[3]);
+				};
+
+				for (int32 Texel = 0; Texel < OutputDim.X / 2; ++Texel)
+				{
+					int32 Result[4];
+
+					if (Factor == 2)
+					{
+						Halve(&Vertical[Texel * 8], &Vertical[Texel * 8 + 4], Result);
+					}
+					else
+					{
+						int32 Even[4], Odd[4];
+
+						Halve(&Vertical[Texel * 16], &Vertical[Texel * 16 + 4], Even);
+						Halve(&Vertical[Texel * 16 + 8], &Vertical[Texel * 16 + 12], Odd);
+						Halve(Even, Odd, Result);
+					}
+
+					for (int32 Component = 0; Component < 4; ++Component)
+					{
+						Output[Texel * 4 + Component] = (uint8)Result[Component];
+					}
+				}
+			}
+			else
+			{
+				for (int32 Pixel = 0; Pixel < OutputDim.X; ++Pixel)
+				{
+					for (int32 Component = 0; Component < 4; ++Component)
+					{
+						auto Column = [&](int32 SourcePixel) { return Vertical[SourcePixel * 4 + Component]; };
+						int32 Result;
+
+						if (Factor == 2)
+						{
+							Result = Avg(Column(Pixel * 2), Column(Pixel * 2 + 1));
+						}
+						else if (Bilinear)
+						{
+							Result = Avg(Column(Pixel * 4 + 1), Column(Pixel * 4 + 2));
+						}
+						else
+						{
+							Result = Avg(Avg(Column(Pixel * 4), Column(Pixel * 4 + 1)), Avg(Column(Pixel * 4 + 2), Column(Pixel * 4 + 3)));
+						}
+
+						Output[Pixel * 4 + Component] = (uint8)Result;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+bool FNdiMediaDownscalerRowsTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaDownscalerTest;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Source;
+	TArray<uint8> Source1;
+	TArray<uint8> Simd;
+	TArray<uint8> Scalar;
+
+	// all SIMD block counts with all scalar tails
+	for (int32 NumUnits = 0; NumUnits <= 67; ++NumUnits)
+	{
+		for (const FRowFunction& Function : RowFunctions)
+		{
+			FillRandom(Source, NumUnits * Function.SourceUnitBytes, Random);
+
+			// the output is compared including one unit past the row, which must stay untouched
+			Simd.Init(0, NumUnits * 4 + 4);
+			Scalar.Init(0, NumUnits * 4 + 4);
+
+			Function.Simd(Source.GetData(), Simd.GetData(), NumUnits);
+			Function.Scalar(Source.GetData(), Scalar.GetData(), NumUnits);
+
+			TestTrue(FString::Printf(TEXT("%s of %i units matches the scalar loop"), Function.Name, NumUnits), FMemory::Memcmp(Simd.GetData(), Scalar.GetData(), Simd.Num()) == 0);
+		}
+
+		const int32 NumBytes = NumUnits * 4 + 3;
+
+		FillRandom(Source, NumBytes, Random);
+		FillRandom(Source1, NumBytes, Random);
+		Simd.Init(0, NumBytes);
+		Scalar.Init(0, NumBytes);
+
+		FDownscaler::AverageRows(Source.GetData(), Source1.GetData(), Simd.GetData(), NumBytes);
+		FDownscaler::AverageRowsScalar(Source.GetData(), Source1.GetData(), Scalar.GetData(), NumBytes);
+
+		TestTrue(FString::Printf(TEXT("AverageRows of %i bytes matches the scalar loop"), NumBytes), FMemory::Memcmp(Simd.GetData(), Scalar.GetData(), NumBytes) == 0);
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaDownscalerFramesTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaDownscalerTest;
+
+	// widths that are multiples of four, so that the last group of pixels ends at the end of the row, widths with
+	// remainders, and padded strides, so that averaging pixels past the end of a row would show up in the output
+	const FIntPoint Dims[] = { FIntPoint(8, 4), FIntPoint(68, 12), FIntPoint(1920, 1080), FIntPoint(1922, 1082) };
+	const int32 StridePadding = 32;
+
+	FRandomStream Random(0x4e4449);
+	FNdiMediaDownscaler Downscaler;
+
+	for (const FIntPoint& Dim : Dims)
+	{
+		for (const EMediaTextureSampleFormat SampleFormat : { EMediaTextureSampleFormat::CharBGRA, EMediaTextureSampleFormat::CharUYVY })
+		{
+			const bool Uyvy = (SampleFormat == EMediaTextureSampleFormat::CharUYVY);
+			const int32 Stride = (Uyvy ? Dim.X * 2 : Dim.X * 4) + StridePadding;
+
+			TArray<uint8> Frame;
+			FillRandom(Frame, Stride * Dim.Y, Random);
+
+			for (const FMode& Mode : Modes)
+			{
+				Downscaler.SetMode(Mode.Downscale, Mode.Filter);
+
+				const int32 Factor = (Mode.Downscale == ENdiMediaDownscale::Half) ? 2 : 4;
+				const FIntPoint OutputDim = Downscaler.GetOutputDim(Dim, SampleFormat);
+				const int32 OutputRowBytes = Uyvy ? OutputDim.X * 2 : OutputDim.X * 4;
+
+				TArray<uint8> Expected;
+				Expected.SetNumUninitialized(OutputRowBytes * OutputDim.Y);
+				DownscaleReference(Frame.GetData(), Stride, Dim, Uyvy, Factor, Mode.Filter == ENdiMediaDownscaleFilter::Bilinear, OutputDim, Expected.GetData());
+
+				for (const int32 MaxThreads : { 1, 0 })
+				{
+					TArray<uint8> Output;
+					Output.SetNumZeroed(OutputRowBytes * OutputDim.Y);
+					Downscaler.Downscale(Frame.GetData(), Stride, Dim, SampleFormat, Output.GetData(), OutputRowBytes, MaxThreads);
+
+					TestTrue(FString::Printf(TEXT("%s %i x %i %s on %s matches the reference"), Mode.Name, Dim.X, Dim.Y, Uyvy ? TEXT("UYVY") : TEXT("BGRA"), (MaxThreads == 1) ? TEXT("1 thread") : TEXT("all threads")),
+						FMemory::Memcmp(Output.GetData(), Expected.GetData(), Output.Num()) == 0);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaDownscalerCostTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaDownscalerTest;
+
+	FRandomStream Random(0x4e4449);
+
+	// column passes on one 4K row, repeated for the number of rows of a 4K frame
+	const int32 NumRowIterations = 2160;
+	const int32 NumOutputUnits = 3840 / 4;
+
+	for (const FRowFunction& Function : RowFunctions)
+	{
+		TArray<uint8> Source;
+		FillRandom(Source, NumOutputUnits * Function.SourceUnitBytes, Random);
+
+		TArray<uint8> Output;
+		Output.SetNumUninitialized(NumOutputUnits * 4);
+
+		double Milliseconds[2];
+
+		for (int32 Pass = 0; Pass < 2; ++Pass)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			for (int32 Iteration = 0; Iteration < NumRowIterations; ++Iteration)
+			{
+				(Pass == 0 ? Function.Simd : Function.Scalar)(Source.GetData(), Output.GetData(), NumOutputUnits);
+			}
+
+			Milliseconds[Pass] = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		AddInfo(FString::Printf(TEXT("%s, %i rows of %i output units: %.3f ms SIMD, %.3f ms scalar (%.2fx)"),
+			Function.Name, NumRowIterations, NumOutputUnits, Milliseconds[0], Milliseconds[1], Milliseconds[1] / FMath::Max(Milliseconds[0], 0.001)));
+	}
+
+	// whole frames
+	const FIntPoint Dims[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+	const int32 NumIterations = 20;
+
+	FNdiMediaDownscaler Downscaler;
+
+	for (const FIntPoint& Dim : Dims)
+	{
+		for (const EMediaTextureSampleFormat SampleFormat : { EMediaTextureSampleFormat::CharBGRA, EMediaTextureSampleFormat::CharUYVY })
+		{
+			const bool Uyvy = (SampleFormat == EMediaTextureSampleFormat::CharUYVY);
+			const int32 Stride = Uyvy ? Dim.X * 2 : Dim.X * 4;
+
+			TArray<uint8> Frame;
+			FillRandom(Frame, Stride * Dim.Y, Random);
+
+			for (const FMode& Mode : Modes)
+			{
+				Downscaler.SetMode(Mode.Downscale, Mode.Filter);
+
+				const FIntPoint OutputDim = Downscaler.GetOutputDim(Dim, SampleFormat);
+				const int32 OutputRowBytes = Uyvy ? OutputDim.X * 2 : OutputDim.X * 4;
+
+				TArray<uint8> Output;
+				Output.SetNumUninitialized(OutputRowBytes * OutputDim.Y);
+
+				double Milliseconds[2];
+
+				for (const int32 MaxThreads : { 1, 0 })
+				{
+					// the first call allocates the scratch rows
+					Downscaler.Downscale(Frame.GetData(), Stride, Dim, SampleFormat, Output.GetData(), OutputRowBytes, MaxThreads);
+
+					const uint64 StartCycles = FPlatformTime::Cycles64();
+
+					for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+					{
+						Downscaler.Downscale(Frame.GetData(), Stride, Dim, SampleFormat, Output.GetData(), OutputRowBytes, MaxThreads);
+					}
+
+					Milliseconds[(MaxThreads == 1) ? 0 : 1] = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+				}
+
+				AddInfo(FString::Printf(TEXT("%s %i x %i %s: %.3f ms on 1 thread, %.3f ms on all threads"),
+					Mode.Name, Dim.X, Dim.Y, Uyvy ? TEXT("UYVY") : TEXT("BGRA"), Milliseconds[0], Milliseconds[1]));
+			}
+		}
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
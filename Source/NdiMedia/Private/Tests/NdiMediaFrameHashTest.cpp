@@ -0,0 +1,257 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaFrameHash.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaFrameHashRowsTest, "Plugin.NdiMedia.FrameHash.Rows", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaFrameHashDetectionTest, "Plugin.NdiMedia.FrameHash.Detection", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaFrameHashCostTest, "Plugin.NdiMedia.FrameHash.Cost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaFrameHashTest
+{
+	/** Exposes the row hashing of the frame hash. */
+	class FFrameHash
+		: public FNdiMediaFrameHash
+	{
+	public:
+
+		using FNdiMediaFrameHash::HashRow;
+		using FNdiMediaFrameHash::HashRowScalar;
+	};
+
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+
+	/** Describe a progressive UYVY frame in the given buffer. */
+	NDIlib_video_frame_v2_t MakeFrame(TArray<uint8>& Buffer, int32 Width, int32 Height, int32 Stride)
+	{
+		NDIlib_video_frame_v2_t Frame;
+		{
+			Frame.xres = Width;
+			Frame.yres = Height;
+			Frame.FourCC = NDIlib_FourCC_type_UYVY;
+			Frame.frame_rate_N = 60;
+			Frame.frame_rate_D = 1;
+			Frame.frame_format_type = NDIlib_frame_format_type_progressive;
+			Frame.p_data = Buffer.GetData();
+			Frame.line_stride_in_bytes = Stride;
+		}
+
+		return Frame;
+	}
+}
+
+
+bool FNdiMediaFrameHashRowsTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaFrameHashTest;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Row;
+
+	// all partial stripe lengths, and rows that span several scrambled blocks
+	TArray<int32> RowLengths;
+
+	for (int32 RowBytes = 0; RowBytes <= 320; ++RowBytes)
+	{
+		RowLengths.Add(RowBytes);
+	}
+
+	RowLengths.Append({ 1023, 1024, 1025, 3840, 7680 + 17 });
+
+	for (const int32 RowBytes : RowLengths)
+	{
+		FillRandom(Row, RowBytes, Random);
+
+		uint64 Simd[8];
+		uint64 Scalar[8];
+
+		for (int32 Lane = 0; Lane < 8; ++Lane)
+		{
+			Simd[Lane] = Scalar[Lane] = ((uint64)Random.GetUnsignedInt() << 32) | Random.GetUnsignedInt();
+		}
+
+		FFrameHash::HashRow(Simd, Row.GetData(), RowBytes);
+		FFrameHash::HashRowScalar(Scalar, Row.GetData(), RowBytes);
+
+		TestTrue(FString::Printf(TEXT("Hashing a row of %i bytes matches the scalar hash"), RowBytes), FMemory::Memcmp(Simd, Scalar, sizeof(Simd)) == 0);
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaFrameHashDetectionTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaFrameHashTest;
+
+	const int32 Width = 96;
+	const int32 Height = 64;
+	const int32 Stride = Width * 2 + 32;
+
+	FRandomStream Random(0x4e4449);
+	TArray<uint8> Buffer;
+	FillRandom(Buffer, Stride * Height, Random);
+
+	NDIlib_video_frame_v2_t Frame = MakeFrame(Buffer, Width, Height, Stride);
+
+	const uint64 Full = FNdiMediaFrameHash::HashFrame(Frame, false);
+	const uint64 Sampled = FNdiMediaFrameHash::HashFrame(Frame, true);
+
+	TestTrue(TEXT("A repeated frame has the same full hash"), FNdiMediaFrameHash::HashFrame(Frame, false) == Full);
+	TestTrue(TEXT("A repeated frame has the same sampled hash"), FNdiMediaFrameHash::HashFrame(Frame, true) == Sampled);
+
+	// row padding is undefined
+	Buffer[5 * Stride + Width * 2] ^= 0x01;
+	TestTrue(TEXT("Changed row padding is ignored by the full hash"), FNdiMediaFrameHash::HashFrame(Frame, false) == Full);
+	TestTrue(TEXT("Changed row padding is ignored by the sampled hash"), FNdiMediaFrameHash::HashFrame(Frame, true) == Sampled);
+
+	// sampled detection only hashes every eighth row, so it misses changes in other rows
+	Buffer[13 * Stride + 7] ^= 0x01;
+	TestTrue(TEXT("A change in a skipped row changes the full hash"), FNdiMediaFrameHash::HashFrame(Frame, false) != Full);
+	TestTrue(TEXT("A change in a skipped row is missed by the sampled hash"), FNdiMediaFrameHash::HashFrame(Frame, true) == Sampled);
+	Buffer[13 * Stride + 7] ^= 0x01;
+
+	Buffer[16 * Stride + 7] ^= 0x01;
+	TestTrue(TEXT("A change in a sampled row changes the full hash"), FNdiMediaFrameHash::HashFrame(Frame, false) != Full);
+	TestTrue(TEXT("A change in a sampled row changes the sampled hash"), FNdiMediaFrameHash::HashFrame(Frame, true) != Sampled);
+	Buffer[16 * Stride + 7] ^= 0x01;
+
+	// swapped content hashes differently
+	for (int32 Byte = 0; Byte < 4; ++Byte)
+	{
+		Swap(Buffer[Byte], Buffer[4 + Byte]);
+	}
+
+	TestTrue(TEXT("Swapped texels change the full hash"), FNdiMediaFrameHash::HashFrame(Frame, false) != Full);
+
+	for (int32 Byte = 0; Byte < 4; ++Byte)
+	{
+		Swap(Buffer[Byte], Buffer[4 + Byte]);
+	}
+
+	TestTrue(TEXT("Restoring the frame restores the full hash"), FNdiMediaFrameHash::HashFrame(Frame, false) == Full);
+
+	// fields of opposite parity never match
+	Frame.frame_format_type = NDIlib_frame_format_type_field_0;
+	const uint64 Field0 = FNdiMediaFrameHash::HashFrame(Frame, false);
+	Frame.frame_format_type = NDIlib_frame_format_type_field_1;
+	TestTrue(TEXT("Fields of opposite parity have different hashes"), FNdiMediaFrameHash::HashFrame(Frame, false) != Field0);
+	Frame.frame_format_type = NDIlib_frame_format_type_progressive;
+
+	// the alpha plane of UYVA frames is hashed as well
+	TArray<uint8> UyvaBuffer;
+	FillRandom(UyvaBuffer, Stride * Height + Width * Height, Random);
+
+	NDIlib_video_frame_v2_t UyvaFrame = MakeFrame(UyvaBuffer, Width, Height, Stride);
+	UyvaFrame.FourCC = NDIlib_FourCC_type_UYVA;
+
+	const uint64 Uyva = FNdiMediaFrameHash::HashFrame(UyvaFrame, false);
+	UyvaBuffer[Stride * Height + 3 * Width + 5] ^= 0x01;
+	TestTrue(TEXT("A change in the alpha plane changes the full hash"), FNdiMediaFrameHash::HashFrame(UyvaFrame, false) != Uyva);
+
+	return true;
+}
+
+
+bool FNdiMediaFrameHashCostTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaFrameHashTest;
+
+	const FIntPoint Dims[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+	const int32 NumIterations = 30;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const FIntPoint& Dim : Dims)
+	{
+		const int32 RowBytes = Dim.X * 2;
+
+		TArray<uint8> Buffer;
+		FillRandom(Buffer, RowBytes * Dim.Y, Random);
+
+		TArray<uint8> Copy;
+		Copy.SetNumUninitialized(Buffer.Num());
+
+		const NDIlib_video_frame_v2_t Frame = MakeFrame(Buffer, Dim.X, Dim.Y, RowBytes);
+
+		// warm up the caches the same way for all measurements
+		FMemory::Memcpy(Copy.GetData(), Buffer.GetData(), Buffer.Num());
+
+		uint64 Hash = 0;
+		uint64 FullCycles = 0;
+		uint64 SampledCycles = 0;
+		uint64 ScalarCycles = 0;
+		uint64 CopyCycles = 0;
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			uint64 StartCycles = FPlatformTime::Cycles64();
+			Hash ^= FNdiMediaFrameHash::HashFrame(Frame, false);
+			FullCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			StartCycles = FPlatformTime::Cycles64();
+			Hash ^= FNdiMediaFrameHash::HashFrame(Frame, true);
+			SampledCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			uint64 Acc[8] = { 0 };
+
+			StartCycles = FPlatformTime::Cycles64();
+
+			for (int32 Row = 0; Row < Dim.Y; ++Row)
+			{
+				FFrameHash::HashRowScalar(Acc, Buffer.GetData() + Row * RowBytes, RowBytes);
+			}
+
+			ScalarCycles += FPlatformTime::Cycles64() - StartCycles;
+			Hash ^= Acc[0];
+
+			StartCycles = FPlatformTime::Cycles64();
+			FMemory::Memcpy(Copy.GetData(), Buffer.GetData(), Buffer.Num());
+			CopyCycles += FPlatformTime::Cycles64() - StartCycles;
+		}
+
+		const double FullMilliseconds = FPlatformTime::ToMilliseconds64(FullCycles) / NumIterations;
+		const double SampledMilliseconds = FPlatformTime::ToMilliseconds64(SampledCycles) / NumIterations;
+		const double ScalarMilliseconds = FPlatformTime::ToMilliseconds64(ScalarCycles) / NumIterations;
+		const double CopyMilliseconds = FPlatformTime::ToMilliseconds64(CopyCycles) / NumIterations;
+
+		AddInfo(FString::Printf(TEXT("%i x %i UYVY: %.3f ms full, %.3f ms sampled, %.3f ms full without SIMD, %.3f ms copying the frame (hash %016llx)"),
+			Dim.X, Dim.Y, FullMilliseconds, SampledMilliseconds, ScalarMilliseconds, CopyMilliseconds, Hash));
+
+		// skipping a duplicate frame only pays off if hashing is cheaper than copying
+		if (FullMilliseconds > CopyMilliseconds)
+		{
+			AddWarning(FString::Printf(TEXT("Hashing %i x %i frames takes longer than copying them"), Dim.X, Dim.Y));
+		}
+
+		TestTrue(FString::Printf(TEXT("%i x %i UYVY: sampled hashing is faster than full hashing"), Dim.X, Dim.Y), SampledMilliseconds < FullMilliseconds);
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+#include "NdiMediaHidePlatformTypes.h"
@@ -0,0 +1,164 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/UnrealMemory.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaVideoConversion.h"
+#include "NdiMediaVideoCopy.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaParallelRowsCoverageTest, "Plugin.NdiMedia.ParallelRows.Coverage", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaParallelRowsScalingTest, "Plugin.NdiMedia.ParallelRows.Scaling", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+bool FNdiMediaParallelRowsCoverageTest::RunTest(const FString& Parameters)
+{
+	const int32 RowCounts[] = { 0, 1, 7, 1080, 2161 };
+	const int32 RowBytes = 3840 * 2;
+
+	for (const int32 NumRows : RowCounts)
+	{
+		for (const int32 MaxThreads : { 0, 1, 2, 3 })
+		{
+			TArray<FThreadSafeCounter> Visits;
+			Visits.SetNum(NumRows);
+
+			FNdiMediaParallelRows::ParallelFor(NumRows, RowBytes, MaxThreads, [&Visits](int32 FirstRow, int32 NumBandRows)
+			{
+				for (int32 Row = FirstRow; Row < FirstRow + NumBandRows; ++Row)
+				{
+					Visits[Row].Increment();
+				}
+			});
+
+			bool VisitedOnce = true;
+
+			for (const FThreadSafeCounter& Counter : Visits)
+			{
+				VisitedOnce &= (Counter.GetValue() == 1);
+			}
+
+			TestTrue(FString::Printf(TEXT("Each of %i rows is processed once with %i max threads"), NumRows, MaxThreads), VisitedOnce);
+		}
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaParallelRowsScalingTest::RunTest(const FString& Parameters)
+{
+	// 2160p frames, which gain the most from parallel processing
+	const int32 Width = 3840;
+	const int32 Height = 2160;
+	const int32 NumIterations = 20;
+	const int32 NumWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+	// P216 source with limited range mid gray luma and neutral chroma
+	TArray<uint16> P216;
+	P216.SetNumUninitialized(Width * Height * 2);
+
+	for (int32 Index = 0; Index < Width * Height; ++Index)
+	{
+		P216[Index] = 0x7000;
+		P216[Width * Height + Index] = 0x8000;
+	}
+
+	// UYVA source
+	TArray<uint8> Uyva;
+	Uyva.SetNumUninitialized(Width * Height * 3);
+	FMemory::Memset(Uyva.GetData(), 0x80, Uyva.Num());
+
+	uint8* Dest = (uint8*)FMemory::Malloc((SIZE_T)Width * Height * 4, 64);
+
+	NDIlib_video_frame_v2_t P216Frame;
+	{
+		P216Frame.xres = Width;
+		P216Frame.yres = Height;
+		P216Frame.FourCC = (NDIlib_FourCC_type_e)NdiMedia::FourCC_P216;
+		P216Frame.p_data = (uint8*)P216.GetData();
+		P216Frame.line_stride_in_bytes = Width * 2;
+	}
+
+	NDIlib_video_frame_v2_t UyvaFrame;
+	{
+		UyvaFrame.xres = Width;
+		UyvaFrame.yres = Height;
+		UyvaFrame.FourCC = NDIlib_FourCC_type_UYVA;
+		UyvaFrame.p_data = Uyva.GetData();
+		UyvaFrame.line_stride_in_bytes = Width * 2;
+	}
+
+	const TCHAR* StageNames[] = { TEXT("P216 to BGR10A2"), TEXT("UYVA to AYUV"), TEXT("Streaming copy") };
+
+	// powers of two up to all worker threads
+	TArray<int32> ThreadCounts;
+
+	for (int32 MaxThreads = 1; MaxThreads < NumWorkers; MaxThreads *= 2)
+	{
+		ThreadCounts.Add(MaxThreads);
+	}
+
+	ThreadCounts.Add(NumWorkers);
+
+	AddInfo(FString::Printf(TEXT("%i worker threads, including the calling thread"), NumWorkers));
+
+	for (int32 Stage = 0; Stage < ARRAY_COUNT(StageNames); ++Stage)
+	{
+		double SingleThreadMilliseconds = 0.0;
+
+		for (const int32 MaxThreads : ThreadCounts)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				switch (Stage)
+				{
+				case 0:
+					FNdiMediaVideoConversion::P216ToBgr10A2(P216Frame, Dest, Width * 4, MaxThreads);
+					break;
+
+				case 1:
+					FNdiMediaVideoConversion::UyvaToAyuv(UyvaFrame, Dest, Width * 4, MaxThreads);
+					break;
+
+				default:
+					FNdiMediaParallelRows::ParallelFor(Height, Width * 4, MaxThreads, [&Uyva, Dest, Width](int32 FirstRow, int32 NumRows)
+					{
+						FNdiMediaVideoCopy::StreamCopy(Dest + FirstRow * Width * 2, Uyva.GetData() + FirstRow * Width * 2, (SIZE_T)NumRows * Width * 2);
+					});
+				}
+			}
+
+			const double Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+
+			if (MaxThreads == 1)
+			{
+				SingleThreadMilliseconds = Milliseconds;
+			}
+
+			AddInfo(FString::Printf(TEXT("%s, 3840 x 2160, %i threads: %.3f ms per frame, %.2fx speedup"), StageNames[Stage], MaxThreads, Milliseconds, SingleThreadMilliseconds / FMath::Max(Milliseconds, 0.001)));
+		}
+	}
+
+	FMemory::Free(Dest);
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
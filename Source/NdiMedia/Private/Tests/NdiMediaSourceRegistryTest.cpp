@@ -0,0 +1,293 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Containers/Set.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+
+#include "NdiMediaSourceRegistry.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaSourceRegistryQueriesTest, "Plugin.NdiMedia.SourceRegistry.Queries", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaSourceRegistryLookupTest, "Plugin.NdiMedia.SourceRegistry.Lookup", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaSourceRegistryTest
+{
+	/** Number of synthetic sources, as seen on large facility networks. */
+	const int32 NumSources = 10000;
+
+	/** Number of sources that each synthetic machine announces. */
+	const int32 SourcesPerMachine = 20;
+
+	/** Search strings that cover trigram lookups, short strings and misses. */
+	const TCHAR* SubstringQueries[] = {
+		TEXT("camera"),
+		TEXT("CAMERA 1"),
+		TEXT("io-b-0"),
+		TEXT("(re"),
+		TEXT("ay 1"),
+		TEXT("a"),
+		TEXT("99"),
+		TEXT("studio-c-123 (graphics 4)"),
+		TEXT("no such source"),
+		TEXT(""),
+	};
+
+	/** Prefixes that cover partial machine names, full names and misses. */
+	const TCHAR* PrefixQueries[] = {
+		TEXT("STUDIO-A"),
+		TEXT("studio-b-01"),
+		TEXT("studio-d-042 (replay"),
+		TEXT("s"),
+		TEXT("x"),
+	};
+
+	/** Create the synthetic sources, i.e. "STUDIO-A-017 (Camera 3)" on 10.0.17.3:5961. */
+	void MakeSources(TArray<FNdiMediaSourceId>& OutSources)
+	{
+		const TCHAR* Kinds[] = { TEXT("Camera"), TEXT("Graphics"), TEXT("Multiview"), TEXT("Playout"), TEXT("Replay") };
+
+		OutSources.Reset(NumSources);
+
+		for (int32 SourceIndex = 0; SourceIndex < NumSources; ++SourceIndex)
+		{
+			const int32 Machine = SourceIndex / SourcesPerMachine;
+			const int32 Channel = SourceIndex % SourcesPerMachine;
+
+			const FString Name = FString::Printf(TEXT("STUDIO-%c-%03i (%s %i)"), TEXT('A') + (Machine % 4), Machine / 4, Kinds[Channel % ARRAY_COUNT(Kinds)], Channel / ARRAY_COUNT(Kinds) + 1);
+			const FString Endpoint = FString::Printf(TEXT("10.%i.%i.%i:%i"), Machine / 256, Machine % 256, Channel + 1, 5961 + Channel);
+
+			OutSources.Add(FNdiMediaSourceId(Endpoint, Name));
+		}
+	}
+
+	/** Find the sources whose name contains the given text by checking all of them. */
+	void ScanSubstring(const TArray<FNdiMediaSourceId>& Sources, const FString& Text, TArray<FNdiMediaSourceId>& OutSources)
+	{
+		for (const FNdiMediaSourceId& Source : Sources)
+		{
+			if (Source.Name.Contains(Text, ESearchCase::IgnoreCase))
+			{
+				OutSources.Add(Source);
+			}
+		}
+	}
+
+	/** Check whether two lists contain the same sources, in any order. */
+	bool SameSources(const TArray<FNdiMediaSourceId>& A, const TArray<FNdiMediaSourceId>& B)
+	{
+		if (A.Num() != B.Num())
+		{
+			return false;
+		}
+
+		const TSet<FNdiMediaSourceId> SetA(A);
+
+		for (const FNdiMediaSourceId& Source : B)
+		{
+			if (!SetA.Contains(Source))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+bool FNdiMediaSourceRegistryQueriesTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaSourceRegistryTest;
+
+	TArray<FNdiMediaSourceId> Sources;
+	MakeSources(Sources);
+
+	const TArray<FString> Groups = { TEXT("public") };
+	FNdiMediaSourceRegistry Registry;
+
+	for (const FNdiMediaSourceId& Source : Sources)
+	{
+		Registry.Add(Source, Groups);
+	}
+
+	TestEqual(TEXT("All sources are registered"), Registry.Num(), NumSources);
+
+	// compares all queries with a linear scan of the expected sources
+	auto CheckQueries = [this, &Registry](const TArray<FNdiMediaSourceId>& Expected, const TCHAR* Stage)
+	{
+		for (const TCHAR* Query : SubstringQueries)
+		{
+			TArray<FNdiMediaSourceId> Found, Scanned;
+			Registry.FindBySubstring(Query, Found);
+			ScanSubstring(Expected, Query, Scanned);
+
+			TestTrue(FString::Printf(TEXT("%s: substring '%s' finds all %i matching sources"), Stage, Query, Scanned.Num()), SameSources(Found, Scanned));
+		}
+
+		for (const TCHAR* Query : PrefixQueries)
+		{
+			TArray<FNdiMediaSourceId> Found, Scanned;
+			Registry.FindByPrefix(Query, Found);
+
+			for (const FNdiMediaSourceId& Source : Expected)
+			{
+				if (Source.Name.StartsWith(Query, ESearchCase::IgnoreCase))
+				{
+					Scanned.Add(Source);
+				}
+			}
+
+			bool Sorted = true;
+
+			for (int32 Index = 1; Index < Found.Num(); ++Index)
+			{
+				Sorted &= (Found[Index - 1].Name.ToLower() <= Found[Index].Name.ToLower());
+			}
+
+			TestTrue(FString::Printf(TEXT("%s: prefix '%s' finds all %i matching sources"), Stage, Query, Scanned.Num()), SameSources(Found, Scanned));
+			TestTrue(FString::Printf(TEXT("%s: prefix '%s' returns sources in order"), Stage, Query), Sorted);
+		}
+
+		TArray<FNdiMediaSourceId> Found, Scanned;
+		Registry.FindByMachine(TEXT("STUDIO-B-001"), Found);
+
+		for (const FNdiMediaSourceId& Source : Expected)
+		{
+			if (Source.GetMachineName() == TEXT("STUDIO-B-001"))
+			{
+				Scanned.Add(Source);
+			}
+		}
+
+		TestTrue(FString::Printf(TEXT("%s: machine lookup finds all %i sources of the machine"), Stage, Scanned.Num()), SameSources(Found, Scanned));
+	};
+
+	CheckQueries(Sources, TEXT("Initial"));
+
+	// remove every third source, and move every fifth of the rest to a new endpoint
+	TArray<FNdiMediaSourceId> Expected;
+
+	for (int32 SourceIndex = 0; SourceIndex < Sources.Num(); ++SourceIndex)
+	{
+		const FNdiMediaSourceId& Source = Sources[SourceIndex];
+
+		if (SourceIndex % 3 == 0)
+		{
+			TestTrue(TEXT("Registered sources can be removed"), Registry.Remove(Source));
+		}
+		else if (SourceIndex % 5 == 0)
+		{
+			const FNdiMediaSourceId Moved(FString::Printf(TEXT("172.16.%i.%i:5960"), SourceIndex / 256, SourceIndex % 256), Source.Name);
+			Registry.Add(Moved, Groups);
+			Expected.Add(Moved);
+		}
+		else
+		{
+			Expected.Add(Source);
+		}
+	}
+
+	TestEqual(TEXT("Removed sources are unregistered"), Registry.Num(), Expected.Num());
+	TestFalse(TEXT("Removed sources can't be removed again"), Registry.Remove(Sources[0]));
+	TestNull(TEXT("Moved sources are not found at their old endpoint"), Registry.FindByEndpoint(Sources[5].Endpoint));
+
+	const FNdiMediaSourceId* Moved = Registry.FindByName(Sources[5].Name);
+	TestTrue(TEXT("Moved sources are found at their new endpoint"), (Moved != nullptr) && (Moved->Endpoint == TEXT("172.16.0.5:5960")));
+
+	CheckQueries(Expected, TEXT("Updated"));
+
+	Registry.Empty();
+	TestEqual(TEXT("Emptied registry has no sources"), Registry.Num(), 0);
+
+	TArray<FNdiMediaSourceId> Found;
+	Registry.FindBySubstring(TEXT("camera"), Found);
+	TestEqual(TEXT("Emptied registry finds no sources"), Found.Num(), 0);
+
+	return true;
+}
+
+
+bool FNdiMediaSourceRegistryLookupTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaSourceRegistryTest;
+
+	const int32 NumIterations = 100;
+
+	TArray<FNdiMediaSourceId> Sources;
+	MakeSources(Sources);
+
+	const TArray<FString> Groups = { TEXT("public") };
+	FNdiMediaSourceRegistry Registry;
+
+	uint64 StartCycles = FPlatformTime::Cycles64();
+
+	for (const FNdiMediaSourceId& Source : Sources)
+	{
+		Registry.Add(Source, Groups);
+	}
+
+	AddInfo(FString::Printf(TEXT("Adding %i sources: %.3f ms"), NumSources, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)));
+
+	// the source picker searches on every key stroke, so lookups must take well below a frame
+	for (const TCHAR* Query : SubstringQueries)
+	{
+		TArray<FNdiMediaSourceId> Found;
+		StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Found.Reset();
+			Registry.FindBySubstring(Query, Found);
+		}
+
+		const double IndexedMilliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+
+		TArray<FNdiMediaSourceId> Scanned;
+		StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Scanned.Reset();
+			ScanSubstring(Sources, Query, Scanned);
+		}
+
+		const double ScanMilliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+
+		AddInfo(FString::Printf(TEXT("Substring '%s', %i matches: %.4f ms indexed, %.4f ms linear scan"), Query, Found.Num(), IndexedMilliseconds, ScanMilliseconds));
+	}
+
+	for (const TCHAR* Query : PrefixQueries)
+	{
+		TArray<FNdiMediaSourceId> Found;
+		StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Found.Reset();
+			Registry.FindByPrefix(Query, Found);
+		}
+
+		AddInfo(FString::Printf(TEXT("Prefix '%s', %i matches: %.4f ms"), Query, Found.Num(), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations));
+	}
+
+	// sources come and go while the registry is large
+	StartCycles = FPlatformTime::Cycles64();
+
+	for (int32 SourceIndex = 0; SourceIndex < NumSources; SourceIndex += 10)
+	{
+		Registry.Remove(Sources[SourceIndex]);
+		Registry.Add(Sources[SourceIndex], Groups);
+	}
+
+	AddInfo(FString::Printf(TEXT("Removing and adding a source: %.4f ms"), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / (NumSources / 10)));
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,584 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Async/Async.h"
+#include "Containers/StringConv.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/Float16.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Guid.h"
+
+#include "Ndi.h"
+#include "NdiMediaVideoConversion.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoConversionP216Test, "Plugin.NdiMedia.VideoConversion.P216", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoConversionPa16Test, "Plugin.NdiMedia.VideoConversion.Pa16", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoConversionUyvaTest, "Plugin.NdiMedia.VideoConversion.Uyva", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoConversionUyvaCostTest, "Plugin.NdiMedia.VideoConversion.UyvaCost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaVideoConversionTest
+{
+	/** Exposes the row conversions. */
+	class FVideoConversion
+		: public FNdiMediaVideoConversion
+	{
+	public:
+
+		using FNdiMediaVideoConversion::P216ToBgr10A2Row;
+		using FNdiMediaVideoConversion::P216ToBgr10A2RowScalar;
+		using FNdiMediaVideoConversion::Pa16ToFloatRgbaRow;
+		using FNdiMediaVideoConversion::Pa16ToFloatRgbaRowScalar;
+		using FNdiMediaVideoConversion::UyvaToAyuvRow;
+		using FNdiMediaVideoConversion::UyvaToAyuvRowScalar;
+	};
+
+	/** Results of a loopback run. */
+	struct FLoopbackResult
+	{
+		/** Total time spent in NDIlib_recv_capture_v2 for received frames (in CPU cycles). */
+		uint64 CaptureCycles;
+
+		/** Total time spent converting received frames (in CPU cycles). */
+		uint64 ConvertCycles;
+
+		/** Number of frames that were received. */
+		int64 NumReceived;
+	};
+
+	/** Widths that cover the scalar path alone, the vector loop, its tail, and odd pixel counts. */
+	const int32 Widths[] = { 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 1001, 1920 };
+
+	/** Fill the given buffer with random 16-bit values. */
+	void FillRandom16(TArray<uint16>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint16& Value : Buffer)
+		{
+			Value = (uint16)Random.RandHelper(65536);
+		}
+	}
+
+	/** Convert a 16-bit limited range BT.709 YUV pixel to normalized RGB in double precision. */
+	void ReferenceYuvToRgb(uint16 Y, uint16 U, uint16 V, double OutRgb[3])
+	{
+		const double L = (Y - 4096.0) / 56064.0;
+		const double Cb = (U - 32768.0) / 57344.0;
+		const double Cr = (V - 32768.0) / 57344.0;
+
+		OutRgb[0] = FMath::Clamp(L + 1.5748 * Cr, 0.0, 1.0);
+		OutRgb[1] = FMath::Clamp(L - 0.1873 * Cb - 0.4681 * Cr, 0.0, 1.0);
+		OutRgb[2] = FMath::Clamp(L + 1.8556 * Cb, 0.0, 1.0);
+	}
+
+	/** Get the error of a half precision value relative to its step size, i.e. 0.5 for correct rounding. */
+	double GetHalfError(uint16 Encoded, double Expected)
+	{
+		FFloat16 Half;
+		Half.Encoded = Encoded;
+
+		// values below 2^-14 are flushed to zero, so the smallest normal value is the step
+		const double Step = FMath::Max(FMath::Pow(2.0, FMath::FloorToDouble(FMath::Log2(FMath::Max(Expected, 1e-30))) - 10.0), 1.0 / 16384.0);
+
+		return FMath::Abs(Half.GetFloat() - Expected) / Step;
+	}
+
+	/** Fill the given buffer with random bytes. */
+	void FillRandom(TArray<uint8>& Buffer, int32 Size, FRandomStream& Random)
+	{
+		Buffer.SetNumUninitialized(Size);
+
+		for (uint8& Byte : Buffer)
+		{
+			Byte = (uint8)Random.RandHelper(256);
+		}
+	}
+
+	/**
+	 * Send 1080p UYVA video to a local receiver as fast as possible, and receive it in the given color format.
+	 *
+	 * Frames that arrive as UYVA are converted to AYUV the same way as in the player.
+	 * Frames that arrive as BGRA were already converted by NDI.
+	 *
+	 * @param ColorFormat The color format to receive in.
+	 * @param Seconds How long to receive.
+	 * @param OutResult Will contain the results.
+	 * @return true on success, false if the receiver could not connect to the sender.
+	 */
+	bool RunLoopback(NDIlib_recv_color_format_e ColorFormat, double Seconds, FLoopbackResult& OutResult)
+	{
+		const int32 Width = 1920;
+		const int32 Height = 1080;
+
+		// create an unclocked sender with a unique name
+		const FString SenderName = FString::Printf(TEXT("NdiMedia Benchmark %s"), *FGuid::NewGuid().ToString());
+		const FString SourceName = FString::Printf(TEXT("%s (%s)"), FPlatformProcess::ComputerName(), *SenderName);
+		auto SenderNameAnsi = StringCast<ANSICHAR>(*SenderName);
+		auto SourceNameAnsi = StringCast<ANSICHAR>(*SourceName);
+
+		NDIlib_send_create_t SendCreate;
+		{
+			SendCreate.p_ndi_name = SenderNameAnsi.Get();
+			SendCreate.p_groups = nullptr;
+			SendCreate.clock_video = false;
+			SendCreate.clock_audio = false;
+		}
+
+		void* SendInstance = FNdi::Lib->NDIlib_send_create(&SendCreate);
+
+		if (SendInstance == nullptr)
+		{
+			return false;
+		}
+
+		NDIlib_source_t Source;
+		{
+			Source.p_ndi_name = SourceNameAnsi.Get();
+			Source.p_ip_address = nullptr;
+		}
+
+		NDIlib_recv_create_t RecvCreate;
+		{
+			RecvCreate.source_to_connect_to = Source;
+			RecvCreate.color_format = ColorFormat;
+			RecvCreate.bandwidth = NDIlib_recv_bandwidth_highest;
+			RecvCreate.allow_video_fields = true;
+		}
+
+		void* ReceiverInstance = FNdi::Lib->NDIlib_recv_create_v2(&RecvCreate);
+
+		if (ReceiverInstance == nullptr)
+		{
+			FNdi::Lib->NDIlib_send_destroy(SendInstance);
+
+			return false;
+		}
+
+		// send frames with a key until the receiver is done
+		FRandomStream Random(0x4e4449);
+		TArray<uint8> FrameData;
+		FillRandom(FrameData, Width * Height * 3, Random);
+
+		FThreadSafeBool Stopped;
+
+		TFuture<void> SendTask = Async<void>(EAsyncExecution::Thread, [&FrameData, &Stopped, SendInstance, Width, Height]()
+		{
+			NDIlib_video_frame_v2_t VideoFrame;
+			{
+				VideoFrame.xres = Width;
+				VideoFrame.yres = Height;
+				VideoFrame.FourCC = NDIlib_FourCC_type_UYVA;
+				VideoFrame.frame_rate_N = 60;
+				VideoFrame.frame_rate_D = 1;
+				VideoFrame.picture_aspect_ratio = 16.0f / 9.0f;
+				VideoFrame.frame_format_type = NDIlib_frame_format_type_progressive;
+				VideoFrame.timecode = NDIlib_send_timecode_synthesize;
+				VideoFrame.p_data = FrameData.GetData();
+				VideoFrame.line_stride_in_bytes = Width * 2;
+				VideoFrame.p_metadata = nullptr;
+			}
+
+			while (!Stopped)
+			{
+				FNdi::Lib->NDIlib_send_send_video_v2(SendInstance, &VideoFrame);
+			}
+		});
+
+		// wait for the connection
+		const double ConnectTimeout = FPlatformTime::Seconds() + 10.0;
+
+		while ((FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) == 0) && (FPlatformTime::Seconds() < ConnectTimeout))
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		const bool Connected = (FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) > 0);
+
+		OutResult.CaptureCycles = 0;
+		OutResult.ConvertCycles = 0;
+		OutResult.NumReceived = 0;
+
+		if (Connected)
+		{
+			TArray<uint8> Ayuv;
+			Ayuv.SetNumUninitialized(Width * Height * 4);
+
+			const double EndTime = FPlatformTime::Seconds() + Seconds;
+
+			while (FPlatformTime::Seconds() < EndTime)
+			{
+				NDIlib_video_frame_v2_t VideoFrame;
+
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+
+				if (FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, &VideoFrame, nullptr, nullptr, 100) != NDIlib_frame_type_video)
+				{
+					continue;
+				}
+
+				OutResult.CaptureCycles += FPlatformTime::Cycles64() - StartCycles;
+
+				if (VideoFrame.FourCC == NDIlib_FourCC_type_UYVA)
+				{
+					const uint64 ConvertStartCycles = FPlatformTime::Cycles64();
+					FNdiMediaVideoConversion::UyvaToAyuv(VideoFrame, Ayuv.GetData(), VideoFrame.xres * 4, 0);
+					OutResult.ConvertCycles += FPlatformTime::Cycles64() - ConvertStartCycles;
+				}
+
+				FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+				++OutResult.NumReceived;
+			}
+		}
+
+		Stopped = true;
+		SendTask.Wait();
+
+		FNdi::Lib->NDIlib_recv_destroy(ReceiverInstance);
+		FNdi::Lib->NDIlib_send_destroy(SendInstance);
+
+		return Connected;
+	}
+}
+
+
+bool FNdiMediaVideoConversionP216Test::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaVideoConversionTest;
+
+	const int32 NumRows = 16;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const int32 Width : Widths)
+	{
+		TArray<uint16> Y, UV;
+		TArray<uint32> Simd, Scalar;
+
+		Simd.SetNumUninitialized(Width);
+		Scalar.SetNumUninitialized(Width);
+
+		int32 MaxError = 0;
+		int32 MaxMismatch = 0;
+		bool Opaque = true;
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			// chroma rows are padded to whole pairs
+			FillRandom16(Y, Width, Random);
+			FillRandom16(UV, (Width + 1) / 2 * 2, Random);
+
+			FVideoConversion::P216ToBgr10A2Row(Y.GetData(), UV.GetData(), (uint8*)Simd.GetData(), Width);
+			FVideoConversion::P216ToBgr10A2RowScalar(Y.GetData(), UV.GetData(), (uint8*)Scalar.GetData(), Width);
+
+			for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+			{
+				double Rgb[3];
+				ReferenceYuvToRgb(Y[Pixel], UV[Pixel / 2 * 2], UV[Pixel / 2 * 2 + 1], Rgb);
+
+				for (int32 Component = 0; Component < 3; ++Component)
+				{
+					const int32 Expected = FMath::RoundToInt(Rgb[Component] * 1023.0);
+					const int32 SimdValue = (Simd[Pixel] >> (Component * 10)) & 1023;
+					const int32 ScalarValue = (Scalar[Pixel] >> (Component * 10)) & 1023;
+
+					MaxError = FMath::Max3(MaxError, FMath::Abs(SimdValue - Expected), FMath::Abs(ScalarValue - Expected));
+					MaxMismatch = FMath::Max(MaxMismatch, FMath::Abs(SimdValue - ScalarValue));
+				}
+
+				Opaque &= ((Simd[Pixel] >> 30) == 3) && ((Scalar[Pixel] >> 30) == 3);
+			}
+		}
+
+		// the vector path rounds ties to even, the scalar path rounds them up
+		TestTrue(FString::Printf(TEXT("%i pixels: P216 is within 1 LSB of the reference (max error %i)"), Width, MaxError), MaxError <= 1);
+		TestTrue(FString::Printf(TEXT("%i pixels: P216 SIMD and scalar results are within 1 LSB (max difference %i)"), Width, MaxMismatch), MaxMismatch <= 1);
+		TestTrue(FString::Printf(TEXT("%i pixels: P216 output is opaque"), Width), Opaque);
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaVideoConversionPa16Test::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaVideoConversionTest;
+
+	const int32 NumRows = 16;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const int32 Width : Widths)
+	{
+		TArray<uint16> Y, UV, Alpha, Simd, Scalar;
+
+		Simd.SetNumUninitialized(Width * 4);
+		Scalar.SetNumUninitialized(Width * 4);
+
+		double MaxError = 0.0;
+		bool Identical = true;
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			FillRandom16(Y, Width, Random);
+			FillRandom16(UV, (Width + 1) / 2 * 2, Random);
+			FillRandom16(Alpha, Width, Random);
+
+			FVideoConversion::Pa16ToFloatRgbaRow(Y.GetData(), UV.GetData(), Alpha.GetData(), (uint8*)Simd.GetData(), Width);
+			FVideoConversion::Pa16ToFloatRgbaRowScalar(Y.GetData(), UV.GetData(), Alpha.GetData(), (uint8*)Scalar.GetData(), Width);
+
+			Identical &= (Simd == Scalar);
+
+			for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+			{
+				double Expected[4];
+				ReferenceYuvToRgb(Y[Pixel], UV[Pixel / 2 * 2], UV[Pixel / 2 * 2 + 1], Expected);
+				Expected[3] = Alpha[Pixel] / 65535.0;
+
+				for (int32 Component = 0; Component < 4; ++Component)
+				{
+					MaxError = FMath::Max(MaxError, GetHalfError(Simd[Pixel * 4 + Component], Expected[Component]));
+				}
+			}
+		}
+
+		TestTrue(FString::Printf(TEXT("%i pixels: PA16 SIMD and scalar results are identical"), Width), Identical);
+		TestTrue(FString::Printf(TEXT("%i pixels: PA16 is within one half precision step of the reference (max error %.3f steps)"), Width, MaxError), MaxError <= 1.0);
+	}
+
+	// all 16-bit alpha values go through the float to half conversion unchanged, so they cover it exhaustively
+	const int32 NumAlphaValues = 65536;
+
+	TArray<uint16> Y, UV, Alpha, Simd;
+	Y.Init(4096, NumAlphaValues);
+	UV.Init(32768, NumAlphaValues);
+	Alpha.SetNumUninitialized(NumAlphaValues);
+	Simd.SetNumUninitialized(NumAlphaValues * 4);
+
+	for (int32 Value = 0; Value < NumAlphaValues; ++Value)
+	{
+		Alpha[Value] = (uint16)Value;
+	}
+
+	FVideoConversion::Pa16ToFloatRgbaRow(Y.GetData(), UV.GetData(), Alpha.GetData(), (uint8*)Simd.GetData(), NumAlphaValues);
+
+	double MaxRoundingError = 0.0;
+	int32 MaxStepsFromFloat16 = 0;
+	int32 NumFlushed = 0;
+
+	for (int32 Value = 0; Value < NumAlphaValues; ++Value)
+	{
+		const float Normalized = Value * (1.0f / 65535.0f);
+		const uint16 Encoded = Simd[Value * 4 + 3];
+
+		if (Normalized < 1.0f / 16384.0f)
+		{
+			NumFlushed += (Encoded == 0) ? 1 : 0;
+
+			continue;
+		}
+
+		// FFloat16 truncates, so rounding to nearest may end up one step above it
+		MaxRoundingError = FMath::Max(MaxRoundingError, GetHalfError(Encoded, Normalized));
+		MaxStepsFromFloat16 = FMath::Max(MaxStepsFromFloat16, FMath::Abs((int32)Encoded - (int32)FFloat16(Normalized).Encoded));
+	}
+
+	AddInfo(FString::Printf(TEXT("Float to half: max error %.3f steps, max %i steps from FFloat16, %i tiny values flushed to zero"), MaxRoundingError, MaxStepsFromFloat16, NumFlushed));
+	TestTrue(TEXT("Float to half rounds to the nearest value"), MaxRoundingError <= 0.5 + 1e-3);
+	TestTrue(TEXT("Float to half is within one step of FFloat16"), MaxStepsFromFloat16 <= 1);
+	TestEqual(TEXT("Float to half flushes values below 2^-14 to zero"), NumFlushed, 4);
+
+	return true;
+}
+
+
+bool FNdiMediaVideoConversionUyvaTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaVideoConversionTest;
+
+	const int32 NumRows = 16;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const int32 Width : Widths)
+	{
+		TArray<uint8> Uyvy, Alpha, Simd, Scalar;
+
+		Simd.SetNumUninitialized(Width * 4);
+		Scalar.SetNumUninitialized(Width * 4);
+
+		bool Identical = true;
+		bool MatchesReference = true;
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			// UYVY rows are padded to whole texels
+			FillRandom(Uyvy, (Width + 1) / 2 * 4, Random);
+			FillRandom(Alpha, Width, Random);
+
+			FVideoConversion::UyvaToAyuvRow(Uyvy.GetData(), Alpha.GetData(), Simd.GetData(), Width);
+			FVideoConversion::UyvaToAyuvRowScalar(Uyvy.GetData(), Alpha.GetData(), Scalar.GetData(), Width);
+
+			Identical &= (Simd == Scalar);
+
+			for (int32 Pixel = 0; Pixel < Width; ++Pixel)
+			{
+				const uint8* Pair = &Uyvy[Pixel / 2 * 4];
+				const uint8* Texel = &Simd[Pixel * 4];
+
+				// VUYA
+				MatchesReference &= (Texel[0] == Pair[2]) && (Texel[1] == Pair[0]) && (Texel[2] == Pair[1 + (Pixel % 2) * 2]) && (Texel[3] == Alpha[Pixel]);
+			}
+		}
+
+		TestTrue(FString::Printf(TEXT("%i pixels: SIMD and scalar interleaving are identical"), Width), Identical);
+		TestTrue(FString::Printf(TEXT("%i pixels: texels hold the pixel's chroma pair, luma and alpha"), Width), MatchesReference);
+	}
+
+	// whole frames with padded rows on all worker threads
+	const int32 Width = 1001;
+	const int32 Height = 37;
+	const int32 Stride = 2048;
+
+	TArray<uint8> FrameData;
+	FillRandom(FrameData, Stride * Height + Width * Height, Random);
+
+	NDIlib_video_frame_v2_t Frame;
+	{
+		Frame.xres = Width;
+		Frame.yres = Height;
+		Frame.FourCC = NDIlib_FourCC_type_UYVA;
+		Frame.p_data = FrameData.GetData();
+		Frame.line_stride_in_bytes = Stride;
+	}
+
+	TArray<uint8> Dest, Expected;
+	Dest.SetNumZeroed(Width * 4 * Height);
+	Expected.SetNumZeroed(Width * 4 * Height);
+
+	FNdiMediaVideoConversion::UyvaToAyuv(Frame, Dest.GetData(), Width * 4, 0);
+
+	for (int32 Row = 0; Row < Height; ++Row)
+	{
+		FVideoConversion::UyvaToAyuvRowScalar(&FrameData[Row * Stride], &FrameData[Stride * Height + Row * Width], &Expected[Row * Width * 4], Width);
+	}
+
+	TestTrue(TEXT("Frames with padded rows are converted row by row"), Dest == Expected);
+
+	return true;
+}
+
+
+bool FNdiMediaVideoConversionUyvaCostTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaVideoConversionTest;
+
+	const FIntPoint Dims[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+	const int32 NumIterations = 20;
+
+	FRandomStream Random(0x4e4449);
+
+	for (const FIntPoint& Dim : Dims)
+	{
+		TArray<uint8> FrameData, Dest;
+		FillRandom(FrameData, Dim.X * Dim.Y * 3, Random);
+		Dest.SetNumUninitialized(Dim.X * Dim.Y * 4);
+
+		const uint8* Alpha = FrameData.GetData() + Dim.X * Dim.Y * 2;
+		double Milliseconds[2];
+
+		for (int32 Path = 0; Path < 2; ++Path)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+			{
+				for (int32 Row = 0; Row < Dim.Y; ++Row)
+				{
+					if (Path == 0)
+					{
+						FVideoConversion::UyvaToAyuvRow(FrameData.GetData() + Row * Dim.X * 2, Alpha + Row * Dim.X, Dest.GetData() + Row * Dim.X * 4, Dim.X);
+					}
+					else
+					{
+						FVideoConversion::UyvaToAyuvRowScalar(FrameData.GetData() + Row * Dim.X * 2, Alpha + Row * Dim.X, Dest.GetData() + Row * Dim.X * 4, Dim.X);
+					}
+				}
+			}
+
+			Milliseconds[Path] = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+		}
+
+		NDIlib_video_frame_v2_t Frame;
+		{
+			Frame.xres = Dim.X;
+			Frame.yres = Dim.Y;
+			Frame.FourCC = NDIlib_FourCC_type_UYVA;
+			Frame.p_data = FrameData.GetData();
+			Frame.line_stride_in_bytes = Dim.X * 2;
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			FNdiMediaVideoConversion::UyvaToAyuv(Frame, Dest.GetData(), Dim.X * 4, 0);
+		}
+
+		const double ParallelMilliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+
+		AddInfo(FString::Printf(TEXT("UYVA to AYUV, %i x %i: %.3f ms SIMD, %.3f ms scalar (%.2fx), %.3f ms on all threads"),
+			Dim.X, Dim.Y, Milliseconds[0], Milliseconds[1], Milliseconds[1] / FMath::Max(Milliseconds[0], 0.001), ParallelMilliseconds));
+	}
+
+	// compare with receiving BGRA, which NDI converts internally
+	if (!FNdi::WaitForInitialization())
+	{
+		AddWarning(TEXT("The NDI runtime is not available, so the conversion can't be compared with NDI's BGRA conversion."));
+
+		return true;
+	}
+
+	const double Seconds = 5.0;
+
+	for (const NDIlib_recv_color_format_e ColorFormat : { NDIlib_recv_color_format_e_BGRX_BGRA, NDIlib_recv_color_format_e_fastest })
+	{
+		FLoopbackResult Result;
+
+		if (!RunLoopback(ColorFormat, Seconds, Result))
+		{
+			AddError(TEXT("Failed to connect to the local NDI sender."));
+
+			return false;
+		}
+
+		const double NumReceived = FMath::Max<double>(Result.NumReceived, 1.0);
+
+		AddInfo(FString::Printf(TEXT("1920 x 1080 UYVA received as %s: %lld frames (%.1f fps), %.3f ms per frame in capture, %.3f ms converting"),
+			(ColorFormat == NDIlib_recv_color_format_e_fastest) ? TEXT("UYVA and interleaved to AYUV") : TEXT("BGRA by NDI"),
+			Result.NumReceived,
+			Result.NumReceived / Seconds,
+			FPlatformTime::ToMilliseconds64(Result.CaptureCycles) / NumReceived,
+			FPlatformTime::ToMilliseconds64(Result.ConvertCycles) / NumReceived));
+
+		TestTrue(TEXT("Video must be received"), Result.NumReceived > 0);
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
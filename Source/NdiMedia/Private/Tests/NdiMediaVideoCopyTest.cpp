@@ -0,0 +1,349 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Async/Async.h"
+#include "Containers/StringConv.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/UnrealMemory.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Guid.h"
+
+#include "Ndi.h"
+#include "NdiMediaParallelRows.h"
+#include "NdiMediaTextureSample.h"
+#include "NdiMediaVideoCopy.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoCopyStreamCopyTest, "Plugin.NdiMedia.VideoCopy.StreamCopy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoCopyCostTest, "Plugin.NdiMedia.VideoCopy.CopyCost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoCopyDropRateTest, "Plugin.NdiMedia.VideoCopy.DropRate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+namespace NdiMediaVideoCopyTest
+{
+	/** Results of a loopback run. */
+	struct FLoopbackResult
+	{
+		/** Total time spent copying frames (in CPU cycles). */
+		uint64 CopyCycles;
+
+		/** Number of frames that NDI dropped. */
+		int64 NumDropped;
+
+		/** Number of frames that were received. */
+		int64 NumReceived;
+	};
+
+	/**
+	 * Send 1080p60 UYVY video to a local receiver, and receive it the same way as the player.
+	 *
+	 * The received samples are held for as long as a texture upload that lags a few
+	 * frames behind, either referencing the NDI frames or copying them first.
+	 *
+	 * @param CopyFrames Whether to copy the frames, and release them to NDI immediately.
+	 * @param Seconds How long to receive.
+	 * @param OutResult Will contain the results.
+	 * @return true on success, false if the receiver could not connect to the sender.
+	 */
+	bool RunLoopback(bool CopyFrames, double Seconds, FLoopbackResult& OutResult)
+	{
+		const int32 Width = 1920;
+		const int32 Height = 1080;
+		const int32 NumHeldFrames = 3;
+
+		// create a clocked sender with a unique name
+		const FString SenderName = FString::Printf(TEXT("NdiMedia Benchmark %s"), *FGuid::NewGuid().ToString());
+		const FString SourceName = FString::Printf(TEXT("%s (%s)"), FPlatformProcess::ComputerName(), *SenderName);
+		auto SenderNameAnsi = StringCast<ANSICHAR>(*SenderName);
+		auto SourceNameAnsi = StringCast<ANSICHAR>(*SourceName);
+
+		NDIlib_send_create_t SendCreate;
+		{
+			SendCreate.p_ndi_name = SenderNameAnsi.Get();
+			SendCreate.p_groups = nullptr;
+			SendCreate.clock_video = true;
+			SendCreate.clock_audio = false;
+		}
+
+		void* SendInstance = FNdi::Lib->NDIlib_send_create(&SendCreate);
+
+		if (SendInstance == nullptr)
+		{
+			return false;
+		}
+
+		NDIlib_source_t Source;
+		{
+			Source.p_ndi_name = SourceNameAnsi.Get();
+			Source.p_ip_address = nullptr;
+		}
+
+		NDIlib_recv_create_t RecvCreate;
+		{
+			RecvCreate.source_to_connect_to = Source;
+			RecvCreate.color_format = NDIlib_recv_color_format_e_UYVY_BGRA;
+			RecvCreate.bandwidth = NDIlib_recv_bandwidth_highest;
+			RecvCreate.allow_video_fields = true;
+		}
+
+		void* ReceiverInstance = FNdi::Lib->NDIlib_recv_create_v2(&RecvCreate);
+
+		if (ReceiverInstance == nullptr)
+		{
+			FNdi::Lib->NDIlib_send_destroy(SendInstance);
+
+			return false;
+		}
+
+		// send frames until the receiver is done
+		TArray<uint8> FrameData;
+		FrameData.SetNumZeroed(Width * Height * 2);
+
+		FThreadSafeBool Stopped;
+
+		TFuture<void> SendTask = Async<void>(EAsyncExecution::Thread, [&FrameData, &Stopped, SendInstance, Width, Height]()
+		{
+			NDIlib_video_frame_v2_t VideoFrame;
+			{
+				VideoFrame.xres = Width;
+				VideoFrame.yres = Height;
+				VideoFrame.FourCC = NDIlib_FourCC_type_UYVY;
+				VideoFrame.frame_rate_N = 60;
+				VideoFrame.frame_rate_D = 1;
+				VideoFrame.picture_aspect_ratio = 16.0f / 9.0f;
+				VideoFrame.frame_format_type = NDIlib_frame_format_type_progressive;
+				VideoFrame.timecode = NDIlib_send_timecode_synthesize;
+				VideoFrame.p_data = FrameData.GetData();
+				VideoFrame.line_stride_in_bytes = Width * 2;
+				VideoFrame.p_metadata = nullptr;
+			}
+
+			while (!Stopped)
+			{
+				FNdi::Lib->NDIlib_send_send_video_v2(SendInstance, &VideoFrame);
+			}
+		});
+
+		// wait for the connection
+		const double ConnectTimeout = FPlatformTime::Seconds() + 10.0;
+
+		while ((FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) == 0) && (FPlatformTime::Seconds() < ConnectTimeout))
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		const bool Connected = (FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) > 0);
+
+		OutResult.CopyCycles = 0;
+		OutResult.NumDropped = 0;
+		OutResult.NumReceived = 0;
+
+		if (Connected)
+		{
+			FNdiMediaTextureSamplePool SamplePool;
+			TArray<TSharedRef<FNdiMediaTextureSample, ESPMode::ThreadSafe>> HeldSamples;
+			const double EndTime = FPlatformTime::Seconds() + Seconds;
+
+			while (FPlatformTime::Seconds() < EndTime)
+			{
+				NDIlib_video_frame_v2_t VideoFrame;
+
+				if (FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, &VideoFrame, nullptr, nullptr, 100) != NDIlib_frame_type_video)
+				{
+					continue;
+				}
+
+				auto TextureSample = SamplePool.AcquireShared();
+
+				if (!TextureSample->Initialize(ReceiverInstance, VideoFrame, EMediaTextureSampleFormat::CharUYVY, FTimespan::Zero()))
+				{
+					FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+
+					continue;
+				}
+
+				if (CopyFrames)
+				{
+					const uint64 StartCycles = FPlatformTime::Cycles64();
+					TextureSample->Detach(0);
+					OutResult.CopyCycles += FPlatformTime::Cycles64() - StartCycles;
+				}
+
+				// the render thread releases samples after they were uploaded
+				HeldSamples.Add(TextureSample);
+
+				if (HeldSamples.Num() > NumHeldFrames)
+				{
+					HeldSamples.RemoveAt(0);
+				}
+
+				++OutResult.NumReceived;
+			}
+
+			HeldSamples.Empty();
+			SamplePool.Reset();
+
+			NDIlib_recv_performance_t PerfTotal, PerfDropped;
+			FNdi::Lib->NDIlib_recv_get_performance(ReceiverInstance, &PerfTotal, &PerfDropped);
+
+			OutResult.NumDropped = PerfDropped.video_frames;
+		}
+
+		Stopped = true;
+		SendTask.Wait();
+
+		FNdi::Lib->NDIlib_recv_destroy(ReceiverInstance);
+		FNdi::Lib->NDIlib_send_destroy(SendInstance);
+
+		return Connected;
+	}
+}
+
+
+bool FNdiMediaVideoCopyStreamCopyTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x4e4449);
+
+	TArray<uint8> Source;
+	Source.SetNumUninitialized(4096 + 64);
+
+	for (uint8& Byte : Source)
+	{
+		Byte = (uint8)Random.RandHelper(256);
+	}
+
+	uint8* Dest = (uint8*)FMemory::Malloc(4096 + 64, 64);
+
+	// aligned and unaligned sources, with and without tails
+	const int32 Sizes[] = { 0, 1, 15, 16, 63, 64, 65, 127, 1000, 4096 };
+
+	for (int32 SourceOffset = 0; SourceOffset < 4; ++SourceOffset)
+	{
+		for (int32 Size : Sizes)
+		{
+			FMemory::Memset(Dest, 0xcd, 4096 + 64);
+			FNdiMediaVideoCopy::StreamCopy(Dest, Source.GetData() + SourceOffset, Size);
+
+			TestTrue(FString::Printf(TEXT("Copy of %i bytes from offset %i"), Size, SourceOffset), FMemory::Memcmp(Dest, Source.GetData() + SourceOffset, Size) == 0);
+			TestEqual(FString::Printf(TEXT("Byte after copy of %i bytes from offset %i"), Size, SourceOffset), Dest[Size], (uint8)0xcd);
+		}
+	}
+
+	// unaligned destinations fall back to a regular copy
+	FNdiMediaVideoCopy::StreamCopy(Dest + 1, Source.GetData(), 1000);
+	TestTrue(TEXT("Copy to an unaligned destination"), FMemory::Memcmp(Dest + 1, Source.GetData(), 1000) == 0);
+
+	FMemory::Free(Dest);
+
+	return true;
+}
+
+
+bool FNdiMediaVideoCopyCostTest::RunTest(const FString& Parameters)
+{
+	const FIntPoint Resolutions[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+	const int32 NumIterations = 50;
+
+	for (const FIntPoint& Resolution : Resolutions)
+	{
+		// UYVY frames, as received from NDI
+		const int32 RowBytes = Resolution.X * 2;
+		const SIZE_T Size = (SIZE_T)RowBytes * Resolution.Y;
+
+		uint8* Source = (uint8*)FMemory::Malloc(Size, 64);
+		uint8* Dest = (uint8*)FMemory::Malloc(Size, 64);
+
+		FMemory::Memset(Source, 0x80, Size);
+		FMemory::Memset(Dest, 0, Size);
+
+		uint64 MemcpyCycles = 0;
+		uint64 StreamCycles = 0;
+		uint64 ParallelCycles = 0;
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			uint64 StartCycles = FPlatformTime::Cycles64();
+			FMemory::Memcpy(Dest, Source, Size);
+			MemcpyCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			StartCycles = FPlatformTime::Cycles64();
+			FNdiMediaVideoCopy::StreamCopy(Dest, Source, Size);
+			StreamCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			// same as FNdiMediaTextureSample::Detach
+			StartCycles = FPlatformTime::Cycles64();
+
+			FNdiMediaParallelRows::ParallelFor(Resolution.Y, RowBytes * 2, 0, [=](int32 FirstRow, int32 NumRows)
+			{
+				FNdiMediaVideoCopy::StreamCopy(Dest + FirstRow * RowBytes, Source + FirstRow * RowBytes, (SIZE_T)NumRows * RowBytes);
+			});
+
+			ParallelCycles += FPlatformTime::Cycles64() - StartCycles;
+		}
+
+		TestTrue(FString::Printf(TEXT("%i x %i copy"), Resolution.X, Resolution.Y), FMemory::Memcmp(Dest, Source, Size) == 0);
+
+		AddInfo(FString::Printf(TEXT("%i x %i UYVY (%.1f MB): memcpy %.3f ms, streaming copy %.3f ms, parallel streaming copy %.3f ms"),
+			Resolution.X, Resolution.Y, Size / (1024.0 * 1024.0),
+			FPlatformTime::ToMilliseconds64(MemcpyCycles) / NumIterations,
+			FPlatformTime::ToMilliseconds64(StreamCycles) / NumIterations,
+			FPlatformTime::ToMilliseconds64(ParallelCycles) / NumIterations));
+
+		FMemory::Free(Source);
+		FMemory::Free(Dest);
+	}
+
+	return true;
+}
+
+
+bool FNdiMediaVideoCopyDropRateTest::RunTest(const FString& Parameters)
+{
+	if (!FNdi::WaitForInitialization())
+	{
+		AddWarning(TEXT("The NDI runtime is not available, so the drop rates can't be measured."));
+
+		return true;
+	}
+
+	const double Seconds = 5.0;
+
+	for (const bool CopyFrames : { false, true })
+	{
+		NdiMediaVideoCopyTest::FLoopbackResult Result;
+
+		if (!NdiMediaVideoCopyTest::RunLoopback(CopyFrames, Seconds, Result))
+		{
+			AddError(TEXT("Failed to connect to the local NDI sender."));
+
+			return false;
+		}
+
+		const int64 NumSent = Result.NumReceived + Result.NumDropped;
+
+		AddInfo(FString::Printf(TEXT("%s: %lld frames received, %lld dropped (%.2f%%), average copy %.3f ms"),
+			CopyFrames ? TEXT("Copy and release") : TEXT("Zero-copy"),
+			Result.NumReceived,
+			Result.NumDropped,
+			(NumSent > 0) ? 100.0 * Result.NumDropped / NumSent : 0.0,
+			(Result.NumReceived > 0) ? FPlatformTime::ToMilliseconds64(Result.CopyCycles) / Result.NumReceived : 0.0));
+
+		TestTrue(TEXT("Video must be received"), Result.NumReceived > 0);
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
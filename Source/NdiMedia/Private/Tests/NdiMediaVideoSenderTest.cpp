@@ -0,0 +1,278 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaPrivate.h"
+
+#include "Async/Async.h"
+#include "Containers/StringConv.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/UnrealMemory.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Guid.h"
+
+#include "Ndi.h"
+#include "NdiMediaVideoSender.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNdiMediaVideoSenderLoopbackTest, "Plugin.NdiMedia.VideoSender.Loopback", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+namespace NdiMediaVideoSenderTest
+{
+	/** Exposes the frame conversion of the video sender. */
+	class FTestVideoSender
+		: public FNdiMediaVideoSender
+	{
+	public:
+
+		using FNdiMediaVideoSender::FNdiMediaVideoSender;
+		using FNdiMediaVideoSender::FFrame;
+		using FNdiMediaVideoSender::SendFrame;
+	};
+
+	/** A received frame. */
+	struct FReceivedFrame
+	{
+		/** The BGRA or BGRX pixels (no row padding). */
+		TArray<uint8> Data;
+
+		/** Dimensions of the frame (in pixels). */
+		FIntPoint Dim;
+
+		/** The received FourCC. */
+		uint32 FourCC;
+	};
+
+	/** Fill the given buffer with smooth BGRA gradients, which survive NDI's compression. */
+	void FillGradient(TArray<uint8>& Buffer, const FIntPoint& Dim)
+	{
+		Buffer.SetNumUninitialized(Dim.X * Dim.Y * 4);
+
+		for (int32 Y = 0; Y < Dim.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dim.X; ++X)
+			{
+				uint8* Pixel = &Buffer[(Y * Dim.X + X) * 4];
+
+				Pixel[0] = (uint8)(X * 255 / (Dim.X - 1));
+				Pixel[1] = (uint8)(Y * 255 / (Dim.Y - 1));
+				Pixel[2] = 160;
+				Pixel[3] = (uint8)(64 + (X + Y) * 191 / (Dim.X + Dim.Y - 2));
+			}
+		}
+	}
+
+	/**
+	 * Send a frame through the video sender to a local receiver that receives BGRX or BGRA.
+	 *
+	 * @param ColorFormat The color format of the sender.
+	 * @param Rgba Whether to send the frame in RGBA instead of BGRA order.
+	 * @param Bgra The BGRA pixels to send.
+	 * @param Dim Dimensions of the frame (in pixels).
+	 * @param OutFrame Will contain the received frame.
+	 * @return true on success, false if no frame was received.
+	 */
+	bool RunLoopback(ENdiMediaSenderColorFormat ColorFormat, bool Rgba, const TArray<uint8>& Bgra, const FIntPoint& Dim, FReceivedFrame& OutFrame)
+	{
+		const FString SenderName = FString::Printf(TEXT("NdiMedia Test %s"), *FGuid::NewGuid().ToString());
+		const FString SourceName = FString::Printf(TEXT("%s (%s)"), FPlatformProcess::ComputerName(), *SenderName);
+		auto SourceNameAnsi = StringCast<ANSICHAR>(*SourceName);
+
+		FTestVideoSender Sender(SenderName, FString(), ColorFormat, ENdiMediaDownscale::None, ENdiMediaDownscaleFilter::Box, 60, 1);
+
+		if (!Sender.Start())
+		{
+			return false;
+		}
+
+		NDIlib_source_t Source;
+		{
+			Source.p_ndi_name = SourceNameAnsi.Get();
+			Source.p_ip_address = nullptr;
+		}
+
+		NDIlib_recv_create_t RecvCreate;
+		{
+			RecvCreate.source_to_connect_to = Source;
+			RecvCreate.color_format = NDIlib_recv_color_format_e_BGRX_BGRA;
+			RecvCreate.bandwidth = NDIlib_recv_bandwidth_highest;
+			RecvCreate.allow_video_fields = false;
+		}
+
+		void* ReceiverInstance = FNdi::Lib->NDIlib_recv_create_v2(&RecvCreate);
+
+		if (ReceiverInstance == nullptr)
+		{
+			return false;
+		}
+
+		// nothing is queued for the send thread, so frames can be sent from another thread
+		FThreadSafeBool Stopped;
+
+		TFuture<void> SendTask = Async<void>(EAsyncExecution::Thread, [&Bgra, &Dim, &Sender, &Stopped, Rgba]()
+		{
+			FTestVideoSender::FFrame Frame;
+
+			while (!Stopped)
+			{
+				// sending converts the frame in place
+				Frame.Data = Bgra;
+				Frame.Dim = Dim;
+				Frame.Rgba = Rgba;
+
+				if (Rgba)
+				{
+					for (int32 PixelIndex = 0; PixelIndex < Dim.X * Dim.Y; ++PixelIndex)
+					{
+						Swap(Frame.Data[PixelIndex * 4], Frame.Data[PixelIndex * 4 + 2]);
+					}
+				}
+
+				Sender.SendFrame(Frame);
+				FPlatformProcess::Sleep(1.0f / 60.0f);
+			}
+		});
+
+		// wait for the connection
+		const double ConnectTimeout = FPlatformTime::Seconds() + 10.0;
+
+		while ((FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) == 0) && (FPlatformTime::Seconds() < ConnectTimeout))
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		bool Received = false;
+
+		if (FNdi::Lib->NDIlib_recv_get_no_connections(ReceiverInstance) > 0)
+		{
+			const double EndTime = FPlatformTime::Seconds() + 5.0;
+
+			while (!Received && (FPlatformTime::Seconds() < EndTime))
+			{
+				NDIlib_video_frame_v2_t VideoFrame;
+
+				if (FNdi::Lib->NDIlib_recv_capture_v2(ReceiverInstance, &VideoFrame, nullptr, nullptr, 100) != NDIlib_frame_type_video)
+				{
+					continue;
+				}
+
+				const int32 RowBytes = VideoFrame.xres * 4;
+
+				OutFrame.Data.SetNumUninitialized(RowBytes * VideoFrame.yres);
+				OutFrame.Dim = FIntPoint(VideoFrame.xres, VideoFrame.yres);
+				OutFrame.FourCC = VideoFrame.FourCC;
+
+				for (int32 Row = 0; Row < VideoFrame.yres; ++Row)
+				{
+					FMemory::Memcpy(OutFrame.Data.GetData() + Row * RowBytes, VideoFrame.p_data + Row * VideoFrame.line_stride_in_bytes, RowBytes);
+				}
+
+				FNdi::Lib->NDIlib_recv_free_video_v2(ReceiverInstance, &VideoFrame);
+				Received = true;
+			}
+		}
+
+		Stopped = true;
+		SendTask.Wait();
+
+		FNdi::Lib->NDIlib_recv_destroy(ReceiverInstance);
+
+		return Received;
+	}
+}
+
+
+bool FNdiMediaVideoSenderLoopbackTest::RunTest(const FString& Parameters)
+{
+	using namespace NdiMediaVideoSenderTest;
+
+	if (!FNdi::WaitForInitialization())
+	{
+		AddWarning(TEXT("The NDI runtime is not available, so sent frames can't be received."));
+
+		return true;
+	}
+
+	// odd width, so that packing into UYVY drops the last column
+	const FIntPoint Dim(321, 180);
+
+	TArray<uint8> Bgra;
+	FillGradient(Bgra, Dim);
+
+	const ENdiMediaSenderColorFormat ColorFormats[] = { ENdiMediaSenderColorFormat::BGRA, ENdiMediaSenderColorFormat::UYVY, ENdiMediaSenderColorFormat::UYVA };
+	const TCHAR* ColorFormatNames[] = { TEXT("BGRA"), TEXT("UYVY"), TEXT("UYVA") };
+
+	// NDI compresses the video, so pixels are only compared on average
+	const double MaxMeanError = 4.0;
+
+	for (int32 FormatIndex = 0; FormatIndex < ARRAY_COUNT(ColorFormats); ++FormatIndex)
+	{
+		const ENdiMediaSenderColorFormat ColorFormat = ColorFormats[FormatIndex];
+		const bool Packed = (ColorFormat != ENdiMediaSenderColorFormat::BGRA);
+		const bool WithAlpha = (ColorFormat != ENdiMediaSenderColorFormat::UYVY);
+
+		for (const bool Rgba : { false, true })
+		{
+			const FString Name = FString::Printf(TEXT("%s from %s"), ColorFormatNames[FormatIndex], Rgba ? TEXT("RGBA") : TEXT("BGRA"));
+			FReceivedFrame Frame;
+
+			if (!RunLoopback(ColorFormat, Rgba, Bgra, Dim, Frame))
+			{
+				AddError(FString::Printf(TEXT("%s: No frame was received from the local NDI sender."), *Name));
+
+				continue;
+			}
+
+			TestEqual(FString::Printf(TEXT("%s: FourCC"), *Name), (int32)Frame.FourCC, (int32)(WithAlpha ? NDIlib_FourCC_type_BGRA : NDIlib_FourCC_type_BGRX));
+			TestEqual(FString::Printf(TEXT("%s: Width"), *Name), Frame.Dim.X, Packed ? (Dim.X & ~1) : Dim.X);
+			TestEqual(FString::Printf(TEXT("%s: Height"), *Name), Frame.Dim.Y, Dim.Y);
+
+			if ((Frame.Dim.X > Dim.X) || (Frame.Dim.Y != Dim.Y))
+			{
+				continue;
+			}
+
+			double Errors[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+			for (int32 Y = 0; Y < Frame.Dim.Y; ++Y)
+			{
+				for (int32 X = 0; X < Frame.Dim.X; ++X)
+				{
+					const uint8* Received = &Frame.Data[(Y * Frame.Dim.X + X) * 4];
+					const uint8* Expected = &Bgra[(Y * Dim.X + X) * 4];
+
+					for (int32 Channel = 0; Channel < 4; ++Channel)
+					{
+						// frames without alpha are received opaque
+						const int32 ExpectedValue = ((Channel == 3) && !WithAlpha) ? 255 : Expected[Channel];
+						Errors[Channel] += FMath::Abs(Received[Channel] - ExpectedValue);
+					}
+				}
+			}
+
+			const double NumPixels = (double)Frame.Dim.X * Frame.Dim.Y;
+			const TCHAR* ChannelNames[] = { TEXT("Blue"), TEXT("Green"), TEXT("Red"), TEXT("Alpha") };
+
+			AddInfo(FString::Printf(TEXT("%s: mean error B %.2f, G %.2f, R %.2f, A %.2f"), *Name,
+				Errors[0] / NumPixels, Errors[1] / NumPixels, Errors[2] / NumPixels, Errors[3] / NumPixels));
+
+			for (int32 Channel = 0; Channel < 4; ++Channel)
+			{
+				TestTrue(FString::Printf(TEXT("%s: %s channel matches the sent frame"), *Name, ChannelNames[Channel]), Errors[Channel] / NumPixels <= MaxMeanError);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+#endif //WITH_DEV_AUTOMATION_TESTS
+
+
+#include "NdiMediaHidePlatformTypes.h"
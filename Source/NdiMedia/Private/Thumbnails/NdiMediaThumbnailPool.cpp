@@ -0,0 +1,326 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaThumbnailPool.h"
+#include "NdiMediaPrivate.h"
+
+#include "Containers/StringConv.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "IMediaTextureSample.h"
+#include "Misc/ScopeLock.h"
+
+#include "Ndi.h"
+#include "NdiMediaSource.h"
+
+#include "NdiMediaAllowPlatformTypes.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Time after which a capture is abandoned if no video frame arrived (in seconds). */
+static const double CaptureTimeout = 5.0;
+
+/** Time that the capture thread sleeps if there is nothing to capture (in seconds). */
+static const float IdleSleepTime = 0.1f;
+
+/** Maximum time that the capture thread waits for a video frame from each receiver. */
+static const uint32 PollTimeoutMs = 20;
+
+/** Time after which sources whose thumbnails are no longer requested are forgotten (in seconds). */
+static const double RequestTimeout = 5.0;
+
+
+/** A source that is being captured. */
+struct FNdiMediaThumbnailCapture
+{
+	/** The receiver instance. */
+	void* ReceiverInstance;
+
+	/** The name of the source. */
+	FString SourceName;
+
+	/** The time at which the capture started (in seconds). */
+	double StartTime;
+};
+
+
+/* FNdiMediaThumbnailPool structors
+ *****************************************************************************/
+
+FNdiMediaThumbnailPool::FNdiMediaThumbnailPool(int32 InMaxReceivers, int32 InMaxWidth, double InRefreshInterval)
+	: MaxReceivers(FMath::Max(1, InMaxReceivers))
+	, MaxWidth(FMath::Max(1, InMaxWidth))
+	, RefreshInterval(InRefreshInterval)
+	, Thread(nullptr)
+{ }
+
+
+FNdiMediaThumbnailPool::~FNdiMediaThumbnailPool()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+
+/* FNdiMediaThumbnailPool interface
+ *****************************************************************************/
+
+TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> FNdiMediaThumbnailPool::GetThumbnail(const FNdiMediaSourceId& Source)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FRequest* Request = Requests.Find(Source.Name);
+
+	if (Request == nullptr)
+	{
+		Request = &Requests.Add(Source.Name);
+		Request->Capturing = false;
+		Request->LastCaptured = 0.0;
+	}
+
+	Request->LastRequested = FPlatformTime::Seconds();
+	Request->Source = Source;
+
+	return Request->Thumbnail;
+}
+
+
+bool FNdiMediaThumbnailPool::Start()
+{
+	if (!FNdi::IsInitialized() || (Thread != nullptr))
+	{
+		return false;
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("NdiMediaThumbnailPool"), 0, TPri_Lowest);
+
+	if (Thread == nullptr)
+	{
+		UE_LOG(LogNdiMedia, Warning, TEXT("Failed to create NDI thumbnail capture thread"));
+		return false;
+	}
+
+	return true;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FNdiMediaThumbnailPool::Run()
+{
+	TArray<FNdiMediaThumbnailCapture> Captures;
+
+	while (!Stopping)
+	{
+		const double Now = FPlatformTime::Seconds();
+
+		// start capturing the sources that are due, least recently captured first
+		if (Captures.Num() < MaxReceivers)
+		{
+			TArray<FRequest*> DueRequests;
+			TArray<FNdiMediaSourceId> DueSources;
+			{
+				FScopeLock Lock(&CriticalSection);
+
+				for (auto It = Requests.CreateIterator(); It; ++It)
+				{
+					FRequest& Request = It.Value();
+
+					if (!Request.Capturing && (Now - Request.LastRequested > RequestTimeout))
+					{
+						It.RemoveCurrent();
+					}
+					else if (!Request.Capturing && (Now - Request.LastCaptured >= RefreshInterval))
+					{
+						DueRequests.Add(&Request);
+					}
+				}
+
+				DueRequests.Sort([](const FRequest& A, const FRequest& B) {
+					return (A.LastCaptured < B.LastCaptured);
+				});
+
+				for (int32 RequestIndex = 0; (RequestIndex < DueRequests.Num()) && (Captures.Num() + DueSources.Num() < MaxReceivers); ++RequestIndex)
+				{
+					DueRequests[RequestIndex]->Capturing = true;
+					DueSources.Add(DueRequests[RequestIndex]->Source);
+				}
+			}
+
+			for (const FNdiMediaSourceId& Source : DueSources)
+			{
+				void* ReceiverInstance = CreateReceiver(Source);
+
+				if (ReceiverInstance == nullptr)
+				{
+					FinishCapture(Source.Name, nullptr);
+					continue;
+				}
+
+				FNdiMediaThumbnailCapture Capture;
+				{
+					Capture.ReceiverInstance = ReceiverInstance;
+					Capture.SourceName = Source.Name;
+					Capture.StartTime = Now;
+				}
+
+				Captures.Add(Capture);
+			}
+		}
+
+		if (Captures.Num() == 0)
+		{
+			FPlatformProcess::Sleep(IdleSleepTime);
+			continue;
+		}
+
+		// grab one video frame per source
+		for (int32 CaptureIndex = Captures.Num() - 1; CaptureIndex >= 0; --CaptureIndex)
+		{
+			FNdiMediaThumbnailCapture& Capture = Captures[CaptureIndex];
+
+			NDIlib_video_frame_v2_t VideoFrame;
+			const NDIlib_frame_type_e FrameType = FNdi::Lib->NDIlib_recv_capture_v2(Capture.ReceiverInstance, &VideoFrame, nullptr, nullptr, PollTimeoutMs);
+
+			TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> Thumbnail;
+
+			if (FrameType == NDIlib_frame_type_video)
+			{
+				if ((VideoFrame.FourCC == NDIlib_FourCC_type_BGRA) || (VideoFrame.FourCC == NDIlib_FourCC_type_BGRX))
+				{
+					Thumbnail = CreateThumbnail(VideoFrame.p_data, VideoFrame.line_stride_in_bytes, FIntPoint(VideoFrame.xres, VideoFrame.yres));
+				}
+				else
+				{
+					UE_LOG(LogNdiMedia, Verbose, TEXT("Unsupported video format for thumbnail of NDI source %s"), *Capture.SourceName);
+				}
+
+				FNdi::Lib->NDIlib_recv_free_video_v2(Capture.ReceiverInstance, &VideoFrame);
+			}
+			else if ((FrameType != NDIlib_frame_type_error) && (FPlatformTime::Seconds() - Capture.StartTime < CaptureTimeout))
+			{
+				continue; // no frame yet
+			}
+
+			FNdi::Lib->NDIlib_recv_destroy(Capture.ReceiverInstance);
+			FinishCapture(Capture.SourceName, Thumbnail);
+			Captures.RemoveAtSwap(CaptureIndex);
+		}
+	}
+
+	for (const FNdiMediaThumbnailCapture& Capture : Captures)
+	{
+		FNdi::Lib->NDIlib_recv_destroy(Capture.ReceiverInstance);
+	}
+
+	return 0;
+}
+
+
+void FNdiMediaThumbnailPool::Stop()
+{
+	Stopping = true;
+}
+
+
+/* FNdiMediaThumbnailPool implementation
+ *****************************************************************************/
+
+void* FNdiMediaThumbnailPool::CreateReceiver(const FNdiMediaSourceId& Source) const
+{
+	// the converted strings must outlive the call to NDIlib_recv_create_v2
+	auto EndpointAnsi = StringCast<ANSICHAR>(*Source.Endpoint);
+	auto NameAnsi = StringCast<ANSICHAR>(*Source.Name);
+
+	NDIlib_source_t NdiSource;
+	{
+		NdiSource.p_ip_address = Source.Endpoint.IsEmpty() ? nullptr : EndpointAnsi.Get();
+		NdiSource.p_ndi_name = Source.Name.IsEmpty() ? nullptr : NameAnsi.Get();
+	}
+
+	NDIlib_recv_create_t RcvCreateDesc;
+	{
+		RcvCreateDesc.source_to_connect_to = NdiSource;
+		RcvCreateDesc.color_format = NDIlib_recv_color_format_e_BGRX_BGRA;
+		RcvCreateDesc.bandwidth = NDIlib_recv_bandwidth_lowest;
+		RcvCreateDesc.allow_video_fields = false;
+	};
+
+	return FNdi::Lib->NDIlib_recv_create_v2(&RcvCreateDesc);
+}
+
+
+TSharedRef<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> FNdiMediaThumbnailPool::CreateThumbnail(const uint8* Data, uint32 Stride, const FIntPoint& Dim)
+{
+	TSharedRef<FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> Thumbnail = MakeShared<FNdiMediaSourceThumbnail, ESPMode::ThreadSafe>();
+
+	// reduce the resolution by factors of two or four until it fits
+	TArray<uint8> Buffers[2];
+	int32 BufferIndex = 0;
+	FIntPoint CurrentDim = Dim;
+
+	while (CurrentDim.X > MaxWidth)
+	{
+		Downscaler.SetMode((CurrentDim.X / 4 >= MaxWidth) ? ENdiMediaDownscale::Quarter : ENdiMediaDownscale::Half, ENdiMediaDownscaleFilter::Box);
+
+		const FIntPoint OutputDim = Downscaler.GetOutputDim(CurrentDim, EMediaTextureSampleFormat::CharBGRA);
+		TArray<uint8>& Output = Buffers[BufferIndex];
+
+		Output.SetNumUninitialized(OutputDim.X * OutputDim.Y * 4);
+		Downscaler.Downscale(Data, Stride, CurrentDim, EMediaTextureSampleFormat::CharBGRA, Output.GetData(), OutputDim.X * 4, 1);
+
+		Data = Output.GetData();
+		Stride = OutputDim.X * 4;
+		CurrentDim = OutputDim;
+		BufferIndex ^= 1;
+	}
+
+	// copy without row padding
+	Thumbnail->Dim = CurrentDim;
+	Thumbnail->Pixels.SetNumUninitialized(CurrentDim.X * CurrentDim.Y * 4);
+
+	for (int32 Row = 0; Row < CurrentDim.Y; ++Row)
+	{
+		FMemory::Memcpy(Thumbnail->Pixels.GetData() + Row * CurrentDim.X * 4, Data + Row * Stride, CurrentDim.X * 4);
+	}
+
+	// BGRX frames have undefined alpha
+	for (int32 PixelIndex = 0; PixelIndex < CurrentDim.X * CurrentDim.Y; ++PixelIndex)
+	{
+		Thumbnail->Pixels[PixelIndex * 4 + 3] = 0xff;
+	}
+
+	return Thumbnail;
+}
+
+
+void FNdiMediaThumbnailPool::FinishCapture(const FString& SourceName, const TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe>& Thumbnail)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FRequest* Request = Requests.Find(SourceName);
+
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	Request->Capturing = false;
+	Request->LastCaptured = FPlatformTime::Seconds();
+
+	// keep the previous thumbnail if the capture failed
+	if (Thumbnail.IsValid())
+	{
+		Request->Thumbnail = Thumbnail;
+	}
+}
+
+
+#include "NdiMediaHidePlatformTypes.h"
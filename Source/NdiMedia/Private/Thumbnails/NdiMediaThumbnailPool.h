@@ -0,0 +1,146 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+#include "INdiMediaModule.h"
+#include "NdiMediaDownscaler.h"
+#include "NdiMediaFinder.h"
+
+class FRunnableThread;
+
+
+/**
+ * Captures thumbnails of NDI sources on a background thread.
+ *
+ * Sources are captured for as long as their thumbnails keep being requested. The
+ * capture thread connects to the sources that are due for a refresh at the lowest
+ * bandwidth, grabs a single video frame from each, downscales it, and disconnects
+ * again. The number of receivers that exist at the same time is capped, so that
+ * browsing a large network doesn't overload the machine.
+ *
+ * This class is thread-safe.
+ */
+class FNdiMediaThumbnailPool
+	: public FRunnable
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InMaxReceivers Maximum number of receivers that may exist at the same time.
+	 * @param InMaxWidth Maximum width of thumbnails (in pixels).
+	 * @param InRefreshInterval Time after which thumbnails are captured again (in seconds).
+	 */
+	FNdiMediaThumbnailPool(int32 InMaxReceivers, int32 InMaxWidth, double InRefreshInterval);
+
+	/**
+	 * Virtual destructor.
+	 *
+	 * Waits for the capture thread to exit, which may block while receivers are
+	 * polled. Use FNdi::ReleaseAsync to destroy the pool on the game thread.
+	 */
+	virtual ~FNdiMediaThumbnailPool();
+
+public:
+
+	/**
+	 * Get the thumbnail of a source, and request it to be captured.
+	 *
+	 * @param Source The source to get the thumbnail for.
+	 * @return The most recent thumbnail, or nullptr if none was captured yet.
+	 */
+	TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> GetThumbnail(const FNdiMediaSourceId& Source);
+
+	/**
+	 * Start the capture thread.
+	 *
+	 * @return true on success, false otherwise.
+	 */
+	bool Start();
+
+public:
+
+	//~ FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+
+	/**
+	 * Create a receiver for the specified source.
+	 *
+	 * @param Source The source to connect to.
+	 * @return The receiver instance, or nullptr on failure.
+	 */
+	void* CreateReceiver(const FNdiMediaSourceId& Source) const;
+
+	/**
+	 * Create a thumbnail from a BGRA video frame.
+	 *
+	 * @param Data The frame data.
+	 * @param Stride Number of bytes per row in the frame.
+	 * @param Dim Dimensions of the frame (in pixels).
+	 * @return The thumbnail.
+	 */
+	TSharedRef<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> CreateThumbnail(const uint8* Data, uint32 Stride, const FIntPoint& Dim);
+
+	/**
+	 * Complete the capture of a source.
+	 *
+	 * @param SourceName The name of the captured source.
+	 * @param Thumbnail The new thumbnail, or nullptr if the capture failed.
+	 */
+	void FinishCapture(const FString& SourceName, const TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe>& Thumbnail);
+
+private:
+
+	/** A source whose thumbnail was requested. */
+	struct FRequest
+	{
+		/** Whether the source is currently being captured. */
+		bool Capturing;
+
+		/** The time at which the source was last captured (in seconds). */
+		double LastCaptured;
+
+		/** The time at which the thumbnail was last requested (in seconds). */
+		double LastRequested;
+
+		/** The source. */
+		FNdiMediaSourceId Source;
+
+		/** The most recent thumbnail. */
+		TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> Thumbnail;
+	};
+
+	/** Critical section for synchronizing access to the requests. */
+	FCriticalSection CriticalSection;
+
+	/** Downscaler for captured frames (only used on the capture thread). */
+	FNdiMediaDownscaler Downscaler;
+
+	/** Maximum number of receivers that may exist at the same time. */
+	int32 MaxReceivers;
+
+	/** Maximum width of thumbnails (in pixels). */
+	int32 MaxWidth;
+
+	/** Time after which thumbnails are captured again (in seconds). */
+	double RefreshInterval;
+
+	/** The requested sources by name. */
+	TMap<FString, FRequest> Requests;
+
+	/** Whether the capture thread should stop. */
+	FThreadSafeBool Stopping;
+
+	/** The capture thread. */
+	FRunnableThread* Thread;
+};
@@ -2,12 +2,29 @@
 
 #pragma once
 
+#include "Containers/Array.h"
+#include "Math/IntPoint.h"
 #include "Modules/ModuleInterface.h"
 #include "Templates/SharedPointer.h"
 
 class IMediaEventSink;
 class IMediaPlayer;
 
+struct FNdiMediaSourceId;
+
+
+/**
+ * A downscaled snapshot of the video of an NDI source.
+ */
+struct FNdiMediaSourceThumbnail
+{
+	/** Dimensions of the thumbnail (in pixels). */
+	FIntPoint Dim;
+
+	/** The pixel data (BGRA, 8 bits per channel, no row padding). */
+	TArray<uint8> Pixels;
+};
+
 
 /**
  * Interface for the NdiMedia module.
@@ -25,6 +42,18 @@ public:
 	 */
 	virtual TSharedPtr<IMediaPlayer, ESPMode::ThreadSafe> CreatePlayer(IMediaEventSink& EventSink) = 0;
 
+	/**
+	 * Get a thumbnail of an NDI source.
+	 *
+	 * Thumbnails are captured in the background by a small pool of low bandwidth
+	 * receivers, and refreshed every few seconds for as long as they are requested.
+	 * Call this function periodically while the thumbnail is visible.
+	 *
+	 * @param Source The source to get the thumbnail for.
+	 * @return The most recent thumbnail, or nullptr if none was captured yet.
+	 */
+	virtual TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> GetSourceThumbnail(const FNdiMediaSourceId& Source) = 0;
+
 public:
 
 	/** Virtual destructor. */
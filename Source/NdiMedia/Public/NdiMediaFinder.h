@@ -9,6 +9,9 @@
 
 #include "NdiMediaFinder.generated.h"
 
+class FNdiMediaSourceDiscovery;
+class FNdiMediaSourceRegistry;
+
 
 /**
  * Identifies an NDI media source.
@@ -42,6 +45,45 @@ struct FNdiMediaSourceId
 
 public:
 
+	/**
+	 * Compare this source with another for equality.
+	 *
+	 * @param Other The source to compare with.
+	 * @return true if the sources are equal, false otherwise.
+	 */
+	bool operator==(const FNdiMediaSourceId& Other) const
+	{
+		return (Name == Other.Name) && (Endpoint == Other.Endpoint);
+	}
+
+	/**
+	 * Get the hash for the specified source.
+	 *
+	 * @param Source The source to get the hash for.
+	 * @return Hash value.
+	 */
+	friend uint32 GetTypeHash(const FNdiMediaSourceId& Source)
+	{
+		return HashCombine(GetTypeHash(Source.Name), GetTypeHash(Source.Endpoint));
+	}
+
+	/**
+	 * Get the name of the machine that this source is running on.
+	 *
+	 * @return The machine name, i.e. "MACHINE" for "MACHINE (Source)", or an empty string if unknown.
+	 */
+	FString GetMachineName() const
+	{
+		int32 ParenthesisIndex = INDEX_NONE;
+
+		if (!Name.EndsWith(TEXT(")")) || !Name.FindChar(TEXT('('), ParenthesisIndex))
+		{
+			return FString();
+		}
+
+		return Name.Left(ParenthesisIndex).TrimEnd();
+	}
+
 	/**
 	 * Get a string representation of this source.
 	 *
@@ -55,9 +97,25 @@ public:
 };
 
 
+/** Multicast delegate that is invoked when an NDI source was added or removed. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNdiMediaFinderSourceEvent, const FNdiMediaSourceId&, Source);
+
+/** Multicast delegate that is invoked when the list of NDI sources changed. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnNdiMediaFinderSourcesChanged);
+
+
 //
 // Asset for finding NDI streams.
 //
+// Sources are discovered on a background thread. The list returned by GetSources
+// is a snapshot that is updated on the game thread, after which the OnSourceRemoved,
+// OnSourceAdded and OnSourcesChanged delegates are broadcast.
+//
+// Changes to the discovery settings are batched and applied on the next tick. The
+// previous list of sources remains available while a replacement NDI find instance
+// warms up, and is swapped once the replacement found the same sources or its
+// warm-up time elapsed.
+//
 UCLASS(BlueprintType)
 class NDIMEDIA_API UNdiMediaFinder
 	: public UObject
@@ -71,9 +129,58 @@ public:
 
 public:
 
+	/**
+	 * Find a discovered NDI source by its IP endpoint.
+	 *
+	 * @param Endpoint The endpoint to find, i.e. "1.2.3.4:12345".
+	 * @param OutSource Will contain the source, if found.
+	 * @return true if the source was found, false otherwise.
+	 * @see FindSourceByName, FindSourcesByGroup, FindSourcesByMachine, SearchSources
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	bool FindSourceByEndpoint(const FString& Endpoint, FNdiMediaSourceId& OutSource) const;
+
+	/**
+	 * Find a discovered NDI source by its name.
+	 *
+	 * @param Name The name to find, i.e. "MACHINE (Source)".
+	 * @param OutSource Will contain the source, if found.
+	 * @return true if the source was found, false otherwise.
+	 * @see FindSourceByEndpoint, FindSourcesByGroup, FindSourcesByMachine, SearchSources
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	bool FindSourceByName(const FString& Name, FNdiMediaSourceId& OutSource) const;
+
+	/**
+	 * Find the discovered NDI sources in a group.
+	 *
+	 * The NDI SDK does not report the groups of sources, so a source is considered
+	 * to be in all groups that were searched when it was found ("public" if the
+	 * finder has no group filters).
+	 *
+	 * @param Group The name of the group.
+	 * @param OutSources Will contain the sources.
+	 * @see FindSourceByEndpoint, FindSourceByName, FindSourcesByMachine, GetGroupFilters
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	void FindSourcesByGroup(const FString& Group, TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Find the discovered NDI sources that are running on a machine.
+	 *
+	 * @param Machine The name of the machine, i.e. "MACHINE".
+	 * @param OutSources Will contain the sources.
+	 * @see FindSourceByEndpoint, FindSourceByName, FindSourcesByGroup
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	void FindSourcesByMachine(const FString& Machine, TArray<FNdiMediaSourceId>& OutSources) const;
+
 	/**
 	 * Get the list of NDI media sources currently available on the network.
 	 *
+	 * The list is a cached snapshot, which is updated on the game thread whenever
+	 * the background discovery reports a change.
+	 *
 	 * @param OutSources Will contain the collection of found NDI source names and their URLs.
 	 * @return true on success, false if the finder wasn't initialized.
 	 * @see Initialize, Shutdown
@@ -84,12 +191,48 @@ public:
 	/**
 	 * Initialize this finder and start discovering NDI sources on the network.
 	 *
+	 * If the finder is already initialized, the discovery is restarted with the
+	 * current settings, unless they did not change.
+	 *
 	 * @return true on success, false otherwise.
 	 * @see GetSources, Shutdown
 	 */
 	UFUNCTION(BlueprintCallable, Category=NDI)
 	bool Initialize();
 
+	/**
+	 * Search the names of discovered NDI sources (ignoring case).
+	 *
+	 * @param Text The text to search for.
+	 * @param PrefixOnly Whether to only find names that start with the text.
+	 * @param OutSources Will contain the matching sources (sorted by name if PrefixOnly is set).
+	 * @see FindSourceByName, GetSources
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	void SearchSources(const FString& Text, bool PrefixOnly, TArray<FNdiMediaSourceId>& OutSources) const;
+
+	/**
+	 * Get the sources from previous sessions that were not discovered yet.
+	 *
+	 * @return Collection of cached sources.
+	 * @see SetCachedSources
+	 */
+	const TArray<FNdiMediaSourceId>& GetCachedSources() const
+	{
+		return CachedSources;
+	}
+
+	/**
+	 * Provide sources that were seen in previous sessions.
+	 *
+	 * The sources are returned until the discovery has warmed up, unless the discovery
+	 * reports a source with the same name before then. The finder must be initialized.
+	 *
+	 * @param InCachedSources The cached sources.
+	 * @see GetCachedSources, GetSources, Initialize
+	 */
+	void SetCachedSources(const TArray<FNdiMediaSourceId>& InCachedSources);
+
 	/**
 	 * Shut down this finder and stop discovering NDI sources on the network.
 	 *
@@ -201,6 +344,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category=NDI)
 	void RemoveGroupFilter(const FString& GroupName);
 
+public:
+
+	/** A delegate that is invoked for each NDI source that was discovered. */
+	UPROPERTY(BlueprintAssignable, Category=NDI)
+	FOnNdiMediaFinderSourceEvent OnSourceAdded;
+
+	/** A delegate that is invoked for each NDI source that disappeared. */
+	UPROPERTY(BlueprintAssignable, Category=NDI)
+	FOnNdiMediaFinderSourceEvent OnSourceRemoved;
+
+	/** A delegate that is invoked after the list of NDI sources changed. */
+	UPROPERTY(BlueprintAssignable, Category=NDI)
+	FOnNdiMediaFinderSourcesChanged OnSourcesChanged;
+
 public:
 
 	//~ UObject interface
@@ -238,6 +395,65 @@ private:
 
 private:
 
-	/** The NDI source finder instance. */
-	void* FindInstance;
+	/**
+	 * Create and start a background discovery with the current settings.
+	 *
+	 * @return The discovery, or nullptr if it couldn't be started.
+	 */
+	FNdiMediaSourceDiscovery* CreateDiscovery();
+
+	/**
+	 * Handle a list of sources reported by a discovery thread.
+	 *
+	 * @param Generation The generation of the discovery that reported the sources.
+	 * @param NewSources The reported sources.
+	 * @param WarmedUp Whether the discovery's warm-up time elapsed.
+	 */
+	void HandleDiscoveredSources(uint32 Generation, TArray<FNdiMediaSourceId> NewSources, bool WarmedUp);
+
+	/** Apply changed discovery settings by starting a replacement discovery. */
+	void Restart();
+
+	/** Schedule a restart of the discovery on the next tick, so that multiple changes are applied at once. */
+	void ScheduleRestart();
+
+	/**
+	 * Update the cached list of sources and notify listeners.
+	 *
+	 * @param NewSources The new list of sources.
+	 * @param GroupsChanged Whether the searched groups changed since the last update.
+	 */
+	void UpdateSources(TArray<FNdiMediaSourceId> NewSources, bool GroupsChanged);
+
+private:
+
+	/** Sources that were seen in previous sessions, and that were not discovered yet. */
+	TArray<FNdiMediaSourceId> CachedSources;
+
+	/** The background discovery of NDI sources. */
+	FNdiMediaSourceDiscovery* Discovery;
+
+	/** The generation of the current discovery. */
+	uint32 DiscoveryGeneration;
+
+	/** Incremented whenever a discovery is created, so that stale reports can be ignored. */
+	uint32 NextDiscoveryGeneration;
+
+	/** The groups that the sources of the current discovery belong to. */
+	TArray<FString> DiscoveryGroups;
+
+	/** The replacement discovery that is warming up (optional). */
+	FNdiMediaSourceDiscovery* PendingDiscovery;
+
+	/** The generation of the replacement discovery. */
+	uint32 PendingDiscoveryGeneration;
+
+	/** Indexes the discovered sources. */
+	TSharedPtr<FNdiMediaSourceRegistry> Registry;
+
+	/** Whether a restart of the discovery has been scheduled. */
+	bool RestartScheduled;
+
+	/** The cached list of discovered sources. */
+	TArray<FNdiMediaSourceId> Sources;
 };
@@ -0,0 +1,165 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "UObject/ObjectMacros.h"
+
+#include "NdiMediaSource.h"
+
+#include "NdiMediaSender.generated.h"
+
+class FNdiMediaVideoSender;
+class UTextureRenderTarget2D;
+
+
+/**
+ * Available color formats for sent NDI video.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaSenderColorFormat : uint8
+{
+	/** 8-bit BGRA with alpha channel. */
+	BGRA,
+
+	/** 8-bit BGRA without alpha channel. */
+	BGRX,
+
+	/** 8-bit UYVY without alpha channel (packed by the sender, which saves NDI the conversion). */
+	UYVY,
+
+	/** 8-bit UYVY followed by an alpha plane (packed by the sender). */
+	UYVA
+};
+
+
+/**
+ * Asset for publishing engine output as an NDI source.
+ *
+ * The sender captures either a render target or, if no render target is set, the
+ * game viewport. Captured frames are copied into staging textures on the render
+ * thread and read back a few frames later, so that neither the game thread nor the
+ * render thread wait for the GPU. The read back frames are passed through a small
+ * pool of CPU buffers to a send thread, which converts them and hands them to NDI
+ * asynchronously. Frames are dropped if the pool is exhausted.
+ */
+UCLASS(BlueprintType, hidecategories=(Object))
+class NDIMEDIA_API UNdiMediaSender
+	: public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Default constructor. */
+	UNdiMediaSender();
+
+public:
+
+	/**
+	 * Get statistics about the sent video.
+	 *
+	 * @return Human readable statistics, or an empty string if not sending.
+	 * @see IsSending
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	FString GetStats() const;
+
+	/**
+	 * Whether this sender is currently sending.
+	 *
+	 * @return true if sending, false otherwise.
+	 * @see StartSending, StopSending
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	bool IsSending() const;
+
+	/**
+	 * Start publishing the render target or game viewport as an NDI source.
+	 *
+	 * Changes to the settings take effect the next time sending is started.
+	 *
+	 * @return true on success, false otherwise.
+	 * @see IsSending, StopSending
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	bool StartSending();
+
+	/**
+	 * Stop publishing the NDI source.
+	 *
+	 * @see IsSending, StartSending
+	 */
+	UFUNCTION(BlueprintCallable, Category=NDI)
+	void StopSending();
+
+public:
+
+	/** The color format of the sent video (default = BGRA). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video)
+	ENdiMediaSenderColorFormat ColorFormat;
+
+	/** Reduce the resolution of the sent video (default = None). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video)
+	ENdiMediaDownscale Downscale;
+
+	/** The filter to use for reducing the resolution (default = Box). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaDownscaleFilter DownscaleFilter;
+
+	/** Frame rate denominator of the sent video (default = 1). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, meta=(ClampMin=1))
+	int32 FrameRateDenominator;
+
+	/** Frame rate numerator of the sent video (default = 60). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, meta=(ClampMin=1))
+	int32 FrameRateNumerator;
+
+	/**
+	 * The render target to send.
+	 *
+	 * If no render target is set, the game viewport is sent. Only render targets
+	 * with 8-bit RGBA or BGRA pixel formats are supported.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video)
+	UTextureRenderTarget2D* RenderTarget;
+
+public:
+
+	/** Comma separated list of NDI groups to publish the source in (empty = default group). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=NDI, AdvancedDisplay)
+	FString Groups;
+
+	/** The name of the published NDI source (default = Unreal Engine). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=NDI)
+	FString SourceName;
+
+public:
+
+	//~ UObject interface
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	/** Callback for the core ticker, used to capture frames at the desired frame rate. */
+	bool HandleTicker(float DeltaTime);
+
+private:
+
+	/** Handle to the registered back buffer delegate (only when sending the game viewport). */
+	FDelegateHandle BackBufferHandle;
+
+	/** Time between sent frames (in seconds). */
+	double FrameInterval;
+
+	/** The time at which the next frame is due (in seconds). */
+	double NextFrameTime;
+
+	/** Handle to the registered ticker. */
+	FDelegateHandle TickerHandle;
+
+	/** The sender pipeline (only while sending). */
+	TSharedPtr<FNdiMediaVideoSender, ESPMode::ThreadSafe> VideoSender;
+};
@@ -0,0 +1,85 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SynthComponent.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/ObjectMacros.h"
+
+#include "NdiMediaSoundComponent.generated.h"
+
+class FNdiMediaAudioRing;
+class UNdiMediaSource;
+
+
+/**
+ * Implements a sound component for playing NDI audio with minimal latency.
+ *
+ * This component plays the audio of media players whose NDI media source has
+ * UseDirectAudio enabled. The audio bypasses the media sample queues and the
+ * media sound component, and is instead passed through a lock-free ring buffer
+ * that is consumed directly on the audio render thread. Only one sound component
+ * at a time can play the audio of a media source.
+ */
+UCLASS(ClassGroup=Media, editinlinenew, meta=(BlueprintSpawnableComponent))
+class NDIMEDIA_API UNdiMediaSoundComponent
+	: public USynthComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The NDI media source whose audio to play. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=NDI)
+	UNdiMediaSource* MediaSource;
+
+	/**
+	 * Maximum latency beyond one received audio frame (in milliseconds, default = 20).
+	 *
+	 * Older audio is discarded if more audio is buffered, i.e. after the audio
+	 * render thread stalled.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=NDI, AdvancedDisplay)
+	int32 MaxLatency;
+
+	/**
+	 * Sample rate of the played audio (in samples per second, default = 48000).
+	 *
+	 * This should match the sample rate of the NDI source, because the audio
+	 * is not resampled on the direct path.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=NDI, AdvancedDisplay)
+	int32 SampleRate;
+
+public:
+
+	/** Default constructor. */
+	UNdiMediaSoundComponent(const FObjectInitializer& ObjectInitializer);
+
+public:
+
+	//~ UActorComponent interface
+
+	virtual void OnUnregister() override;
+
+protected:
+
+	//~ USynthComponent interface
+
+	virtual bool Init(int32& OutSampleRate) override;
+	virtual void OnGenerateAudio(float* OutAudio, int32 NumSamples) override;
+
+protected:
+
+	/** Detach from the ring buffer, so that another sound component can play the audio. */
+	void DetachRing();
+
+private:
+
+	/** The ring buffer that the audio is read from. */
+	TSharedPtr<FNdiMediaAudioRing, ESPMode::ThreadSafe> Ring;
+
+	/** Critical section for synchronizing access to the ring buffer. */
+	FCriticalSection RingCriticalSection;
+};
@@ -10,6 +10,20 @@
 #include "NdiMediaSource.generated.h"
 
 
+/**
+ * Policies for recovering from audio queue overruns.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaAudioOverrunPolicy : uint8
+{
+	/** Discard the oldest queued audio, so that the newest audio plays with half the maximum latency. */
+	Drop,
+
+	/** Play received audio about 7% faster until the queue has drained (raises the pitch by about a semitone). */
+	Compress
+};
+
+
 /**
  * NDI source stream bandwidth options.
  */
@@ -27,6 +41,111 @@ enum class ENdiMediaBandwidth : uint8
 };
 
 
+/**
+ * Available value ranges of YUV video.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaColorRange : uint8
+{
+	/** Studio range, i.e. luma from 16 to 235. */
+	Limited,
+
+	/** Full range, i.e. luma from 0 to 255. */
+	Full
+};
+
+
+/**
+ * Available color spaces of YUV video.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaColorSpace : uint8
+{
+	/** Let the engine convert to RGB on the GPU (BT.601). */
+	Engine,
+
+	/** BT.601 for SD and BT.709 for HD and larger video. */
+	Auto,
+
+	/** ITU-R BT.601 (SD). */
+	BT601,
+
+	/** ITU-R BT.709 (HD). */
+	BT709,
+
+	/** ITU-R BT.2020 (UHD), mapped to the BT.709 primaries. */
+	BT2020
+};
+
+
+/**
+ * Available deinterlace modes for fielded NDI sources.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaDeinterlaceMode : uint8
+{
+	/** Pass fielded frames through unchanged. */
+	None,
+
+	/** Combine both fields into one frame (best for static content). */
+	Weave,
+
+	/** Interpolate the rows of one field from the other (best for motion). */
+	Bob,
+
+	/** Weave static areas and interpolate moving areas. */
+	MotionAdaptive
+};
+
+
+/**
+ * Available resolution reductions for received video.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaDownscale : uint8
+{
+	/** Full resolution. */
+	None,
+
+	/** Half width and height. */
+	Half,
+
+	/** Quarter width and height. */
+	Quarter
+};
+
+
+/**
+ * Available filters for reducing the resolution of received video.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaDownscaleFilter : uint8
+{
+	/** Average all source pixels (best quality). */
+	Box,
+
+	/** Average the source pixels closest to the output pixel (fastest). */
+	Bilinear
+};
+
+
+/**
+ * Available methods for detecting repeated video frames.
+ */
+UENUM(BlueprintType)
+enum class ENdiMediaDuplicateFrameDetection : uint8
+{
+	/** Upload every received frame. */
+	None,
+
+	/** Compare every eighth row of each frame (fastest, but may miss small changes). */
+	Sampled,
+
+	/** Compare all pixels of each frame. */
+	Full
+};
+
+
 /**
  * NDI source stream progressive video options.
  */
@@ -45,8 +164,17 @@ enum class ENdiMediaFrameFormatPreference : uint8
 UENUM(BlueprintType)
 enum class ENdiMediaColorFormat : uint8
 {
+	/** 8-bit BGRA, converted by NDI if needed. */
 	BGRA,
-	UYVY
+
+	/** 8-bit UYVY, or BGRA for sources with alpha channel. */
+	UYVY,
+
+	/** 8-bit UYVY, or UYVA for sources with alpha channel (converted by the player). */
+	UYVA,
+
+	/** 16-bit P216, or PA16 for sources with alpha channel (converted by the player, requires NDI 4 runtimes, otherwise UYVA). */
+	P216
 };
 
 
@@ -70,6 +198,50 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio)
 	int32 AudioReferenceLevel;
 
+	/**
+	 * Number of audio channels to expose per audio track (0 = all channels in one track, default = 0).
+	 *
+	 * Use this setting to make the channel groups of multi-language or multi-mix feeds
+	 * selectable as separate audio tracks, i.e. a value of 2 exposes each channel pair
+	 * as its own stereo track. Only the channels of the selected track are converted.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio, AdvancedDisplay)
+	int32 NumAudioChannelsPerTrack;
+
+	/**
+	 * Maximum duration of received audio that may be queued for playback (in milliseconds, 0 = unlimited, default = 0).
+	 *
+	 * If the audio consumer stalls, i.e. during a hitch, the audio queue grows and
+	 * the latency stays high afterwards. When this limit is exceeded, the player
+	 * applies the AudioOverrunPolicy until the queue has drained to half the limit.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio, AdvancedDisplay)
+	int32 MaxAudioQueueDuration;
+
+	/**
+	 * Number of audio frames per media sample (0 = one sample per received NDI frame, default = 0).
+	 *
+	 * NDI audio frames arrive in arbitrary sizes, which forces the audio sink to split and
+	 * stitch buffers. Set this to the audio callback buffer size of the target platform
+	 * (i.e. 1024) to re-chunk the received audio into samples that match the callbacks.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio, AdvancedDisplay)
+	int32 NumAudioFramesPerSample;
+
+	/** How to recover from audio queue overruns (default = Drop). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio, AdvancedDisplay)
+	ENdiMediaAudioOverrunPolicy AudioOverrunPolicy;
+
+	/**
+	 * Whether to play the audio through an NdiMediaSoundComponent with minimal latency (default = false).
+	 *
+	 * Enable this setting for talkback and IFB feeds. The received audio bypasses the
+	 * media sample queues and is passed directly to any NdiMediaSoundComponent that
+	 * references this media source. It is no longer available to media sound components.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio, AdvancedDisplay)
+	bool UseDirectAudio;
+
 	/** Preferred audio sample rate (in samples per second, 0 = no preference, default = 48000). */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Audio, AdvancedDisplay)
 	int32 PreferredAudioSampleRate;
@@ -115,7 +287,8 @@ public:
 	 * If you leave this empty, then the SourceEndpoint setting is used instead.
 	 * The connection is faster if the IP address and port number is known, but
 	 * some servers may use dynamic port numbers, so the source has to be looked
-	 * up via this name instead.
+	 * up via this name instead. If the source was discovered before, the player
+	 * connects to its last known endpoint, and falls back to the name if that fails.
 	 */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=NDI, AssetRegistrySearchable)
 	FString SourceName;
@@ -128,10 +301,133 @@ public:
 
 public:
 
-	/** Desired color format of input video frames (default = UYVY). */
+	/**
+	 * Desired color format of input video frames (default = UYVY).
+	 *
+	 * Use UYVA for key and fill sources, so that NDI does not have to convert them to BGRA.
+	 * Use P216 for sources with more than 8 bits per component; 8-bit sources are still
+	 * received as UYVY or UYVA.
+	 */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video)
 	ENdiMediaColorFormat ColorFormat;
 
+	/**
+	 * Value range of received YUV video (default = Limited).
+	 *
+	 * Only used if a color space other than Engine is selected.
+	 *
+	 * @see ColorSpace
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaColorRange ColorRange;
+
+	/**
+	 * Color space of received YUV video (default = Engine).
+	 *
+	 * The engine converts UYVY and UYVA video with the BT.601 matrix, which renders HD
+	 * sources with slightly wrong colors. Select a different color space to convert
+	 * 8-bit YUV frames to sRGB on the CPU instead. Converted frames are deinterlaced and
+	 * downscaled in BGRA, which costs more than processing them in UYVY.
+	 *
+	 * @see ColorRange
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaColorSpace ColorSpace;
+
+	/**
+	 * Whether to copy received video frames and release them to NDI immediately (default = false).
+	 *
+	 * By default, video samples reference the frame buffers of the NDI receiver until
+	 * they are rendered, which can stall the receiver if samples are queued for longer
+	 * periods. Enable this setting to copy each frame into a pooled buffer instead.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	bool CopyVideoFrames;
+
+	/**
+	 * Top-left corner of the region of interest in received video frames (in pixels, default = 0, 0).
+	 *
+	 * @see CropSize
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	FIntPoint CropOffset;
+
+	/**
+	 * Size of the region of interest in received video frames (in pixels, 0 = full frame, default = 0, 0).
+	 *
+	 * Only the region of interest is uploaded to the texture. If frames are not copied, this
+	 * costs nothing, because the video samples simply point into the received frames.
+	 *
+	 * @see CropOffset
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	FIntPoint CropSize;
+
+	/**
+	 * How to deinterlace fielded video frames (default = None).
+	 *
+	 * Deinterlacing is supported for BGRA and UYVY frames, and for UYVA frames that
+	 * are converted with a color space other than Engine.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaDeinterlaceMode DeinterlaceMode;
+
+	/**
+	 * Whether to create one progressive frame per field when deinterlacing (default = false).
+	 *
+	 * This doubles the frame rate for smoother motion. It has no effect in Weave mode.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	bool DeinterlaceToFieldRate;
+
+	/**
+	 * Whether to detect which rows of received video frames changed since the previous sample (default = false).
+	 *
+	 * The changed row ranges are attached to the video samples, so that custom texture
+	 * consumers can update only those rows, i.e. for lower thirds and score boards that
+	 * change only a small part of the frame. Frames are compared with the last frame that
+	 * was turned into a sample, so changes in dropped frames are carried over to the next
+	 * sample. Frames without changes are skipped if duplicate frame detection is enabled.
+	 * The ranges of the last sample are shown in the player stats.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	bool DetectDirtyRows;
+
+	/**
+	 * Reduce the resolution of received video frames (default = None).
+	 *
+	 * Use this setting for multiviewers and previews that display the video much smaller
+	 * than its native resolution, so that only a fraction of the data has to be uploaded.
+	 * Downscaling is supported for BGRA and UYVY frames, and for UYVA frames that
+	 * are converted with a color space other than Engine.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaDownscale Downscale;
+
+	/** The filter to use for reducing the resolution (default = Box). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaDownscaleFilter DownscaleFilter;
+
+	/**
+	 * Whether to skip received video frames that are identical to the previous frame (default = None).
+	 *
+	 * Sources that show slides or static graphics often repeat the same frame at full
+	 * frame rate. Skipped frames are not uploaded, and the texture keeps showing the
+	 * previous frame. Each frame is hashed on the CPU, which takes a fraction of the
+	 * time required for copying it.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	ENdiMediaDuplicateFrameDetection DuplicateFrameDetection;
+
+	/**
+	 * Maximum number of threads for processing a received video frame on the CPU (0 = all worker threads, default = 0).
+	 *
+	 * Copying, conversion and deinterlacing of large frames is split into bands of rows
+	 * that are processed in parallel. Lower this value if many players are open at once.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
+	int32 MaxVideoThreads;
+
 	/** Preferred video frame format type (default = NoPreference). */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=Video, AdvancedDisplay)
 	ENdiMediaFrameFormatPreference PreferredFrameFormat;
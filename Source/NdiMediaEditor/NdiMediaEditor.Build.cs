@@ -30,6 +30,7 @@ namespace UnrealBuildTool.Rules
 					"NdiMediaEditor/Private",
 					"NdiMediaEditor/Private/Customizations",
 					"NdiMediaEditor/Private/Factories",
+					"NdiMediaEditor/Private/Widgets",
 				});
 		}
 	}
@@ -5,11 +5,11 @@
 #include "DetailCategoryBuilder.h"
 #include "DetailLayoutBuilder.h"
 #include "DetailWidgetRow.h"
-#include "Framework/MultiBox/MultiBoxBuilder.h"
-#include "HAL/PlatformProcess.h"
+#include "Framework/Application/SlateApplication.h"
 #include "IDetailPropertyRow.h"
 #include "NdiMediaFinder.h"
 #include "NdiMediaSource.h"
+#include "SNdiMediaSourcePicker.h"
 #include "Widgets/Input/SComboButton.h"
 
 
@@ -94,126 +94,27 @@ void FNdiMediaSourceCustomization::CustomizeDetails(IDetailLayoutBuilder& Detail
 
 TSharedRef<SWidget> FNdiMediaSourceCustomization::HandleSourceComboButtonMenuContent(EProperty Property) const
 {
-	// get default NDI source finder object
-	auto DefaultFinder = GetDefault<UNdiMediaFinder>();
-
-	if (DefaultFinder == nullptr)
-	{
-		return SNullWidget::NullWidget;
-	}
-
-	// fetch found NDI sources
-	TArray<FNdiMediaSourceId> OutSources;
-
-	if (!DefaultFinder->GetSources(OutSources))
+	FNdiMediaSourceId SelectedSource;
 	{
-		return SNullWidget::NullWidget;
+		SourceEndpointProperty->GetValue(SelectedSource.Endpoint);
+		SourceNameProperty->GetValue(SelectedSource.Name);
 	}
 
-	// generate menu
-	FMenuBuilder MenuBuilder(true, nullptr);
-
-	MenuBuilder.BeginSection("AllSources", LOCTEXT("AllSourcesSection", "All Sources"));
-	{
-		bool SourceAdded = false;
-
-		for (auto Source : OutSources)
-		{
-			const TSharedPtr<IPropertyHandle> ResetProperty = (Property == EProperty::SourceName) ? SourceEndpointProperty : SourceNameProperty;
-			const TSharedPtr<IPropertyHandle> ValueProperty = (Property == EProperty::SourceName) ? SourceNameProperty : SourceEndpointProperty;
-			const FString ValueStr = (Property == EProperty::SourceName) ? Source.Name : Source.Endpoint;
-			const FString UrlStr = FString(TEXT("ndi://")) + ValueStr;
-
-			MenuBuilder.AddMenuEntry(
-				FText::FromString(Source.ToString()),
-				FText::FromString(UrlStr),
-				FSlateIcon(),
-				FUIAction(
-					FExecuteAction::CreateLambda([=] {
-						ValueProperty->SetValue(ValueStr);
-						ResetProperty->SetValue(FString());
-					}),
-					FCanExecuteAction(),
-					FIsActionChecked::CreateLambda([=]{
-						FString CurrentValue;
-						return ((ValueProperty->GetValue(CurrentValue) == FPropertyAccess::Success) && CurrentValue == ValueStr);
-					})
-				),
-				NAME_None,
-				EUserInterfaceActionType::RadioButton
-			);
-
-			SourceAdded = true;
-		}
-
-		if (!SourceAdded)
-		{
-			MenuBuilder.AddWidget(SNullWidget::NullWidget, LOCTEXT("NoSourcesFound", "No sources found"), false, false);
-		}
-	}
-	MenuBuilder.EndSection();
-
-	const FString LocalhostPrefix = FString(FPlatformProcess::ComputerName()) + TEXT(" ");
+	return SNew(SNdiMediaSourcePicker)
+		.OnSourcePicked(this, &FNdiMediaSourceCustomization::HandleSourcePickerSourcePicked, Property)
+		.SelectedSource(SelectedSource);
+}
 
-	MenuBuilder.BeginSection("LocalSources", LOCTEXT("LocalSourcesSection", "Local Sources"));
-	{
-		bool SourceAdded = false;
 
-		for (auto Source : OutSources)
-		{
-			FString Name = Source.Name;
-
-			if (!Name.StartsWith(LocalhostPrefix))
-			{
-				continue;
-			}
-
-			const int32 ColonIdx = Source.Endpoint.Find(TEXT(":"));
-
-			if (ColonIdx == INDEX_NONE)
-			{
-				continue;
-			}
-
-			const TSharedPtr<IPropertyHandle> ResetProperty = (Property == EProperty::SourceName) ? SourceEndpointProperty : SourceNameProperty;
-			const TSharedPtr<IPropertyHandle> ValueProperty = (Property == EProperty::SourceName) ? SourceNameProperty : SourceEndpointProperty;
-
-			const FString EndpointStr = FString(TEXT("127.0.0.1")) + Source.Endpoint.RightChop(ColonIdx);
-			const FString NameStr = Name.Replace(*LocalhostPrefix, TEXT("localhost "));
-			const FString SourceStr = NameStr + TEXT(" [") + EndpointStr + TEXT("]");
-			const FString ValueStr = (Property == EProperty::SourceName) ? NameStr : EndpointStr;
-			const FString UrlStr = FString(TEXT("ndi://")) + ValueStr;
-
-			MenuBuilder.AddMenuEntry(
-				FText::FromString(SourceStr),
-				FText::FromString(UrlStr),
-				FSlateIcon(),
-				FUIAction(
-					FExecuteAction::CreateLambda([=] {
-						ValueProperty->SetValue(ValueStr);
-						ResetProperty->SetValue(FString());
-					}),
-					FCanExecuteAction(),
-					FIsActionChecked::CreateLambda([=]{
-						FString CurrentValue;
-						return ((ValueProperty->GetValue(CurrentValue) == FPropertyAccess::Success) && CurrentValue == ValueStr);
-					})
-				),
-				NAME_None,
-				EUserInterfaceActionType::RadioButton
-			);
-
-			SourceAdded = true;
-		}
+void FNdiMediaSourceCustomization::HandleSourcePickerSourcePicked(const FNdiMediaSourceId& Source, EProperty Property) const
+{
+	const TSharedPtr<IPropertyHandle> ResetProperty = (Property == EProperty::SourceName) ? SourceEndpointProperty : SourceNameProperty;
+	const TSharedPtr<IPropertyHandle> ValueProperty = (Property == EProperty::SourceName) ? SourceNameProperty : SourceEndpointProperty;
 
-		if (!SourceAdded)
-		{
-			MenuBuilder.AddWidget(SNullWidget::NullWidget, LOCTEXT("NoSourcesFound", "No sources found"), false, false);
-		}
-	}
-	MenuBuilder.EndSection();
+	ValueProperty->SetValue((Property == EProperty::SourceName) ? Source.Name : Source.Endpoint);
+	ResetProperty->SetValue(FString());
 
-	return MenuBuilder.MakeWidget();
+	FSlateApplication::Get().DismissAllMenus();
 }
 
 
@@ -9,6 +9,8 @@
 class IPropertyHandle;
 class SWidget;
 
+struct FNdiMediaSourceId;
+
 
 /**
  * Implements a details view customization for the UNdiMediaSource class.
@@ -40,9 +42,12 @@ private:
 		SourceName
 	};
 
-	/** Callback for generating the menu content of the SourceName combo box. */
+	/** Callback for generating the menu content of the SourceName and SourceEndpoint combo boxes. */
 	TSharedRef<SWidget> HandleSourceComboButtonMenuContent(EProperty Property) const;
 
+	/** Callback for picking a source in the source picker. */
+	void HandleSourcePickerSourcePicked(const FNdiMediaSourceId& Source, EProperty Property) const;
+
 private:
 
 	/** Pointer to the SourceEndpoint property handle. */
@@ -0,0 +1,39 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "NdiMediaSenderFactoryNew.h"
+
+#include "AssetTypeCategories.h"
+#include "NdiMediaSender.h"
+
+
+/* UNdiMediaSenderFactoryNew structors
+ *****************************************************************************/
+
+UNdiMediaSenderFactoryNew::UNdiMediaSenderFactoryNew(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	SupportedClass = UNdiMediaSender::StaticClass();
+	bCreateNew = true;
+	bEditAfterNew = true;
+}
+
+
+/* UFactory overrides
+ *****************************************************************************/
+
+UObject* UNdiMediaSenderFactoryNew::FactoryCreateNew(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags, UObject* Context, FFeedbackContext* Warn)
+{
+	return NewObject<UNdiMediaSender>(InParent, InClass, InName, Flags);
+}
+
+
+uint32 UNdiMediaSenderFactoryNew::GetMenuCategories() const
+{
+	return EAssetTypeCategories::Media;
+}
+
+
+bool UNdiMediaSenderFactoryNew::ShouldShowInNewMenu() const
+{
+	return true;
+}
@@ -0,0 +1,359 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "SNdiMediaSourcePicker.h"
+
+#include "Brushes/SlateDynamicImageBrush.h"
+#include "DetailLayoutBuilder.h"
+#include "HAL/PlatformProcess.h"
+#include "INdiMediaModule.h"
+#include "Modules/ModuleManager.h"
+#include "Widgets/Images/SImage.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/STableRow.h"
+
+
+#define LOCTEXT_NAMESPACE "SNdiMediaSourcePicker"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Interval at which the picker checks for changed sources (in seconds). */
+static const float SourcesRefreshInterval = 1.0f;
+
+/** Size at which source thumbnails are displayed (in slate units). */
+static const FVector2D ThumbnailSize(64.0f, 36.0f);
+
+
+/* SNdiMediaSourcePicker interface
+ *****************************************************************************/
+
+void SNdiMediaSourcePicker::Construct(const FArguments& InArgs)
+{
+	NdiMediaModule = FModuleManager::LoadModulePtr<INdiMediaModule>("NdiMedia");
+	NumThumbnailBrushes = 0;
+	OnSourcePicked = InArgs._OnSourcePicked;
+	SelectedSource = InArgs._SelectedSource;
+
+	ChildSlot
+	[
+		SNew(SBox)
+			.MaxDesiredHeight(480.0f)
+			.WidthOverride(480.0f)
+			[
+				SNew(SVerticalBox)
+
+				+ SVerticalBox::Slot()
+					.AutoHeight()
+					.Padding(4.0f)
+					[
+						SAssignNew(SearchBox, SSearchBox)
+							.HintText(LOCTEXT("SearchBoxHint", "Search sources"))
+							.OnTextChanged(this, &SNdiMediaSourcePicker::HandleSearchBoxTextChanged)
+							.OnTextCommitted(this, &SNdiMediaSourcePicker::HandleSearchBoxTextCommitted)
+					]
+
+				+ SVerticalBox::Slot()
+					.FillHeight(1.0f)
+					[
+						SAssignNew(ListView, SListView<TSharedPtr<FItem>>)
+							.ListItemsSource(&Items)
+							.OnGenerateRow(this, &SNdiMediaSourcePicker::HandleListViewGenerateRow)
+							.OnMouseButtonClick(this, &SNdiMediaSourcePicker::HandleListViewMouseButtonClick)
+							.SelectionMode(ESelectionMode::Single)
+					]
+			]
+	];
+
+	GetDefault<UNdiMediaFinder>()->GetSources(Sources);
+	RefreshItems();
+
+	// highlight the current source
+	for (const TSharedPtr<FItem>& Item : Items)
+	{
+		if (!Item->IsHeader &&
+			((!SelectedSource.Name.IsEmpty() && (Item->Source.Name == SelectedSource.Name)) ||
+			 (!SelectedSource.Endpoint.IsEmpty() && (Item->Source.Endpoint == SelectedSource.Endpoint))))
+		{
+			ListView->SetSelection(Item);
+			ListView->RequestScrollIntoView(Item);
+
+			break;
+		}
+	}
+
+	RegisterActiveTimer(SourcesRefreshInterval, FWidgetActiveTimerDelegate::CreateSP(this, &SNdiMediaSourcePicker::HandleActiveTimer));
+}
+
+
+TSharedRef<SWidget> SNdiMediaSourcePicker::GetWidgetToFocus() const
+{
+	return SearchBox.ToSharedRef();
+}
+
+
+/* SNdiMediaSourcePicker implementation
+ *****************************************************************************/
+
+void SNdiMediaSourcePicker::PickItem(TSharedPtr<FItem> Item)
+{
+	if (Item.IsValid() && !Item->IsHeader)
+	{
+		OnSourcePicked.ExecuteIfBound(Item->Source);
+	}
+}
+
+
+void SNdiMediaSourcePicker::RefreshItems()
+{
+	Items.Reset();
+
+	// filter sources
+	TArray<FNdiMediaSourceId> FilteredSources;
+
+	if (FilterString.IsEmpty())
+	{
+		FilteredSources = Sources;
+	}
+	else
+	{
+		GetDefault<UNdiMediaFinder>()->SearchSources(FilterString, false, FilteredSources);
+	}
+
+	// group by machine
+	TMap<FString, TArray<FNdiMediaSourceId>> MachineSources;
+
+	for (const FNdiMediaSourceId& Source : FilteredSources)
+	{
+		MachineSources.FindOrAdd(Source.GetMachineName()).Add(Source);
+	}
+
+	MachineSources.KeySort(TLess<FString>());
+
+	for (auto& MachineSourcesPair : MachineSources)
+	{
+		MachineSourcesPair.Value.Sort([](const FNdiMediaSourceId& A, const FNdiMediaSourceId& B) {
+			return (A.Name < B.Name);
+		});
+	}
+
+	// local sources, reachable via loopback
+	const FString LocalMachine = FPlatformProcess::ComputerName();
+	const TArray<FNdiMediaSourceId>* LocalSources = MachineSources.Find(LocalMachine);
+
+	if (LocalSources != nullptr)
+	{
+		const TSharedPtr<FItem> HeaderItem = MakeShareable(new FItem);
+		{
+			HeaderItem->IsHeader = true;
+			HeaderItem->Label = LOCTEXT("LocalSourcesHeader", "Local Sources");
+		}
+
+		Items.Add(HeaderItem);
+
+		for (const FNdiMediaSourceId& Source : *LocalSources)
+		{
+			const int32 ColonIdx = Source.Endpoint.Find(TEXT(":"));
+
+			if (ColonIdx == INDEX_NONE)
+			{
+				continue;
+			}
+
+			const TSharedPtr<FItem> SourceItem = MakeShareable(new FItem);
+			{
+				SourceItem->IsHeader = false;
+				SourceItem->Source.Endpoint = FString(TEXT("127.0.0.1")) + Source.Endpoint.RightChop(ColonIdx);
+				SourceItem->Source.Name = FString(TEXT("localhost")) + Source.Name.RightChop(LocalMachine.Len());
+				SourceItem->Label = FText::FromString(SourceItem->Source.Name);
+				SourceItem->NetworkSource = Source;
+			}
+
+			Items.Add(SourceItem);
+		}
+	}
+
+	// all sources
+	for (const auto& MachineSourcesPair : MachineSources)
+	{
+		const TSharedPtr<FItem> HeaderItem = MakeShareable(new FItem);
+		{
+			HeaderItem->IsHeader = true;
+			HeaderItem->Label = MachineSourcesPair.Key.IsEmpty()
+				? LOCTEXT("OtherSourcesHeader", "Other Sources")
+				: FText::Format(LOCTEXT("MachineHeaderFormat", "{0} ({1})"), FText::FromString(MachineSourcesPair.Key), FText::AsNumber(MachineSourcesPair.Value.Num()));
+		}
+
+		Items.Add(HeaderItem);
+
+		for (const FNdiMediaSourceId& Source : MachineSourcesPair.Value)
+		{
+			const TSharedPtr<FItem> SourceItem = MakeShareable(new FItem);
+			{
+				SourceItem->IsHeader = false;
+				SourceItem->Label = FText::FromString(Source.Name);
+				SourceItem->NetworkSource = Source;
+				SourceItem->Source = Source;
+			}
+
+			Items.Add(SourceItem);
+		}
+	}
+
+	ListView->RequestListRefresh();
+}
+
+
+/* SNdiMediaSourcePicker callbacks
+ *****************************************************************************/
+
+EActiveTimerReturnType SNdiMediaSourcePicker::HandleActiveTimer(double InCurrentTime, float InDeltaTime)
+{
+	TArray<FNdiMediaSourceId> NewSources;
+	GetDefault<UNdiMediaFinder>()->GetSources(NewSources);
+
+	if (NewSources != Sources)
+	{
+		Sources = MoveTemp(NewSources);
+		RefreshItems();
+	}
+
+	return EActiveTimerReturnType::Continue;
+}
+
+
+TSharedRef<ITableRow> SNdiMediaSourcePicker::HandleListViewGenerateRow(TSharedPtr<FItem> Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	if (Item->IsHeader)
+	{
+		return SNew(STableRow<TSharedPtr<FItem>>, OwnerTable)
+			.ShowSelection(false)
+			[
+				SNew(STextBlock)
+					.Font(IDetailLayoutBuilder::GetDetailFontBold())
+					.Margin(FMargin(2.0f, 4.0f, 2.0f, 2.0f))
+					.Text(Item->Label)
+			];
+	}
+
+	return SNew(STableRow<TSharedPtr<FItem>>, OwnerTable)
+		.ToolTipText(FText::FromString(Item->Source.ToString()))
+		[
+			SNew(SHorizontalBox)
+
+			+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(12.0f, 2.0f, 4.0f, 2.0f)
+				[
+					SNew(SBox)
+						.HeightOverride(ThumbnailSize.Y)
+						.WidthOverride(ThumbnailSize.X)
+						[
+							SNew(SImage)
+								.Image(this, &SNdiMediaSourcePicker::HandleThumbnailImage, Item)
+						]
+				]
+
+			+ SHorizontalBox::Slot()
+				.FillWidth(1.0f)
+				.Padding(4.0f, 2.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+						.Font(IDetailLayoutBuilder::GetDetailFont())
+						.HighlightText(FText::FromString(FilterString))
+						.Text(Item->Label)
+				]
+
+			+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(4.0f, 2.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+						.ColorAndOpacity(FSlateColor::UseSubduedForeground())
+						.Font(IDetailLayoutBuilder::GetDetailFont())
+						.Text(FText::FromString(Item->Source.Endpoint))
+				]
+		];
+}
+
+
+void SNdiMediaSourcePicker::HandleListViewMouseButtonClick(TSharedPtr<FItem> Item)
+{
+	PickItem(Item);
+}
+
+
+void SNdiMediaSourcePicker::HandleSearchBoxTextChanged(const FText& NewText)
+{
+	FilterString = NewText.ToString().TrimStartAndEnd();
+	RefreshItems();
+}
+
+
+void SNdiMediaSourcePicker::HandleSearchBoxTextCommitted(const FText& NewText, ETextCommit::Type CommitType)
+{
+	if (CommitType != ETextCommit::OnEnter)
+	{
+		return;
+	}
+
+	// pick the selected source, or the first one that matches the filter
+	TArray<TSharedPtr<FItem>> SelectedItems = ListView->GetSelectedItems();
+
+	if ((SelectedItems.Num() > 0) && !SelectedItems[0]->IsHeader)
+	{
+		PickItem(SelectedItems[0]);
+
+		return;
+	}
+
+	for (const TSharedPtr<FItem>& Item : Items)
+	{
+		if (!Item->IsHeader)
+		{
+			PickItem(Item);
+
+			break;
+		}
+	}
+}
+
+
+const FSlateBrush* SNdiMediaSourcePicker::HandleThumbnailImage(TSharedPtr<FItem> Item)
+{
+	// only called for visible rows, which keeps their thumbnails refreshing
+	if (NdiMediaModule == nullptr)
+	{
+		return nullptr;
+	}
+
+	const TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> Thumbnail = NdiMediaModule->GetSourceThumbnail(Item->NetworkSource);
+
+	if (!Thumbnail.IsValid())
+	{
+		return nullptr;
+	}
+
+	FThumbnailBrush& ThumbnailBrush = ThumbnailBrushes.FindOrAdd(Item->NetworkSource.Name);
+
+	if (ThumbnailBrush.Thumbnail != Thumbnail)
+	{
+		ThumbnailBrush.Brush = FSlateDynamicImageBrush::CreateWithImageData(
+			FName(TEXT("NdiMediaSourceThumbnail"), ++NumThumbnailBrushes),
+			FVector2D(Thumbnail->Dim.X, Thumbnail->Dim.Y),
+			Thumbnail->Pixels
+		);
+
+		ThumbnailBrush.Thumbnail = Thumbnail;
+	}
+
+	return ThumbnailBrush.Brush.Get();
+}
+
+
+#undef LOCTEXT_NAMESPACE
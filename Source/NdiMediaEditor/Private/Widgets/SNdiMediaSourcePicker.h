@@ -0,0 +1,152 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Input/Reply.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+#include "NdiMediaFinder.h"
+
+
+class INdiMediaModule;
+class ITableRow;
+class SSearchBox;
+class STableViewBase;
+
+struct FNdiMediaSourceThumbnail;
+struct FSlateBrush;
+struct FSlateDynamicImageBrush;
+
+
+/** Delegate that is executed when an NDI source was picked. */
+DECLARE_DELEGATE_OneParam(FOnNdiMediaSourcePicked, const FNdiMediaSourceId& /*Source*/);
+
+
+/**
+ * Implements a searchable list of discovered NDI sources, grouped by machine.
+ *
+ * The list is virtualized, so that only the visible rows are generated, and filtering
+ * uses the source index of the default UNdiMediaFinder. This keeps the picker
+ * responsive even if thousands of sources are on the network. Thumbnails are only
+ * requested for the visible rows.
+ */
+class SNdiMediaSourcePicker
+	: public SCompoundWidget
+{
+public:
+
+	SLATE_BEGIN_ARGS(SNdiMediaSourcePicker) { }
+
+		/** The source that is currently selected (only its name or endpoint need to be set). */
+		SLATE_ARGUMENT(FNdiMediaSourceId, SelectedSource)
+
+		/** Called when a source was picked. */
+		SLATE_EVENT(FOnNdiMediaSourcePicked, OnSourcePicked)
+
+	SLATE_END_ARGS()
+
+public:
+
+	/**
+	 * Construct this widget.
+	 *
+	 * @param InArgs The declaration data for this widget.
+	 */
+	void Construct(const FArguments& InArgs);
+
+	/**
+	 * Get the widget that should receive keyboard focus when the picker opens.
+	 *
+	 * @return The search box.
+	 */
+	TSharedRef<SWidget> GetWidgetToFocus() const;
+
+private:
+
+	/** A row in the source list. */
+	struct FItem
+	{
+		/** Whether this item is a machine header. */
+		bool IsHeader;
+
+		/** The display text (header text or source name). */
+		FText Label;
+
+		/** The source as discovered (differs from Source for local sources). */
+		FNdiMediaSourceId NetworkSource;
+
+		/** The source (not set for headers). */
+		FNdiMediaSourceId Source;
+	};
+
+	/** A source thumbnail that was converted to a brush. */
+	struct FThumbnailBrush
+	{
+		/** The brush. */
+		TSharedPtr<FSlateDynamicImageBrush> Brush;
+
+		/** The thumbnail that the brush was created from. */
+		TSharedPtr<const FNdiMediaSourceThumbnail, ESPMode::ThreadSafe> Thumbnail;
+	};
+
+	/** Pick the specified item, unless it is a header. */
+	void PickItem(TSharedPtr<FItem> Item);
+
+	/** Rebuild the list items from the discovered sources and the current filter. */
+	void RefreshItems();
+
+private:
+
+	/** Callback for periodically checking for changed sources. */
+	EActiveTimerReturnType HandleActiveTimer(double InCurrentTime, float InDeltaTime);
+
+	/** Callback for generating a row in the source list. */
+	TSharedRef<ITableRow> HandleListViewGenerateRow(TSharedPtr<FItem> Item, const TSharedRef<STableViewBase>& OwnerTable);
+
+	/** Callback for clicking a row in the source list. */
+	void HandleListViewMouseButtonClick(TSharedPtr<FItem> Item);
+
+	/** Callback for changing the search box text. */
+	void HandleSearchBoxTextChanged(const FText& NewText);
+
+	/** Callback for committing the search box text. */
+	void HandleSearchBoxTextCommitted(const FText& NewText, ETextCommit::Type CommitType);
+
+	/** Callback for getting the thumbnail image of a source row. */
+	const FSlateBrush* HandleThumbnailImage(TSharedPtr<FItem> Item);
+
+private:
+
+	/** The current filter text. */
+	FString FilterString;
+
+	/** The list items (machine headers and sources). */
+	TArray<TSharedPtr<FItem>> Items;
+
+	/** The list view. */
+	TSharedPtr<SListView<TSharedPtr<FItem>>> ListView;
+
+	/** The NdiMedia module, used to get source thumbnails. */
+	INdiMediaModule* NdiMediaModule;
+
+	/** Number of thumbnail brushes created so far, used to name them. */
+	int32 NumThumbnailBrushes;
+
+	/** Delegate that is executed when a source was picked. */
+	FOnNdiMediaSourcePicked OnSourcePicked;
+
+	/** The search box. */
+	TSharedPtr<SSearchBox> SearchBox;
+
+	/** The source that was selected when the picker opened. */
+	FNdiMediaSourceId SelectedSource;
+
+	/** The sources that the list items were built from. */
+	TArray<FNdiMediaSourceId> Sources;
+
+	/** Thumbnail brushes by source name. */
+	TMap<FString, FThumbnailBrush> ThumbnailBrushes;
+};